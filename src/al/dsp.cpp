@@ -88,6 +88,17 @@ class DspSSE86 : public Dsp {
       };
 #endif
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+// In dspAVX2.cpp and dspAVX512.cpp.
+extern Dsp* createDspAVX2();
+extern Dsp* createDspAVX512();
+#endif
+
+#if defined(__aarch64__)
+// In dspNEON.cpp.
+extern Dsp* createDspNEON();
+#endif
+
 //---------------------------------------------------------
 //   initDsp
 //---------------------------------------------------------
@@ -104,6 +115,27 @@ void initDsp()
 #endif
 #endif
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+      // Pick the widest instruction set the cpu supports.
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx512f")) {
+            printf("Using AVX-512 optimized routines\n");
+            dsp = createDspAVX512();
+            return;
+            }
+      if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            printf("Using AVX2 optimized routines\n");
+            dsp = createDspAVX2();
+            return;
+            }
+#endif
+
+#if defined(__aarch64__)
+      printf("Using NEON optimized routines\n");
+      dsp = createDspNEON();
+      return;
+#endif
+
 #if defined(__i386__) && defined(USE_SSE)
       unsigned long useSSE = 0;
       if(debugMsg)
@@ -203,4 +235,40 @@ void Dsp::cpy(float* dst, float* src, unsigned n, bool addDenormal)
 #endif
 }
 
+//---------------------------------------------------------
+//   rampGain
+//---------------------------------------------------------
+
+unsigned Dsp::rampGain(float* dst, float* src, unsigned n, double& gain, double factor, double target, double floor)
+{
+  unsigned i = 0;
+  if(factor > 1.0)
+  {
+    for( ; i < n; ++i)
+    {
+      gain *= factor;
+      if(gain >= target)
+      {
+        gain = target;
+        break;
+      }
+      dst[i] = src[i] * gain;
+    }
+  }
+  else
+  {
+    for( ; i < n; ++i)
+    {
+      gain *= factor;
+      if(gain <= target || gain <= floor)
+      {
+        gain = target;
+        break;
+      }
+      dst[i] = src[i] * gain;
+    }
+  }
+  return i;
+}
+
 } // namespace AL
@@ -71,6 +71,54 @@ class Dsp {
                   dst[i] += src[i];
             }
       virtual void cpy(float* dst, float* src, unsigned n, bool addDenormal = false);
+
+      //---------------------------------------------------
+      //   Fused routines. They save passes over the
+      //    buffers in the track processing code.
+      //---------------------------------------------------
+
+      // dst = src * gain
+      virtual void cpyWithGain(float* dst, float* src, unsigned n, float gain) {
+            for (unsigned i = 0; i < n; ++i)
+                  dst[i] = src[i] * gain;
+            }
+      // dst = src * gain. Returns the peak of dst, or current if higher.
+      virtual float cpyWithGainAndPeak(float* dst, float* src, unsigned n, float gain, float current) {
+            for (unsigned i = 0; i < n; ++i) {
+                  dst[i] = src[i] * gain;
+                  current = f_max(current, fabsf(dst[i]));
+                  }
+            return current;
+            }
+      // dst += src * gain. Returns the peak of src * gain, or current if higher.
+      virtual float mixWithGainAndPeak(float* dst, float* src, unsigned n, float gain, float current) {
+            for (unsigned i = 0; i < n; ++i) {
+                  const float v = src[i] * gain;
+                  dst[i] += v;
+                  current = f_max(current, fabsf(v));
+                  }
+            return current;
+            }
+      // Pans a mono source into two destinations: dstL (+)= src * gainL, dstR (+)= src * gainR.
+      virtual void mixStereoPan(float* dstL, float* dstR, float* src, unsigned n, float gainL, float gainR, bool add = false) {
+            if (add) {
+                  for (unsigned i = 0; i < n; ++i) {
+                        dstL[i] += src[i] * gainL;
+                        dstR[i] += src[i] * gainR;
+                        }
+                  }
+            else {
+                  for (unsigned i = 0; i < n; ++i) {
+                        dstL[i] = src[i] * gainL;
+                        dstR[i] = src[i] * gainR;
+                        }
+                  }
+            }
+      // dst = src * gain, where gain is multiplied by factor before each frame,
+      //  ramping it towards target. Stops at the frame where gain would reach target,
+      //  or for a downward ramp when it falls to floor, setting gain to target
+      //  without writing that frame. Returns the number of frames written.
+      virtual unsigned rampGain(float* dst, float* src, unsigned n, double& gain, double factor, double target, double floor);
 /*      
       {
 // Changed by T356. Not defined. Where are these???
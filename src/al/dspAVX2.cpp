@@ -0,0 +1,266 @@
+//=============================================================================
+//  AL
+//  Audio Utility Library
+//
+//  dspAVX2.cpp
+//  Copyright (C) 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//=============================================================================
+
+#include "al.h"
+#include "dsp.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+
+#include <immintrin.h>
+
+// The kernels are compiled for AVX2 + FMA by attribute rather than by compiler
+//  flags, so that nothing else in this file (or inline code from dsp.h) can
+//  accidentally end up using instructions the running cpu might not have.
+// DspAVX2 is only created by initDsp() after checking the cpu supports them.
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+
+namespace AL {
+
+//---------------------------------------------------------
+//   AVX2 kernels
+//    Buffers need not be aligned.
+//---------------------------------------------------------
+
+AVX2_TARGET static inline float avx2_hmax(__m256 v)
+      {
+      __m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+      m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+      m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+      return _mm_cvtss_f32(m);
+      }
+
+AVX2_TARGET static float avx2_peak(const float* buf, unsigned n, float current)
+      {
+      const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+      __m256 m0 = _mm256_set1_ps(current);
+      __m256 m1 = m0;
+      unsigned i = 0;
+      for ( ; i + 16 <= n; i += 16) {
+            m0 = _mm256_max_ps(m0, _mm256_and_ps(_mm256_loadu_ps(buf + i), abs_mask));
+            m1 = _mm256_max_ps(m1, _mm256_and_ps(_mm256_loadu_ps(buf + i + 8), abs_mask));
+            }
+      for ( ; i + 8 <= n; i += 8)
+            m0 = _mm256_max_ps(m0, _mm256_and_ps(_mm256_loadu_ps(buf + i), abs_mask));
+      current = avx2_hmax(_mm256_max_ps(m0, m1));
+      for ( ; i < n; ++i)
+            current = f_max(current, fabsf(buf[i]));
+      return current;
+      }
+
+AVX2_TARGET static void avx2_applyGain(float* buf, unsigned n, float gain)
+      {
+      const __m256 g = _mm256_set1_ps(gain);
+      unsigned i = 0;
+      for ( ; i + 8 <= n; i += 8)
+            _mm256_storeu_ps(buf + i, _mm256_mul_ps(_mm256_loadu_ps(buf + i), g));
+      for ( ; i < n; ++i)
+            buf[i] *= gain;
+      }
+
+AVX2_TARGET static void avx2_mixWithGain(float* dst, const float* src, unsigned n, float gain)
+      {
+      const __m256 g = _mm256_set1_ps(gain);
+      unsigned i = 0;
+      for ( ; i + 8 <= n; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(_mm256_loadu_ps(src + i), g, _mm256_loadu_ps(dst + i)));
+      for ( ; i < n; ++i)
+            dst[i] += src[i] * gain;
+      }
+
+AVX2_TARGET static void avx2_mix(float* dst, const float* src, unsigned n)
+      {
+      unsigned i = 0;
+      for ( ; i + 8 <= n; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_loadu_ps(src + i)));
+      for ( ; i < n; ++i)
+            dst[i] += src[i];
+      }
+
+AVX2_TARGET static void avx2_cpyDenormal(float* dst, const float* src, unsigned n)
+      {
+      const __m256 b = _mm256_set1_ps(denormalBias);
+      unsigned i = 0;
+      for ( ; i + 8 <= n; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(src + i), b));
+      for ( ; i < n; ++i)
+            dst[i] = src[i] + denormalBias;
+      }
+
+AVX2_TARGET static void avx2_cpyWithGain(float* dst, const float* src, unsigned n, float gain)
+      {
+      const __m256 g = _mm256_set1_ps(gain);
+      unsigned i = 0;
+      for ( ; i + 8 <= n; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+      for ( ; i < n; ++i)
+            dst[i] = src[i] * gain;
+      }
+
+AVX2_TARGET static float avx2_cpyWithGainAndPeak(float* dst, const float* src, unsigned n, float gain, float current)
+      {
+      const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+      const __m256 g = _mm256_set1_ps(gain);
+      __m256 m = _mm256_set1_ps(current);
+      unsigned i = 0;
+      for ( ; i + 8 <= n; i += 8) {
+            const __m256 v = _mm256_mul_ps(_mm256_loadu_ps(src + i), g);
+            _mm256_storeu_ps(dst + i, v);
+            m = _mm256_max_ps(m, _mm256_and_ps(v, abs_mask));
+            }
+      current = avx2_hmax(m);
+      for ( ; i < n; ++i) {
+            dst[i] = src[i] * gain;
+            current = f_max(current, fabsf(dst[i]));
+            }
+      return current;
+      }
+
+AVX2_TARGET static float avx2_mixWithGainAndPeak(float* dst, const float* src, unsigned n, float gain, float current)
+      {
+      const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+      const __m256 g = _mm256_set1_ps(gain);
+      __m256 m = _mm256_set1_ps(current);
+      unsigned i = 0;
+      for ( ; i + 8 <= n; i += 8) {
+            const __m256 v = _mm256_mul_ps(_mm256_loadu_ps(src + i), g);
+            _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), v));
+            m = _mm256_max_ps(m, _mm256_and_ps(v, abs_mask));
+            }
+      current = avx2_hmax(m);
+      for ( ; i < n; ++i) {
+            const float v = src[i] * gain;
+            dst[i] += v;
+            current = f_max(current, fabsf(v));
+            }
+      return current;
+      }
+
+AVX2_TARGET static void avx2_mixStereoPan(float* dstL, float* dstR, const float* src, unsigned n,
+   float gainL, float gainR, bool add)
+      {
+      const __m256 gl = _mm256_set1_ps(gainL);
+      const __m256 gr = _mm256_set1_ps(gainR);
+      unsigned i = 0;
+      if (add) {
+            for ( ; i + 8 <= n; i += 8) {
+                  const __m256 s = _mm256_loadu_ps(src + i);
+                  _mm256_storeu_ps(dstL + i, _mm256_fmadd_ps(s, gl, _mm256_loadu_ps(dstL + i)));
+                  _mm256_storeu_ps(dstR + i, _mm256_fmadd_ps(s, gr, _mm256_loadu_ps(dstR + i)));
+                  }
+            for ( ; i < n; ++i) {
+                  dstL[i] += src[i] * gainL;
+                  dstR[i] += src[i] * gainR;
+                  }
+            }
+      else {
+            for ( ; i + 8 <= n; i += 8) {
+                  const __m256 s = _mm256_loadu_ps(src + i);
+                  _mm256_storeu_ps(dstL + i, _mm256_mul_ps(s, gl));
+                  _mm256_storeu_ps(dstR + i, _mm256_mul_ps(s, gr));
+                  }
+            for ( ; i < n; ++i) {
+                  dstL[i] = src[i] * gainL;
+                  dstR[i] = src[i] * gainR;
+                  }
+            }
+      }
+
+// Processes whole blocks of 8 frames while the ramp cannot end inside the block.
+// Since the ramp is monotonic, it is enough to check the gain at the end of the block.
+// Returns the number of frames written. The scalar code finishes the rest.
+AVX2_TARGET static unsigned avx2_rampGainBlocks(float* dst, const float* src, unsigned n,
+   double& gain, double factor, double target, double floor)
+      {
+      double pw[8];
+      double p = 1.0;
+      for (int k = 0; k < 8; ++k) {
+            p *= factor;
+            pw[k] = p;
+            }
+      const double block_factor = pw[7];
+      const __m256 powers = _mm256_setr_ps(pw[0], pw[1], pw[2], pw[3], pw[4], pw[5], pw[6], pw[7]);
+      const bool up = factor > 1.0;
+      unsigned i = 0;
+      for ( ; i + 8 <= n; i += 8) {
+            const double end_gain = gain * block_factor;
+            if (up ? end_gain >= target : (end_gain <= target || end_gain <= floor))
+                  break;
+            const __m256 g = _mm256_mul_ps(_mm256_set1_ps(gain), powers);
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+            gain = end_gain;
+            }
+      return i;
+      }
+
+//---------------------------------------------------------
+//   DspAVX2
+//---------------------------------------------------------
+
+class DspAVX2 : public Dsp {
+   public:
+      DspAVX2() {}
+      virtual ~DspAVX2() {}
+
+      virtual float peak(float* buf, unsigned n, float current) {
+            return avx2_peak(buf, n, current);
+            }
+      virtual void applyGainToBuffer(float* buf, unsigned n, float gain) {
+            avx2_applyGain(buf, n, gain);
+            }
+      virtual void mixWithGain(float* dst, float* src, unsigned n, float gain) {
+            avx2_mixWithGain(dst, src, n, gain);
+            }
+      virtual void mix(float* dst, float* src, unsigned n) {
+            avx2_mix(dst, src, n);
+            }
+      virtual void cpy(float* dst, float* src, unsigned n, bool addDenormal = false) {
+            if (addDenormal)
+                  avx2_cpyDenormal(dst, src, n);
+            else
+                  memcpy(dst, src, sizeof(float) * n);
+            }
+      virtual void cpyWithGain(float* dst, float* src, unsigned n, float gain) {
+            avx2_cpyWithGain(dst, src, n, gain);
+            }
+      virtual float cpyWithGainAndPeak(float* dst, float* src, unsigned n, float gain, float current) {
+            return avx2_cpyWithGainAndPeak(dst, src, n, gain, current);
+            }
+      virtual float mixWithGainAndPeak(float* dst, float* src, unsigned n, float gain, float current) {
+            return avx2_mixWithGainAndPeak(dst, src, n, gain, current);
+            }
+      virtual void mixStereoPan(float* dstL, float* dstR, float* src, unsigned n, float gainL, float gainR, bool add = false) {
+            avx2_mixStereoPan(dstL, dstR, src, n, gainL, gainR, add);
+            }
+      virtual unsigned rampGain(float* dst, float* src, unsigned n, double& gain, double factor, double target, double floor) {
+            const unsigned done = avx2_rampGainBlocks(dst, src, n, gain, factor, target, floor);
+            return done + Dsp::rampGain(dst + done, src + done, n - done, gain, factor, target, floor);
+            }
+      };
+
+Dsp* createDspAVX2()
+      {
+      return new DspAVX2();
+      }
+
+} // namespace AL
+
+#endif // __x86_64__
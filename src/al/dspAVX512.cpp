@@ -0,0 +1,283 @@
+//=============================================================================
+//  AL
+//  Audio Utility Library
+//
+//  dspAVX512.cpp
+//  Copyright (C) 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//=============================================================================
+
+#include "al.h"
+#include "dsp.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+
+#include <immintrin.h>
+
+#if defined(__GNUC__) && !defined(__clang__)
+// Some GCC versions' avx512 headers give false 'uninitialized' warnings
+//  when used through target attributes instead of -mavx512f.
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// See dspAVX2.cpp. Only AVX-512 Foundation is required.
+#define AVX512_TARGET __attribute__((target("avx512f")))
+
+namespace AL {
+
+//---------------------------------------------------------
+//   AVX-512 kernels
+//    Buffers need not be aligned. Tails are handled
+//    with masked loads and stores.
+//---------------------------------------------------------
+
+AVX512_TARGET static inline __mmask16 avx512_tailMask(unsigned rem)
+      {
+      return (__mmask16)((1U << rem) - 1U);
+      }
+
+AVX512_TARGET static float avx512_peak(const float* buf, unsigned n, float current)
+      {
+      __m512 m0 = _mm512_set1_ps(current);
+      __m512 m1 = m0;
+      unsigned i = 0;
+      for ( ; i + 32 <= n; i += 32) {
+            m0 = _mm512_max_ps(m0, _mm512_abs_ps(_mm512_loadu_ps(buf + i)));
+            m1 = _mm512_max_ps(m1, _mm512_abs_ps(_mm512_loadu_ps(buf + i + 16)));
+            }
+      for ( ; i + 16 <= n; i += 16)
+            m0 = _mm512_max_ps(m0, _mm512_abs_ps(_mm512_loadu_ps(buf + i)));
+      if (i < n) {
+            const __mmask16 k = avx512_tailMask(n - i);
+            m1 = _mm512_mask_max_ps(m1, k, m1, _mm512_abs_ps(_mm512_maskz_loadu_ps(k, buf + i)));
+            }
+      return _mm512_reduce_max_ps(_mm512_max_ps(m0, m1));
+      }
+
+AVX512_TARGET static void avx512_applyGain(float* buf, unsigned n, float gain)
+      {
+      const __m512 g = _mm512_set1_ps(gain);
+      unsigned i = 0;
+      for ( ; i + 16 <= n; i += 16)
+            _mm512_storeu_ps(buf + i, _mm512_mul_ps(_mm512_loadu_ps(buf + i), g));
+      if (i < n) {
+            const __mmask16 k = avx512_tailMask(n - i);
+            _mm512_mask_storeu_ps(buf + i, k, _mm512_mul_ps(_mm512_maskz_loadu_ps(k, buf + i), g));
+            }
+      }
+
+AVX512_TARGET static void avx512_mixWithGain(float* dst, const float* src, unsigned n, float gain)
+      {
+      const __m512 g = _mm512_set1_ps(gain);
+      unsigned i = 0;
+      for ( ; i + 16 <= n; i += 16)
+            _mm512_storeu_ps(dst + i, _mm512_fmadd_ps(_mm512_loadu_ps(src + i), g, _mm512_loadu_ps(dst + i)));
+      if (i < n) {
+            const __mmask16 k = avx512_tailMask(n - i);
+            _mm512_mask_storeu_ps(dst + i, k,
+              _mm512_fmadd_ps(_mm512_maskz_loadu_ps(k, src + i), g, _mm512_maskz_loadu_ps(k, dst + i)));
+            }
+      }
+
+AVX512_TARGET static void avx512_mix(float* dst, const float* src, unsigned n)
+      {
+      unsigned i = 0;
+      for ( ; i + 16 <= n; i += 16)
+            _mm512_storeu_ps(dst + i, _mm512_add_ps(_mm512_loadu_ps(dst + i), _mm512_loadu_ps(src + i)));
+      if (i < n) {
+            const __mmask16 k = avx512_tailMask(n - i);
+            _mm512_mask_storeu_ps(dst + i, k,
+              _mm512_add_ps(_mm512_maskz_loadu_ps(k, dst + i), _mm512_maskz_loadu_ps(k, src + i)));
+            }
+      }
+
+AVX512_TARGET static void avx512_cpyDenormal(float* dst, const float* src, unsigned n)
+      {
+      const __m512 b = _mm512_set1_ps(denormalBias);
+      unsigned i = 0;
+      for ( ; i + 16 <= n; i += 16)
+            _mm512_storeu_ps(dst + i, _mm512_add_ps(_mm512_loadu_ps(src + i), b));
+      if (i < n) {
+            const __mmask16 k = avx512_tailMask(n - i);
+            _mm512_mask_storeu_ps(dst + i, k, _mm512_add_ps(_mm512_maskz_loadu_ps(k, src + i), b));
+            }
+      }
+
+AVX512_TARGET static void avx512_cpyWithGain(float* dst, const float* src, unsigned n, float gain)
+      {
+      const __m512 g = _mm512_set1_ps(gain);
+      unsigned i = 0;
+      for ( ; i + 16 <= n; i += 16)
+            _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_loadu_ps(src + i), g));
+      if (i < n) {
+            const __mmask16 k = avx512_tailMask(n - i);
+            _mm512_mask_storeu_ps(dst + i, k, _mm512_mul_ps(_mm512_maskz_loadu_ps(k, src + i), g));
+            }
+      }
+
+AVX512_TARGET static float avx512_cpyWithGainAndPeak(float* dst, const float* src, unsigned n, float gain, float current)
+      {
+      const __m512 g = _mm512_set1_ps(gain);
+      __m512 m = _mm512_set1_ps(current);
+      unsigned i = 0;
+      for ( ; i + 16 <= n; i += 16) {
+            const __m512 v = _mm512_mul_ps(_mm512_loadu_ps(src + i), g);
+            _mm512_storeu_ps(dst + i, v);
+            m = _mm512_max_ps(m, _mm512_abs_ps(v));
+            }
+      if (i < n) {
+            const __mmask16 k = avx512_tailMask(n - i);
+            const __m512 v = _mm512_mul_ps(_mm512_maskz_loadu_ps(k, src + i), g);
+            _mm512_mask_storeu_ps(dst + i, k, v);
+            m = _mm512_max_ps(m, _mm512_abs_ps(v));
+            }
+      return _mm512_reduce_max_ps(m);
+      }
+
+AVX512_TARGET static float avx512_mixWithGainAndPeak(float* dst, const float* src, unsigned n, float gain, float current)
+      {
+      const __m512 g = _mm512_set1_ps(gain);
+      __m512 m = _mm512_set1_ps(current);
+      unsigned i = 0;
+      for ( ; i + 16 <= n; i += 16) {
+            const __m512 v = _mm512_mul_ps(_mm512_loadu_ps(src + i), g);
+            _mm512_storeu_ps(dst + i, _mm512_add_ps(_mm512_loadu_ps(dst + i), v));
+            m = _mm512_max_ps(m, _mm512_abs_ps(v));
+            }
+      if (i < n) {
+            const __mmask16 k = avx512_tailMask(n - i);
+            const __m512 v = _mm512_mul_ps(_mm512_maskz_loadu_ps(k, src + i), g);
+            _mm512_mask_storeu_ps(dst + i, k, _mm512_add_ps(_mm512_maskz_loadu_ps(k, dst + i), v));
+            m = _mm512_max_ps(m, _mm512_abs_ps(v));
+            }
+      return _mm512_reduce_max_ps(m);
+      }
+
+AVX512_TARGET static void avx512_mixStereoPan(float* dstL, float* dstR, const float* src, unsigned n,
+   float gainL, float gainR, bool add)
+      {
+      const __m512 gl = _mm512_set1_ps(gainL);
+      const __m512 gr = _mm512_set1_ps(gainR);
+      unsigned i = 0;
+      if (add) {
+            for ( ; i + 16 <= n; i += 16) {
+                  const __m512 s = _mm512_loadu_ps(src + i);
+                  _mm512_storeu_ps(dstL + i, _mm512_fmadd_ps(s, gl, _mm512_loadu_ps(dstL + i)));
+                  _mm512_storeu_ps(dstR + i, _mm512_fmadd_ps(s, gr, _mm512_loadu_ps(dstR + i)));
+                  }
+            if (i < n) {
+                  const __mmask16 k = avx512_tailMask(n - i);
+                  const __m512 s = _mm512_maskz_loadu_ps(k, src + i);
+                  _mm512_mask_storeu_ps(dstL + i, k, _mm512_fmadd_ps(s, gl, _mm512_maskz_loadu_ps(k, dstL + i)));
+                  _mm512_mask_storeu_ps(dstR + i, k, _mm512_fmadd_ps(s, gr, _mm512_maskz_loadu_ps(k, dstR + i)));
+                  }
+            }
+      else {
+            for ( ; i + 16 <= n; i += 16) {
+                  const __m512 s = _mm512_loadu_ps(src + i);
+                  _mm512_storeu_ps(dstL + i, _mm512_mul_ps(s, gl));
+                  _mm512_storeu_ps(dstR + i, _mm512_mul_ps(s, gr));
+                  }
+            if (i < n) {
+                  const __mmask16 k = avx512_tailMask(n - i);
+                  const __m512 s = _mm512_maskz_loadu_ps(k, src + i);
+                  _mm512_mask_storeu_ps(dstL + i, k, _mm512_mul_ps(s, gl));
+                  _mm512_mask_storeu_ps(dstR + i, k, _mm512_mul_ps(s, gr));
+                  }
+            }
+      }
+
+// Processes whole blocks of 16 frames while the ramp cannot end inside the block.
+// Since the ramp is monotonic, it is enough to check the gain at the end of the block.
+// Returns the number of frames written. The scalar code finishes the rest.
+AVX512_TARGET static unsigned avx512_rampGainBlocks(float* dst, const float* src, unsigned n,
+   double& gain, double factor, double target, double floor)
+      {
+      float pw[16];
+      double p = 1.0;
+      for (int k = 0; k < 16; ++k) {
+            p *= factor;
+            pw[k] = p;
+            }
+      const double block_factor = p;
+      const __m512 powers = _mm512_loadu_ps(pw);
+      const bool up = factor > 1.0;
+      unsigned i = 0;
+      for ( ; i + 16 <= n; i += 16) {
+            const double end_gain = gain * block_factor;
+            if (up ? end_gain >= target : (end_gain <= target || end_gain <= floor))
+                  break;
+            const __m512 g = _mm512_mul_ps(_mm512_set1_ps(gain), powers);
+            _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_loadu_ps(src + i), g));
+            gain = end_gain;
+            }
+      return i;
+      }
+
+//---------------------------------------------------------
+//   DspAVX512
+//---------------------------------------------------------
+
+class DspAVX512 : public Dsp {
+   public:
+      DspAVX512() {}
+      virtual ~DspAVX512() {}
+
+      virtual float peak(float* buf, unsigned n, float current) {
+            return avx512_peak(buf, n, current);
+            }
+      virtual void applyGainToBuffer(float* buf, unsigned n, float gain) {
+            avx512_applyGain(buf, n, gain);
+            }
+      virtual void mixWithGain(float* dst, float* src, unsigned n, float gain) {
+            avx512_mixWithGain(dst, src, n, gain);
+            }
+      virtual void mix(float* dst, float* src, unsigned n) {
+            avx512_mix(dst, src, n);
+            }
+      virtual void cpy(float* dst, float* src, unsigned n, bool addDenormal = false) {
+            if (addDenormal)
+                  avx512_cpyDenormal(dst, src, n);
+            else
+                  memcpy(dst, src, sizeof(float) * n);
+            }
+      virtual void cpyWithGain(float* dst, float* src, unsigned n, float gain) {
+            avx512_cpyWithGain(dst, src, n, gain);
+            }
+      virtual float cpyWithGainAndPeak(float* dst, float* src, unsigned n, float gain, float current) {
+            return avx512_cpyWithGainAndPeak(dst, src, n, gain, current);
+            }
+      virtual float mixWithGainAndPeak(float* dst, float* src, unsigned n, float gain, float current) {
+            return avx512_mixWithGainAndPeak(dst, src, n, gain, current);
+            }
+      virtual void mixStereoPan(float* dstL, float* dstR, float* src, unsigned n, float gainL, float gainR, bool add = false) {
+            avx512_mixStereoPan(dstL, dstR, src, n, gainL, gainR, add);
+            }
+      virtual unsigned rampGain(float* dst, float* src, unsigned n, double& gain, double factor, double target, double floor) {
+            const unsigned done = avx512_rampGainBlocks(dst, src, n, gain, factor, target, floor);
+            return done + Dsp::rampGain(dst + done, src + done, n - done, gain, factor, target, floor);
+            }
+      };
+
+Dsp* createDspAVX512()
+      {
+      return new DspAVX512();
+      }
+
+} // namespace AL
+
+#endif // __x86_64__
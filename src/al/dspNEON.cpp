@@ -0,0 +1,244 @@
+//=============================================================================
+//  AL
+//  Audio Utility Library
+//
+//  dspNEON.cpp
+//  Copyright (C) 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//=============================================================================
+
+#include "al.h"
+#include "dsp.h"
+
+// NEON (Advanced SIMD) is part of the aarch64 base architecture,
+//  so no runtime check is needed.
+#if defined(__aarch64__)
+
+#include <arm_neon.h>
+
+namespace AL {
+
+//---------------------------------------------------------
+//   NEON kernels
+//---------------------------------------------------------
+
+static float neon_peak(const float* buf, unsigned n, float current)
+      {
+      float32x4_t m0 = vdupq_n_f32(current);
+      float32x4_t m1 = m0;
+      unsigned i = 0;
+      for ( ; i + 8 <= n; i += 8) {
+            m0 = vmaxq_f32(m0, vabsq_f32(vld1q_f32(buf + i)));
+            m1 = vmaxq_f32(m1, vabsq_f32(vld1q_f32(buf + i + 4)));
+            }
+      current = vmaxvq_f32(vmaxq_f32(m0, m1));
+      for ( ; i < n; ++i)
+            current = f_max(current, fabsf(buf[i]));
+      return current;
+      }
+
+static void neon_applyGain(float* buf, unsigned n, float gain)
+      {
+      unsigned i = 0;
+      for ( ; i + 4 <= n; i += 4)
+            vst1q_f32(buf + i, vmulq_n_f32(vld1q_f32(buf + i), gain));
+      for ( ; i < n; ++i)
+            buf[i] *= gain;
+      }
+
+static void neon_mixWithGain(float* dst, const float* src, unsigned n, float gain)
+      {
+      const float32x4_t g = vdupq_n_f32(gain);
+      unsigned i = 0;
+      for ( ; i + 4 <= n; i += 4)
+            vst1q_f32(dst + i, vfmaq_f32(vld1q_f32(dst + i), vld1q_f32(src + i), g));
+      for ( ; i < n; ++i)
+            dst[i] += src[i] * gain;
+      }
+
+static void neon_mix(float* dst, const float* src, unsigned n)
+      {
+      unsigned i = 0;
+      for ( ; i + 4 <= n; i += 4)
+            vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vld1q_f32(src + i)));
+      for ( ; i < n; ++i)
+            dst[i] += src[i];
+      }
+
+static void neon_cpyDenormal(float* dst, const float* src, unsigned n)
+      {
+      const float32x4_t b = vdupq_n_f32(denormalBias);
+      unsigned i = 0;
+      for ( ; i + 4 <= n; i += 4)
+            vst1q_f32(dst + i, vaddq_f32(vld1q_f32(src + i), b));
+      for ( ; i < n; ++i)
+            dst[i] = src[i] + denormalBias;
+      }
+
+static void neon_cpyWithGain(float* dst, const float* src, unsigned n, float gain)
+      {
+      unsigned i = 0;
+      for ( ; i + 4 <= n; i += 4)
+            vst1q_f32(dst + i, vmulq_n_f32(vld1q_f32(src + i), gain));
+      for ( ; i < n; ++i)
+            dst[i] = src[i] * gain;
+      }
+
+static float neon_cpyWithGainAndPeak(float* dst, const float* src, unsigned n, float gain, float current)
+      {
+      float32x4_t m = vdupq_n_f32(current);
+      unsigned i = 0;
+      for ( ; i + 4 <= n; i += 4) {
+            const float32x4_t v = vmulq_n_f32(vld1q_f32(src + i), gain);
+            vst1q_f32(dst + i, v);
+            m = vmaxq_f32(m, vabsq_f32(v));
+            }
+      current = vmaxvq_f32(m);
+      for ( ; i < n; ++i) {
+            dst[i] = src[i] * gain;
+            current = f_max(current, fabsf(dst[i]));
+            }
+      return current;
+      }
+
+static float neon_mixWithGainAndPeak(float* dst, const float* src, unsigned n, float gain, float current)
+      {
+      float32x4_t m = vdupq_n_f32(current);
+      unsigned i = 0;
+      for ( ; i + 4 <= n; i += 4) {
+            const float32x4_t v = vmulq_n_f32(vld1q_f32(src + i), gain);
+            vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), v));
+            m = vmaxq_f32(m, vabsq_f32(v));
+            }
+      current = vmaxvq_f32(m);
+      for ( ; i < n; ++i) {
+            const float v = src[i] * gain;
+            dst[i] += v;
+            current = f_max(current, fabsf(v));
+            }
+      return current;
+      }
+
+static void neon_mixStereoPan(float* dstL, float* dstR, const float* src, unsigned n,
+   float gainL, float gainR, bool add)
+      {
+      const float32x4_t gl = vdupq_n_f32(gainL);
+      const float32x4_t gr = vdupq_n_f32(gainR);
+      unsigned i = 0;
+      if (add) {
+            for ( ; i + 4 <= n; i += 4) {
+                  const float32x4_t s = vld1q_f32(src + i);
+                  vst1q_f32(dstL + i, vfmaq_f32(vld1q_f32(dstL + i), s, gl));
+                  vst1q_f32(dstR + i, vfmaq_f32(vld1q_f32(dstR + i), s, gr));
+                  }
+            for ( ; i < n; ++i) {
+                  dstL[i] += src[i] * gainL;
+                  dstR[i] += src[i] * gainR;
+                  }
+            }
+      else {
+            for ( ; i + 4 <= n; i += 4) {
+                  const float32x4_t s = vld1q_f32(src + i);
+                  vst1q_f32(dstL + i, vmulq_f32(s, gl));
+                  vst1q_f32(dstR + i, vmulq_f32(s, gr));
+                  }
+            for ( ; i < n; ++i) {
+                  dstL[i] = src[i] * gainL;
+                  dstR[i] = src[i] * gainR;
+                  }
+            }
+      }
+
+// Processes whole blocks of 4 frames while the ramp cannot end inside the block.
+// Since the ramp is monotonic, it is enough to check the gain at the end of the block.
+// Returns the number of frames written. The scalar code finishes the rest.
+static unsigned neon_rampGainBlocks(float* dst, const float* src, unsigned n,
+   double& gain, double factor, double target, double floor)
+      {
+      float pw[4];
+      double p = 1.0;
+      for (int k = 0; k < 4; ++k) {
+            p *= factor;
+            pw[k] = p;
+            }
+      const double block_factor = p;
+      const float32x4_t powers = vld1q_f32(pw);
+      const bool up = factor > 1.0;
+      unsigned i = 0;
+      for ( ; i + 4 <= n; i += 4) {
+            const double end_gain = gain * block_factor;
+            if (up ? end_gain >= target : (end_gain <= target || end_gain <= floor))
+                  break;
+            const float32x4_t g = vmulq_n_f32(powers, (float)gain);
+            vst1q_f32(dst + i, vmulq_f32(vld1q_f32(src + i), g));
+            gain = end_gain;
+            }
+      return i;
+      }
+
+//---------------------------------------------------------
+//   DspNEON
+//---------------------------------------------------------
+
+class DspNEON : public Dsp {
+   public:
+      DspNEON() {}
+      virtual ~DspNEON() {}
+
+      virtual float peak(float* buf, unsigned n, float current) {
+            return neon_peak(buf, n, current);
+            }
+      virtual void applyGainToBuffer(float* buf, unsigned n, float gain) {
+            neon_applyGain(buf, n, gain);
+            }
+      virtual void mixWithGain(float* dst, float* src, unsigned n, float gain) {
+            neon_mixWithGain(dst, src, n, gain);
+            }
+      virtual void mix(float* dst, float* src, unsigned n) {
+            neon_mix(dst, src, n);
+            }
+      virtual void cpy(float* dst, float* src, unsigned n, bool addDenormal = false) {
+            if (addDenormal)
+                  neon_cpyDenormal(dst, src, n);
+            else
+                  memcpy(dst, src, sizeof(float) * n);
+            }
+      virtual void cpyWithGain(float* dst, float* src, unsigned n, float gain) {
+            neon_cpyWithGain(dst, src, n, gain);
+            }
+      virtual float cpyWithGainAndPeak(float* dst, float* src, unsigned n, float gain, float current) {
+            return neon_cpyWithGainAndPeak(dst, src, n, gain, current);
+            }
+      virtual float mixWithGainAndPeak(float* dst, float* src, unsigned n, float gain, float current) {
+            return neon_mixWithGainAndPeak(dst, src, n, gain, current);
+            }
+      virtual void mixStereoPan(float* dstL, float* dstR, float* src, unsigned n, float gainL, float gainR, bool add = false) {
+            neon_mixStereoPan(dstL, dstR, src, n, gainL, gainR, add);
+            }
+      virtual unsigned rampGain(float* dst, float* src, unsigned n, double& gain, double factor, double target, double floor) {
+            const unsigned done = neon_rampGainBlocks(dst, src, n, gain, factor, target, floor);
+            return done + Dsp::rampGain(dst + done, src + done, n - done, gain, factor, target, floor);
+            }
+      };
+
+Dsp* createDspNEON()
+      {
+      return new DspNEON();
+      }
+
+} // namespace AL
+
+#endif // __aarch64__
@@ -0,0 +1,558 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  muse_dsp_bench.cpp
+//  Copyright (C) 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+//---------------------------------------------------------
+//   muse_dsp_bench
+//    Micro-benchmarks for the realtime building blocks:
+//     the AL::Dsp kernels, LatencyCompensator, Fifo,
+//     CtrlList::value(), MPEventList::add() and the
+//     MPEventList versus MPEventQueue device queues.
+//    Every kernel is swept over buffer sizes 16..4096 and
+//     channel counts 1..64. Results are written as JSON,
+//     one record per (kernel, frames, channels), with the
+//     best-of-N time in ns and cpu cycles per sample.
+//---------------------------------------------------------
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#endif
+
+#include "al/dsp.h"
+#include "audio_fifo.h"
+#include "latency_compensator.h"
+#include "ctrl.h"
+#include "mpevent.h"
+#include "mpevent_queue.h"
+#include "midi_consts.h"
+
+namespace {
+
+const unsigned frameSizes[]   = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+const int      channelCounts[] = { 1, 2, 8, 16, 32, 64 };
+const int      midiStreamCounts[] = { 1, 8, 32 };
+const unsigned maxFrames      = 4096;
+const int      maxChannels    = 64;
+
+// Each measurement is the best of this many repetitions.
+const int      repetitions    = 7;
+// Each repetition runs the kernel for at least this long.
+const double   minRepTimeNs   = 2.0e6;
+
+struct Result {
+      std::string kernel;
+      unsigned frames;
+      int channels;
+      double nsPerSample;
+      double cyclesPerSample;
+      };
+
+std::vector<Result> results;
+const char* filter = nullptr;
+bool quick = false;
+
+// Keeps the compiler from optimizing away results.
+volatile float sink;
+
+inline double nowNs()
+      {
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return double(ts.tv_sec) * 1.0e9 + double(ts.tv_nsec);
+      }
+
+inline unsigned long long cycles()
+      {
+#ifdef BENCH_HAVE_TSC
+      return __rdtsc();
+#else
+      return 0;
+#endif
+      }
+
+//---------------------------------------------------------
+//   Buffers
+//    One buffer set per channel, filled with a test signal.
+//---------------------------------------------------------
+
+struct Buffers {
+      float* src[maxChannels];
+      float* dst[maxChannels];
+      float* dst2[maxChannels];
+
+      Buffers() {
+            for (int ch = 0; ch < maxChannels; ++ch) {
+                  src[ch]  = alloc();
+                  dst[ch]  = alloc();
+                  dst2[ch] = alloc();
+                  for (unsigned i = 0; i < maxFrames; ++i)
+                        src[ch][i] = float((int(i * 7919 + ch * 104729) % 2001) - 1000) * 0.001f;
+                  }
+            }
+      ~Buffers() {
+            for (int ch = 0; ch < maxChannels; ++ch) {
+                  free(src[ch]);
+                  free(dst[ch]);
+                  free(dst2[ch]);
+                  }
+            }
+      static float* alloc() {
+            float* p = nullptr;
+            if (posix_memalign((void**)&p, 64, sizeof(float) * maxFrames) != 0 || !p) {
+                  fprintf(stderr, "muse_dsp_bench: cannot allocate buffer\n");
+                  exit(1);
+                  }
+            memset(p, 0, sizeof(float) * maxFrames);
+            return p;
+            }
+      };
+
+//---------------------------------------------------------
+//   run
+//    Time fn() and record the result. fn processes
+//     'samples' samples per call.
+//---------------------------------------------------------
+
+template <typename F>
+void run(const char* kernel, unsigned frames, int channels, unsigned long samples, F fn)
+      {
+      if (filter && !strstr(kernel, filter))
+            return;
+
+      // Calibrate the number of calls per repetition.
+      unsigned long calls = 1;
+      for (;;) {
+            const double t0 = nowNs();
+            for (unsigned long i = 0; i < calls; ++i)
+                  fn();
+            const double t = nowNs() - t0;
+            if (t >= minRepTimeNs || calls >= (1UL << 30))
+                  break;
+            calls *= 2;
+            }
+
+      double best_ns = 0.0;
+      double best_cycles = 0.0;
+      const int reps = quick ? 2 : repetitions;
+      for (int r = 0; r < reps; ++r) {
+            const unsigned long long c0 = cycles();
+            const double t0 = nowNs();
+            for (unsigned long i = 0; i < calls; ++i)
+                  fn();
+            const double t = nowNs() - t0;
+            const unsigned long long c = cycles() - c0;
+            if (r == 0 || t < best_ns) {
+                  best_ns = t;
+                  best_cycles = double(c);
+                  }
+            }
+
+      const double n = double(calls) * double(samples);
+      Result res;
+      res.kernel = kernel;
+      res.frames = frames;
+      res.channels = channels;
+      res.nsPerSample = best_ns / n;
+#ifdef BENCH_HAVE_TSC
+      res.cyclesPerSample = best_cycles / n;
+#else
+      res.cyclesPerSample = -1.0;
+#endif
+      results.push_back(res);
+
+      fprintf(stderr, "%-28s frames:%5u channels:%3d  %9.4f ns/sample", kernel, frames, channels, res.nsPerSample);
+#ifdef BENCH_HAVE_TSC
+      fprintf(stderr, "  %8.4f cycles/sample", res.cyclesPerSample);
+#endif
+      fprintf(stderr, "\n");
+      }
+
+//---------------------------------------------------------
+//   benchDsp
+//---------------------------------------------------------
+
+void benchDsp(Buffers& b, unsigned n, int chans)
+      {
+      AL::Dsp* d = AL::dsp;
+      const unsigned long s = (unsigned long)n * chans;
+
+      run("dsp.peak", n, chans, s, [&]() {
+            float p = 0.0f;
+            for (int ch = 0; ch < chans; ++ch)
+                  p = d->peak(b.src[ch], n, p);
+            sink = p;
+            });
+      // A gain of -1 keeps the buffer from decaying into denormals.
+      run("dsp.applyGainToBuffer", n, chans, s, [&]() {
+            for (int ch = 0; ch < chans; ++ch)
+                  d->applyGainToBuffer(b.src[ch], n, -1.0f);
+            });
+      run("dsp.cpy", n, chans, s, [&]() {
+            for (int ch = 0; ch < chans; ++ch)
+                  d->cpy(b.dst[ch], b.src[ch], n);
+            });
+      run("dsp.cpyDenormal", n, chans, s, [&]() {
+            for (int ch = 0; ch < chans; ++ch)
+                  d->cpy(b.dst[ch], b.src[ch], n, true);
+            });
+      run("dsp.cpyWithGain", n, chans, s, [&]() {
+            for (int ch = 0; ch < chans; ++ch)
+                  d->cpyWithGain(b.dst[ch], b.src[ch], n, 0.5f);
+            });
+      run("dsp.cpyWithGainAndPeak", n, chans, s, [&]() {
+            float p = 0.0f;
+            for (int ch = 0; ch < chans; ++ch)
+                  p = d->cpyWithGainAndPeak(b.dst[ch], b.src[ch], n, 0.5f, p);
+            sink = p;
+            });
+      // The mixing kernels accumulate into dst. Keep the values bounded
+      //  by mixing twice with opposite signs, and count both passes.
+      run("dsp.mix", n, chans, 2 * s, [&]() {
+            for (int ch = 0; ch < chans; ++ch)
+                  d->mix(b.dst[ch], b.src[ch], n);
+            for (int ch = 0; ch < chans; ++ch)
+                  d->mixWithGain(b.dst[ch], b.src[ch], n, -1.0f);
+            });
+      run("dsp.mixWithGain", n, chans, 2 * s, [&]() {
+            for (int ch = 0; ch < chans; ++ch)
+                  d->mixWithGain(b.dst[ch], b.src[ch], n, 0.5f);
+            for (int ch = 0; ch < chans; ++ch)
+                  d->mixWithGain(b.dst[ch], b.src[ch], n, -0.5f);
+            });
+      run("dsp.mixWithGainAndPeak", n, chans, 2 * s, [&]() {
+            float p = 0.0f;
+            for (int ch = 0; ch < chans; ++ch)
+                  p = d->mixWithGainAndPeak(b.dst[ch], b.src[ch], n, 0.5f, p);
+            for (int ch = 0; ch < chans; ++ch)
+                  p = d->mixWithGainAndPeak(b.dst[ch], b.src[ch], n, -0.5f, p);
+            sink = p;
+            });
+      // One mono source panned to a stereo pair per channel.
+      run("dsp.mixStereoPan", n, chans, s, [&]() {
+            for (int ch = 0; ch < chans; ++ch)
+                  d->mixStereoPan(b.dst[ch], b.dst2[ch], b.src[ch], n, 0.7f, 0.3f);
+            });
+      run("dsp.mixStereoPanAdd", n, chans, 2 * s, [&]() {
+            for (int ch = 0; ch < chans; ++ch)
+                  d->mixStereoPan(b.dst[ch], b.dst2[ch], b.src[ch], n, 0.7f, 0.3f, true);
+            for (int ch = 0; ch < chans; ++ch)
+                  d->mixStereoPan(b.dst[ch], b.dst2[ch], b.src[ch], n, -0.7f, -0.3f, true);
+            });
+      // A fade in long enough to never reach its target within the buffer.
+      run("dsp.rampGain", n, chans, s, [&]() {
+            for (int ch = 0; ch < chans; ++ch) {
+                  double gain = 0.001;
+                  d->rampGain(b.dst[ch], b.src[ch], n, gain, 1.0001, 1.0, 0.0);
+                  }
+            });
+      }
+
+//---------------------------------------------------------
+//   benchLatencyCompensator
+//---------------------------------------------------------
+
+void benchLatencyCompensator(Buffers& b, unsigned n, int chans)
+      {
+      MusECore::LatencyCompensator lc(chans, 16384);
+      const unsigned long s = (unsigned long)n * chans;
+      const float* const* src = b.src;
+
+      run("latency.write", n, chans, s, [&]() {
+            lc.write(n, 256, src);
+            });
+      lc.clear();
+      run("latency.read", n, chans, s, [&]() {
+            lc.read(n, b.dst);
+            });
+      lc.clear();
+      run("latency.write_read", n, chans, s, [&]() {
+            lc.write(n, 256, src);
+            lc.read(n, b.dst);
+            });
+      lc.clear();
+      run("latency.peek_advance", n, chans, s, [&]() {
+            lc.peek(n, b.dst);
+            lc.advance(n);
+            });
+      }
+
+//---------------------------------------------------------
+//   benchFifo
+//---------------------------------------------------------
+
+void benchFifo(Buffers& b, unsigned n, int chans)
+      {
+      MusECore::Fifo fifo;
+      const unsigned long s = (unsigned long)n * chans;
+      MusECore::MuseCount_t pos = 0;
+      float latency = 0.0f;
+
+      float* out[maxChannels];
+
+      // get() only hands out pointers into the fifo. Copy the data out
+      //  as the reader does.
+      run("fifo.put_get", n, chans, s, [&]() {
+            fifo.put(chans, n, b.src, pos, 0.0f);
+            fifo.get(chans, n, out, &pos, &latency);
+            for (int ch = 0; ch < chans; ++ch)
+                  AL::dsp->cpy(b.dst[ch], out[ch], n);
+            });
+      }
+
+//---------------------------------------------------------
+//   benchCtrlList
+//    Per-frame interpolated lookups in a list with a point
+//     every 64 frames.
+//---------------------------------------------------------
+
+void benchCtrlList(MusECore::CtrlList& cl, unsigned n)
+      {
+      unsigned frame = 0;
+      run("ctrl.value", n, 1, n, [&]() {
+            double v = 0.0;
+            for (unsigned i = 0; i < n; ++i)
+                  v += cl.value(frame + i);
+            frame = (frame + n) & 0xfffff;
+            sink = float(v);
+            });
+
+      // What the audio thread actually does: one lookup per run of
+      //  frames, using nextFrame to find the end of the run.
+      frame = 0;
+      run("ctrl.value_next", n, 1, n, [&]() {
+            double v = 0.0;
+            unsigned i = 0;
+            while (i < n) {
+                  unsigned next = 0;
+                  bool next_valid = false;
+                  v += cl.value(frame + i, false, &next, &next_valid);
+                  if (!next_valid || next <= frame + i || next >= frame + n)
+                        break;
+                  i = next - frame;
+                  }
+            frame = (frame + n) & 0xfffff;
+            sink = float(v);
+            });
+      }
+
+//---------------------------------------------------------
+//   benchMPEventList
+//    Inserting n events with scattered times, as a device
+//     queue receives them from several tracks.
+//---------------------------------------------------------
+
+void benchMPEventList(unsigned n)
+      {
+      MusECore::MPEventList el;
+      run("mpevent.add", n, 1, n, [&]() {
+            for (unsigned i = 0; i < n; ++i) {
+                  const unsigned t = (i * 2654435761U) % (n * 4);
+                  el.add(MusECore::MidiPlayEvent(t, 0, i & 15, MusECore::ME_NOTEON, 60 + (i % 24), 100));
+                  }
+            el.clear();
+            });
+      }
+
+//---------------------------------------------------------
+//   benchMidiQueue
+//    A device queue under dense controller streams. Each
+//     cycle every stream (a track) puts a controller every
+//     8 frames of the next cycle, in time order, then all
+//     the events due in this cycle are taken out. Channels
+//     is the number of streams, and a sample is an event.
+//---------------------------------------------------------
+
+const unsigned midiStreamInterval = 8;
+
+template <typename Q, typename P>
+void runMidiQueue(const char* kernel, Q& q, unsigned n, int streams, P pop)
+      {
+      unsigned frame = 0;
+      auto cycle = [&]() {
+            const unsigned next = frame + n;
+            for (int s = 0; s < streams; ++s) {
+                  for (unsigned t = next + s % midiStreamInterval; t < next + n; t += midiStreamInterval)
+                        q.insert(MusECore::MidiPlayEvent(t, 0, s & 15, MusECore::ME_CONTROLLER, 1 + (s >> 4), t & 127));
+                  }
+            pop(q, next);
+            frame = next;
+            // Keep clear of the frame counter wrapping around.
+            if (frame >= 0x40000000) {
+                  q.clear();
+                  frame = 0;
+                  }
+            };
+      run(kernel, n, streams, (unsigned long)streams * (n / midiStreamInterval), cycle);
+      q.clear();
+      }
+
+void benchMidiQueue(unsigned n, int streams)
+      {
+      {
+      MusECore::MPEventList el;
+      runMidiQueue("midiqueue.mpeventlist", el, n, streams, [](MusECore::MPEventList& l, unsigned end) {
+            unsigned v = 0;
+            MusECore::iMPEvent i = l.begin();
+            for ( ; i != l.end() && i->time() < end; ++i)
+                  v += i->dataB();
+            l.erase(l.begin(), i);
+            sink = float(v);
+            });
+      }
+      {
+      // Room for two cycles of events.
+      MusECore::MPEventQueue q(2 * streams * (n / midiStreamInterval) + 16);
+      runMidiQueue("midiqueue.mpeventqueue", q, n, streams, [](MusECore::MPEventQueue& q, unsigned end) {
+            unsigned v = 0;
+            q.popBefore(end, [&v](const MusECore::MidiPlayEvent& ev) { v += ev.dataB(); });
+            sink = float(v);
+            });
+      }
+      }
+
+//---------------------------------------------------------
+//   writeJson
+//---------------------------------------------------------
+
+bool writeJson(FILE* f, const char* dspName)
+      {
+      fprintf(f, "{\n");
+      fprintf(f, "  \"benchmark\": \"muse_dsp_bench\",\n");
+      fprintf(f, "  \"dsp\": \"%s\",\n", dspName);
+      fprintf(f, "  \"repetitions\": %d,\n", quick ? 2 : repetitions);
+#ifdef BENCH_HAVE_TSC
+      fprintf(f, "  \"cycle_counter\": \"rdtsc\",\n");
+#else
+      fprintf(f, "  \"cycle_counter\": null,\n");
+#endif
+      fprintf(f, "  \"results\": [\n");
+      for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            fprintf(f, "    { \"kernel\": \"%s\", \"frames\": %u, \"channels\": %d, \"ns_per_sample\": %.6f, ",
+               r.kernel.c_str(), r.frames, r.channels, r.nsPerSample);
+            if (r.cyclesPerSample < 0.0)
+                  fprintf(f, "\"cycles_per_sample\": null }");
+            else
+                  fprintf(f, "\"cycles_per_sample\": %.6f }", r.cyclesPerSample);
+            fprintf(f, "%s\n", i + 1 < results.size() ? "," : "");
+            }
+      fprintf(f, "  ]\n}\n");
+      return !ferror(f);
+      }
+
+void usage(const char* prog)
+      {
+      fprintf(stderr,
+         "usage: %s [options]\n"
+         "   -o file    write JSON results to file (default stdout)\n"
+         "   -f name    only run kernels whose name contains 'name'\n"
+         "   -s         use the scalar Dsp instead of the best one for this cpu\n"
+         "   -q         quick run (fewer repetitions)\n"
+         "   -h         this help\n", prog);
+      }
+
+} // anonymous namespace
+
+//---------------------------------------------------------
+//   main
+//---------------------------------------------------------
+
+int main(int argc, char* argv[])
+      {
+      const char* out_file = nullptr;
+      bool scalar = false;
+      int c;
+      while ((c = getopt(argc, argv, "o:f:sqh")) != EOF) {
+            switch (c) {
+                  case 'o': out_file = optarg; break;
+                  case 'f': filter = optarg; break;
+                  case 's': scalar = true; break;
+                  case 'q': quick = true; break;
+                  case 'h':
+                        usage(argv[0]);
+                        return 0;
+                  default:
+                        usage(argv[0]);
+                        return 1;
+                  }
+            }
+
+      // initDsp() reports on stdout. Keep that out of the JSON.
+      fflush(stdout);
+      const int saved_stdout = dup(1);
+      dup2(2, 1);
+      AL::initDsp();
+      fflush(stdout);
+      dup2(saved_stdout, 1);
+      close(saved_stdout);
+
+      const char* dsp_name = "auto";
+      if (scalar) {
+            delete AL::dsp;
+            AL::dsp = new AL::Dsp();
+            dsp_name = "scalar";
+            }
+
+      Buffers buffers;
+
+      MusECore::CtrlList cl(0, QString("bench"), 0.0, 1.0, MusECore::VAL_LINEAR);
+      for (unsigned f = 0; f <= 0x100000; f += 64)
+            cl.add(f, double((f / 64) % 101) / 100.0);
+
+      for (unsigned n : frameSizes) {
+            for (int chans : channelCounts) {
+                  benchDsp(buffers, n, chans);
+                  benchLatencyCompensator(buffers, n, chans);
+                  benchFifo(buffers, n, chans);
+                  }
+            benchCtrlList(cl, n);
+            benchMPEventList(n);
+            for (int streams : midiStreamCounts)
+                  benchMidiQueue(n, streams);
+            }
+
+      AL::exitDsp();
+
+      FILE* f = stdout;
+      if (out_file) {
+            f = fopen(out_file, "w");
+            if (!f) {
+                  fprintf(stderr, "muse_dsp_bench: cannot open <%s>: %s\n", out_file, strerror(errno));
+                  return 1;
+                  }
+            }
+      const bool ok = writeJson(f, dsp_name);
+      if (out_file)
+            fclose(f);
+      return ok ? 0 : 1;
+      }
@@ -0,0 +1,281 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  mpevent_queue.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <stdio.h>
+
+#include "mpevent_queue.h"
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   MPEventQueue
+//---------------------------------------------------------
+
+MPEventQueue::MPEventQueue(unsigned int capacity, unsigned int numBuckets, unsigned int bucketShift)
+{
+  if(capacity == 0)
+    capacity = 1;
+  _capacity = capacity;
+  _nodes = new Node[_capacity];
+  for(unsigned int i = 0; i < _capacity; ++i)
+    _nodes[i].next = (i + 1 < _capacity) ? int(i + 1) : -1;
+  _freeHead = 0;
+  _size = 0;
+
+  _numBuckets = 1;
+  while(_numBuckets < numBuckets)
+    _numBuckets <<= 1;
+  _bucketMask = _numBuckets - 1;
+  _bucketShift = bucketShift;
+  _buckets = new List[_numBuckets];
+  for(unsigned int i = 0; i < _numBuckets; ++i)
+  {
+    _buckets[i].head = -1;
+    _buckets[i].tail = -1;
+  }
+  _baseSlot = 0;
+
+  _overflow.head = -1;
+  _overflow.tail = -1;
+  _overflowSize = 0;
+
+  _finger = -1;
+  _fingerList = nullptr;
+}
+
+MPEventQueue::~MPEventQueue()
+{
+  delete[] _buckets;
+  delete[] _nodes;
+}
+
+//---------------------------------------------------------
+//   insertSorted
+//---------------------------------------------------------
+
+void MPEventQueue::insertSorted(List& l, int n)
+{
+  const int finger = (_fingerList == &l) ? _finger : -1;
+  Node& nd = _nodes[n];
+  _finger = n;
+  _fingerList = &l;
+  if(l.head < 0)
+  {
+    nd.next = -1;
+    l.head = l.tail = n;
+    return;
+  }
+  // Equal events go after the ones already there, like std::multiset.
+  if(!(nd.ev < _nodes[l.tail].ev))
+  {
+    nd.next = -1;
+    _nodes[l.tail].next = n;
+    l.tail = n;
+    return;
+  }
+  if(nd.ev < _nodes[l.head].ev)
+  {
+    nd.next = l.head;
+    l.head = n;
+    return;
+  }
+  // It goes somewhere before the tail. Start from the last insert if that is not after it.
+  int p = l.head;
+  if(finger >= 0 && !(nd.ev < _nodes[finger].ev))
+    p = finger;
+  while(!(nd.ev < _nodes[_nodes[p].next].ev))
+    p = _nodes[p].next;
+  nd.next = _nodes[p].next;
+  _nodes[p].next = n;
+}
+
+//---------------------------------------------------------
+//   migrateOverflow
+//---------------------------------------------------------
+
+void MPEventQueue::migrateOverflow()
+{
+  while(_overflow.head >= 0)
+  {
+    const int n = _overflow.head;
+    const unsigned int s = slot(_nodes[n].ev.time());
+    // Overflow events are never before the first bucket.
+    if(s - _baseSlot >= _numBuckets)
+      break;
+    _overflow.head = _nodes[n].next;
+    if(_overflow.head < 0)
+      _overflow.tail = -1;
+    --_overflowSize;
+    insertSorted(_buckets[s & _bucketMask], n);
+  }
+}
+
+//---------------------------------------------------------
+//   settle
+//---------------------------------------------------------
+
+void MPEventQueue::settle()
+{
+  if(_size == 0)
+    return;
+  // Nothing left in the ring? Jump straight to the next overflow event.
+  if(_size == _overflowSize)
+  {
+    _baseSlot = slot(_nodes[_overflow.head].ev.time());
+    migrateOverflow();
+    return;
+  }
+  while(_buckets[_baseSlot & _bucketMask].head < 0)
+  {
+    ++_baseSlot;
+    migrateOverflow();
+  }
+}
+
+//---------------------------------------------------------
+//   release
+//---------------------------------------------------------
+
+void MPEventQueue::release(int n)
+{
+  if(n == _finger)
+    _finger = -1;
+  // Let go of any sysex data.
+  if(_nodes[n].ev.len() != 0)
+    _nodes[n].ev.setData(EvData());
+  _nodes[n].next = _freeHead;
+  _freeHead = n;
+}
+
+//---------------------------------------------------------
+//   insert
+//---------------------------------------------------------
+
+bool MPEventQueue::insert(const MidiPlayEvent& ev)
+{
+  if(_freeHead < 0)
+  {
+    fprintf(stderr, "MPEventQueue::insert: Queue is full (%u events). Event dropped.\n", _capacity);
+    return false;
+  }
+  const int n = _freeHead;
+  _freeHead = _nodes[n].next;
+  _nodes[n].ev = ev;
+
+  const unsigned int s = slot(ev.time());
+  if(_size == 0)
+    _baseSlot = s;
+  ++_size;
+
+  // Late events join the first bucket, where they sort to the front.
+  if(s < _baseSlot)
+    insertSorted(_buckets[_baseSlot & _bucketMask], n);
+  else if(s - _baseSlot < _numBuckets)
+    insertSorted(_buckets[s & _bucketMask], n);
+  else
+  {
+    insertSorted(_overflow, n);
+    ++_overflowSize;
+  }
+  return true;
+}
+
+//---------------------------------------------------------
+//   pop_front
+//---------------------------------------------------------
+
+void MPEventQueue::pop_front()
+{
+  List& b = _buckets[_baseSlot & _bucketMask];
+  const int n = b.head;
+  b.head = _nodes[n].next;
+  if(b.head < 0)
+    b.tail = -1;
+  release(n);
+  --_size;
+  if(b.head < 0)
+    settle();
+}
+
+//---------------------------------------------------------
+//   countBefore
+//---------------------------------------------------------
+
+unsigned int MPEventQueue::countBefore(unsigned int frame) const
+{
+  unsigned int c = 0;
+  if(_size == 0)
+    return c;
+  const unsigned int frame_slot = slot(frame);
+  for(unsigned int i = 0; i < _numBuckets; ++i)
+  {
+    const unsigned int s = _baseSlot + i;
+    // The first bucket may hold earlier events, so always look in it.
+    if(i != 0 && s > frame_slot)
+      return c;
+    for(int n = _buckets[s & _bucketMask].head; n >= 0; n = _nodes[n].next)
+    {
+      if(_nodes[n].ev.time() >= frame)
+        return c;
+      ++c;
+    }
+  }
+  for(int n = _overflow.head; n >= 0; n = _nodes[n].next)
+  {
+    if(_nodes[n].ev.time() >= frame)
+      return c;
+    ++c;
+  }
+  return c;
+}
+
+//---------------------------------------------------------
+//   clear
+//---------------------------------------------------------
+
+void MPEventQueue::clear()
+{
+  if(_size == 0)
+    return;
+  for(unsigned int i = 0; i < _numBuckets; ++i)
+  {
+    List& b = _buckets[i];
+    for(int n = b.head, next; n >= 0; n = next)
+    {
+      next = _nodes[n].next;
+      release(n);
+    }
+    b.head = b.tail = -1;
+  }
+  for(int n = _overflow.head, next; n >= 0; n = next)
+  {
+    next = _nodes[n].next;
+    release(n);
+  }
+  _overflow.head = _overflow.tail = -1;
+  _overflowSize = 0;
+  _size = 0;
+  _finger = -1;
+}
+
+} // namespace MusECore
@@ -0,0 +1,135 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  mpevent_queue.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __MPEVENT_QUEUE_H__
+#define __MPEVENT_QUEUE_H__
+
+#include "mpevent.h"
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   MPEventQueue
+//    A time ordered queue of play events with a fixed
+//     capacity, allocated up front. Used by the devices and
+//     synths for their playback events, in place of the
+//     MPEventList red-black tree.
+//
+//    Time is divided into buckets of (1 << bucketShift)
+//     frames, held in a ring covering the near future (16384
+//     frames by default). Small buckets keep the lists short
+//     when many tracks put controllers into one device. Each
+//     bucket is a short list in MEvent::operator< order, so
+//     the queue pops in the same order as an MPEventList.
+//     Events beyond the ring wait in a sorted overflow list,
+//     and late events join the first bucket.
+//
+//    Inserting an event which is not earlier than the last
+//     one in its bucket, or than the last one inserted, is
+//     O(1). That is the usual case with events coming in time
+//     order from each track. Popping is O(1), too.
+//
+//    The queue has no locking. It belongs to the thread which
+//     processes the device, which fills it from the device's
+//     lock-free event buffers.
+//---------------------------------------------------------
+
+class MPEventQueue {
+      struct Node {
+            MidiPlayEvent ev;
+            int next;
+            };
+      struct List {
+            int head;
+            int tail;
+            };
+
+      Node* _nodes;
+      unsigned int _capacity;
+      int _freeHead;
+      unsigned int _size;
+
+      List* _buckets;
+      unsigned int _numBuckets;
+      unsigned int _bucketMask;
+      unsigned int _bucketShift;
+      // The slot (time >> bucketShift) of the first bucket. While the queue
+      //  is not empty, the first bucket is not empty.
+      unsigned int _baseSlot;
+
+      List _overflow;
+      unsigned int _overflowSize;
+
+      // The last node inserted, and its list. Events from each track come in
+      //  time order, so an insert usually goes right after the previous one
+      //  from the same track, which is at or after the last one inserted.
+      int _finger;
+      const List* _fingerList;
+
+      unsigned int slot(unsigned int time) const { return time >> _bucketShift; }
+      void insertSorted(List& l, int n);
+      // Moves overflow events which now fall in the ring into their buckets.
+      void migrateOverflow();
+      // Advances the first bucket to the earliest event.
+      void settle();
+      void release(int n);
+
+   public:
+      // The ring covers numBuckets << bucketShift frames. numBuckets must be a power of two.
+      MPEventQueue(unsigned int capacity = 2048, unsigned int numBuckets = 4096, unsigned int bucketShift = 2);
+      ~MPEventQueue();
+      MPEventQueue(const MPEventQueue&) = delete;
+      MPEventQueue& operator=(const MPEventQueue&) = delete;
+
+      unsigned int capacity() const { return _capacity; }
+      unsigned int size() const     { return _size; }
+      bool empty() const            { return _size == 0; }
+      bool full() const             { return _size >= _capacity; }
+
+      // Returns false and drops the event if the queue is full.
+      bool insert(const MidiPlayEvent& ev);
+      // The earliest event. The queue must not be empty.
+      const MidiPlayEvent& front() const { return _nodes[_buckets[_baseSlot & _bucketMask].head].ev; }
+      // Removes the earliest event. The queue must not be empty.
+      void pop_front();
+      // Number of events with time before frame.
+      unsigned int countBefore(unsigned int frame) const;
+      // Removes all the events with time before frame, in order, passing each to f.
+      // Returns the number of events removed.
+      template <typename F> unsigned int popBefore(unsigned int frame, F f)
+      {
+        unsigned int n = 0;
+        while(_size != 0 && front().time() < frame)
+        {
+          f(front());
+          pop_front();
+          ++n;
+        }
+        return n;
+      }
+      void clear();
+      };
+
+} // namespace MusECore
+
+#endif
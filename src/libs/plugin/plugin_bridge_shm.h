@@ -0,0 +1,245 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  plugin_bridge_shm.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __PLUGIN_BRIDGE_SHM_H__
+#define __PLUGIN_BRIDGE_SHM_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// The shared memory a bridged plugin is run through, by MusE and by
+//  the muse_plugin_bridge host process. Both sides include this file,
+//  so it must not change without changing BridgeShmVersion.
+//
+// MusE queues commands and writes the audio inputs, the host runs the
+//  plugin and writes the audio outputs. Each side only writes its own
+//  positions, so no locks are needed. The positions count frames and
+//  commands, and wrap around.
+//
+// The gui thread talks to the host through a request slot next to the
+//  commands, for the DSSI calls which return something: MusE fills
+//  it in and counts requestWrite up, the host answers and sets
+//  requestRead to the same.
+//
+// The file descriptors the host gets, at fixed numbers:
+//  the shared memory, an eventfd MusE wakes the host with, an
+//  eventfd the host wakes MusE with after each command, and the
+//  read end of a pipe MusE never writes to. The pipe reads end of
+//  file once MusE closed it or is gone, then the host quits.
+
+namespace MusEPlugin {
+
+const uint32_t BridgeShmMagic   = 0x4d425247; // "MBRG"
+const uint32_t BridgeShmVersion = 3;
+
+const int BridgeShmFd     = 3;
+const int BridgeRequestFd = 4;
+const int BridgeReplyFd   = 5;
+const int BridgeParentFd  = 6;
+
+// Number of queued commands. Must be a power of two.
+const uint32_t BridgeCommands = 16;
+// The most DSSI events in one BridgeRun command, more are dropped.
+const uint32_t BridgeMaxEvents = 512;
+// Room for the strings of a request.
+const uint32_t BridgeRequestText = 65536;
+
+enum BridgeState {
+      BridgeStarting = 0,
+      BridgeReady,
+      BridgeFailed
+      };
+
+enum BridgeCommandType {
+      BridgeRun = 0,
+      BridgeActivate,
+      BridgeDeactivate,
+      BridgeSelectProgram,
+      BridgeQuit
+      };
+
+enum BridgeRequestType {
+      BridgeConfigure = 0,
+      BridgeGetProgram,
+      BridgeGetMidiController
+      };
+
+struct BridgeShmHeader {
+      uint32_t magic;
+      uint32_t version;
+      uint32_t sampleRate;
+      uint32_t portCount;
+      uint32_t audioIns;
+      uint32_t audioOuts;
+      uint32_t controlIns;
+      uint32_t controlOuts;
+      // Frames in each audio ring. A power of two.
+      uint32_t ringFrames;
+      // The most frames in one BridgeRun command.
+      uint32_t maxFrames;
+      // Not zero for a DSSI plugin, the host runs it with run_synth() then.
+      uint32_t dssi;
+      // The size of one event, a snd_seq_event_t, and the most in one command.
+      uint32_t eventSize;
+      uint32_t maxEvents;
+
+      std::atomic<uint32_t> state;
+
+      // Written by MusE.
+      alignas(64) std::atomic<uint32_t> commandWrite;
+      std::atomic<uint32_t> inputWrite;
+      // Written by the host.
+      alignas(64) std::atomic<uint32_t> commandRead;
+      std::atomic<uint32_t> inputRead;
+      std::atomic<uint32_t> outputWrite;
+      std::atomic<uint32_t> requestRead;
+      // Counts the programs selected. The control values each left behind
+      //  are in the program controls, see BridgeCommand::programControls.
+      std::atomic<uint32_t> programControls;
+      // Written by MusE.
+      alignas(64) std::atomic<uint32_t> outputRead;
+      std::atomic<uint32_t> requestWrite;
+      };
+
+struct BridgeCommand {
+      uint32_t type;
+      uint32_t frames;
+      // BridgeRun: the number of events.
+      uint32_t events;
+      // BridgeSelectProgram: what to select.
+      uint32_t bank;
+      uint32_t program;
+      // The programControls MusE has taken the control values of. Until it
+      //  took the latest, the host keeps its own values instead of these.
+      uint32_t programControls;
+      // Followed by the values of the control inputs, in port order,
+      //  then by the events, their ticks counting from the command's start.
+      };
+
+struct BridgeRequest {
+      uint32_t type;
+      // BridgeGetProgram: the index of the program. BridgeGetMidiController: the port.
+      uint32_t index;
+      // The answer. BridgeConfigure: not zero if there is a message.
+      //  BridgeGetProgram: not zero if there is a program, and its bank
+      //  and number. BridgeGetMidiController: what the plugin returned.
+      int32_t result;
+      uint32_t bank;
+      uint32_t program;
+      // BridgeConfigure: the key and value, then the message.
+      //  BridgeGetProgram: the name. Each ends in a zero.
+      char text[BridgeRequestText];
+      };
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "the bridge positions must be lock free to be shared between processes");
+
+//---------------------------------------------------------
+//   BridgeShmLayout
+//    Where the parts of the shared memory are, from
+//     the start of it.
+//---------------------------------------------------------
+
+struct BridgeShmLayout {
+      size_t commandSize;
+      size_t commands;
+      size_t inputs;
+      size_t outputs;
+      size_t controlOuts;
+      size_t programControls;
+      size_t request;
+      size_t total;
+
+      BridgeShmLayout(uint32_t audioIns, uint32_t audioOuts, uint32_t controlIns,
+                      uint32_t controlOuts_, uint32_t ringFrames, uint32_t eventBytes)
+            {
+            commandSize     = align(sizeof(BridgeCommand) + sizeof(float) * controlIns + eventBytes);
+            commands        = align(sizeof(BridgeShmHeader));
+            inputs          = commands + commandSize * BridgeCommands;
+            outputs         = inputs + align(sizeof(float) * ringFrames * audioIns);
+            controlOuts     = outputs + align(sizeof(float) * ringFrames * audioOuts);
+            programControls = controlOuts + align(sizeof(float) * controlOuts_);
+            request         = programControls + align(sizeof(float) * controlIns);
+            total           = request + align(sizeof(BridgeRequest));
+            }
+      explicit BridgeShmLayout(const BridgeShmHeader* h)
+         : BridgeShmLayout(h->audioIns, h->audioOuts, h->controlIns, h->controlOuts,
+                           h->ringFrames, h->eventSize * h->maxEvents) { }
+
+      static size_t align(size_t n) { return (n + 63) & ~size_t(63); }
+
+      BridgeCommand* command(void* base, uint32_t i) const {
+            return (BridgeCommand*)((char*)base + commands + commandSize * (i & (BridgeCommands - 1)));
+            }
+      static float* commandControls(BridgeCommand* c) { return (float*)(c + 1); }
+      static void* commandEvents(BridgeCommand* c, uint32_t controlIns) {
+            return commandControls(c) + controlIns;
+            }
+      float* inputRing(void* base, uint32_t ringFrames, uint32_t port) const {
+            return (float*)((char*)base + inputs) + size_t(ringFrames) * port;
+            }
+      float* outputRing(void* base, uint32_t ringFrames, uint32_t port) const {
+            return (float*)((char*)base + outputs) + size_t(ringFrames) * port;
+            }
+      float* controlOutValues(void* base) const {
+            return (float*)((char*)base + controlOuts);
+            }
+      float* programControlValues(void* base) const {
+            return (float*)((char*)base + programControls);
+            }
+      BridgeRequest* requestSlot(void* base) const {
+            return (BridgeRequest*)((char*)base + request);
+            }
+      };
+
+//---------------------------------------------------------
+//   bridgeRingWrite
+//   bridgeRingRead
+//    Copy n frames into or out of a ring, starting
+//     at position pos. ringFrames is a power of two.
+//---------------------------------------------------------
+
+inline void bridgeRingWrite(float* ring, uint32_t ringFrames, uint32_t pos, const float* src, uint32_t n)
+      {
+      const uint32_t start = pos & (ringFrames - 1);
+      const uint32_t first = (n < ringFrames - start) ? n : ringFrames - start;
+      for (uint32_t i = 0; i < first; ++i)
+            ring[start + i] = src[i];
+      for (uint32_t i = first; i < n; ++i)
+            ring[i - first] = src[i];
+      }
+
+inline void bridgeRingRead(const float* ring, uint32_t ringFrames, uint32_t pos, float* dst, uint32_t n)
+      {
+      const uint32_t start = pos & (ringFrames - 1);
+      const uint32_t first = (n < ringFrames - start) ? n : ringFrames - start;
+      for (uint32_t i = 0; i < first; ++i)
+            dst[i] = ring[start + i];
+      for (uint32_t i = first; i < n; ++i)
+            dst[i] = ring[i - first];
+      }
+
+} // namespace MusEPlugin
+
+#endif
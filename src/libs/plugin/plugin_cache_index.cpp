@@ -0,0 +1,409 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  plugin_cache_index.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QByteArray>
+#include <QSaveFile>
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+
+#include "plugin_cache_index.h"
+#include "plugin_cache_reader.h"
+
+namespace MusEPlugin {
+
+//---------------------------------------------------------
+//   The index file
+//
+//   IndexHeader
+//   IndexEntry[entryCount]
+//   The strings, UTF-8, not terminated.
+//
+//   The entries of each cache file follow each other, in
+//    the order of indexCacheTypes. Everything is in the
+//    byte order of the machine, the index is thrown away
+//    and written again if it does not match.
+//---------------------------------------------------------
+
+static const char indexMagic[8] = { 'M', 'U', 'S', 'E', 'P', 'I', 'D', 'X' };
+static const uint32_t indexVersion = 1;
+
+// The cache files in the order readPluginCacheFiles() reads them.
+static const PluginScanInfoStruct::PluginType indexCacheTypes[] = {
+  PluginScanInfoStruct::PluginTypeDSSI,
+  PluginScanInfoStruct::PluginTypeMESS,
+  PluginScanInfoStruct::PluginTypeLADSPA,
+  PluginScanInfoStruct::PluginTypeLinuxVST,
+  PluginScanInfoStruct::PluginTypeVST,
+  PluginScanInfoStruct::PluginTypeUnknown
+};
+static const int indexCacheCount = sizeof(indexCacheTypes) / sizeof(indexCacheTypes[0]);
+
+enum IndexStrings {
+  IdxCompleteBaseName = 0, IdxBaseName, IdxSuffix, IdxCompleteSuffix, IdxAbsolutePath, IdxPath,
+  IdxUri, IdxLabel, IdxName, IdxDescription, IdxVersion, IdxMaker, IdxCopyright, IdxUiFilename,
+  IdxStringCount
+};
+
+struct IndexCacheFile
+{
+  // The cache text file as it was when the index was written.
+  int64_t fileTime;
+  int64_t fileSize;
+  uint32_t exists;
+  // What readPluginCacheFile() returned for it.
+  uint32_t readOk;
+  // Its entries.
+  uint32_t first;
+  uint32_t count;
+};
+
+struct IndexHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t entrySize;
+  uint32_t entryCount;
+  uint32_t stringsSize;
+  IndexCacheFile files[indexCacheCount];
+};
+
+struct IndexString
+{
+  uint32_t offset;
+  uint32_t size;
+};
+
+struct IndexEntry
+{
+  int64_t fileTime;
+  int64_t fileSize;
+  uint64_t uniqueID;
+  int64_t subID;
+  uint64_t portCount;
+  uint64_t inports;
+  uint64_t outports;
+  uint64_t controlInPorts;
+  uint64_t controlOutPorts;
+  uint64_t eventInPorts;
+  uint64_t eventOutPorts;
+  uint64_t freewheelPortIdx;
+  uint64_t latencyPortIdx;
+  uint64_t enableOrBypassPortIdx;
+  int32_t type;
+  int32_t pluginClass;
+  int32_t apiVersionMajor;
+  int32_t apiVersionMinor;
+  int32_t pluginVersionMajor;
+  int32_t pluginVersionMinor;
+  int32_t pluginFlags;
+  int32_t pluginLatencyReportingType;
+  int32_t pluginBypassType;
+  int32_t pluginFreewheelType;
+  int32_t requiredFeatures;
+  int32_t vstPluginFlags;
+  uint32_t fileIsBad;
+  uint32_t reserved;
+  IndexString strings[IdxStringCount];
+};
+
+//---------------------------------------------------------
+//   cacheFileStamp
+//   Fills in how the cache text file of the type is now.
+//---------------------------------------------------------
+
+static void cacheFileStamp(const QString& path, PluginScanInfoStruct::PluginType type, IndexCacheFile* f)
+{
+  const QFileInfo fi(path + '/' + QString(pluginCacheFilename(type)));
+  f->exists = fi.exists() ? 1 : 0;
+  f->fileTime = f->exists ? fi.lastModified().toMSecsSinceEpoch() : 0;
+  f->fileSize = f->exists ? fi.size() : 0;
+}
+
+static bool cacheFileChanged(const QString& path, PluginScanInfoStruct::PluginType type, const IndexCacheFile& f)
+{
+  IndexCacheFile now;
+  cacheFileStamp(path, type, &now);
+  return now.exists != f.exists || now.fileTime != f.fileTime || now.fileSize != f.fileSize;
+}
+
+//---------------------------------------------------------
+//   pluginCacheIndexFilename
+//---------------------------------------------------------
+
+const char* pluginCacheIndexFilename()
+{
+  return "plugins.index";
+}
+
+//---------------------------------------------------------
+//   checkIndexHeader
+//   Returns the header if the data is a whole index which
+//    matches the cache text files, or null.
+//---------------------------------------------------------
+
+static const IndexHeader* checkIndexHeader(const QString& path, const uchar* data, qint64 size)
+{
+  if(!data || size < (qint64)sizeof(IndexHeader))
+    return nullptr;
+  const IndexHeader* h = (const IndexHeader*)data;
+  if(std::memcmp(h->magic, indexMagic, sizeof(indexMagic)) != 0 ||
+     h->version != indexVersion || h->entrySize != sizeof(IndexEntry))
+    return nullptr;
+  if((qint64)sizeof(IndexHeader) + (qint64)h->entryCount * sizeof(IndexEntry) + h->stringsSize != size)
+    return nullptr;
+  for(int i = 0; i < indexCacheCount; ++i)
+  {
+    const IndexCacheFile& f = h->files[i];
+    if((uint64_t)f.first + f.count > h->entryCount)
+      return nullptr;
+    if(cacheFileChanged(path, indexCacheTypes[i], f))
+      return nullptr;
+  }
+  return h;
+}
+
+//---------------------------------------------------------
+//   pluginCacheIndexIsCurrent
+//---------------------------------------------------------
+
+bool pluginCacheIndexIsCurrent(const QString& path)
+{
+  QFile f(path + '/' + QString(pluginCacheIndexFilename()));
+  if(!f.open(QIODevice::ReadOnly))
+    return false;
+  const qint64 size = f.size();
+  if(size < (qint64)sizeof(IndexHeader))
+    return false;
+  uchar* data = f.map(0, size);
+  const bool res = checkIndexHeader(path, data, size) != nullptr;
+  if(data)
+    f.unmap(data);
+  return res;
+}
+
+//---------------------------------------------------------
+//   writePluginCacheIndex
+//---------------------------------------------------------
+
+bool writePluginCacheIndex(const QString& path)
+{
+  IndexHeader h;
+  std::memset(&h, 0, sizeof(h));
+  std::memcpy(h.magic, indexMagic, sizeof(indexMagic));
+  h.version = indexVersion;
+  h.entrySize = sizeof(IndexEntry);
+
+  std::vector<IndexEntry> entries;
+  QByteArray strings;
+
+  for(int i = 0; i < indexCacheCount; ++i)
+  {
+    const PluginScanInfoStruct::PluginType type = indexCacheTypes[i];
+    IndexCacheFile& f = h.files[i];
+    // Take the stamp first. If the file changes while it is read,
+    //  the index does not match it and is not used.
+    cacheFileStamp(path, type, &f);
+    f.first = entries.size();
+
+    PluginScanList list;
+    f.readOk = readPluginCacheFile(path, &list, false, false, type) ? 1 : 0;
+
+    for(ciPluginScanList ips = list.cbegin(); ips != list.cend(); ++ips)
+    {
+      const PluginScanInfoStruct& info = (*ips)->info();
+      IndexEntry e;
+      std::memset(&e, 0, sizeof(e));
+      e.fileTime = info._fileTime;
+      e.fileSize = info._fileSize;
+      e.uniqueID = info._uniqueID;
+      e.subID = info._subID;
+      e.portCount = info._portCount;
+      e.inports = info._inports;
+      e.outports = info._outports;
+      e.controlInPorts = info._controlInPorts;
+      e.controlOutPorts = info._controlOutPorts;
+      e.eventInPorts = info._eventInPorts;
+      e.eventOutPorts = info._eventOutPorts;
+      e.freewheelPortIdx = info._freewheelPortIdx;
+      e.latencyPortIdx = info._latencyPortIdx;
+      e.enableOrBypassPortIdx = info._enableOrBypassPortIdx;
+      e.type = info._type;
+      e.pluginClass = info._class;
+      e.apiVersionMajor = info._apiVersionMajor;
+      e.apiVersionMinor = info._apiVersionMinor;
+      e.pluginVersionMajor = info._pluginVersionMajor;
+      e.pluginVersionMinor = info._pluginVersionMinor;
+      e.pluginFlags = info._pluginFlags;
+      e.pluginLatencyReportingType = info._pluginLatencyReportingType;
+      e.pluginBypassType = info._pluginBypassType;
+      e.pluginFreewheelType = info._pluginFreewheelType;
+      e.requiredFeatures = info._requiredFeatures;
+      e.vstPluginFlags = info._vstPluginFlags;
+      e.fileIsBad = info._fileIsBad ? 1 : 0;
+
+      const PluginInfoString_t* s[IdxStringCount] = {
+        &info._completeBaseName, &info._baseName, &info._suffix, &info._completeSuffix,
+        &info._absolutePath, &info._path, &info._uri, &info._label, &info._name,
+        &info._description, &info._version, &info._maker, &info._copyright, &info._uiFilename };
+      for(int k = 0; k < IdxStringCount; ++k)
+      {
+        const QByteArray ba = PLUGIN_GET_QSTRING(*s[k]).toUtf8();
+        e.strings[k].offset = strings.size();
+        e.strings[k].size = ba.size();
+        strings.append(ba);
+      }
+
+      entries.push_back(e);
+    }
+    f.count = entries.size() - f.first;
+  }
+  h.entryCount = entries.size();
+  h.stringsSize = strings.size();
+
+  const QString filepath = path + '/' + QString(pluginCacheIndexFilename());
+  // Written to a temporary file and renamed, so that it is never seen half written.
+  QSaveFile f(filepath);
+  if(!f.open(QIODevice::WriteOnly))
+  {
+    std::fprintf(stderr, "writePluginCacheIndex: open() failed: filename:%s\n",
+                 filepath.toLocal8Bit().constData());
+    return false;
+  }
+  f.write((const char*)&h, sizeof(h));
+  if(!entries.empty())
+    f.write((const char*)entries.data(), entries.size() * sizeof(IndexEntry));
+  f.write(strings);
+  if(!f.commit())
+  {
+    std::fprintf(stderr, "writePluginCacheIndex: writing failed: filename:%s\n",
+                 filepath.toLocal8Bit().constData());
+    return false;
+  }
+  return true;
+}
+
+//---------------------------------------------------------
+//   readPluginCacheIndex
+//---------------------------------------------------------
+
+bool readPluginCacheIndex(
+  const QString& path,
+  PluginScanList* list,
+  PluginScanInfoStruct::PluginType_t types,
+  bool* cacheRes)
+{
+  QFile qf(path + '/' + QString(pluginCacheIndexFilename()));
+  if(!qf.open(QIODevice::ReadOnly))
+    return false;
+  const qint64 size = qf.size();
+  if(size < (qint64)sizeof(IndexHeader))
+    return false;
+  uchar* data = qf.map(0, size);
+  const IndexHeader* h = checkIndexHeader(path, data, size);
+  if(!h)
+  {
+    if(data)
+      qf.unmap(data);
+    return false;
+  }
+
+  const IndexEntry* entries = (const IndexEntry*)(data + sizeof(IndexHeader));
+  const char* strings = (const char*)(entries + h->entryCount);
+
+  bool res = true;
+  for(int i = 0; i < indexCacheCount; ++i)
+  {
+    const PluginScanInfoStruct::PluginType type = indexCacheTypes[i];
+    const PluginScanInfoStruct::PluginType_t want = (type == PluginScanInfoStruct::PluginTypeDSSI) ?
+      (PluginScanInfoStruct::PluginTypeDSSI | PluginScanInfoStruct::PluginTypeDSSIVST) : type;
+    if(!(types & want))
+      continue;
+
+    const IndexCacheFile& f = h->files[i];
+    if(!f.exists || !f.readOk)
+    {
+      res = false;
+      continue;
+    }
+
+    for(uint32_t n = f.first; n < f.first + f.count; ++n)
+    {
+      const IndexEntry& e = entries[n];
+      PluginScanInfoStruct info;
+      info._fileTime = e.fileTime;
+      info._fileSize = e.fileSize;
+      info._uniqueID = e.uniqueID;
+      info._subID = e.subID;
+      info._portCount = e.portCount;
+      info._inports = e.inports;
+      info._outports = e.outports;
+      info._controlInPorts = e.controlInPorts;
+      info._controlOutPorts = e.controlOutPorts;
+      info._eventInPorts = e.eventInPorts;
+      info._eventOutPorts = e.eventOutPorts;
+      info._freewheelPortIdx = e.freewheelPortIdx;
+      info._latencyPortIdx = e.latencyPortIdx;
+      info._enableOrBypassPortIdx = e.enableOrBypassPortIdx;
+      info._type = PluginScanInfoStruct::PluginType(e.type);
+      info._class = e.pluginClass;
+      info._apiVersionMajor = e.apiVersionMajor;
+      info._apiVersionMinor = e.apiVersionMinor;
+      info._pluginVersionMajor = e.pluginVersionMajor;
+      info._pluginVersionMinor = e.pluginVersionMinor;
+      info._pluginFlags = e.pluginFlags;
+      info._pluginLatencyReportingType = MusECore::PluginLatencyReportingType(e.pluginLatencyReportingType);
+      info._pluginBypassType = MusECore::PluginBypassType(e.pluginBypassType);
+      info._pluginFreewheelType = MusECore::PluginFreewheelType(e.pluginFreewheelType);
+      info._requiredFeatures = e.requiredFeatures;
+      info._vstPluginFlags = e.vstPluginFlags;
+      info._fileIsBad = e.fileIsBad != 0;
+
+      PluginInfoString_t* s[IdxStringCount] = {
+        &info._completeBaseName, &info._baseName, &info._suffix, &info._completeSuffix,
+        &info._absolutePath, &info._path, &info._uri, &info._label, &info._name,
+        &info._description, &info._version, &info._maker, &info._copyright, &info._uiFilename };
+      for(int k = 0; k < IdxStringCount; ++k)
+      {
+        const IndexString& is = e.strings[k];
+        if((uint64_t)is.offset + is.size > h->stringsSize)
+          continue;
+        *s[k] = PLUGIN_SET_QSTRING(QString::fromUtf8(strings + is.offset, is.size));
+      }
+
+      list->add(new PluginScanInfo(info));
+    }
+  }
+
+  qf.unmap(data);
+  if(cacheRes)
+    *cacheRes = res;
+  return true;
+}
+
+} // namespace MusEPlugin
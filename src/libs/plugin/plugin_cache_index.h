@@ -0,0 +1,81 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  plugin_cache_index.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __PLUGIN_CACHE_INDEX_H__
+#define __PLUGIN_CACHE_INDEX_H__
+
+#include <QString>
+
+#include "config.h"
+#include "plugin_scan.h"
+#include "plugin_list.h"
+
+// The plugin cache index is a binary copy of what is in the plugin
+//  cache text files, without the ports. It is mapped into memory and
+//  read without parsing, which is much quicker at startup with a few
+//  thousand plugins.
+//
+// The text files stay what the cache is made of. The index is only
+//  used while it was written after them: it remembers the time stamp
+//  and size of each of them, and is ignored if any of them changed.
+
+namespace MusEPlugin {
+
+//-----------------------------------------
+// Public plugin cache index functions
+//-----------------------------------------
+
+// Returns the name of the index file, without path.
+const char* pluginCacheIndexFilename();
+
+// Returns true if the index exists and is up to date with the cache text files.
+bool pluginCacheIndexIsCurrent(
+  // Path to the cache file directory (eg. config path + /scanner).
+  const QString& path
+);
+
+// Write (or overwrite) the index, from the cache text files as they are now.
+// Returns true on success.
+bool writePluginCacheIndex(
+  // Path to the cache file directory (eg. config path + /scanner).
+  const QString& path
+);
+
+// Read the given types of plugins from the index, the same as readPluginCacheFiles()
+//  would read them from the cache text files without ports.
+// Returns false if the index is missing or not up to date, the list is untouched then.
+// Otherwise cacheRes is set to what readPluginCacheFiles() would have returned.
+bool readPluginCacheIndex(
+  // Path to the cache file directory (eg. config path + /scanner).
+  const QString& path,
+  // List to read into.
+  PluginScanList* list,
+  // The types of plugin cache files to read.
+  PluginScanInfoStruct::PluginType_t types,
+  // Set to false if any of the cache files could not be read.
+  bool* cacheRes
+);
+
+} // namespace MusEPlugin
+
+#endif
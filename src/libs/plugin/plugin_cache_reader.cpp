@@ -35,6 +35,7 @@
 #include <cstdlib>
 
 #include "plugin_cache_reader.h"
+#include "plugin_cache_index.h"
 #include "xml.h"
 
 // For debugging output: Uncomment the fprintf section.
@@ -77,6 +78,7 @@ void setPluginScanFileInfo(const QString& filename, PluginScanInfoStruct* info)
 //  info->_absolutePath     = PLUGIN_SET_QSTRING(fi.absolutePath());
 //  info->_path             = PLUGIN_SET_QSTRING(fi.path());
   info->_fileTime         = fi.lastModified().toMSecsSinceEpoch();
+  info->_fileSize         = fi.size();
 }
 
 //---------------------------------------------------------
@@ -284,6 +286,8 @@ bool readPluginScanInfo(MusECore::Xml& xml, PluginScanInfoStruct* info, bool rea
                               info->_uri = PLUGIN_SET_QSTRING(xml.parse1());
                         else if (tag == "filetime")
                               info->_fileTime = xml.parseLongLong();
+                        else if (tag == "filesize")
+                              info->_fileSize = xml.parseLongLong();
                         else if (tag == "fileIsBad")
                               info->_fileIsBad = xml.parseInt();
                         else if (tag == "type")
@@ -877,6 +881,13 @@ bool readPluginCacheFiles(
   PluginScanInfoStruct::PluginType_t types)
 {
   bool res = true;
+
+  // Without ports, the index has everything and is much quicker to read.
+  // Not in an AppImage, where the paths of internal plugins are adjusted
+  //  to where it is mounted each time they are read.
+  if(!readPorts && !readEnums && qgetenv("APPDIR").isEmpty() &&
+     readPluginCacheIndex(path, list, types, &res))
+    return res;
   
   if(types & (PluginScanInfoStruct::PluginTypeDSSI | PluginScanInfoStruct::PluginTypeDSSIVST))
   {
@@ -30,12 +30,18 @@
 //#include <QFileInfoList>
 #include <QFileDevice>
 #include <QProcess>
+#include <QElapsedTimer>
+#include <QThread>
 #include <QByteArray>
 //#include <QByteArrayList>
 #include <QStringList>
 #include <sys/stat.h>
 
 #include <map>
+#include <set>
+#include <memory>
+#include <vector>
+#include <algorithm>
 
 #include <cstdio>
 #include <cstring>
@@ -44,6 +50,7 @@
 
 #include "plugin_cache_writer.h"
 #include "plugin_cache_reader.h"
+#include "plugin_cache_index.h"
 
 #ifdef HAVE_LRDF
   #include "plugin_rdf.h"
@@ -1330,6 +1337,8 @@ void writePluginScanInfo(int level, MusECore::Xml& xml, const PluginScanInfoStru
 
       if(info._fileTime != 0)
         xml.longLongTag(level, "filetime", info._fileTime);
+      if(info._fileSize != 0)
+        xml.longLongTag(level, "filesize", info._fileSize);
       if(info._fileIsBad)
         xml.intTag(level, "fileIsBad", info._fileIsBad);
 
@@ -1560,38 +1569,64 @@ void writePluginScanInfo(int level, MusECore::Xml& xml, const PluginScanInfoStru
       }
 
 //---------------------------------------------------------
-//   pluginScan
-//   If debugStdErr is true, any stderr content received
-//    from the scan program will be printed.
+//   PluginFileStamp
+//   What tells whether a plugin file changed since it was
+//    scanned: its time stamp in milliseconds since epoch,
+//    and its size.
+//---------------------------------------------------------
+
+struct PluginFileStamp
+{
+  std::int64_t _time;
+  std::int64_t _size;
+};
+
+static bool pluginFileChanged(const PluginFileStamp& cached, const PluginFileStamp& current)
+{
+  return cached._time != current._time || cached._size != current._size;
+}
+
+//---------------------------------------------------------
+//   PluginScanJob
+//    One muse_plugin_scan process, scanning one file.
+//---------------------------------------------------------
+
+struct PluginScanJob
+{
+  QString filename;
+  QTemporaryFile tmpfile;
+  QString tmpfilename;
+  QProcess process;
+  QElapsedTimer timer;
+};
+
+//---------------------------------------------------------
+//   pluginScanStart
+//   Starts scanning the file in its own process.
 //   Returns true on success
 //---------------------------------------------------------
 
-static bool pluginScan(
-  const QString& filename,
+static bool pluginScanStart(
+  PluginScanJob* job,
   PluginScanInfoStruct::PluginType_t types,
-  PluginScanList* list,
   bool scanPorts,
   bool debugStdErr)
 {
-  const QByteArray filename_ba = filename.toLocal8Bit();
-  QTemporaryFile tmpfile;
+  const QByteArray filename_ba = job->filename.toLocal8Bit();
   // Must open the temp file to get its name.
-  if(!tmpfile.open())
+  if(!job->tmpfile.open())
   {
     std::fprintf(stderr, "\npluginScan FAILED: Could not create temporary output file for input file: %s\n\n", filename_ba.constData());
     return false;
   }
   // Get the unique temp file name.
-  const QString tmpfilename = tmpfile.fileName();
-  const QByteArray tmpfilename_ba = tmpfilename.toLocal8Bit();
+  job->tmpfilename = job->tmpfile.fileName();
   // Close the temp file. It exists until tmpfile goes out of scope.
-  tmpfile.close();
+  job->tmpfile.close();
 
   if(debugStdErr)
     std::fprintf(stderr, "\nChecking file: <%s>\n", filename_ba.constData());
 
-  QProcess process;
-
   QString prog;
   const QByteArray appDir = qgetenv("APPDIR");
   if (!appDir.isEmpty())
@@ -1600,50 +1635,56 @@ static bool pluginScan(
       prog = QString(BINDIR) + QString("/muse_plugin_scan");
 
   QStringList args;
-  args << QString("-t") + QString::number(types) << QString("-f") + filename << QString("-o") + tmpfilename;
+  args << QString("-t") + QString::number(types) << QString("-f") + job->filename << QString("-o") + job->tmpfilename;
   if(scanPorts)
     args << QString("-p");
 
-  process.start(prog, args);
-
-  bool fail = false;
+  job->process.start(prog, args);
+  job->timer.start();
+  return true;
+}
 
-//   if(!process.waitForStarted(4000))
-//   {
-//     std::fprintf(stderr, "pluginScan: waitForStarted failed\n");
-// //     return false;
-//     fail = true;
-//   }
+//---------------------------------------------------------
+//   pluginScanTimedOut
+//   Asks whether to keep waiting for a scan which takes
+//    very long. Returns true if it should be given up.
+//---------------------------------------------------------
 
-//   if(!process.waitForReadyRead(4000))
-//   {
-//     std::fprintf(stderr, "pluginScan: waitForReadyRead failed\n");
-// //     return false;
-//     fail = true;
-//   }
+static bool pluginScanTimedOut(PluginScanJob* job)
+{
+  std::fprintf(stderr, "\npluginScan FAILED: waitForFinished: file: %s\n\n", job->filename.toLocal8Bit().constData());
+  QMessageBox::StandardButton btn = QMessageBox::warning(
+      nullptr, QMessageBox::tr("Plugin Scanner"),
+      QMessageBox::tr("Checking Plugin %1 is taking a very long time, do you want to keep waiting for it to finish, or skip this plugin?").arg(job->filename),
+      QMessageBox::Retry|QMessageBox::Abort, QMessageBox::Retry);
+
+  if (btn == QMessageBox::Retry) {
+    job->timer.start();
+    return false;
+  }
+  job->process.kill();
+  job->process.waitForFinished(1000);
+  return true;
+}
 
-  if(!process.waitForFinished(6000))
-  {
-    std::fprintf(stderr, "\npluginScan FAILED: waitForFinished: file: %s\n\n", filename_ba.constData());
-    while (1) {
-      QMessageBox::StandardButton btn = QMessageBox::warning(
-          nullptr, QMessageBox::tr("Plugin Scanner"),
-          QMessageBox::tr("Checking Plugin %1 is taking a very long time, do you want to keep waiting for it to finish, or skip this plugin?").arg(filename),
-          QMessageBox::Retry|QMessageBox::Abort, QMessageBox::Retry);
+//---------------------------------------------------------
+//   pluginScanFinish
+//   Reads the results of a finished scan into the list.
+//   If debugStdErr is true, any stderr content received
+//    from the scan program will be printed.
+//   Returns true on success
+//---------------------------------------------------------
 
-      if (btn == QMessageBox::Retry) {
-        if (process.state() == QProcess::NotRunning) {
-          break; // success
-        }
-        if(process.waitForFinished(6000)) {
-          break; // success
-        }
-      } else {
-        fail = true;
-        break; // failure
-      }
-    }
-  }
+static bool pluginScanFinish(
+  PluginScanJob* job,
+  bool fail,
+  PluginScanList* list,
+  bool scanPorts,
+  bool debugStdErr)
+{
+  const QByteArray filename_ba = job->filename.toLocal8Bit();
+  const QByteArray tmpfilename_ba = job->tmpfilename.toLocal8Bit();
+  QProcess& process = job->process;
 
   if(!fail && debugStdErr)
   {
@@ -1663,13 +1704,13 @@ static bool pluginScan(
     }
   }
 
-  if(process.exitStatus() != QProcess::NormalExit)
+  if(!fail && process.exitStatus() != QProcess::NormalExit)
   {
     std::fprintf(stderr, "\npluginScan FAILED: Scan not exited normally: file: %s\n\n", filename_ba.constData());
     fail = true;
   }
 
-  if(process.exitCode() != 0)
+  if(!fail && process.exitCode() != 0)
   {
     std::fprintf(stderr, "\npluginScan FAILED: Scan exit code not 0: file: %s\n\n", filename_ba.constData());
     fail = true;
@@ -1678,7 +1719,7 @@ static bool pluginScan(
   if(!fail)
   {
     // Open the temp file again...
-    QFile infile(tmpfilename);
+    QFile infile(job->tmpfilename);
     if(!infile.exists())
     {
       std::fprintf(stderr, "\npluginScan FAILED: Temporary file does not exist: %s\n\n", tmpfilename_ba.constData());
@@ -1715,7 +1756,7 @@ static bool pluginScan(
       // Close the temp file.
       infile.close();
 
-      // Now going out of scope destroys the temporary file...
+      // The temporary file is destroyed along with the job...
       if(!fail)
         return true;
     }
@@ -1726,7 +1767,7 @@ static bool pluginScan(
   //---------------------------------------------------------------
 
   PluginScanInfoStruct info;
-  setPluginScanFileInfo(filename, &info);
+  setPluginScanFileInfo(job->filename, &info);
   info._type = PluginScanInfoStruct::PluginTypeUnknown;
   info._fileIsBad = true;
   // We must include all plugins.
@@ -1736,16 +1777,112 @@ static bool pluginScan(
 }
 
 //---------------------------------------------------------
-//   scanPluginDir
-//   This might be called recursively!
+//   reusePluginScan
+//   Copies the cached results of a file into the list,
+//    if the file did not change since.
+//   Returns true if it did so.
 //---------------------------------------------------------
 
-static void scanPluginDir(
-  const QString& dirname,
+static bool reusePluginScan(const QString& filename, const PluginScanReuseMap* reuse, PluginScanList* list)
+{
+  if(!reuse)
+    return false;
+  PluginScanReuseMap::const_iterator ir = reuse->find(filename);
+  if(ir == reuse->cend() || ir->second.empty())
+    return false;
+
+  const QFileInfo fi(filename);
+  const PluginScanInfoStruct& cached = ir->second.front()->info();
+  if(pluginFileChanged(PluginFileStamp { cached._fileTime, cached._fileSize },
+                       PluginFileStamp { fi.lastModified().toMSecsSinceEpoch(), fi.size() }))
+    return false;
+
+  list->insert(list->end(), ir->second.begin(), ir->second.end());
+  return true;
+}
+
+//---------------------------------------------------------
+//   pluginScanFiles
+//   Scans the files, each in its own muse_plugin_scan
+//    process, a few of them at the same time. Files
+//    which did not change since they were cached are
+//    not scanned again.
+//   The results are added to the list in file order.
+//---------------------------------------------------------
+
+static void pluginScanFiles(
+  const QStringList& files,
   PluginScanInfoStruct::PluginType_t types,
   PluginScanList* list,
   bool scanPorts,
   bool debugStdErr,
+  const PluginScanReuseMap* reuse)
+{
+  const int count = files.size();
+  std::vector<PluginScanList> results(count);
+  std::vector<std::unique_ptr<PluginScanJob> > jobs(count);
+  const int maxRunning = std::max(1, QThread::idealThreadCount());
+  int next = 0;
+  int running = 0;
+  int scanned = 0;
+
+  while(next < count || running > 0)
+  {
+    // Keep the processes busy.
+    while(next < count && running < maxRunning)
+    {
+      const int i = next++;
+      if(reusePluginScan(files.at(i), reuse, &results[i]))
+        continue;
+      ++scanned;
+      jobs[i].reset(new PluginScanJob);
+      jobs[i]->filename = files.at(i);
+      if(pluginScanStart(jobs[i].get(), types, scanPorts, debugStdErr))
+        ++running;
+      else
+      {
+        pluginScanFinish(jobs[i].get(), true, &results[i], scanPorts, debugStdErr);
+        jobs[i].reset();
+      }
+    }
+
+    // Collect the finished ones. Each one waits a little, so this does not spin.
+    for(int i = 0; i < next; ++i)
+    {
+      PluginScanJob* job = jobs[i].get();
+      if(!job)
+        continue;
+      bool fail = false;
+      if(!job->process.waitForFinished(5) && job->process.state() != QProcess::NotRunning)
+      {
+        if(job->timer.elapsed() < 6000)
+          continue;
+        if(!pluginScanTimedOut(job))
+          continue;
+        fail = true;
+      }
+      pluginScanFinish(job, fail, &results[i], scanPorts, debugStdErr);
+      jobs[i].reset();
+      --running;
+    }
+  }
+
+  if(debugStdErr)
+    std::fprintf(stderr, "pluginScanFiles: %d files, %d scanned, %d unchanged\n", count, scanned, count - scanned);
+
+  for(int i = 0; i < count; ++i)
+    list->insert(list->end(), results[i].begin(), results[i].end());
+}
+
+//---------------------------------------------------------
+//   findPluginDirFiles
+//   Adds the plugin files in the directory to the list.
+//   This might be called recursively!
+//---------------------------------------------------------
+
+static void findPluginDirFiles(
+  const QString& dirname,
+  QStringList* files,
   // Only for recursions, original top caller should not touch!
   int recurseLevel = 0
 )
@@ -1775,35 +1912,53 @@ static void scanPluginDir(
       const QFileInfo& fi = *it;
       if(fi.isDir())
         // RECURSIVE!
-        scanPluginDir(fi.filePath(), types, list, scanPorts, debugStdErr, recurseLevel + 1);
+        findPluginDirFiles(fi.filePath(), files, recurseLevel + 1);
       else
-        pluginScan(fi.filePath(), types, list, scanPorts, debugStdErr);
+        files->append(fi.filePath());
 
       ++it;
     }
   }
 }
 
+//---------------------------------------------------------
+//   scanPluginDirs
+//---------------------------------------------------------
+
+static void scanPluginDirs(
+  const QStringList& dirnames,
+  PluginScanInfoStruct::PluginType_t types,
+  PluginScanList* list,
+  bool scanPorts,
+  bool debugStdErr,
+  const PluginScanReuseMap* reuse)
+{
+  QStringList files;
+  for(QStringList::const_iterator it = dirnames.cbegin(); it != dirnames.cend(); ++it)
+    findPluginDirFiles(*it, &files);
+  pluginScanFiles(files, types, list, scanPorts, debugStdErr, reuse);
+}
+
 //---------------------------------------------------------
 //   scanLadspaPlugins
 //---------------------------------------------------------
 
-void scanLadspaPlugins(const QString& museGlobalLib, PluginScanList* list, bool scanPorts, bool debugStdErr)
+void scanLadspaPlugins(const QString& museGlobalLib, PluginScanList* list, bool scanPorts, bool debugStdErr,
+                       const PluginScanReuseMap* reuse)
 {
   QStringList sl = pluginGetLadspaDirectories(museGlobalLib);
-  for(QStringList::const_iterator it = sl.cbegin(); it != sl.cend(); ++it)
-    scanPluginDir(*it, PluginScanInfoStruct::PluginTypeAll, list, scanPorts, debugStdErr);
+  scanPluginDirs(sl, PluginScanInfoStruct::PluginTypeAll, list, scanPorts, debugStdErr, reuse);
 }
 
 //---------------------------------------------------------
 //   scanMessPlugins
 //---------------------------------------------------------
 
-void scanMessPlugins(const QString& museGlobalLib, PluginScanList* list, bool scanPorts, bool debugStdErr)
+void scanMessPlugins(const QString& museGlobalLib, PluginScanList* list, bool scanPorts, bool debugStdErr,
+                     const PluginScanReuseMap* reuse)
 {
   QStringList sl = pluginGetMessDirectories(museGlobalLib);
-  for(QStringList::const_iterator it = sl.cbegin(); it != sl.cend(); ++it)
-    scanPluginDir(*it, PluginScanInfoStruct::PluginTypeAll, list, scanPorts, debugStdErr);
+  scanPluginDirs(sl, PluginScanInfoStruct::PluginTypeAll, list, scanPorts, debugStdErr, reuse);
 }
 
 //---------------------------------------------------------
@@ -1811,14 +1966,15 @@ void scanMessPlugins(const QString& museGlobalLib, PluginScanList* list, bool sc
 //---------------------------------------------------------
 
 #ifdef DSSI_SUPPORT
-void scanDssiPlugins(PluginScanList* list, bool scanPorts, bool debugStdErr)
+void scanDssiPlugins(PluginScanList* list, bool scanPorts, bool debugStdErr,
+                     const PluginScanReuseMap* reuse)
 {
   QStringList sl = pluginGetDssiDirectories();
-  for(QStringList::const_iterator it = sl.cbegin(); it != sl.cend(); ++it)
-    scanPluginDir(*it, PluginScanInfoStruct::PluginTypeAll, list, scanPorts, debugStdErr);
+  scanPluginDirs(sl, PluginScanInfoStruct::PluginTypeAll, list, scanPorts, debugStdErr, reuse);
 }
 #else // No DSSI_SUPPORT
-void scanDssiPlugins(PluginScanList* /*list*/, bool /*scanPorts*/, bool /*debugStdErr*/)
+void scanDssiPlugins(PluginScanList* /*list*/, bool /*scanPorts*/, bool /*debugStdErr*/,
+                     const PluginScanReuseMap* /*reuse*/)
 {
 }
 #endif // DSSI_SUPPORT
@@ -1828,7 +1984,8 @@ void scanDssiPlugins(PluginScanList* /*list*/, bool /*scanPorts*/, bool /*debugS
 //---------------------------------------------------------
 
 #ifdef VST_NATIVE_SUPPORT
-void scanLinuxVSTPlugins(PluginScanList* list, bool scanPorts, bool debugStdErr)
+void scanLinuxVSTPlugins(PluginScanList* list, bool scanPorts, bool debugStdErr,
+                         const PluginScanReuseMap* reuse)
 {
   #ifdef VST_VESTIGE_SUPPORT
     std::fprintf(stderr, "Initializing Native VST support. Using VESTIGE compatibility implementation.\n");
@@ -1839,11 +1996,11 @@ void scanLinuxVSTPlugins(PluginScanList* list, bool scanPorts, bool debugStdErr)
 //   sem_init(&_vstIdLock, 0, 1);
 
   QStringList sl = pluginGetLinuxVstDirectories();
-  for(QStringList::const_iterator it = sl.cbegin(); it != sl.cend(); ++it)
-    scanPluginDir(*it, PluginScanInfoStruct::PluginTypeAll, list, scanPorts, debugStdErr);
+  scanPluginDirs(sl, PluginScanInfoStruct::PluginTypeAll, list, scanPorts, debugStdErr, reuse);
 }
 #else
-void scanLinuxVSTPlugins(PluginScanList* /*list*/, bool /*scanPorts*/, bool /*debugStdErr*/)
+void scanLinuxVSTPlugins(PluginScanList* /*list*/, bool /*scanPorts*/, bool /*debugStdErr*/,
+                         const PluginScanReuseMap* /*reuse*/)
 {
 }
 #endif // VST_NATIVE_SUPPORT
@@ -2652,23 +2809,24 @@ void scanAllPlugins(
   PluginScanList* list,
   bool scanPorts,
   bool debugStdErr,
-  PluginScanInfoStruct::PluginType_t types)
+  PluginScanInfoStruct::PluginType_t types,
+  const PluginScanReuseMap* reuse)
 {
   if(types & (PluginScanInfoStruct::PluginTypeDSSI | PluginScanInfoStruct::PluginTypeDSSIVST))
     // Take care of DSSI plugins first...
-    scanDssiPlugins(list, scanPorts, debugStdErr);
+    scanDssiPlugins(list, scanPorts, debugStdErr, reuse);
 
   if(types & (PluginScanInfoStruct::PluginTypeLADSPA))
     // Now do LADSPA plugins...
-    scanLadspaPlugins(museGlobalLib, list, scanPorts, debugStdErr);
+    scanLadspaPlugins(museGlobalLib, list, scanPorts, debugStdErr, reuse);
 
   if(types & (PluginScanInfoStruct::PluginTypeMESS))
     // Now do MESS plugins...
-    scanMessPlugins(museGlobalLib, list, scanPorts, debugStdErr);
+    scanMessPlugins(museGlobalLib, list, scanPorts, debugStdErr, reuse);
 
   if(types & (PluginScanInfoStruct::PluginTypeLinuxVST))
     // Now do LinuxVST plugins...
-    scanLinuxVSTPlugins(list, scanPorts, debugStdErr);
+    scanLinuxVSTPlugins(list, scanPorts, debugStdErr, reuse);
 
 // SPECIAL for LV2: No need for a cache file. Do not create one here. Read directly into the list later.
 //   if(types & (PluginScanInfoStruct::PluginTypeLV2))
@@ -2676,8 +2834,8 @@ void scanAllPlugins(
 //     scanLv2Plugins(list, scanPorts, debugStdErr);
 }
 
-typedef std::map<QString, std::int64_t, std::less<QString> > filepath_set;
-typedef std::pair<QString, std::int64_t> filepath_set_pair;
+typedef std::map<QString, PluginFileStamp, std::less<QString> > filepath_set;
+typedef std::pair<QString, PluginFileStamp> filepath_set_pair;
 
 //---------------------------------------------------------
 //   findPluginFilesDir
@@ -2723,7 +2881,8 @@ static QString findPluginFilesDir(
       }
       else
       {
-        fplist.insert(filepath_set_pair(fi.filePath(), fi.lastModified().toMSecsSinceEpoch()));
+        fplist.insert(filepath_set_pair(fi.filePath(),
+                      PluginFileStamp { fi.lastModified().toMSecsSinceEpoch(), fi.size() }));
       }
 
       ++it;
@@ -3022,10 +3181,11 @@ bool createPluginCacheFile(
   bool writePorts,
   const QString& museGlobalLib,
   PluginScanInfoStruct::PluginType_t types,
-  bool debugStdErr)
+  bool debugStdErr,
+  const PluginScanReuseMap* reuse)
 {
   // Scan all plugins into the list.
-  scanAllPlugins(museGlobalLib, list, writePorts, debugStdErr, type);
+  scanAllPlugins(museGlobalLib, list, writePorts, debugStdErr, type, reuse);
 
   // Write the list's cache file.
   if(!writePluginCacheFile(path, QString(pluginCacheFilename(type)), *list, writePorts, types))
@@ -3047,11 +3207,12 @@ bool createPluginCacheFiles(
   bool writePorts,
   const QString& museGlobalLib,
   PluginScanInfoStruct::PluginType_t types,
-  bool debugStdErr)
+  bool debugStdErr,
+  const PluginScanReuseMap* reuse)
 {
   if(types & (PluginScanInfoStruct::PluginTypeDSSI | PluginScanInfoStruct::PluginTypeDSSIVST))
     createPluginCacheFile(path, PluginScanInfoStruct::PluginTypeDSSI, list, writePorts,
-      museGlobalLib, PluginScanInfoStruct::PluginTypeDSSI | PluginScanInfoStruct::PluginTypeDSSIVST, debugStdErr);
+      museGlobalLib, PluginScanInfoStruct::PluginTypeDSSI | PluginScanInfoStruct::PluginTypeDSSIVST, debugStdErr, reuse);
 
   // NOTE: Because the dss-vst library installs itself in both the dssi AND ladspa folders,
   //        we must include dssi-vst types in the search here.
@@ -3059,32 +3220,74 @@ bool createPluginCacheFiles(
   //        and the dssi folder dss-vst file scan.
   if(types & PluginScanInfoStruct::PluginTypeLADSPA)
     createPluginCacheFile(path, PluginScanInfoStruct::PluginTypeLADSPA, list, writePorts,
-      museGlobalLib, PluginScanInfoStruct::PluginTypeLADSPA | PluginScanInfoStruct::PluginTypeDSSIVST, debugStdErr);
+      museGlobalLib, PluginScanInfoStruct::PluginTypeLADSPA | PluginScanInfoStruct::PluginTypeDSSIVST, debugStdErr, reuse);
 
   if(types & PluginScanInfoStruct::PluginTypeLinuxVST)
     createPluginCacheFile(path, PluginScanInfoStruct::PluginTypeLinuxVST, list, writePorts,
-      museGlobalLib, PluginScanInfoStruct::PluginTypeLinuxVST, debugStdErr);
+      museGlobalLib, PluginScanInfoStruct::PluginTypeLinuxVST, debugStdErr, reuse);
 
   if(types & PluginScanInfoStruct::PluginTypeMESS)
     createPluginCacheFile(path, PluginScanInfoStruct::PluginTypeMESS, list, writePorts,
-      museGlobalLib, PluginScanInfoStruct::PluginTypeMESS, debugStdErr);
+      museGlobalLib, PluginScanInfoStruct::PluginTypeMESS, debugStdErr, reuse);
 
   // SPECIAL for LV2: No need for a cache file. Do not create one here. Read directly into the list later.
   //if(types & PluginScanInfoStruct::PluginTypeLV2)
   //  createPluginCacheFile(path, PluginScanInfoStruct::PluginTypeLV2, list, writePorts,
-  //    museGlobalLib, PluginScanInfoStruct::PluginTypeLV2, debugStdErr);
+  //    museGlobalLib, PluginScanInfoStruct::PluginTypeLV2, debugStdErr, reuse);
 
   if(types & PluginScanInfoStruct::PluginTypeVST)
     createPluginCacheFile(path, PluginScanInfoStruct::PluginTypeVST, list, writePorts,
-      museGlobalLib, PluginScanInfoStruct::PluginTypeVST, debugStdErr);
+      museGlobalLib, PluginScanInfoStruct::PluginTypeVST, debugStdErr, reuse);
 
   if(types & PluginScanInfoStruct::PluginTypeUnknown)
     createPluginCacheFile(path, PluginScanInfoStruct::PluginTypeUnknown, list, writePorts,
-      museGlobalLib, PluginScanInfoStruct::PluginTypeUnknown, debugStdErr);
+      museGlobalLib, PluginScanInfoStruct::PluginTypeUnknown, debugStdErr, reuse);
 
   return true;
 }
 
+//---------------------------------------------------------
+//   buildPluginScanReuseMap
+//   Gathers the cached scan results by file path.
+//   A file can be in more than one cache file (dssi-vst
+//    is in both the dssi and ladspa folders), its
+//    plugins are taken only once.
+//---------------------------------------------------------
+
+static void buildPluginScanReuseMap(const PluginScanList& list, PluginScanReuseMap* reuse)
+{
+  std::set<QString> bad;
+  for(ciPluginScanList ips = list.cbegin(); ips != list.cend(); ++ips)
+  {
+    const PluginScanInfoRef inforef = *ips;
+    const PluginScanInfoStruct& info = inforef->info();
+    const QString filepath = PLUGIN_GET_QSTRING(info.filePath());
+    if(info._fileIsBad)
+    {
+      bad.insert(filepath);
+      continue;
+    }
+
+    PluginScanList& entries = (*reuse)[filepath];
+    bool found = false;
+    for(ciPluginScanList ie = entries.cbegin(); ie != entries.cend(); ++ie)
+    {
+      const PluginScanInfoStruct& e = (*ie)->info();
+      if(e._type == info._type && e._uniqueID == info._uniqueID && e._subID == info._subID &&
+         e._label == info._label && e._uri == info._uri)
+      {
+        found = true;
+        break;
+      }
+    }
+    if(!found)
+      entries.push_back(inforef);
+  }
+
+  for(std::set<QString>::const_iterator ib = bad.cbegin(); ib != bad.cend(); ++ib)
+    reuse->erase(*ib);
+}
+
 //---------------------------------------------------------
 //   checkPluginCacheFiles
 //---------------------------------------------------------
@@ -3132,7 +3335,8 @@ bool checkPluginCacheFiles(
     {
       PluginScanInfoRef inforef = *ips;
       const PluginScanInfoStruct& infos = inforef->info();
-      cache_fpset.insert(filepath_set_pair(PLUGIN_GET_QSTRING(infos.filePath()), infos._fileTime));
+      cache_fpset.insert(filepath_set_pair(PLUGIN_GET_QSTRING(infos.filePath()),
+                                           PluginFileStamp{infos._fileTime, infos._fileSize}));
     }
 
     //---------------------------------------
@@ -3142,7 +3346,7 @@ bool checkPluginCacheFiles(
     for(filepath_set::iterator icfps = cache_fpset.begin(); icfps != cache_fpset.end(); ++icfps)
     {
       filepath_set::iterator ifpset = fpset.find(icfps->first);
-      if(ifpset == fpset.end() || ifpset->second != icfps->second)
+      if(ifpset == fpset.end() || pluginFileChanged(icfps->second, ifpset->second))
       {
         cache_dirty = true;
 
@@ -3151,10 +3355,12 @@ bool checkPluginCacheFiles(
             if(ifpset == fpset.end())
                 std::fprintf(stderr, "Missing plugin: %s:\n", icfps->first.toLatin1().data());
             else
-                std::fprintf(stderr, "Modified plugin: %s (Cache ts: %ld / File ts: %ld)\n",
+                std::fprintf(stderr, "Modified plugin: %s (Cache ts: %ld size: %lld / File ts: %ld size: %lld)\n",
                              icfps->first.toLatin1().data(),
-                             (long int) icfps->second,
-                             (long int) ifpset->second);
+                             (long int) icfps->second._time,
+                             (long long int) icfps->second._size,
+                             (long int) ifpset->second._time,
+                             (long long int) ifpset->second._size);
         }
 
         break;
@@ -3191,14 +3397,31 @@ bool checkPluginCacheFiles(
     if(debugStdErr)
       std::fprintf(stderr, "Re-scanning and creating plugin cache files...\n");
 
+    // Keep what we have of files which may not have changed, so that only the new
+    //  and changed ones are scanned again. The cache was read without ports, so
+    //  not if ports are wanted. Files which failed are always tried again.
+    PluginScanReuseMap reuse;
+    if(!alwaysRecreate && !writePorts)
+      buildPluginScanReuseMap(*list, &reuse);
+
     list->clear();
-    if(!createPluginCacheFiles(path, list, writePorts, museGlobalLib, types, debugStdErr))
+    if(!createPluginCacheFiles(path, list, writePorts, museGlobalLib, types, debugStdErr,
+                               (!alwaysRecreate && !writePorts) ? &reuse : nullptr))
     {
       res = false;
       std::fprintf(stderr, "checkPluginCacheFiles: createPluginCacheFiles() failed\n");
     }
   }
 
+  // Bring the index up to date with the cache files, if they were just
+  //  written, or it is missing or older than them.
+  if(!dontRecreate && !pluginCacheIndexIsCurrent(path))
+  {
+    if(debugStdErr)
+      std::fprintf(stderr, "Writing plugin cache index...\n");
+    writePluginCacheIndex(path);
+  }
+
   // SPECIAL for LV2: Get rid of old cache file. Not used any more.
   const QString targ_filepath = path + "/" + QString(pluginCacheFilename(PluginScanInfoStruct::PluginTypeLV2));
   QFile targ_qfile(targ_filepath);
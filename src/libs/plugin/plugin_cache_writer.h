@@ -26,6 +26,8 @@
 
 #include <QString>
 
+#include <map>
+
 #include "config.h"
 #include "globaldefs.h"
 #include "plugin_scan.h"
@@ -145,11 +147,19 @@ bool writeUnknownPluginInfo(const char* filename, int level, MusECore::Xml& xml)
 
 void writePluginScanInfo(int level, MusECore::Xml& xml, const PluginScanInfoStruct& info, bool writePorts);
 
+// Cached scan results by plugin file path. Files which have not changed since
+//  are taken from here instead of being scanned again.
+typedef std::map<QString, PluginScanList> PluginScanReuseMap;
+
 // The museGlobalLib is where to find the application's installed libraries.
-void scanLadspaPlugins(const QString& museGlobalLib, PluginScanList* list, bool scanPorts, bool debugStdErr);
-void scanMessPlugins(const QString& museGlobalLib, PluginScanList* list, bool scanPorts, bool debugStdErr);
-void scanDssiPlugins(PluginScanList* list, bool scanPorts, bool debugStdErr);
-void scanLinuxVSTPlugins(PluginScanList* list, bool scanPorts, bool debugStdErr);
+void scanLadspaPlugins(const QString& museGlobalLib, PluginScanList* list, bool scanPorts, bool debugStdErr,
+                       const PluginScanReuseMap* reuse = nullptr);
+void scanMessPlugins(const QString& museGlobalLib, PluginScanList* list, bool scanPorts, bool debugStdErr,
+                     const PluginScanReuseMap* reuse = nullptr);
+void scanDssiPlugins(PluginScanList* list, bool scanPorts, bool debugStdErr,
+                     const PluginScanReuseMap* reuse = nullptr);
+void scanLinuxVSTPlugins(PluginScanList* list, bool scanPorts, bool debugStdErr,
+                         const PluginScanReuseMap* reuse = nullptr);
 #ifdef LV2_USE_PLUGIN_CACHE
 void scanLv2Plugins(PluginScanList* list, bool scanPorts, bool debugStdErr);
 #endif
@@ -158,7 +168,8 @@ void scanAllPlugins(const QString& museGlobalLib,
                     PluginScanList* list,
                     bool scanPorts,
                     bool debugStdErr,
-                    PluginScanInfoStruct::PluginType_t types = PluginScanInfoStruct::PluginTypeAll);
+                    PluginScanInfoStruct::PluginType_t types = PluginScanInfoStruct::PluginTypeAll,
+                    const PluginScanReuseMap* reuse = nullptr);
 
 //-----------------------------------------
 // Public cache writer functions
@@ -179,7 +190,9 @@ bool createPluginCacheFile(
   // The types of plugins to write into this one file.
   PluginScanInfoStruct::PluginType_t types = PluginScanInfoStruct::PluginTypeAll,
   // Print some stderr text
-  bool debugStdErr = false
+  bool debugStdErr = false,
+  // Earlier scan results to take for files which have not changed. Can be null.
+  const PluginScanReuseMap* reuse = nullptr
 );
 
 bool createPluginCacheFiles(
@@ -194,7 +207,9 @@ bool createPluginCacheFiles(
   // The types of plugin cache files to create.
   PluginScanInfoStruct::PluginType_t types = PluginScanInfoStruct::PluginTypeAll,
   // Print some stderr text
-  bool debugStdErr = false
+  bool debugStdErr = false,
+  // Earlier scan results to take for files which have not changed. Can be null.
+  const PluginScanReuseMap* reuse = nullptr
 );
 
 // Checks existence of given cache file types.
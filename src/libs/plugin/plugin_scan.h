@@ -206,6 +206,8 @@ class PluginScanInfoStruct
 
     // The file's time stamp in milliseconds since epoch.
     int64_t _fileTime;
+    // The file's size in bytes.
+    int64_t _fileSize;
     // Whether the file failed scanning.
     bool _fileIsBad;
     
@@ -267,6 +269,7 @@ class PluginScanInfoStruct
   public:
     PluginScanInfoStruct() :
       _fileTime(0),
+      _fileSize(0),
       _fileIsBad(false),
       _type(PluginTypeNone),
       _class(PluginClassNone),
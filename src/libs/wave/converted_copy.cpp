@@ -0,0 +1,220 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  converted_copy.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QString>
+
+#include "converted_copy.h"
+#include "worker_pool.h"
+#include "audio_convert/audio_converter_plugin.h"
+#include "time_stretch.h"
+
+// For debugging output: Uncomment the fprintf section.
+#define ERROR_CONVERTED(dev, format, args...) fprintf(dev, format, ##args)
+#define DEBUG_CONVERTED(dev, format, args...)  // fprintf(dev, format, ##args)
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   renderPool
+//    One thread renders the copies, one after another,
+//     so they do not compete with playback for the CPU.
+//---------------------------------------------------------
+
+static WorkerPool& renderPool()
+{
+  static WorkerPool pool(1);
+  return pool;
+}
+
+static std::atomic<unsigned> tempCounter(0);
+
+//---------------------------------------------------------
+//   ConvertedCopy
+//---------------------------------------------------------
+
+ConvertedCopy::ConvertedCopy()
+  : _channels(0), _ratio(1.0), _sampleRate(0), _frames(0), _converter(nullptr), _budget(0),
+    _cancelled(false), _done(false), _ok(false)
+{
+}
+
+ConvertedCopy::~ConvertedCopy()
+{
+  if(_converter)
+    delete _converter;
+}
+
+//---------------------------------------------------------
+//   start
+//---------------------------------------------------------
+
+std::shared_ptr<ConvertedCopy> ConvertedCopy::start(
+  const char* srcPath, const char* path, int channels, double ratio, int sampleRate,
+  sf_count_t frames, AudioConverterPluginI* converter, size_t budgetBytes)
+{
+  std::shared_ptr<ConvertedCopy> cc(new ConvertedCopy());
+  cc->_srcPath = srcPath;
+  cc->_path = path;
+  cc->_channels = channels;
+  cc->_ratio = ratio;
+  cc->_sampleRate = sampleRate;
+  cc->_frames = frames;
+  cc->_converter = converter;
+  cc->_budget = budgetBytes;
+  renderPool().add([cc]() { cc->render(); });
+  return cc;
+}
+
+//---------------------------------------------------------
+//   render
+//---------------------------------------------------------
+
+void ConvertedCopy::render()
+{
+  bool ok = false;
+  if(_cancelled.load())
+  {
+    _done.store(true, std::memory_order_release);
+    return;
+  }
+
+  // A unique temporary name, in case two sound files render the same copy.
+  const std::string tmpPath = _path + "." + std::to_string(tempCounter.fetch_add(1)) + ".part";
+  SF_INFO inInfo;
+  memset(&inInfo, 0, sizeof(inInfo));
+  SNDFILE* in = sf_open(_srcPath.c_str(), SFM_READ, &inInfo);
+  SF_INFO outInfo;
+  memset(&outInfo, 0, sizeof(outInfo));
+  outInfo.samplerate = _sampleRate;
+  outInfo.channels = _channels;
+  outInfo.format = SF_FORMAT_W64 | SF_FORMAT_FLOAT;
+  SNDFILE* out = in ? sf_open(tmpPath.c_str(), SFM_WRITE, &outInfo) : nullptr;
+
+  if(in && out && inInfo.channels == _channels)
+  {
+    DEBUG_CONVERTED(stderr, "ConvertedCopy: rendering %s\n", _path.c_str());
+    // The copy holds the file as it is, without any stretching.
+    StretchList stretchList;
+    const int chunk = 16384;
+    std::vector<float> data(size_t(chunk) * _channels);
+    std::vector<float> interleaved(size_t(chunk) * _channels);
+    float* buffers[_channels];
+    for(int ch = 0; ch < _channels; ++ch)
+      buffers[ch] = data.data() + size_t(ch) * chunk;
+
+    sf_count_t pos = 0;
+    while(pos < _frames && !_cancelled.load(std::memory_order_relaxed))
+    {
+      const int n = int(std::min(sf_count_t(chunk), _frames - pos));
+      const int got = _converter->process(
+        in, _channels, _ratio, &stretchList, pos, buffers, _channels, n, true);
+      if(got <= 0)
+        break;
+      for(int i = 0; i < got; ++i)
+        for(int ch = 0; ch < _channels; ++ch)
+          interleaved[size_t(i) * _channels + ch] = buffers[ch][i];
+      if(sf_writef_float(out, interleaved.data(), got) != got)
+        break;
+      pos += got;
+    }
+    ok = pos >= _frames && !_cancelled.load();
+    if(!ok && !_cancelled.load())
+      ERROR_CONVERTED(stderr, "ConvertedCopy: Rendering %s into %s failed at frame %ld.\n",
+        _srcPath.c_str(), _path.c_str(), long(pos));
+  }
+  else
+    ERROR_CONVERTED(stderr, "ConvertedCopy: Cannot render %s into %s: %s\n",
+      _srcPath.c_str(), tmpPath.c_str(), sf_strerror(in ? out : nullptr));
+
+  if(in)
+    sf_close(in);
+  if(out && sf_close(out) != 0)
+    ok = false;
+
+  if(ok && rename(tmpPath.c_str(), _path.c_str()) != 0)
+  {
+    ERROR_CONVERTED(stderr, "ConvertedCopy: Cannot rename %s: %s\n", tmpPath.c_str(), strerror(errno));
+    ok = false;
+  }
+  if(!ok)
+    remove(tmpPath.c_str());
+  else
+    trimCache();
+
+  // The converter is not needed any more.
+  delete _converter;
+  _converter = nullptr;
+
+  _ok.store(ok, std::memory_order_release);
+  _done.store(true, std::memory_order_release);
+}
+
+//---------------------------------------------------------
+//   trimCache
+//---------------------------------------------------------
+
+void ConvertedCopy::trimCache() const
+{
+  const QFileInfo self(QString::fromLocal8Bit(_path.c_str()));
+  // Most recently used first.
+  const QFileInfoList files = self.absoluteDir().entryInfoList(
+    QStringList() << "*.w64", QDir::Files, QDir::Time);
+  qint64 total = 0;
+  for(const QFileInfo& fi : files)
+  {
+    if(fi.absoluteFilePath() == self.absoluteFilePath())
+    {
+      total += fi.size();
+      continue;
+    }
+    if(total + fi.size() > qint64(_budget))
+    {
+      DEBUG_CONVERTED(stderr, "ConvertedCopy: removing %s\n", fi.absoluteFilePath().toLocal8Bit().constData());
+      QFile::remove(fi.absoluteFilePath());
+    }
+    else
+      total += fi.size();
+  }
+}
+
+//---------------------------------------------------------
+//   touch
+//---------------------------------------------------------
+
+void ConvertedCopy::touch(const char* path)
+{
+  utimes(path, nullptr);
+}
+
+} // namespace MusECore
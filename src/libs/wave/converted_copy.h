@@ -0,0 +1,98 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  converted_copy.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __CONVERTED_COPY_H__
+#define __CONVERTED_COPY_H__
+
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <sndfile.h>
+
+namespace MusECore {
+
+class AudioConverterPluginI;
+
+//---------------------------------------------------------
+//   ConvertedCopy
+//    Renders a copy of a sound file converted to the
+//     system sample rate into the disk cache, in the
+//     background. Once done, SndFile plays the copy
+//     instead of converting the file while playing.
+//
+//    The copy is written as a float W64 file next to the
+//     others in the cache directory, under a temporary
+//     name which is only renamed to the final path when
+//     complete. Afterwards the least recently used copies
+//     are removed until the directory fits into the budget.
+//---------------------------------------------------------
+
+class ConvertedCopy {
+      std::string _srcPath;
+      std::string _path;
+      int _channels;
+      double _ratio;
+      int _sampleRate;
+      // The number of frames the copy gets.
+      sf_count_t _frames;
+      // Used by the render job only, and deleted along with the copy.
+      AudioConverterPluginI* _converter;
+      size_t _budget;
+
+      std::atomic<bool> _cancelled;
+      std::atomic<bool> _done;
+      std::atomic<bool> _ok;
+
+      ConvertedCopy();
+      void render();
+      // Removes the least recently used copies over the budget, except this one.
+      void trimCache() const;
+
+   public:
+      ~ConvertedCopy();
+      ConvertedCopy(const ConvertedCopy&) = delete;
+      ConvertedCopy& operator=(const ConvertedCopy&) = delete;
+
+      // Starts rendering the sound file at srcPath into path, with the given converter,
+      //  which the copy takes over. ratio is the file's sample rate over sampleRate,
+      //  frames the length of the converted audio. The cache directory is trimmed to
+      //  budgetBytes afterwards.
+      static std::shared_ptr<ConvertedCopy> start(
+        const char* srcPath, const char* path, int channels, double ratio, int sampleRate,
+        sf_count_t frames, AudioConverterPluginI* converter, size_t budgetBytes);
+
+      const std::string& path() const { return _path; }
+      // Whether rendering ended, and whether the copy was completed.
+      bool isDone() const { return _done.load(std::memory_order_acquire); }
+      bool succeeded() const { return _ok.load(std::memory_order_acquire); }
+      // Stops rendering. Nothing is left behind in the cache.
+      void cancel() { _cancelled.store(true); }
+
+      // Marks the copy at path as just used, for trimming.
+      static void touch(const char* path);
+      };
+
+} // namespace MusECore
+
+#endif
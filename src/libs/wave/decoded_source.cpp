@@ -0,0 +1,574 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  decoded_source.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "decoded_source.h"
+#include "worker_pool.h"
+
+// For debugging output: Uncomment the fprintf section.
+#define ERROR_DECODED(dev, format, args...) fprintf(dev, format, ##args)
+#define DEBUG_DECODED(dev, format, args...)  // fprintf(dev, format, ##args)
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   decodePool
+//    The threads decoding ahead, shared by all sources.
+//---------------------------------------------------------
+
+static WorkerPool& decodePool()
+{
+  static WorkerPool pool(2);
+  return pool;
+}
+
+//---------------------------------------------------------
+//   DecodedSource::Blocks
+//    The decoded blocks of a file, shared by all sources
+//     reading the same file, so the clones of an event or
+//     a clip used many times decode each block once.
+//
+//    Each source may keep as many blocks as its cache size
+//     allows, so sharing never keeps more than separate
+//     caches would, and never more than the whole file.
+//---------------------------------------------------------
+
+struct DecodedSource::Blocks {
+      // Decoded interleaved frames of a block.
+      struct Block {
+            std::vector<float> data;
+            sf_count_t frames;
+            unsigned long used;
+            };
+
+      std::string key;
+      int channels;
+      sf_count_t frames;
+      size_t blocksPerSource;
+
+      std::mutex mutex;
+      std::condition_variable cond;
+      // The sources reading these blocks, and the blocks they keep together.
+      int sources;
+      size_t maxBlocks;
+      std::map<sf_count_t, Block> blocks;
+      // Blocks being decoded right now, by any of the sources.
+      std::set<sf_count_t> pending;
+      unsigned long useCount;
+
+      Blocks() : channels(0), frames(0), blocksPerSource(0), sources(0), maxBlocks(0), useCount(0) { }
+
+      void setSources(int n);
+      void insert(sf_count_t b, std::vector<float>& data, sf_count_t n);
+      };
+
+//---------------------------------------------------------
+//   setSources
+//    Mutex must be held.
+//---------------------------------------------------------
+
+void DecodedSource::Blocks::setSources(int n)
+{
+  sources = n;
+  const size_t fileBlocks = size_t((frames + BlockFrames - 1) / BlockFrames);
+  maxBlocks = std::max(size_t(1), std::min(fileBlocks, blocksPerSource * size_t(std::max(1, sources))));
+}
+
+//---------------------------------------------------------
+//   insert
+//    Stores a decoded block and drops the least recently
+//     used ones over the limit. Mutex must be held.
+//---------------------------------------------------------
+
+void DecodedSource::Blocks::insert(sf_count_t b, std::vector<float>& data, sf_count_t n)
+{
+  Block& blk = blocks[b];
+  blk.data.swap(data);
+  blk.frames = n;
+  blk.used = ++useCount;
+  pending.erase(b);
+
+  while(blocks.size() > maxBlocks)
+  {
+    auto oldest = blocks.end();
+    for(auto it = blocks.begin(); it != blocks.end(); ++it)
+      if(it->first != b && (oldest == blocks.end() || it->second.used < oldest->second.used))
+        oldest = it;
+    if(oldest == blocks.end())
+      break;
+    blocks.erase(oldest);
+  }
+  cond.notify_all();
+}
+
+//---------------------------------------------------------
+//   sharedBlocks
+//    Finds the blocks of the file at path, or makes new
+//     ones. Files are told apart by device, inode, size
+//     and modification time, so a file changed on disk
+//     gets new blocks, and paths leading to the same file
+//     share them.
+//---------------------------------------------------------
+
+static std::mutex sharedBlocksMutex;
+static std::map<std::string, std::weak_ptr<DecodedSource::Blocks> > sharedBlocksMap;
+
+static std::shared_ptr<DecodedSource::Blocks> sharedBlocks(
+  const char* path, const SF_INFO& info, size_t blocksPerSource)
+{
+  struct stat st;
+  std::string key;
+  if(stat(path, &st) == 0)
+    key = std::to_string(st.st_dev) + ":" + std::to_string(st.st_ino) + ":" +
+          std::to_string(st.st_size) + ":" + std::to_string(st.st_mtim.tv_sec) + "." +
+          std::to_string(st.st_mtim.tv_nsec);
+  else
+    key = path;
+
+  std::lock_guard<std::mutex> g(sharedBlocksMutex);
+  for(auto it = sharedBlocksMap.begin(); it != sharedBlocksMap.end(); )
+  {
+    if(it->second.expired())
+      it = sharedBlocksMap.erase(it);
+    else
+      ++it;
+  }
+
+  std::shared_ptr<DecodedSource::Blocks> bl;
+  auto it = sharedBlocksMap.find(key);
+  if(it != sharedBlocksMap.end())
+    bl = it->second.lock();
+  if(bl && bl->channels == info.channels && bl->frames == info.frames)
+  {
+    DEBUG_DECODED(stderr, "DecodedSource: sharing the blocks of %s\n", path);
+    std::lock_guard<std::mutex> gb(bl->mutex);
+    bl->blocksPerSource = std::max(bl->blocksPerSource, blocksPerSource);
+    bl->setSources(bl->sources + 1);
+    return bl;
+  }
+
+  bl = std::make_shared<DecodedSource::Blocks>();
+  bl->key = key;
+  bl->channels = info.channels;
+  bl->frames = info.frames;
+  bl->blocksPerSource = blocksPerSource;
+  bl->setSources(1);
+  sharedBlocksMap[key] = bl;
+  return bl;
+}
+
+//---------------------------------------------------------
+//   DecodedSource::State
+//    What one source has on its own: Its decoders, and
+//     the blocks it wants decoded ahead. The ahead range
+//     is guarded by the mutex of the shared blocks.
+//---------------------------------------------------------
+
+struct DecodedSource::State {
+      // A decoder and where it is in the file.
+      struct Cursor {
+            SNDFILE* sf;
+            sf_count_t pos;
+            };
+      enum { ReaderCursor = 0, AheadCursor = 1 };
+
+      std::string path;
+      int channels;
+      sf_count_t frames;
+      std::shared_ptr<Blocks> shared;
+
+      // The blocks wanted ahead of the reader, and whether a job is decoding them.
+      sf_count_t aheadFrom;
+      sf_count_t aheadTo;
+      bool aheadQueued;
+      std::atomic<bool> closed;
+
+      // Each cursor is only used by one thread at a time: The reader, or the one ahead job.
+      Cursor cursors[2];
+      std::vector<float> skipBuffer[2];
+
+      State() : channels(0), frames(0), aheadFrom(0), aheadTo(0), aheadQueued(false), closed(false)
+            {
+            for(int i = 0; i < 2; ++i)
+            {
+              cursors[i].sf = nullptr;
+              cursors[i].pos = 0;
+            }
+            }
+      ~State()
+            {
+            for(int i = 0; i < 2; ++i)
+              if(cursors[i].sf)
+                sf_close(cursors[i].sf);
+            if(shared)
+            {
+              std::lock_guard<std::mutex> g(shared->mutex);
+              shared->setSources(shared->sources - 1);
+            }
+            }
+
+      bool openCursor(int cursor);
+      bool decode(sf_count_t b, int cursor, std::vector<float>& data, sf_count_t& n);
+      void decodeAhead();
+      };
+
+//---------------------------------------------------------
+//   openCursor
+//---------------------------------------------------------
+
+bool DecodedSource::State::openCursor(int cursor)
+{
+  Cursor& cu = cursors[cursor];
+  if(cu.sf)
+    return true;
+  SF_INFO info;
+  memset(&info, 0, sizeof(info));
+  cu.sf = sf_open(path.c_str(), SFM_READ, &info);
+  if(!cu.sf)
+  {
+    ERROR_DECODED(stderr, "DecodedSource: cannot open %s: %s\n", path.c_str(), sf_strerror(nullptr));
+    return false;
+  }
+  cu.pos = 0;
+  return true;
+}
+
+//---------------------------------------------------------
+//   decode
+//    Decodes block b with the given cursor, without
+//     holding the mutex.
+//---------------------------------------------------------
+
+bool DecodedSource::State::decode(sf_count_t b, int cursor, std::vector<float>& data, sf_count_t& n)
+{
+  if(!openCursor(cursor))
+    return false;
+  Cursor& cu = cursors[cursor];
+
+  const sf_count_t start = b * BlockFrames;
+  if(cu.pos != start)
+  {
+    // Decoding on over a short gap is cheaper than seeking.
+    if(cu.pos < start && start - cu.pos <= BlockFrames)
+    {
+      std::vector<float>& skip = skipBuffer[cursor];
+      skip.resize(size_t(start - cu.pos) * channels);
+      cu.pos += sf_readf_float(cu.sf, skip.data(), start - cu.pos);
+    }
+    if(cu.pos != start)
+    {
+      DEBUG_DECODED(stderr, "DecodedSource: seeking %s from %ld to %ld\n", path.c_str(), long(cu.pos), long(start));
+      cu.pos = sf_seek(cu.sf, start, SEEK_SET);
+      if(cu.pos != start)
+      {
+        cu.pos = -1;
+        return false;
+      }
+    }
+  }
+
+  const sf_count_t want = std::min(sf_count_t(BlockFrames), frames - start);
+  data.resize(size_t(want) * channels);
+  n = want > 0 ? sf_readf_float(cu.sf, data.data(), want) : 0;
+  if(n < 0)
+    n = 0;
+  cu.pos = start + n;
+  return true;
+}
+
+//---------------------------------------------------------
+//   decodeAhead
+//    Decodes the blocks wanted ahead of the reader that
+//     are missing. Runs as a pool job.
+//---------------------------------------------------------
+
+void DecodedSource::State::decodeAhead()
+{
+  Blocks* bl = shared.get();
+  std::vector<float> data;
+  for(;;)
+  {
+    sf_count_t b = -1;
+    {
+      std::lock_guard<std::mutex> g(bl->mutex);
+      if(!closed.load())
+      {
+        for(sf_count_t i = aheadFrom; i <= aheadTo; ++i)
+          if(bl->blocks.find(i) == bl->blocks.end() && bl->pending.find(i) == bl->pending.end())
+          {
+            b = i;
+            break;
+          }
+      }
+      if(b < 0)
+      {
+        aheadQueued = false;
+        return;
+      }
+      bl->pending.insert(b);
+    }
+
+    sf_count_t n = 0;
+    const bool ok = decode(b, AheadCursor, data, n);
+
+    std::lock_guard<std::mutex> g(bl->mutex);
+    if(!ok)
+    {
+      bl->pending.erase(b);
+      aheadQueued = false;
+      bl->cond.notify_all();
+      return;
+    }
+    bl->insert(b, data, n);
+  }
+}
+
+//---------------------------------------------------------
+//   DecodedSource
+//---------------------------------------------------------
+
+DecodedSource::DecodedSource()
+{
+}
+
+DecodedSource::~DecodedSource()
+{
+  _state->closed.store(true);
+}
+
+//---------------------------------------------------------
+//   isCompressed
+//---------------------------------------------------------
+
+bool DecodedSource::isCompressed(int format)
+{
+  switch(format & SF_FORMAT_TYPEMASK)
+  {
+    case SF_FORMAT_FLAC:
+    // Vorbis and Opus.
+    case SF_FORMAT_OGG:
+      return true;
+    default:
+      return false;
+  }
+}
+
+//---------------------------------------------------------
+//   open
+//---------------------------------------------------------
+
+DecodedSource* DecodedSource::open(const char* path, const SF_INFO& info, size_t cacheBytes)
+{
+  if(info.channels <= 0 || info.frames <= 0 || !info.seekable)
+    return nullptr;
+
+  std::shared_ptr<State> st = std::make_shared<State>();
+  st->path = path;
+  st->channels = info.channels;
+  st->frames = info.frames;
+  // Room for the block being read, the ones ahead, and one behind.
+  const size_t blockBytes = size_t(BlockFrames) * info.channels * sizeof(float);
+  st->shared = sharedBlocks(path, info, std::max(cacheBytes / blockBytes, size_t(ReadAheadBlocks + 2)));
+  Blocks* bl = st->shared.get();
+
+  // Open the reader's decoder now, so a file which cannot be decoded is noticed here.
+  // The first block is decoded along with it, unless another source did that already.
+  bool haveFirst;
+  {
+    std::lock_guard<std::mutex> g(bl->mutex);
+    haveFirst = bl->blocks.find(0) != bl->blocks.end();
+  }
+  if(haveFirst)
+  {
+    if(!st->openCursor(State::ReaderCursor))
+      return nullptr;
+  }
+  else
+  {
+    std::vector<float> data;
+    sf_count_t n = 0;
+    if(!st->decode(0, State::ReaderCursor, data, n))
+      return nullptr;
+    std::lock_guard<std::mutex> g(bl->mutex);
+    bl->insert(0, data, n);
+  }
+
+  DecodedSource* ds = new DecodedSource();
+  ds->_state = st;
+  return ds;
+}
+
+int DecodedSource::channels() const
+{
+  return _state->channels;
+}
+
+sf_count_t DecodedSource::frames() const
+{
+  return _state->frames;
+}
+
+//---------------------------------------------------------
+//   read
+//---------------------------------------------------------
+
+size_t DecodedSource::read(sf_count_t pos, int dstChannels, float** dst, size_t n, bool overwrite)
+{
+  State* st = _state.get();
+  Blocks* bl = st->shared.get();
+  const int srcChannels = st->channels;
+  if(pos < 0 || pos >= st->frames)
+    return 0;
+  if(!(srcChannels == dstChannels || (dstChannels == 1 && srcChannels == 2) ||
+       (dstChannels == 2 && srcChannels == 1)))
+  {
+    ERROR_DECODED(stderr, "DecodedSource:read channel mismatch %d -> %d\n", dstChannels, srcChannels);
+    return 0;
+  }
+
+  std::vector<float> data;
+  size_t done = 0;
+  sf_count_t lastBlock = pos / BlockFrames;
+  std::unique_lock<std::mutex> g(bl->mutex);
+  while(done < n)
+  {
+    const sf_count_t p = pos + done;
+    const sf_count_t b = p / BlockFrames;
+    lastBlock = b;
+
+    auto it = bl->blocks.find(b);
+    if(it == bl->blocks.end())
+    {
+      if(bl->pending.find(b) != bl->pending.end())
+      {
+        // Being decoded already, ahead or by another source. Wait for it.
+        bl->cond.wait(g, [bl, b]() { return bl->pending.find(b) == bl->pending.end(); });
+        continue;
+      }
+      bl->pending.insert(b);
+      g.unlock();
+      sf_count_t got = 0;
+      const bool ok = st->decode(b, State::ReaderCursor, data, got);
+      g.lock();
+      if(!ok)
+      {
+        bl->pending.erase(b);
+        bl->cond.notify_all();
+        break;
+      }
+      bl->insert(b, data, got);
+      it = bl->blocks.find(b);
+    }
+
+    Blocks::Block& blk = it->second;
+    blk.used = ++bl->useCount;
+    const sf_count_t off = p - b * BlockFrames;
+    if(off >= blk.frames)
+      break;
+    const size_t m = std::min(size_t(blk.frames - off), n - done);
+    const float* src = blk.data.data() + off * srcChannels;
+
+    if(srcChannels == dstChannels)
+    {
+      for(int ch = 0; ch < dstChannels; ++ch)
+      {
+        float* d = dst[ch] + done;
+        const float* s = src + ch;
+        if(overwrite)
+          for(size_t i = 0; i < m; ++i, s += srcChannels)
+            d[i] = *s;
+        else
+          for(size_t i = 0; i < m; ++i, s += srcChannels)
+            d[i] += *s;
+      }
+    }
+    else if(dstChannels == 1)
+    {
+      // stereo to mono
+      float* d = dst[0] + done;
+      if(overwrite)
+        for(size_t i = 0; i < m; ++i)
+          d[i] = src[i + i] + src[i + i + 1];
+      else
+        for(size_t i = 0; i < m; ++i)
+          d[i] += src[i + i] + src[i + i + 1];
+    }
+    else
+    {
+      // mono to stereo
+      float* d0 = dst[0] + done;
+      float* d1 = dst[1] + done;
+      if(overwrite)
+        for(size_t i = 0; i < m; ++i)
+          d0[i] = d1[i] = src[i];
+      else
+        for(size_t i = 0; i < m; ++i)
+        {
+          d0[i] += src[i];
+          d1[i] += src[i];
+        }
+    }
+    done += m;
+  }
+
+  // Have the blocks after this one decoded in the background.
+  const sf_count_t lastInFile = (st->frames - 1) / BlockFrames;
+  st->aheadFrom = lastBlock + 1;
+  st->aheadTo = std::min(lastBlock + ReadAheadBlocks, lastInFile);
+  if(!st->aheadQueued && st->aheadFrom <= st->aheadTo)
+  {
+    bool missing = false;
+    for(sf_count_t i = st->aheadFrom; i <= st->aheadTo && !missing; ++i)
+      missing = bl->blocks.find(i) == bl->blocks.end() && bl->pending.find(i) == bl->pending.end();
+    if(missing)
+    {
+      st->aheadQueued = true;
+      std::shared_ptr<State> keep = _state;
+      decodePool().add([keep]() { keep->decodeAhead(); });
+    }
+  }
+  return done;
+}
+
+//---------------------------------------------------------
+//   setDecodeThreads
+//---------------------------------------------------------
+
+void DecodedSource::setDecodeThreads(int n)
+{
+  decodePool().setThreads(n);
+}
+
+} // namespace MusECore
@@ -0,0 +1,94 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  decoded_source.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __DECODED_SOURCE_H__
+#define __DECODED_SOURCE_H__
+
+#include <stddef.h>
+#include <memory>
+#include <sndfile.h>
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   DecodedSource
+//    Random access to the audio of a compressed (FLAC,
+//     Ogg Vorbis or Opus) file for the audio reads.
+//
+//    The file is decoded in blocks of BlockFrames frames,
+//     which are kept in memory up to a set size, least
+//     recently used first out. Whenever a block is read,
+//     the next ReadAheadBlocks blocks are decoded by a
+//     background thread, so playback normally finds its
+//     blocks already decoded.
+//
+//    The decoders keep their positions between blocks, so
+//     decoding on from where one left off costs no seek.
+//     Seeking the source itself only moves the read
+//     position. A read of a block nobody decoded yet
+//     decodes just that block, costing at most one decoder
+//     seek and one block, instead of libsndfile seeking
+//     on every loop jump.
+//
+//    Sources of the same file share their decoded blocks,
+//     so the events of cloned parts, or a clip used many
+//     times, decode each block once for all of them.
+//---------------------------------------------------------
+
+class DecodedSource {
+   public:
+      enum { BlockFrames = 32768, ReadAheadBlocks = 4 };
+      struct State;
+      struct Blocks;
+
+   private:
+      // Shared with the background decoding, which may outlive the source.
+      std::shared_ptr<State> _state;
+
+      DecodedSource();
+
+   public:
+      ~DecodedSource();
+      DecodedSource(const DecodedSource&) = delete;
+      DecodedSource& operator=(const DecodedSource&) = delete;
+
+      // Whether files of the given format are decoded this way.
+      static bool isCompressed(int format);
+      // Opens the file at path, which libsndfile opened with the given info. At most cacheBytes
+      //  of decoded audio are kept. Returns null if the file cannot be opened.
+      static DecodedSource* open(const char* path, const SF_INFO& info, size_t cacheBytes);
+
+      int channels() const;
+      sf_count_t frames() const;
+
+      // Reads up to n frames starting at frame pos into the dstChannels buffers of dst,
+      //  mixing channels like SndFile::read(). Returns the number of frames read.
+      size_t read(sf_count_t pos, int dstChannels, float** dst, size_t n, bool overwrite = true);
+
+      // Sets how many threads decode ahead, shared by all sources.
+      static void setDecodeThreads(int n);
+      };
+
+} // namespace MusECore
+
+#endif
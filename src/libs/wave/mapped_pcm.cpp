@@ -0,0 +1,548 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  mapped_pcm.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <stdio.h>
+#include <stdint.h>
+#include <algorithm>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "mapped_pcm.h"
+
+// For debugging output: Uncomment the fprintf section.
+#define ERROR_MAPPED_PCM(dev, format, args...) fprintf(dev, format, ##args)
+#define DEBUG_MAPPED_PCM(dev, format, args...) // fprintf(dev, format, ##args)
+
+namespace MusECore {
+
+// How far ahead of the frames being read the kernel is asked to read, in bytes.
+static const sf_count_t readAheadBytes = 1024 * 1024;
+
+//---------------------------------------------------------
+//   Header parsing
+//---------------------------------------------------------
+
+namespace {
+
+struct DataChunk {
+      uint64_t offset;
+      uint64_t bytes;
+      bool bigEndian;
+      // Bytes per frame given by the header, zero if it has none.
+      uint64_t frameBytes;
+      };
+
+inline uint16_t le16(const unsigned char* p) { return uint16_t(p[0] | (p[1] << 8)); }
+inline uint16_t be16(const unsigned char* p) { return uint16_t((p[0] << 8) | p[1]); }
+inline uint32_t le32(const unsigned char* p)
+      { return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24); }
+inline uint32_t be32(const unsigned char* p)
+      { return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]); }
+inline uint64_t le64(const unsigned char* p) { return uint64_t(le32(p)) | (uint64_t(le32(p + 4)) << 32); }
+inline uint64_t be64(const unsigned char* p) { return (uint64_t(be32(p)) << 32) | uint64_t(be32(p + 4)); }
+
+//---------------------------------------------------------
+//   parseWav
+//    RIFF, RIFX, RF64 and BW64
+//---------------------------------------------------------
+
+bool parseWav(const unsigned char* m, uint64_t len, DataChunk* dc)
+{
+  if(len < 12 || memcmp(m + 8, "WAVE", 4) != 0)
+    return false;
+  const bool rf64 = memcmp(m, "RF64", 4) == 0 || memcmp(m, "BW64", 4) == 0;
+  dc->bigEndian = memcmp(m, "RIFX", 4) == 0;
+  if(!rf64 && !dc->bigEndian && memcmp(m, "RIFF", 4) != 0)
+    return false;
+  dc->frameBytes = 0;
+  uint64_t ds64DataBytes = 0;
+  uint64_t pos = 12;
+  while(pos + 8 <= len)
+  {
+    const unsigned char* c = m + pos;
+    const uint64_t sz = dc->bigEndian ? be32(c + 4) : le32(c + 4);
+    if(memcmp(c, "ds64", 4) == 0 && pos + 8 + 16 <= len)
+      ds64DataBytes = le64(c + 8 + 8);
+    else if(memcmp(c, "fmt ", 4) == 0 && pos + 8 + 14 <= len)
+      dc->frameBytes = dc->bigEndian ? be16(c + 8 + 12) : le16(c + 8 + 12);
+    else if(memcmp(c, "data", 4) == 0)
+    {
+      dc->offset = pos + 8;
+      dc->bytes = (rf64 && sz == 0xffffffff) ? ds64DataBytes : sz;
+      return true;
+    }
+    pos += 8 + sz + (sz & 1);
+  }
+  return false;
+}
+
+//---------------------------------------------------------
+//   parseAiff
+//    AIFF and AIFC
+//---------------------------------------------------------
+
+bool parseAiff(const unsigned char* m, uint64_t len, DataChunk* dc)
+{
+  if(len < 12 || memcmp(m, "FORM", 4) != 0)
+    return false;
+  const bool aifc = memcmp(m + 8, "AIFC", 4) == 0;
+  if(!aifc && memcmp(m + 8, "AIFF", 4) != 0)
+    return false;
+  dc->bigEndian = true;
+  dc->frameBytes = 0;
+  uint64_t pos = 12;
+  while(pos + 8 <= len)
+  {
+    const unsigned char* c = m + pos;
+    const uint64_t sz = be32(c + 4);
+    if(aifc && memcmp(c, "COMM", 4) == 0 && pos + 8 + 22 <= len)
+    {
+      const unsigned char* comp = c + 8 + 18;
+      if(memcmp(comp, "sowt", 4) == 0)
+        dc->bigEndian = false;
+      else if(memcmp(comp, "NONE", 4) != 0 && memcmp(comp, "twos", 4) != 0 &&
+              memcmp(comp, "raw ", 4) != 0 && memcmp(comp, "in24", 4) != 0 &&
+              memcmp(comp, "in32", 4) != 0 && memcmp(comp, "fl32", 4) != 0 &&
+              memcmp(comp, "FL32", 4) != 0 && memcmp(comp, "fl64", 4) != 0 &&
+              memcmp(comp, "FL64", 4) != 0)
+        return false;
+    }
+    else if(memcmp(c, "SSND", 4) == 0 && pos + 16 <= len)
+    {
+      const uint64_t skip = be32(c + 8);
+      if(sz < 8 + skip)
+        return false;
+      dc->offset = pos + 16 + skip;
+      dc->bytes = sz - 8 - skip;
+      return true;
+    }
+    pos += 8 + sz + (sz & 1);
+  }
+  return false;
+}
+
+//---------------------------------------------------------
+//   parseW64
+//---------------------------------------------------------
+
+bool parseW64(const unsigned char* m, uint64_t len, DataChunk* dc)
+{
+  static const unsigned char riffGuid[16] =
+    { 'r', 'i', 'f', 'f', 0x2E, 0x91, 0xCF, 0x11, 0xA5, 0xD6, 0x28, 0xDB, 0x04, 0xC1, 0x00, 0x00 };
+  static const unsigned char waveGuid[16] =
+    { 'w', 'a', 'v', 'e', 0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A };
+  static const unsigned char fmtGuid[16] =
+    { 'f', 'm', 't', ' ', 0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A };
+  static const unsigned char dataGuid[16] =
+    { 'd', 'a', 't', 'a', 0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A };
+
+  if(len < 40 || memcmp(m, riffGuid, 16) != 0 || memcmp(m + 24, waveGuid, 16) != 0)
+    return false;
+  dc->bigEndian = false;
+  dc->frameBytes = 0;
+  uint64_t pos = 40;
+  while(pos + 24 <= len)
+  {
+    const unsigned char* c = m + pos;
+    // The size includes the chunk header.
+    const uint64_t sz = le64(c + 16);
+    if(sz < 24)
+      return false;
+    if(memcmp(c, fmtGuid, 16) == 0 && pos + 24 + 14 <= len)
+      dc->frameBytes = le16(c + 24 + 12);
+    else if(memcmp(c, dataGuid, 16) == 0)
+    {
+      dc->offset = pos + 24;
+      dc->bytes = sz - 24;
+      return true;
+    }
+    // Chunks are aligned to 8 bytes.
+    pos += (sz + 7) & ~uint64_t(7);
+  }
+  return false;
+}
+
+//---------------------------------------------------------
+//   parseCaf
+//---------------------------------------------------------
+
+bool parseCaf(const unsigned char* m, uint64_t len, DataChunk* dc)
+{
+  if(len < 8 || memcmp(m, "caff", 4) != 0)
+    return false;
+  dc->bigEndian = true;
+  dc->frameBytes = 0;
+  uint64_t pos = 8;
+  while(pos + 12 <= len)
+  {
+    const unsigned char* c = m + pos;
+    const int64_t sz = int64_t(be64(c + 4));
+    if(memcmp(c, "desc", 4) == 0 && pos + 12 + 32 <= len)
+    {
+      if(memcmp(c + 12 + 8, "lpcm", 4) != 0)
+        return false;
+      // kCAFLinearPCMFormatFlagIsLittleEndian
+      dc->bigEndian = !(be32(c + 12 + 12) & 2);
+      dc->frameBytes = be32(c + 12 + 16);
+    }
+    else if(memcmp(c, "data", 4) == 0)
+    {
+      // The data starts after the edit count. A size of -1 means up to the end of the file.
+      dc->offset = pos + 12 + 4;
+      if(sz == -1)
+        dc->bytes = len > dc->offset ? len - dc->offset : 0;
+      else if(sz < 4)
+        return false;
+      else
+        dc->bytes = sz - 4;
+      return true;
+    }
+    if(sz < 0)
+      return false;
+    pos += 12 + sz;
+  }
+  return false;
+}
+
+//---------------------------------------------------------
+//   Sample loaders
+//    Scale like libsndfile's normalized float reads.
+//---------------------------------------------------------
+
+template <bool BE> struct LoadU8  { static float get(const unsigned char* p)
+      { return float(int(p[0]) - 128) * (1.0f / 0x80); } };
+template <bool BE> struct LoadS8  { static float get(const unsigned char* p)
+      { return float(int8_t(p[0])) * (1.0f / 0x80); } };
+template <bool BE> struct LoadS16 { static float get(const unsigned char* p)
+      { return float(int16_t(BE ? be16(p) : le16(p))) * (1.0f / 0x8000); } };
+template <bool BE> struct LoadS24 { static float get(const unsigned char* p)
+      {
+        const uint32_t u = BE ? ((uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8)) :
+                                ((uint32_t(p[2]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[0]) << 8));
+        return float(int32_t(u)) * (1.0f / 0x80000000);
+      } };
+template <bool BE> struct LoadS32 { static float get(const unsigned char* p)
+      { return float(int32_t(BE ? be32(p) : le32(p))) * (1.0f / 0x80000000); } };
+template <bool BE> struct LoadF32 { static float get(const unsigned char* p)
+      {
+        const uint32_t u = BE ? be32(p) : le32(p);
+        float f;
+        memcpy(&f, &u, sizeof(f));
+        return f;
+      } };
+template <bool BE> struct LoadF64 { static float get(const unsigned char* p)
+      {
+        const uint64_t u = BE ? be64(p) : le64(p);
+        double d;
+        memcpy(&d, &u, sizeof(d));
+        return float(d);
+      } };
+
+template <class L> void convertStrided(const unsigned char* src, int stride, float* dst, size_t n, bool overwrite)
+{
+  if(overwrite)
+    for(size_t i = 0; i < n; ++i, src += stride)
+      dst[i] = L::get(src);
+  else
+    for(size_t i = 0; i < n; ++i, src += stride)
+      dst[i] += L::get(src);
+}
+
+template <template <bool> class L> void convertStrided(
+  bool bigEndian, const unsigned char* src, int stride, float* dst, size_t n, bool overwrite)
+{
+  if(bigEndian)
+    convertStrided<L<true> >(src, stride, dst, n, overwrite);
+  else
+    convertStrided<L<false> >(src, stride, dst, n, overwrite);
+}
+
+#if defined(__SSE2__)
+
+inline void store4(float* dst, __m128 v, bool overwrite)
+{
+  if(overwrite)
+    _mm_storeu_ps(dst, v);
+  else
+    _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), v));
+}
+
+// Eight 16 bit samples into two vectors of four floats.
+inline void load16x8(const unsigned char* src, bool bigEndian, __m128 scale, __m128* lo, __m128* hi)
+{
+  __m128i v = _mm_loadu_si128((const __m128i*)src);
+  if(bigEndian)
+    v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+  // Put each sample in the upper half of a 32 bit lane and shift it down, keeping the sign.
+  *lo = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), scale);
+  *hi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), scale);
+}
+
+// Eight 32 bit little endian floats into two vectors.
+inline void loadF32x8(const unsigned char* src, __m128* lo, __m128* hi)
+{
+  *lo = _mm_loadu_ps((const float*)src);
+  *hi = _mm_loadu_ps((const float*)src + 4);
+}
+
+#endif
+
+} // anonymous namespace
+
+//---------------------------------------------------------
+//   MappedPcmFile
+//---------------------------------------------------------
+
+MappedPcmFile::MappedPcmFile()
+      : _map(nullptr), _mapBytes(0), _data(nullptr), _type(S16), _bigEndian(false),
+        _channels(0), _sampleBytes(0), _frameBytes(0), _frames(0),
+        _advisedBegin(0), _advisedEnd(0)
+      {
+      }
+
+MappedPcmFile::~MappedPcmFile()
+      {
+      if(_map)
+        munmap(_map, _mapBytes);
+      }
+
+//---------------------------------------------------------
+//   open
+//---------------------------------------------------------
+
+MappedPcmFile* MappedPcmFile::open(const char* path, const SF_INFO& info)
+{
+  SampleType type;
+  int sampleBytes;
+  switch(info.format & SF_FORMAT_SUBMASK)
+  {
+    case SF_FORMAT_PCM_U8: type = U8;      sampleBytes = 1; break;
+    case SF_FORMAT_PCM_S8: type = S8;      sampleBytes = 1; break;
+    case SF_FORMAT_PCM_16: type = S16;     sampleBytes = 2; break;
+    case SF_FORMAT_PCM_24: type = S24;     sampleBytes = 3; break;
+    case SF_FORMAT_PCM_32: type = S32;     sampleBytes = 4; break;
+    case SF_FORMAT_FLOAT:  type = Float32; sampleBytes = 4; break;
+    case SF_FORMAT_DOUBLE: type = Float64; sampleBytes = 8; break;
+    default:
+      return nullptr;
+  }
+
+  const int major = info.format & SF_FORMAT_TYPEMASK;
+  if(major != SF_FORMAT_WAV && major != SF_FORMAT_WAVEX && major != SF_FORMAT_RF64 &&
+     major != SF_FORMAT_AIFF && major != SF_FORMAT_W64 && major != SF_FORMAT_CAF)
+    return nullptr;
+  if(info.channels <= 0 || info.frames <= 0)
+    return nullptr;
+
+  const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if(fd < 0)
+    return nullptr;
+  struct stat st;
+  if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 ||
+     uint64_t(st.st_size) > uint64_t(size_t(-1)))
+  {
+    ::close(fd);
+    return nullptr;
+  }
+  const size_t len = st.st_size;
+  void* map = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping keeps its own reference to the file.
+  ::close(fd);
+  if(map == MAP_FAILED)
+  {
+    DEBUG_MAPPED_PCM(stderr, "MappedPcmFile::open: mmap failed for %s\n", path);
+    return nullptr;
+  }
+
+  const unsigned char* m = (const unsigned char*)map;
+  DataChunk dc;
+  bool found = false;
+  switch(major)
+  {
+    case SF_FORMAT_WAV:
+    case SF_FORMAT_WAVEX:
+    case SF_FORMAT_RF64: found = parseWav(m, len, &dc);  break;
+    case SF_FORMAT_AIFF: found = parseAiff(m, len, &dc); break;
+    case SF_FORMAT_W64:  found = parseW64(m, len, &dc);  break;
+    case SF_FORMAT_CAF:  found = parseCaf(m, len, &dc);  break;
+  }
+
+  const uint64_t frameBytes = uint64_t(sampleBytes) * info.channels;
+  if(!found || dc.offset > len || (dc.frameBytes != 0 && dc.frameBytes != frameBytes) ||
+     // The data may be cut short, but not shorter than libsndfile says.
+     std::min<uint64_t>(dc.bytes, len - dc.offset) / frameBytes < uint64_t(info.frames))
+  {
+    DEBUG_MAPPED_PCM(stderr, "MappedPcmFile::open: Unsupported layout in %s\n", path);
+    munmap(map, len);
+    return nullptr;
+  }
+
+  MappedPcmFile* f = new MappedPcmFile();
+  f->_map = (unsigned char*)map;
+  f->_mapBytes = len;
+  f->_data = m + dc.offset;
+  f->_type = type;
+  // Single bytes have no order.
+  f->_bigEndian = sampleBytes > 1 && dc.bigEndian;
+  f->_channels = info.channels;
+  f->_sampleBytes = sampleBytes;
+  f->_frameBytes = frameBytes;
+  f->_frames = info.frames;
+  return f;
+}
+
+//---------------------------------------------------------
+//   advise
+//---------------------------------------------------------
+
+void MappedPcmFile::advise(sf_count_t pos, size_t n)
+{
+  const sf_count_t end = pos + n;
+  const sf_count_t ahead = readAheadBytes / _frameBytes;
+  // Still well inside the range asked for last time?
+  if(pos >= _advisedBegin && end + ahead / 2 <= _advisedEnd)
+    return;
+  const sf_count_t begin = (pos >= _advisedBegin && pos < _advisedEnd) ? _advisedEnd : pos;
+  _advisedBegin = pos;
+  _advisedEnd = std::min(end + ahead, _frames);
+  if(begin >= _advisedEnd)
+    return;
+
+  const long page = sysconf(_SC_PAGESIZE);
+  uintptr_t a = uintptr_t(_data + begin * _frameBytes);
+  const uintptr_t e = uintptr_t(_data + _advisedEnd * _frameBytes);
+  a &= ~uintptr_t(page - 1);
+  if(madvise((void*)a, e - a, MADV_WILLNEED) != 0)
+  {
+    DEBUG_MAPPED_PCM(stderr, "MappedPcmFile::advise: madvise failed\n");
+  }
+}
+
+//---------------------------------------------------------
+//   convert
+//---------------------------------------------------------
+
+void MappedPcmFile::convert(const unsigned char* src, float* dst, size_t n, bool overwrite) const
+{
+  switch(_type)
+  {
+    case U8:      convertStrided<LoadU8>(false, src, _frameBytes, dst, n, overwrite); break;
+    case S8:      convertStrided<LoadS8>(false, src, _frameBytes, dst, n, overwrite); break;
+    case S16:     convertStrided<LoadS16>(_bigEndian, src, _frameBytes, dst, n, overwrite); break;
+    case S24:     convertStrided<LoadS24>(_bigEndian, src, _frameBytes, dst, n, overwrite); break;
+    case S32:     convertStrided<LoadS32>(_bigEndian, src, _frameBytes, dst, n, overwrite); break;
+    case Float32: convertStrided<LoadF32>(_bigEndian, src, _frameBytes, dst, n, overwrite); break;
+    case Float64: convertStrided<LoadF64>(_bigEndian, src, _frameBytes, dst, n, overwrite); break;
+  }
+}
+
+//---------------------------------------------------------
+//   convertFrames
+//---------------------------------------------------------
+
+bool MappedPcmFile::convertFrames(const unsigned char* src, float** dst, size_t n, bool overwrite) const
+{
+#if defined(__SSE2__)
+  if(_channels > 2 || !(_type == S16 || (_type == Float32 && !_bigEndian)))
+    return false;
+
+  // Eight samples at a time.
+  const size_t step = 8 / _channels;
+  const size_t vn = n - n % step;
+  const __m128 scale = _mm_set1_ps(1.0f / 0x8000);
+  __m128 lo, hi;
+  for(size_t i = 0; i < vn; i += step, src += 8 * _sampleBytes)
+  {
+    if(_type == S16)
+      load16x8(src, _bigEndian, scale, &lo, &hi);
+    else
+      loadF32x8(src, &lo, &hi);
+    if(_channels == 1)
+    {
+      store4(dst[0] + i, lo, overwrite);
+      store4(dst[0] + i + 4, hi, overwrite);
+    }
+    else
+    {
+      // L0 R0 L1 R1, L2 R2 L3 R3
+      store4(dst[0] + i, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)), overwrite);
+      store4(dst[1] + i, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)), overwrite);
+    }
+  }
+  for(int ch = 0; ch < _channels; ++ch)
+    convert(src + ch * _sampleBytes, dst[ch] + vn, n - vn, overwrite);
+  return true;
+#else
+  (void)src; (void)dst; (void)n; (void)overwrite;
+  return false;
+#endif
+}
+
+//---------------------------------------------------------
+//   read
+//---------------------------------------------------------
+
+size_t MappedPcmFile::read(sf_count_t pos, int dstChannels, float** dst, size_t n, bool overwrite)
+{
+  if(pos < 0 || pos >= _frames)
+    return 0;
+  if(sf_count_t(n) > _frames - pos)
+    n = _frames - pos;
+  if(n == 0)
+    return 0;
+  advise(pos, n);
+
+  const unsigned char* src = _data + pos * _frameBytes;
+  if(dstChannels == _channels)
+  {
+    if(!convertFrames(src, dst, n, overwrite))
+      for(int ch = 0; ch < _channels; ++ch)
+        convert(src + ch * _sampleBytes, dst[ch], n, overwrite);
+  }
+  else if(dstChannels == 1 && _channels == 2)
+  {
+    // stereo to mono
+    convert(src, dst[0], n, overwrite);
+    convert(src + _sampleBytes, dst[0], n, false);
+  }
+  else if(dstChannels == 2 && _channels == 1)
+  {
+    // mono to stereo
+    convert(src, dst[0], n, overwrite);
+    convert(src, dst[1], n, overwrite);
+  }
+  else
+  {
+    ERROR_MAPPED_PCM(stderr, "MappedPcmFile::read channel mismatch %d -> %d\n", dstChannels, _channels);
+  }
+  return n;
+}
+
+} // namespace MusECore
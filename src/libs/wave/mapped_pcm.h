@@ -0,0 +1,100 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  mapped_pcm.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __MAPPED_PCM_H__
+#define __MAPPED_PCM_H__
+
+#include <stddef.h>
+#include <sndfile.h>
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   MappedPcmFile
+//    Read access to the sample data of an uncompressed
+//     WAV, RF64, AIFF, AIFC, W64 or CAF file through a
+//     read-only memory mapping of the whole file.
+//
+//    read() converts the samples straight from the mapping
+//     into the caller's channel buffers, the same way
+//     sf_readf_float() would scale them, without going through
+//     libsndfile's buffers or an interleaved float buffer.
+//
+//    The kernel is asked to read ahead of the frames being
+//     read, so the pages are usually in memory by the time
+//     they are converted.
+//
+//    The file must not shrink while it is mapped. MusE only
+//     ever opens wave files for writing without truncating.
+//---------------------------------------------------------
+
+class MappedPcmFile {
+   public:
+      enum SampleType { U8, S8, S16, S24, S32, Float32, Float64 };
+
+   private:
+      unsigned char* _map;
+      size_t _mapBytes;
+      // Start of the sample data within the mapping.
+      const unsigned char* _data;
+      SampleType _type;
+      bool _bigEndian;
+      int _channels;
+      // Bytes per sample and per frame.
+      int _sampleBytes;
+      int _frameBytes;
+      sf_count_t _frames;
+      // The range of frames the kernel was last asked to read ahead.
+      sf_count_t _advisedBegin;
+      sf_count_t _advisedEnd;
+
+      MappedPcmFile();
+      void advise(sf_count_t pos, size_t n);
+      // Converts n samples, frameBytes apart, into dst.
+      void convert(const unsigned char* src, float* dst, size_t n, bool overwrite) const;
+      // Converts whole frames into matching channel buffers with SIMD, where supported.
+      // Returns false if there is no such conversion for this format.
+      bool convertFrames(const unsigned char* src, float** dst, size_t n, bool overwrite) const;
+
+   public:
+      ~MappedPcmFile();
+      MappedPcmFile(const MappedPcmFile&) = delete;
+      MappedPcmFile& operator=(const MappedPcmFile&) = delete;
+
+      // Maps the file at path, which libsndfile opened with the given info.
+      // Returns null if the format cannot be read this way or the mapping fails.
+      static MappedPcmFile* open(const char* path, const SF_INFO& info);
+
+      int channels() const { return _channels; }
+      sf_count_t frames() const { return _frames; }
+      SampleType sampleType() const { return _type; }
+      bool bigEndian() const { return _bigEndian; }
+
+      // Reads up to n frames starting at frame pos into the dstChannels buffers of dst,
+      //  mixing channels like SndFile::read(). Returns the number of frames read.
+      size_t read(sf_count_t pos, int dstChannels, float** dst, size_t n, bool overwrite = true);
+      };
+
+} // namespace MusECore
+
+#endif
@@ -29,9 +29,14 @@
 #include "muse_math.h"
 #include <samplerate.h>
 
-#include <QProgressDialog>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
 
 #include "wave.h"
+#include "mapped_pcm.h"
+#include "decoded_source.h"
+#include "converted_copy.h"
 #include "type_defs.h"
 
 // For debugging output: Uncomment the fprintf section.
@@ -41,7 +46,7 @@
 
 namespace MusECore {
 
-const int cacheMag = 128;
+const int cacheMag = WaveOverview::BaseFrames;
 
 // static
 SndFileList* SndFile::_sndFiles = nullptr;
@@ -49,6 +54,10 @@ AudioConverterPluginList* SndFile::_pluginList = nullptr;
 AudioConverterSettingsGroup** SndFile::_defaultSettings = nullptr;
 int SndFile::_systemSampleRate = 0;
 int SndFile::_segSize = 0;
+bool SndFile::_useMappedRead = true;
+size_t SndFile::_decodeCacheBytes = 16 * 1024 * 1024;
+QString SndFile::_convertCacheDir;
+size_t SndFile::_convertCacheBytes = 0;
 
 // static
 void SndFile::initWaveModule(
@@ -56,13 +65,25 @@ void SndFile::initWaveModule(
   AudioConverterPluginList* pluginList, 
   AudioConverterSettingsGroup** defaultSettings,
   int systemSampleRate,
-  int segSize)
+  int segSize,
+  bool useMappedRead,
+  int overviewThreads,
+  int decodeCacheMB,
+  const QString& convertCacheDir,
+  int convertCacheMB,
+  int decodeThreads)
 {
   _sndFiles = sndFiles;
   _pluginList = pluginList;
   _defaultSettings = defaultSettings;
   _systemSampleRate = systemSampleRate;
   _segSize = segSize;
+  _useMappedRead = useMappedRead;
+  WaveOverview::setBuildThreads(overviewThreads);
+  _decodeCacheBytes = decodeCacheMB > 0 ? size_t(decodeCacheMB) * 1024 * 1024 : 0;
+  DecodedSource::setDecodeThreads(decodeThreads);
+  _convertCacheDir = convertCacheDir;
+  _convertCacheBytes = convertCacheMB > 0 ? size_t(convertCacheMB) * 1024 * 1024 : 0;
 }
 
 sf_count_t sndfile_vio_get_filelen(void *user_data)
@@ -170,8 +191,14 @@ SndFile::SndFile(
       finfo = new QFileInfo(name);
       sf    = nullptr;
       sfUI  = nullptr;
-      csize = 0;
-      cache = nullptr;
+      _overviewStale = false;
+      _mapped = nullptr;
+      _mappedPos = 0;
+      _mappedSfStale = false;
+      _decoded = nullptr;
+      _converted = nullptr;
+      _convertedPos = 0;
+      _convertedStale = false;
       openFlag = false;
       if(_sndFiles)
         _sndFiles->push_back(this);
@@ -207,8 +234,14 @@ SndFile::SndFile(
       finfo = nullptr;
       sf    = nullptr;
       sfUI  = nullptr;
-      csize = 0;
-      cache = nullptr;
+      _overviewStale = false;
+      _mapped = nullptr;
+      _mappedPos = 0;
+      _mappedSfStale = false;
+      _decoded = nullptr;
+      _converted = nullptr;
+      _convertedPos = 0;
+      _convertedStale = false;
       openFlag = false;
       //if(_sndFiles)
       //  _sndFiles->push_back(this);
@@ -239,8 +272,8 @@ SndFile::~SndFile()
       }
       if(finfo)
         delete finfo;
-      if (cache)
-        delete[] cache;
+      if (_overview)
+        _overview->cancel();
       if(writeBuffer)
          delete [] writeBuffer;
 
@@ -300,7 +333,10 @@ bool SndFile::setOffline(
       doResample,
       doStretch);
   }
+  // Switching the mode does not change what the converted copy holds.
+  const bool convertedStale = _convertedStale;
   setStaticAudioConverter(converter, AudioConverterSettings::RealtimeMode);
+  _convertedStale = convertedStale;
   return true;
 }
 
@@ -308,7 +344,7 @@ bool SndFile::setOffline(
 //   openRead
 //---------------------------------------------------------
 
-bool SndFile::openRead(bool createCache, bool showProgress)
+bool SndFile::openRead(bool createCache)
       {
       if (openFlag) {
             DEBUG_WAVE(stderr, "SndFile:: already open\n");
@@ -373,9 +409,19 @@ bool SndFile::openRead(bool createCache, bool showProgress)
       writeFlag = false;
       openFlag  = true;
 
+      // The graphics read through sfUI, so sf only has to follow the mapping for the audio reads.
+      if (finfo && sfUI) {
+            if (_useMappedRead)
+                  openMapped();
+            if (!_mapped && _decodeCacheBytes > 0)
+                  openDecoded();
+            }
+      if (finfo && _convertCacheBytes > 0)
+            openConvertedCopy();
+
       if (finfo && createCache) {
         QString cacheName = finfo->absolutePath() + QString("/") + finfo->completeBaseName() + QString(".wca");
-        readCache(cacheName, showProgress);
+        readCache(cacheName);
       }
       return false;
       }
@@ -494,6 +540,7 @@ void SndFile::setStaticAudioConverter(AudioConverterPluginI* converter, AudioCon
 
     case AudioConverterSettings::RealtimeMode:
       _staticAudioConverter = converter;
+      _convertedStale = true;
     break;
 
     case AudioConverterSettings::GuiMode:
@@ -571,6 +618,7 @@ double SndFile::maxPitchShiftRatio() const
 void SndFile::setAudioConverterSettings(AudioConverterSettingsGroup* settings)
 { 
   _audioConverterSettings = settings;
+  _convertedStale = true;
 }
 
 //---------------------------------------------------------
@@ -578,18 +626,24 @@ void SndFile::setAudioConverterSettings(AudioConverterSettingsGroup* settings)
 //    called after recording to file
 //---------------------------------------------------------
 
-void SndFile::update(bool showProgress)
+void SndFile::update()
       {
       if(!finfo)
         return;
 
+      // A recording grew the overview along with the file. Keep it instead of building it again.
+      const bool keepOverview = writeFlag && _overview && !_overviewStale && !_overview->isBuilding() &&
+                                _overview->appendedFrames() == sfinfo.frames;
       close();
 
-      // force recreation of wca data
       QString cacheName = finfo->absolutePath() +
          QString("/") + finfo->completeBaseName() + QString(".wca");
-      ::remove(cacheName.toLocal8Bit().constData());
-      if (openRead(true, showProgress)) {
+      if (keepOverview)
+            writeCache(cacheName);
+      else
+            // force recreation of wca data
+            ::remove(cacheName.toLocal8Bit().constData());
+      if (openRead(true)) {
             ERROR_WAVE(stderr, "SndFile::update openRead(%s) failed: %s\n", path().toLocal8Bit().constData(), strerror().toLocal8Bit().constData());
             }
       }
@@ -598,96 +652,37 @@ void SndFile::update(bool showProgress)
 //  create cache
 //---------------------------------------------------
 
-void SndFile::createCache(const QString& path, bool showProgress, bool bWrite, sf_count_t cstart)
+void SndFile::createCache(const QString& cachePath)
 {
-   if(!finfo || cstart >= csize)
+   if(!finfo)
       return;
-   QProgressDialog* progress = nullptr;
-   if (showProgress) {
-      QString label(QWidget::tr("Create peakfile for "));
-      label += basename();
-      progress = new QProgressDialog(label,
-                                     QString(), 0, csize, 0);
-      progress->setMinimumDuration(0);
-      progress->show();
-   }
-   
-   const int srcChannels = channels();
-   float data[srcChannels][cacheMag];
-   float* fp[srcChannels];
-   for (int k = 0; k < srcChannels; ++k)
-      fp[k] = &data[k][0];
-   int interval = (csize - cstart) / 10;
-
-   if(!interval)
-      interval = 1;
-   for (int i = cstart; i < csize; i++) {
-      if (showProgress && ((i % interval) == 0))
-         progress->setValue(i);
-      seek(i * cacheMag, 0);
-      read(srcChannels, fp, cacheMag);
-      for (int ch = 0; ch < srcChannels; ++ch) {
-         float rms = 0.0;
-         cache[ch][i].peak = 0;
-         for (int n = 0; n < cacheMag; n++) {
-            float fd = data[ch][n];
-            rms += fd * fd;
-            int idata = int(fd * 255.0);
-            if (idata < 0)
-               idata = -idata;
-            if (cache[ch][i].peak < idata)
-               cache[ch][i].peak = idata;
-         }
-         // amplify rms value +12dB
-         int rmsValue = int((sqrt(rms/cacheMag) * 255.0));
-         if (rmsValue > 255)
-            rmsValue = 255;
-         cache[ch][i].rms = rmsValue;
-      }
-   }
-   if (showProgress)
-      progress->setValue(csize);
-   if(bWrite)
-      writeCache(path);
-   if (showProgress)
-      delete progress;
-
+   if(!_overview)
+      _overview = std::make_shared<WaveOverview>(channels(), samples());
+   WaveOverview::build(_overview, path().toLocal8Bit().constData(), cachePath.toLocal8Bit().constData());
 }
 
 //---------------------------------------------------------
 //   readCache
 //---------------------------------------------------------
 
-void SndFile::readCache(const QString& path, bool showProgress)
+void SndFile::readCache(const QString& cachePath)
 {
    if(!finfo)
      return;
 
-   if (cache) {
-      delete[] cache;
+   if (_overview) {
+      _overview->cancel();
+      _overview.reset();
    }
+   _overviewStale = false;
    if (samples() == 0)
       return;
 
-   const int srcChannels = channels();
-   
-   csize = (samples() + cacheMag - 1)/cacheMag;
-   cache = new SampleVtype[srcChannels];
-   for (int ch = 0; ch < srcChannels; ++ch)
-   {
-      cache [ch].resize(csize);
-   }
-
-   FILE* cfile = fopen(path.toLocal8Bit().constData(), "r");
-   if (cfile) {
-      for (int ch = 0; ch < srcChannels; ++ch)
-         fread(&cache[ch] [0], csize * sizeof(SampleV), 1, cfile);
-      fclose(cfile);
+   _overview = std::make_shared<WaveOverview>(channels(), samples());
+   if (_overview->load(cachePath.toLocal8Bit().constData()))
       return;
-   }
-
 
-   createCache(path, showProgress, true);
+   createCache(cachePath);
 }
 
 //---------------------------------------------------------
@@ -696,16 +691,9 @@ void SndFile::readCache(const QString& path, bool showProgress)
 
 void SndFile::writeCache(const QString& path)
       {
-      if(!finfo)
+      if(!finfo || !_overview)
         return;
-
-      FILE* cfile = fopen(path.toLocal8Bit().constData(), "w");
-      if (cfile == 0)
-            return;
-      const int srcChannels = channels();
-      for (int ch = 0; ch < srcChannels; ++ch)
-            fwrite(&cache[ch] [0], csize * sizeof(SampleV), 1, cfile);
-      fclose(cfile);
+      _overview->save(path.toLocal8Bit().constData());
       }
 
 //---------------------------------------------------------
@@ -801,29 +789,8 @@ void SndFile::read(SampleV* s, int mag, unsigned pos, bool overwrite, bool allow
                     s[ch].rms = 0;    // TODO rms / mag;
                   }
             }
-      else {
-            mag /= cacheMag;
-            int rest = csize - (pos/cacheMag);
-            int end  = mag;
-            if (rest < mag)
-                  end = rest;
-
-            for (int ch = 0; ch < srcChannels; ++ch) {
-                  int rms = 0;
-                  int off = pos/cacheMag;
-                  for (int offset = off; offset < off+end; offset++) {
-                        rms += cache[ch][offset].rms;
-                        if (s[ch].peak < cache[ch][offset].peak)
-                              s[ch].peak = cache[ch][offset].peak;
-                              }
-
-                  if(overwrite)
-                    s[ch].rms = rms / mag;
-
-                  else
-                    s[ch].rms += rms / mag;
-                  }
-            }
+      else if (_overview)
+            _overview->read(s, mag, pos, overwrite);
       }
 
 //---------------------------------------------------------
@@ -898,29 +865,8 @@ void SndFile::readConverted(SampleV* s, int mag, sf_count_t pos, sf_count_t offs
                     s[ch].rms = 0;    // TODO rms / mag;
                   }
             }
-      else {
-            mag /= cacheMag;
-            sf_count_t rest = csize - ((offset + convertPosition(pos))/cacheMag);
-            sf_count_t end  = mag;
-            if (rest < mag)
-                  end = rest;
-
-            for (int ch = 0; ch < srcChannels; ++ch) {
-                  int rms = 0;
-                  sf_count_t off = (offset + convertPosition(pos))/cacheMag;
-                  for (sf_count_t offset = off; offset < off+end; offset++) {
-                        rms += cache[ch][offset].rms;
-                        if (s[ch].peak < cache[ch][offset].peak)
-                              s[ch].peak = cache[ch][offset].peak;
-                              }
-
-                  if(overwrite)
-                    s[ch].rms = rms / mag;
-
-                  else
-                    s[ch].rms += rms / mag;
-                  }
-            }
+      else if (_overview)
+            _overview->read(s, mag, offset + convertPosition(pos), overwrite);
       }
 
 //---------------------------------------------------------
@@ -961,7 +907,7 @@ bool SndFile::openWrite()
             {
               QString cacheName = finfo->absolutePath() +
                 QString("/") + finfo->completeBaseName() + QString(".wca");
-              readCache(cacheName, true);
+              readCache(cacheName);
             }
           }
       return !sf;
@@ -978,6 +924,11 @@ void SndFile::close()
             DEBUG_WAVE(stderr, "SndFile:: alread closed\n");
             return;
             }
+      closeMapped();
+      closeConvertedCopy();
+      // A build still running would write a .wca file, which may be outdated by then.
+      if (_overview)
+            _overview->cancel();
       if(int err = sf_close(sf))
       {
         err += 0; // Touch.
@@ -1224,6 +1175,8 @@ void SndFile::setFormat(int fmt, int ch, int rate, sf_count_t frames)
 //---------------------------------------------------------
 size_t SndFile::readWithHeap(int srcChannels, float** dst, size_t n, bool overwrite)
       {
+      if (_mapped || _decoded)
+            return read(srcChannels, dst, n, overwrite);
       float *buffer = new float[n * sfinfo.channels];
       int rn = readInternal(srcChannels,dst,n,overwrite, buffer);
       delete[] buffer;
@@ -1235,6 +1188,18 @@ size_t SndFile::readWithHeap(int srcChannels, float** dst, size_t n, bool overwr
 //---------------------------------------------------------
 size_t SndFile::read(int srcChannels, float** dst, size_t n, bool overwrite)
       {
+      if (_mapped) {
+            const size_t rn = _mapped->read(_mappedPos, srcChannels, dst, n, overwrite);
+            _mappedPos += rn;
+            _mappedSfStale = true;
+            return rn;
+            }
+      if (_decoded) {
+            const size_t rn = _decoded->read(_mappedPos, srcChannels, dst, n, overwrite);
+            _mappedPos += rn;
+            _mappedSfStale = true;
+            return rn;
+            }
       float buffer[n * sfinfo.channels];
       int rn = readInternal(srcChannels,dst,n,overwrite, buffer);
       return rn;
@@ -1291,15 +1256,278 @@ size_t SndFile::readInternal(int srcChannels, float** dst, size_t n, bool overwr
 
 }
 
+//---------------------------------------------------------
+//   readDirect
+//---------------------------------------------------------
+
+size_t SndFile::readDirect(float* buf, size_t n)
+      {
+      syncMapped();
+      const size_t rn = sf_readf_float(sf, buf, n);
+      if (_mapped || _decoded)
+            _mappedPos += rn;
+      return rn;
+      }
+
+//---------------------------------------------------------
+//   openMapped
+//---------------------------------------------------------
+
+void SndFile::openMapped()
+      {
+      closeMapped();
+      MappedPcmFile* m = MappedPcmFile::open(path().toLocal8Bit().constData(), sfinfo);
+      if (!m)
+            return;
+
+      // Make sure the mapping reads exactly what libsndfile reads, at the start and in the middle.
+      const int chans   = sfinfo.channels;
+      const size_t n    = std::min(sf_count_t(64), sfinfo.frames);
+      float check[n * chans];
+      float mapped[chans][n];
+      float* mp[chans];
+      for (int ch = 0; ch < chans; ++ch)
+            mp[ch] = mapped[ch];
+      bool ok = true;
+      const sf_count_t positions[2] = { 0, (sfinfo.frames - sf_count_t(n)) / 2 };
+      for (int k = 0; k < 2 && ok; ++k) {
+            if (sf_seek(sf, positions[k], SEEK_SET | SFM_READ) != positions[k] ||
+                sf_readf_float(sf, check, n) != sf_count_t(n) ||
+                m->read(positions[k], chans, mp, n) != n) {
+                  ok = false;
+                  break;
+                  }
+            for (size_t i = 0; i < n && ok; ++i)
+                  for (int ch = 0; ch < chans; ++ch)
+                        if (check[i * chans + ch] != mapped[ch][i]) {
+                              ok = false;
+                              break;
+                              }
+            }
+      sf_seek(sf, 0, SEEK_SET | SFM_READ);
+
+      if (!ok) {
+            ERROR_WAVE(stderr, "SndFile::openMapped: Mapped data differs from libsndfile in %s. Not using the mapping.\n",
+              path().toLocal8Bit().constData());
+            delete m;
+            return;
+            }
+      _mapped = m;
+      _mappedPos = 0;
+      _mappedSfStale = false;
+      }
+
+//---------------------------------------------------------
+//   openDecoded
+//---------------------------------------------------------
+
+void SndFile::openDecoded()
+      {
+      if (!DecodedSource::isCompressed(sfinfo.format))
+            return;
+      DecodedSource* d = DecodedSource::open(path().toLocal8Bit().constData(), sfinfo, _decodeCacheBytes);
+      if (!d) {
+            ERROR_WAVE(stderr, "SndFile::openDecoded: Cannot decode %s in blocks. Reading it directly.\n",
+              path().toLocal8Bit().constData());
+            return;
+            }
+      _decoded = d;
+      _mappedPos = 0;
+      _mappedSfStale = false;
+      }
+
+void SndFile::closeMapped()
+      {
+      if (_mapped) {
+            delete _mapped;
+            _mapped = nullptr;
+            }
+      if (_decoded) {
+            delete _decoded;
+            _decoded = nullptr;
+            }
+      _mappedPos = 0;
+      _mappedSfStale = false;
+      }
+
+//---------------------------------------------------------
+//   syncMapped
+//---------------------------------------------------------
+
+void SndFile::syncMapped()
+      {
+      if ((!_mapped && !_decoded) || !_mappedSfStale)
+            return;
+      sf_seek(sf, _mappedPos, SEEK_SET | SFM_READ);
+      _mappedSfStale = false;
+      }
+
+//---------------------------------------------------------
+//   convertedCopyKey
+//---------------------------------------------------------
+
+QString SndFile::convertedCopyKey() const
+      {
+      QFile file(path());
+      if (!file.open(QIODevice::ReadOnly))
+            return QString();
+      QCryptographicHash hash(QCryptographicHash::Sha1);
+      // Hashing the start and the end of the file along with its size and time
+      //  tells files apart without reading all of them.
+      const qint64 size = file.size();
+      const qint64 part = 65536;
+      hash.addData(file.read(part));
+      if (size > part) {
+            file.seek(std::max(part, size - part));
+            hash.addData(file.read(part));
+            }
+      hash.addData(QByteArray::number(size));
+      hash.addData(QByteArray::number(finfo->lastModified().toMSecsSinceEpoch()));
+      hash.addData(QByteArray::number(_systemSampleRate));
+
+      // All the settings which may choose the converter.
+      QString settings;
+      Xml xml(&settings);
+      if (_defaultSettings && *_defaultSettings)
+            (*_defaultSettings)->write(0, xml, _pluginList);
+      if (_audioConverterSettings && _audioConverterSettings->useSettings())
+            _audioConverterSettings->write(0, xml, _pluginList);
+      hash.addData(settings.toUtf8());
+      return QString::fromLatin1(hash.result().toHex());
+      }
+
+//---------------------------------------------------------
+//   openConvertedCopy
+//---------------------------------------------------------
+
+void SndFile::openConvertedCopy()
+      {
+      closeConvertedCopy();
+      if (!useConverter() || !sampleRateDiffers() || isStretched() || isResampled() || _convertCacheDir.isEmpty())
+            return;
+      const QString key = convertedCopyKey();
+      if (key.isEmpty())
+            return;
+      const QString copyPath = _convertCacheDir + QString("/") + key + QString(".w64");
+      if (QFileInfo::exists(copyPath)) {
+            ConvertedCopy::touch(copyPath.toLocal8Bit().constData());
+            _convertedPath = copyPath;
+            return;
+            }
+
+      // The copy is rendered with the offline settings, which favour quality over speed.
+      const bool isLocalSettings = _audioConverterSettings && _audioConverterSettings->useSettings();
+      AudioConverterPluginI* converter = setupAudioConverter(
+        isLocalSettings ? _audioConverterSettings : *_defaultSettings,
+        *_defaultSettings,
+        isLocalSettings,
+        AudioConverterSettings::OfflineMode,
+        false,
+        false);
+      if (!converter)
+            return;
+      if (!converter->isValid() || !(converter->capabilities() & AudioConverter::SampleRate)) {
+            delete converter;
+            return;
+            }
+      if (!QDir().mkpath(_convertCacheDir)) {
+            ERROR_WAVE(stderr, "SndFile::openConvertedCopy: Cannot create %s\n",
+              _convertCacheDir.toLocal8Bit().constData());
+            delete converter;
+            return;
+            }
+      _convertedCopy = ConvertedCopy::start(
+        path().toLocal8Bit().constData(), copyPath.toLocal8Bit().constData(),
+        sfinfo.channels, sampleRateRatio(), _systemSampleRate, samplesConverted(),
+        converter, _convertCacheBytes);
+      _convertedPath = copyPath;
+      }
+
+//---------------------------------------------------------
+//   adoptConvertedCopy
+//---------------------------------------------------------
+
+void SndFile::adoptConvertedCopy()
+      {
+      if (_convertedCopy) {
+            if (!_convertedCopy->isDone())
+                  return;
+            const bool ok = _convertedCopy->succeeded();
+            _convertedCopy.reset();
+            if (!ok) {
+                  _convertedPath.clear();
+                  return;
+                  }
+            }
+
+      const QByteArray p = _convertedPath.toLocal8Bit();
+      _convertedPath.clear();
+      SF_INFO info;
+      memset(&info, 0, sizeof(info));
+      SNDFILE* copy = sf_open(p.constData(), SFM_READ, &info);
+      if (!copy)
+            return;
+      MappedPcmFile* m = nullptr;
+      if (info.samplerate == _systemSampleRate && info.channels == sfinfo.channels)
+            m = MappedPcmFile::open(p.constData(), info);
+      sf_close(copy);
+      if (!m) {
+            ERROR_WAVE(stderr, "SndFile::adoptConvertedCopy: Cannot use %s. Converting while playing.\n", p.constData());
+            return;
+            }
+      _converted = m;
+      _convertedPos = 0;
+      }
+
+void SndFile::closeConvertedCopy()
+      {
+      // A render still running is of no use any more.
+      if (_convertedCopy) {
+            _convertedCopy->cancel();
+            _convertedCopy.reset();
+            }
+      _convertedPath.clear();
+      if (_converted) {
+            delete _converted;
+            _converted = nullptr;
+            }
+      _convertedPos = 0;
+      _convertedStale = false;
+      }
+
+//---------------------------------------------------------
+//   useConvertedCopy
+//---------------------------------------------------------
+
+bool SndFile::useConvertedCopy() const
+      {
+      return _converted && !_convertedStale && !isStretched() && !isResampled();
+      }
+
 sf_count_t SndFile::readConverted(sf_count_t pos, int srcChannels,
                                   float** buffer, sf_count_t frames, bool overwrite)
 {
+  if(useConvertedCopy())
+  {
+    const sf_count_t rn = _converted->read(_convertedPos, srcChannels, buffer, frames, overwrite);
+    _convertedPos += rn;
+    // Past the end, the converters deliver silence.
+    if(overwrite)
+      for(int ch = 0; ch < srcChannels; ++ch)
+        for(sf_count_t i = rn; i < frames; ++i)
+          buffer[ch][i] = 0.0f;
+    return frames;
+  }
   if(useConverter() && _staticAudioConverter && _staticAudioConverter->isValid() &&
      (((sampleRateDiffers() || isResampled()) && (_staticAudioConverter->capabilities() & AudioConverter::SampleRate)) ||
       (isStretched() && (_staticAudioConverter->capabilities() & AudioConverter::Stretch))) )
   {
-    return _staticAudioConverter->process(
+    syncMapped();
+    const sf_count_t rn = _staticAudioConverter->process(
       sf, channels(), sampleRateRatio(), stretchList(), pos, buffer, srcChannels, frames, overwrite);
+    if(_mapped || _decoded)
+      _mappedPos = sf_seek(sf, 0, SEEK_CUR | SFM_READ);
+    return rn;
   }
   return read(srcChannels, buffer, frames, overwrite);
 }
@@ -1335,6 +1563,23 @@ size_t SndFile::write(int srcChannels, float** src, size_t n, bool liveWaveUpdat
    return wrFrames;
 }
 
+//---------------------------------------------------------
+//   setWriteSegSize
+//---------------------------------------------------------
+
+void SndFile::setWriteSegSize(size_t frames)
+{
+   frames = std::max(frames, std::max((size_t)_segSize, (size_t)cacheMag));
+   if(frames == writeSegSize)
+      return;
+   writeSegSize = frames;
+   if(writeBuffer)
+   {
+      delete [] writeBuffer;
+      writeBuffer = new float [writeSegSize * std::max(2, sfinfo.channels)];
+   }
+}
+
 size_t SndFile::realWrite(int srcChannels, float** src, size_t n, size_t offs, bool liveWaveUpdate)
 {
    int dstChannels = sfinfo.channels;
@@ -1386,49 +1631,23 @@ size_t SndFile::realWrite(int srcChannels, float** src, size_t n, size_t offs, b
              srcChannels, dstChannels);
       return 0;
    }
+   // Only writes at the end of the file can grow the overview.
+   const sf_count_t wpos = (liveWaveUpdate && finfo) ? sf_seek(sf, 0, SEEK_CUR | SFM_WRITE) : -1;
    int nbr = sf_writef_float(sf, writeBuffer, n) ;
 
    if(liveWaveUpdate)
    { //update cache
-      if(!cache)
-      {
-         cache = new SampleVtype[sfinfo.channels];
-         csize = 0;
-      }
-      sf_count_t cstart = (sfinfo.frames + cacheMag - 1) / cacheMag;
-      sfinfo.frames += n;
-      csize = (sfinfo.frames + cacheMag - 1) / cacheMag;
-      for (int ch = 0; ch < sfinfo.channels; ++ch)
+      sfinfo.frames = wpos >= 0 ? std::max(sfinfo.frames, wpos + sf_count_t(n)) : sfinfo.frames + sf_count_t(n);
+      if(finfo)
       {
-         cache [ch].resize(csize);
+         if(!_overview && wpos == 0)
+            _overview = std::make_shared<WaveOverview>(dstChannels, 0);
+         if(!_overview || wpos != _overview->appendedFrames() || !_overview->append(writeBuffer, n))
+            _overviewStale = true;
       }
-
-      for (int i = cstart; i < csize; i++)
-      {
-         for (int ch = 0; ch < sfinfo.channels; ++ch)
-         {
-            float rms = 0.0;
-            cache[ch][i].peak = 0;
-            for (int n = 0; n < cacheMag; n++)
-            {
-               //float fd = data[ch][n];
-               float fd = writeBuffer [n * sfinfo.channels + ch];
-               rms += fd * fd;
-               int idata = int(fd * 255.0);
-               if (idata < 0)
-                  idata = -idata;
-               if (cache[ch][i].peak < idata)
-                  cache[ch][i].peak = idata;
-            }
-            // amplify rms value +12dB
-            int rmsValue = int((sqrt(rms/cacheMag) * 255.0));
-            if (rmsValue > 255)
-               rmsValue = 255;
-            cache[ch][i].rms = rmsValue;
-         }
-      }
-
    }
+   else
+      _overviewStale = true;
 
    return nbr;
 }
@@ -1439,7 +1658,20 @@ size_t SndFile::realWrite(int srcChannels, float** src, size_t n, size_t offs, b
 
 sf_count_t SndFile::seek(sf_count_t frames, int whence)
       {
-      return sf_seek(sf, frames, whence);
+      if ((whence & ~SFM_RDWR) != SEEK_SET)
+            syncMapped();
+      else if (_decoded) {
+            // Seeking a decoder is slow. Only do it if something reads from sf.
+            _mappedPos = std::max(sf_count_t(0), std::min(frames, sfinfo.frames));
+            _mappedSfStale = true;
+            return _mappedPos;
+            }
+      const sf_count_t rn = sf_seek(sf, frames, whence);
+      if ((_mapped || _decoded) && rn >= 0) {
+            _mappedPos = rn;
+            _mappedSfStale = false;
+            }
+      return rn;
       }
 
 sf_count_t SndFile::seekUI(sf_count_t frames, int whence)
@@ -1492,6 +1724,15 @@ sf_count_t SndFile::seekUIConverted(sf_count_t frames, int whence, sf_count_t of
 
 sf_count_t SndFile::seekConverted(sf_count_t frames, int whence, int offset)
       {
+      // Between seeks the converter's state runs on, so a finished copy is only taken into use here.
+      if (!_converted && !_convertedPath.isEmpty())
+            adoptConvertedCopy();
+      if (useConvertedCopy() && (whence & ~SFM_RDWR) == SEEK_SET) {
+            // The offset is in frames of the file.
+            sf_count_t pos = llrint(double(offset) / sampleRateRatio()) + frames;
+            _convertedPos = std::max(sf_count_t(0), std::min(pos, _converted->frames()));
+            return offset + convertPosition(frames);
+            }
       if(useConverter() && _staticAudioConverter && _staticAudioConverter->isValid() &&
          (((sampleRateDiffers() || isResampled()) && (_staticAudioConverter->capabilities() & AudioConverter::SampleRate)) ||
           (isStretched() && (_staticAudioConverter->capabilities() & AudioConverter::Stretch))) )
@@ -1506,7 +1747,14 @@ sf_count_t SndFile::seekConverted(sf_count_t frames, int whence, int offset)
         if(pos > smps)
           pos = smps;
 
+        if((whence & ~SFM_RDWR) != SEEK_SET)
+          syncMapped();
         const sf_count_t rn = sf_seek(sf, pos, whence);
+        if((_mapped || _decoded) && rn >= 0)
+        {
+          _mappedPos = rn;
+          _mappedSfStale = false;
+        }
         
         // Reset the converter. Its current state is meaningless now.
         _staticAudioConverter->reset();
@@ -1818,7 +2066,7 @@ void SndFileR::remove()           { if(sf) sf->remove();    }
 
 bool SndFileR::isOpen() const     { return sf ? sf->isOpen() : false; }
 bool SndFileR::isWritable() const { return sf ? sf->isWritable() : false; }
-void SndFileR::update(bool showProgress) { if(sf) sf->update(showProgress); }
+void SndFileR::update() { if(sf) sf->update(); }
 
 QString SndFileR::basename() const { return sf ? sf->basename() : QString(); }
 QString SndFileR::dirPath() const  { return sf ? sf->dirPath() : QString(); }
@@ -1852,6 +2100,7 @@ size_t SndFileR::readDirect(float* f, size_t n) { return sf ? sf->readDirect(f,
 size_t SndFileR::write(int channel, float** f, size_t n, bool liveWaveUpdate /*= false*/) {
       return sf ? sf->write(channel, f, n, liveWaveUpdate) : 0;
       }
+void SndFileR::setWriteSegSize(size_t frames) { if(sf) sf->setWriteSegSize(frames); }
 
 sf_count_t SndFileR::readConverted(sf_count_t pos, int channel,
                           float** buffer, sf_count_t frames, bool overwrite) {
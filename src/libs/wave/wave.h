@@ -38,6 +38,7 @@
 #include "time_stretch.h"
 #include "audio_convert/audio_converter_plugin.h"
 #include "audio_convert/audio_converter_settings_group.h"
+#include "wave_overview.h"
 
 namespace MusECore {
 
@@ -58,19 +59,10 @@ class SndFileVirtualData
       : _virtualData(virtualData), _virtualBytes(virtualBytes), _virtualCurPos(0) { }
 };
 
-//---------------------------------------------------------
-//   SampleV
-//    peak file value
-//---------------------------------------------------------
-
-struct SampleV {
-      unsigned char peak;
-      unsigned char rms;
-      };
-
-typedef std::vector<SampleV> SampleVtype;
-
 class SndFileList;
+class MappedPcmFile;
+class DecodedSource;
+class ConvertedCopy;
 
 //---------------------------------------------------------
 //   SndFile
@@ -93,12 +85,36 @@ class SndFile {
       bool _useConverter;
 
       SF_INFO sfinfo;
-      SampleVtype* cache;
-      sf_count_t csize;                    //!< frames in cache
+      // The peak file data drawn by the wave views.
+      std::shared_ptr<WaveOverview> _overview;
+      // Whether the file was written to in a way the overview did not follow.
+      bool _overviewStale;
 
       // For virtual (memory or stream) operation:
       SndFileVirtualData _virtualData;
 
+      // Memory mapped sample data of an uncompressed file opened for reading, if any.
+      // read() then reads from the mapping at _mappedPos, and sf is only
+      //  moved there when something else is going to read from it.
+      MappedPcmFile* _mapped;
+      sf_count_t _mappedPos;
+      // Whether sf is not at _mappedPos.
+      bool _mappedSfStale;
+      // Decoded audio of a compressed file opened for reading, if any. Read like the
+      //  mapping, at _mappedPos. Seeking to a position only sets _mappedPos.
+      DecodedSource* _decoded;
+
+      // Copy of the file converted to the system sample rate in the disk cache, used by
+      //  readConverted() instead of the realtime converter while it matches the file.
+      // _convertedPath is the copy to take into use at the next seekConverted(), once
+      //  _convertedCopy is done rendering it, if it is rendered at all.
+      std::shared_ptr<ConvertedCopy> _convertedCopy;
+      QString _convertedPath;
+      MappedPcmFile* _converted;
+      sf_count_t _convertedPos;
+      // Whether the converter settings changed since the copy was made.
+      bool _convertedStale;
+
       float *writeBuffer;
       size_t writeSegSize;
 
@@ -107,6 +123,21 @@ class SndFile {
       bool openFlag;
       bool writeFlag;
       size_t readInternal(int srcChannels, float** dst, size_t n, bool overwrite, float *buffer);
+      // Maps the file if its format allows, and checks the mapping against libsndfile.
+      void openMapped();
+      // Sets up block decoding if the file is compressed.
+      void openDecoded();
+      void closeMapped();
+      // Finds or starts rendering the converted copy, if the file needs converting.
+      void openConvertedCopy();
+      // Maps the converted copy once it is complete.
+      void adoptConvertedCopy();
+      void closeConvertedCopy();
+      bool useConvertedCopy() const;
+      // Hash of the file and the converter settings, naming its converted copy.
+      QString convertedCopyKey() const;
+      // Moves sf to the mapped read position.
+      void syncMapped();
       size_t realWrite(int srcChannels, float** src, size_t n, size_t offs = 0, bool liveWaveUpdate = false);
       
    protected:
@@ -133,13 +164,26 @@ class SndFile {
       static int _systemSampleRate;
       static int _segSize;
       static SndFileList* _sndFiles;
+      // Whether uncompressed files opened for reading are memory mapped.
+      static bool _useMappedRead;
+      // How much decoded audio of each compressed file opened for reading is kept. 0 = none.
+      static size_t _decodeCacheBytes;
+      // Where converted copies of files are kept, and how much of them. 0 = none.
+      static QString _convertCacheDir;
+      static size_t _convertCacheBytes;
 
       static void initWaveModule(
         SndFileList* sndFiles,
         AudioConverterPluginList* pluginList, 
         AudioConverterSettingsGroup** defaultSettings,
         int systemSampleRate,
-        int segSize);
+        int segSize,
+        bool useMappedRead = true,
+        int overviewThreads = 2,
+        int decodeCacheMB = 16,
+        const QString& convertCacheDir = QString(),
+        int convertCacheMB = 0,
+        int decodeThreads = 2);
 
       int getRefCount() const;
 
@@ -156,8 +200,12 @@ class SndFile {
       // For virtual (memory or stream) operation.
       SndFileVirtualData& virtualData() { return _virtualData; }
 
-      void createCache(const QString& path, bool showProgress, bool bWrite, sf_count_t cstart = 0);
-      void readCache(const QString& path, bool progress);
+      // Builds the overview in the background, and writes it to cachePath when done.
+      void createCache(const QString& cachePath);
+      // Loads the overview from cachePath, or builds it if there is none yet.
+      void readCache(const QString& cachePath);
+      // Bumped whenever a background build of any overview makes progress.
+      static unsigned overviewGeneration() { return WaveOverview::generation(); }
 
       // Creates a new converter based on the supplied settings and AudioConverterSettings::ModeType mode.
       // If isLocalSettings is true, settings is treated as a local settings which may override the 
@@ -174,7 +222,7 @@ class SndFile {
 
       // When using the virtual interface, be sure to call setFormat before opening.
       //!< returns true on error
-      bool openRead(bool createCache=true, bool showProgress=true);
+      bool openRead(bool createCache=true);
       //!< returns true on error
       bool openWrite();
       void close();
@@ -183,8 +231,14 @@ class SndFile {
       bool isOpen() const;
       // Whether the file was opened with write mode.
       bool isWritable() const;
+      // Whether reads come from a memory mapping of the file.
+      bool isMapped() const { return _mapped != nullptr; }
+      // Whether reads come from decoded blocks of a compressed file.
+      bool isDecoded() const { return _decoded != nullptr; }
+      // Whether realtime reads come from a copy converted ahead of time.
+      bool isConvertedCopy() const { return useConvertedCopy(); }
 
-      void update(bool showProgress = true);
+      void update();
 
       QString basename() const;     //!< filename without extension
       QString dirPath() const;      //!< path
@@ -224,9 +278,11 @@ class SndFile {
 
       size_t read(int channel, float**, size_t, bool overwrite = true);
       size_t readWithHeap(int channel, float**, size_t, bool overwrite = true);
-      size_t readDirect(float* buf, size_t n)    { return sf_readf_float(sf, buf, n); }
+      size_t readDirect(float* buf, size_t n);
       size_t write(int channel, float**, size_t, bool liveWaveUpdate /*= false*/);
       size_t writeDirect(float *buf, size_t n) { return sf_writef_float(sf, buf, n); }
+      // Sets how many frames write() hands to libsndfile at a time, at least the default.
+      void setWriteSegSize(size_t frames);
 
       // For now I must provide separate routines here, don't want to upset anything else.
       // Reads realtime audio converted if a samplerate or shift/stretch converter is active. Otherwise a normal read.
@@ -336,7 +392,7 @@ class SndFileR {
       bool isOpen() const;
       // Whether the file was opened with write mode.
       bool isWritable() const;
-      void update(bool showProgress = true);
+      void update();
 
       QString basename() const;
       QString dirPath() const;
@@ -378,6 +434,7 @@ class SndFileR {
       size_t readDirect(float* f, size_t n);
 
       size_t write(int channel, float** f, size_t n, bool liveWaveUpdate /*= false*/);
+      void setWriteSegSize(size_t frames);
 
       // For now I must provide separate routines here, don't want to upset anything else.
       // Reads realtime audio converted if a samplerate or shift/stretch converter is active. Otherwise a normal read.
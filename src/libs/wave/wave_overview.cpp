@@ -0,0 +1,502 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  wave_overview.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "wave_overview.h"
+#include "worker_pool.h"
+
+// For debugging output: Uncomment the fprintf section.
+#define ERROR_OVERVIEW(dev, format, args...) fprintf(dev, format, ##args)
+#define DEBUG_OVERVIEW(dev, format, args...)  // fprintf(dev, format, ##args)
+
+namespace MusECore {
+
+// Base values per build job. 2M frames with the default base.
+static const sf_count_t chunkEntries = 16384;
+// Base values read from the file in one go by a build job.
+static const sf_count_t pieceEntries = 64;
+
+std::atomic<unsigned> WaveOverview::_generation(0);
+
+//---------------------------------------------------------
+//   blockStats
+//    Peak and sum of squares of each channel over n
+//     interleaved frames.
+//---------------------------------------------------------
+
+static inline void blockStats(const float* src, int channels, size_t n, float* peak, float* squares)
+{
+#ifdef __SSE2__
+  if((channels == 1 || channels == 2) && (n & 3) == 0)
+  {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 pk = _mm_setzero_ps();
+    __m128 sq = _mm_setzero_ps();
+    const size_t count = n * channels;
+    for(size_t i = 0; i < count; i += 4)
+    {
+      const __m128 v = _mm_loadu_ps(src + i);
+      sq = _mm_add_ps(sq, _mm_mul_ps(v, v));
+      pk = _mm_max_ps(pk, _mm_and_ps(v, absMask));
+    }
+    float p[4], s[4];
+    _mm_storeu_ps(p, pk);
+    _mm_storeu_ps(s, sq);
+    // Mono has the same channel in all lanes, stereo alternates.
+    if(channels == 1)
+    {
+      peak[0] = std::max(std::max(p[0], p[1]), std::max(p[2], p[3]));
+      squares[0] = s[0] + s[1] + s[2] + s[3];
+    }
+    else
+    {
+      peak[0] = std::max(p[0], p[2]);
+      peak[1] = std::max(p[1], p[3]);
+      squares[0] = s[0] + s[2];
+      squares[1] = s[1] + s[3];
+    }
+    return;
+  }
+#endif
+
+  for(int ch = 0; ch < channels; ++ch)
+  {
+    float pk = 0.0f;
+    float sq = 0.0f;
+    const float* p = src + ch;
+    for(size_t i = 0; i < n; ++i, p += channels)
+    {
+      const float v = *p;
+      sq += v * v;
+      const float a = fabsf(v);
+      if(a > pk)
+        pk = a;
+    }
+    peak[ch] = pk;
+    squares[ch] = sq;
+  }
+}
+
+//---------------------------------------------------------
+//   makeEntry
+//---------------------------------------------------------
+
+static inline SampleV makeEntry(float peak, float squares)
+{
+  SampleV v;
+  const int p = int(peak * 255.0f);
+  v.peak = p > 255 ? 255 : p;
+  const int r = int(sqrtf(squares / WaveOverview::BaseFrames) * 255.0f);
+  v.rms = r > 255 ? 255 : r;
+  return v;
+}
+
+//---------------------------------------------------------
+//   overviewPool
+//    The threads building overviews, shared by all files.
+//---------------------------------------------------------
+
+static WorkerPool& overviewPool()
+{
+  static WorkerPool pool(2);
+  return pool;
+}
+
+//---------------------------------------------------------
+//   WaveOverview
+//---------------------------------------------------------
+
+WaveOverview::WaveOverview(int channels, sf_count_t frames)
+  : _channels(channels), _complete(0), _appendFrames(frames), _appendStarted(false),
+    _appendPeak(channels, 0.0f), _appendSquares(channels, 0.0f),
+    _cancelled(false), _chunksLeft(0)
+{
+  for(int l = 0; l < MaxLevels; ++l)
+    _levels[l].resize(channels);
+  for(int ch = 0; ch < channels; ++ch)
+    _levels[0][ch].resize(entriesFor(frames));
+}
+
+WaveOverview::~WaveOverview()
+{
+}
+
+//---------------------------------------------------------
+//   size
+//---------------------------------------------------------
+
+sf_count_t WaveOverview::size() const
+{
+  std::lock_guard<std::mutex> g(_lock);
+  return _channels > 0 ? sf_count_t(_levels[0][0].size()) : 0;
+}
+
+//---------------------------------------------------------
+//   load
+//---------------------------------------------------------
+
+bool WaveOverview::load(const char* wcaPath)
+{
+  FILE* f = fopen(wcaPath, "r");
+  if(!f)
+    return false;
+
+  std::lock_guard<std::mutex> g(_lock);
+  const sf_count_t n = _channels > 0 ? sf_count_t(_levels[0][0].size()) : 0;
+  bool ok = fseek(f, 0, SEEK_END) == 0 &&
+            ftell(f) == long(n * _channels * sizeof(SampleV)) &&
+            fseek(f, 0, SEEK_SET) == 0;
+  for(int ch = 0; ok && ch < _channels; ++ch)
+    ok = n == 0 || fread(_levels[0][ch].data(), n * sizeof(SampleV), 1, f) == 1;
+  fclose(f);
+
+  if(!ok)
+  {
+    DEBUG_OVERVIEW(stderr, "WaveOverview::load: %s does not fit, rebuilding\n", wcaPath);
+    return false;
+  }
+  _complete.store(n, std::memory_order_release);
+  return true;
+}
+
+//---------------------------------------------------------
+//   save
+//---------------------------------------------------------
+
+bool WaveOverview::save(const char* wcaPath) const
+{
+  FILE* f = fopen(wcaPath, "w");
+  if(!f)
+  {
+    ERROR_OVERVIEW(stderr, "WaveOverview::save: cannot write %s: %s\n", wcaPath, strerror(errno));
+    return false;
+  }
+  std::lock_guard<std::mutex> g(_lock);
+  bool ok = true;
+  for(int ch = 0; ok && ch < _channels; ++ch)
+    ok = _levels[0][ch].empty() ||
+         fwrite(_levels[0][ch].data(), _levels[0][ch].size() * sizeof(SampleV), 1, f) == 1;
+  fclose(f);
+  return ok;
+}
+
+//---------------------------------------------------------
+//   build
+//---------------------------------------------------------
+
+void WaveOverview::build(const std::shared_ptr<WaveOverview>& ov, const char* path, const char* wcaPath)
+{
+  const sf_count_t n = ov->size();
+  if(n == 0 || ov->isBuilding())
+    return;
+  ov->_path = path;
+  ov->_wcaPath = wcaPath;
+  ov->_cancelled.store(false);
+  const int chunks = int((n + chunkEntries - 1) / chunkEntries);
+  ov->_chunksLeft.store(chunks, std::memory_order_release);
+  for(int i = 0; i < chunks; ++i)
+  {
+    const sf_count_t first = i * chunkEntries;
+    const sf_count_t count = std::min(chunkEntries, n - first);
+    overviewPool().add([ov, first, count]() {
+      if(!ov->_cancelled.load(std::memory_order_relaxed))
+        ov->buildChunk(first, count);
+      ov->chunkDone();
+      });
+  }
+}
+
+//---------------------------------------------------------
+//   cancel
+//---------------------------------------------------------
+
+void WaveOverview::cancel()
+{
+  std::lock_guard<std::mutex> g(_buildLock);
+  _cancelled.store(true);
+}
+
+//---------------------------------------------------------
+//   buildChunk
+//---------------------------------------------------------
+
+void WaveOverview::buildChunk(sf_count_t first, sf_count_t n)
+{
+  SF_INFO info;
+  memset(&info, 0, sizeof(info));
+  SNDFILE* f = sf_open(_path.c_str(), SFM_READ, &info);
+  if(!f)
+  {
+    ERROR_OVERVIEW(stderr, "WaveOverview: cannot open %s: %s\n", _path.c_str(), sf_strerror(nullptr));
+    return;
+  }
+  if(info.channels != _channels || sf_seek(f, first * BaseFrames, SEEK_SET) < 0)
+  {
+    sf_close(f);
+    return;
+  }
+
+  std::vector<float> buffer(pieceEntries * BaseFrames * _channels);
+  SampleV* dst[_channels];
+  sf_count_t done = 0;
+  while(done < n && !_cancelled.load(std::memory_order_relaxed))
+  {
+    const sf_count_t want = std::min(pieceEntries, n - done) * BaseFrames;
+    const sf_count_t got = sf_readf_float(f, buffer.data(), want);
+    if(got <= 0)
+      break;
+    for(int ch = 0; ch < _channels; ++ch)
+      dst[ch] = _levels[0][ch].data() + first + done;
+    computeEntries(buffer.data(), _channels, got, dst);
+    done += entriesFor(got);
+    if(got < want)
+      break;
+  }
+  sf_close(f);
+}
+
+//---------------------------------------------------------
+//   chunkDone
+//---------------------------------------------------------
+
+void WaveOverview::chunkDone()
+{
+  _generation.fetch_add(1, std::memory_order_relaxed);
+  if(_chunksLeft.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    return;
+
+  std::lock_guard<std::mutex> g(_buildLock);
+  if(_cancelled.load())
+    return;
+  _complete.store(size(), std::memory_order_release);
+  if(!_wcaPath.empty())
+    save(_wcaPath.c_str());
+  DEBUG_OVERVIEW(stderr, "WaveOverview: built %s\n", _path.c_str());
+}
+
+//---------------------------------------------------------
+//   append
+//---------------------------------------------------------
+
+bool WaveOverview::append(const float* src, size_t n)
+{
+  if(isBuilding())
+    return false;
+
+  std::lock_guard<std::mutex> g(_lock);
+  float peak[_channels];
+  float squares[_channels];
+  size_t i = 0;
+  while(i < n)
+  {
+    const sf_count_t entry = _appendFrames / BaseFrames;
+    const size_t offset = _appendFrames % BaseFrames;
+    const size_t m = std::min(n - i, size_t(BaseFrames) - offset);
+
+    if(sf_count_t(_levels[0][0].size()) <= entry)
+    {
+      for(int ch = 0; ch < _channels; ++ch)
+        _levels[0][ch].resize(entry + 1);
+    }
+    if(offset == 0)
+    {
+      for(int ch = 0; ch < _channels; ++ch)
+        _appendPeak[ch] = _appendSquares[ch] = 0.0f;
+    }
+    else if(!_appendStarted)
+    {
+      // Continuing a value loaded or built before: Start from what it holds.
+      for(int ch = 0; ch < _channels; ++ch)
+      {
+        const SampleV& v = _levels[0][ch][entry];
+        _appendPeak[ch] = v.peak / 255.0f;
+        const float r = v.rms / 255.0f;
+        _appendSquares[ch] = r * r * BaseFrames;
+      }
+    }
+    _appendStarted = true;
+
+    // That value is changing, so nothing derived from it may stay.
+    if(_complete.load(std::memory_order_relaxed) > entry)
+    {
+      _complete.store(entry, std::memory_order_relaxed);
+      sf_count_t below = entry;
+      for(int l = 1; l < MaxLevels; ++l)
+      {
+        below /= LevelFactor;
+        for(int ch = 0; ch < _channels; ++ch)
+          if(sf_count_t(_levels[l][ch].size()) > below)
+            _levels[l][ch].resize(below);
+      }
+    }
+
+    blockStats(src + i * _channels, _channels, m, peak, squares);
+    for(int ch = 0; ch < _channels; ++ch)
+    {
+      _appendPeak[ch] = std::max(_appendPeak[ch], peak[ch]);
+      _appendSquares[ch] += squares[ch];
+      _levels[0][ch][entry] = makeEntry(_appendPeak[ch], _appendSquares[ch]);
+    }
+
+    _appendFrames += m;
+    i += m;
+    if(offset + m == size_t(BaseFrames))
+      _complete.store(entry + 1, std::memory_order_release);
+  }
+  return true;
+}
+
+//---------------------------------------------------------
+//   deriveLevels
+//---------------------------------------------------------
+
+void WaveOverview::deriveLevels(int level)
+{
+  if(_channels <= 0)
+    return;
+  for(int l = 1; l <= level && l < MaxLevels; ++l)
+  {
+    const sf_count_t below = l == 1 ?
+      std::min(_complete.load(std::memory_order_acquire), sf_count_t(_levels[0][0].size())) :
+      sf_count_t(_levels[l - 1][0].size());
+    const sf_count_t want = below / LevelFactor;
+    const sf_count_t have = _levels[l][0].size();
+    if(want <= have)
+      continue;
+    for(int ch = 0; ch < _channels; ++ch)
+    {
+      const std::vector<SampleV>& src = _levels[l - 1][ch];
+      std::vector<SampleV>& dst = _levels[l][ch];
+      dst.resize(want);
+      for(sf_count_t i = have; i < want; ++i)
+      {
+        int peak = 0;
+        int rms = 0;
+        for(int k = 0; k < LevelFactor; ++k)
+        {
+          const SampleV& v = src[i * LevelFactor + k];
+          if(v.peak > peak)
+            peak = v.peak;
+          rms += v.rms;
+        }
+        dst[i].peak = peak;
+        dst[i].rms = (rms + LevelFactor / 2) / LevelFactor;
+      }
+    }
+  }
+}
+
+//---------------------------------------------------------
+//   read
+//---------------------------------------------------------
+
+void WaveOverview::read(SampleV* s, int mag, sf_count_t pos, bool overwrite)
+{
+  const sf_count_t count = mag / BaseFrames;
+  if(count <= 0 || pos < 0)
+    return;
+
+  std::lock_guard<std::mutex> g(_lock);
+  if(_channels <= 0)
+    return;
+  const sf_count_t first = pos / BaseFrames;
+  const sf_count_t end = std::min(first + count, sf_count_t(_levels[0][0].size()));
+
+  // The coarsest level whose values fit into the range.
+  int top = 0;
+  for(sf_count_t u = LevelFactor; top + 1 < MaxLevels && u <= count; u *= LevelFactor)
+    ++top;
+  if(top > 0)
+    deriveLevels(top);
+
+  for(int ch = 0; ch < _channels; ++ch)
+  {
+    int peak = s[ch].peak;
+    long rms = 0;
+    int level = 0;
+    sf_count_t unit = 1;
+    // Climb up while aligned and the coarser value lies within the range, and back
+    //  down for the tail.
+    for(sf_count_t i = first; i < end; i += unit)
+    {
+      while(level < top && i % (unit * LevelFactor) == 0 && i + unit * LevelFactor <= end &&
+            i / (unit * LevelFactor) < sf_count_t(_levels[level + 1][ch].size()))
+      {
+        ++level;
+        unit *= LevelFactor;
+      }
+      while(level > 0 && (i + unit > end || i / unit >= sf_count_t(_levels[level][ch].size())))
+      {
+        --level;
+        unit /= LevelFactor;
+      }
+      const SampleV& v = _levels[level][ch][i / unit];
+      if(v.peak > peak)
+        peak = v.peak;
+      rms += long(v.rms) * unit;
+    }
+
+    s[ch].peak = peak;
+    if(overwrite)
+      s[ch].rms = rms / count;
+    else
+      s[ch].rms += rms / count;
+  }
+}
+
+//---------------------------------------------------------
+//   computeEntries
+//---------------------------------------------------------
+
+void WaveOverview::computeEntries(const float* src, int channels, size_t n, SampleV* const* dst)
+{
+  float peak[channels];
+  float squares[channels];
+  for(size_t i = 0, e = 0; i < n; i += BaseFrames, ++e)
+  {
+    blockStats(src + i * channels, channels, std::min(n - i, size_t(BaseFrames)), peak, squares);
+    for(int ch = 0; ch < channels; ++ch)
+      dst[ch][e] = makeEntry(peak[ch], squares[ch]);
+  }
+}
+
+//---------------------------------------------------------
+//   setBuildThreads
+//---------------------------------------------------------
+
+void WaveOverview::setBuildThreads(int n)
+{
+  overviewPool().setThreads(n);
+}
+
+} // namespace MusECore
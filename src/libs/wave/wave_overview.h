@@ -0,0 +1,152 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  wave_overview.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __WAVE_OVERVIEW_H__
+#define __WAVE_OVERVIEW_H__
+
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sndfile.h>
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   SampleV
+//    peak file value
+//---------------------------------------------------------
+
+struct SampleV {
+      unsigned char peak;
+      unsigned char rms;
+      };
+
+//---------------------------------------------------------
+//   WaveOverview
+//    The peak and rms overview of a sound file, as drawn
+//     by the wave views.
+//
+//    The base level holds one value per BaseFrames frames
+//     and is what the .wca file stores. Each further level
+//     sums up LevelFactor values of the one below. They
+//     are derived from the base the first time a view is
+//     zoomed out far enough to use them, and are never
+//     written to disk.
+//
+//    Missing overviews are built in the background by a
+//     pool of threads, each reading its own chunks of the
+//     file through its own libsndfile handle. The values
+//     are zero until their chunk is done. Every finished
+//     chunk bumps generation(), which the GUI polls to
+//     redraw.
+//
+//    While recording, the written frames are appended so
+//     the overview grows along with the file.
+//---------------------------------------------------------
+
+class WaveOverview {
+   public:
+      enum { BaseFrames = 128, LevelFactor = 4, MaxLevels = 8 };
+
+   private:
+      int _channels;
+      // _levels[level][channel].
+      std::vector<std::vector<SampleV> > _levels[MaxLevels];
+      // The number of leading base values which are final. Levels are only derived from those.
+      std::atomic<sf_count_t> _complete;
+      // Guards the sizes of the levels against concurrent reads, appends and derivation.
+      // The build threads only write into base values which already exist.
+      mutable std::mutex _lock;
+      // Keeps cancel() from passing a build which is writing its .wca file.
+      std::mutex _buildLock;
+
+      // Appending: Frames so far, whether anything was appended yet, and the sums
+      //  of the base value being filled.
+      sf_count_t _appendFrames;
+      bool _appendStarted;
+      std::vector<float> _appendPeak;
+      std::vector<float> _appendSquares;
+
+      // Background build.
+      std::string _path;
+      std::string _wcaPath;
+      std::atomic<bool> _cancelled;
+      std::atomic<int> _chunksLeft;
+
+      static std::atomic<unsigned> _generation;
+
+      // Derives the levels up to level from the complete base values. Lock must be held.
+      void deriveLevels(int level);
+      // Builds the base values [first, first + n) from the file. Build threads.
+      void buildChunk(sf_count_t first, sf_count_t n);
+      void chunkDone();
+
+   public:
+      WaveOverview(int channels, sf_count_t frames);
+      ~WaveOverview();
+      WaveOverview(const WaveOverview&) = delete;
+      WaveOverview& operator=(const WaveOverview&) = delete;
+
+      int channels() const { return _channels; }
+      // Number of base values.
+      sf_count_t size() const;
+      static sf_count_t entriesFor(sf_count_t frames) { return (frames + BaseFrames - 1) / BaseFrames; }
+
+      // Loads the base from a .wca file. Returns false if there is none or it does not fit.
+      bool load(const char* wcaPath);
+      // Writes the base to a .wca file.
+      bool save(const char* wcaPath) const;
+
+      // Builds the overview of the sound file at path in the background, and writes it
+      //  to wcaPath when done, unless cancelled before.
+      static void build(const std::shared_ptr<WaveOverview>& ov, const char* path, const char* wcaPath);
+      // Stops a background build. The values built so far stay.
+      void cancel();
+      bool isBuilding() const { return _chunksLeft.load(std::memory_order_acquire) > 0; }
+
+      // Appends n interleaved frames of all channels, written to the end of the file.
+      // Returns false if a build is running, which the overview cannot grow under.
+      bool append(const float* src, size_t n);
+      sf_count_t appendedFrames() const { return _appendFrames; }
+
+      // Reads the peak and rms values of mag frames at frame pos, mag at least BaseFrames,
+      //  into s, one per channel. Uses the coarsest levels the range allows, deriving them
+      //  first if needed.
+      void read(SampleV* s, int mag, sf_count_t pos, bool overwrite);
+
+      // Computes the base values of n interleaved frames of the given channels into dst,
+      //  one array per channel. The last value may cover fewer than BaseFrames frames.
+      static void computeEntries(const float* src, int channels, size_t n, SampleV* const* dst);
+
+      // Bumped whenever a build makes progress. Any thread.
+      static unsigned generation() { return _generation.load(std::memory_order_relaxed); }
+      // Sets how many threads build overviews. Call before the first build.
+      static void setBuildThreads(int n);
+      };
+
+} // namespace MusECore
+
+#endif
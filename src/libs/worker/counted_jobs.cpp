@@ -0,0 +1,116 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  counted_jobs.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <chrono>
+
+#include "counted_jobs.h"
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   CountedJobs
+//---------------------------------------------------------
+
+CountedJobs::CountedJobs(int threads)
+  : _total(0), _done(0), _pool(threads)
+{
+}
+
+CountedJobs::~CountedJobs()
+{
+  wait();
+}
+
+//---------------------------------------------------------
+//   add
+//   addSeries
+//   addOwn
+//   jobDone
+//---------------------------------------------------------
+
+void CountedJobs::add(std::function<void()> job)
+{
+  addOwn(1);
+  _pool.add([this, job]() { job(); jobDone(); });
+}
+
+void CountedJobs::addSeries(std::vector<std::function<void()> > jobs)
+{
+  addOwn(jobs.size());
+  _pool.add([this, jobs]() {
+    for(const std::function<void()>& job : jobs)
+    {
+      job();
+      jobDone();
+    }
+    });
+}
+
+void CountedJobs::addOwn(int n)
+{
+  std::lock_guard<std::mutex> g(_mutex);
+  _total += n;
+}
+
+void CountedJobs::jobDone()
+{
+  {
+    std::lock_guard<std::mutex> g(_mutex);
+    ++_done;
+  }
+  _cond.notify_all();
+}
+
+//---------------------------------------------------------
+//   progress
+//---------------------------------------------------------
+
+void CountedJobs::progress(int* done, int* total) const
+{
+  std::lock_guard<std::mutex> g(_mutex);
+  *done = _done;
+  *total = _total;
+}
+
+//---------------------------------------------------------
+//   wait
+//---------------------------------------------------------
+
+void CountedJobs::wait(const std::function<void(int done, int total)>& progress)
+{
+  std::unique_lock<std::mutex> g(_mutex);
+  while(_done < _total)
+  {
+    _cond.wait_for(g, std::chrono::milliseconds(100));
+    if(progress)
+    {
+      const int done = _done;
+      const int total = _total;
+      g.unlock();
+      progress(done, total);
+      g.lock();
+    }
+  }
+}
+
+} // namespace MusECore
@@ -0,0 +1,77 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  counted_jobs.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __COUNTED_JOBS_H__
+#define __COUNTED_JOBS_H__
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "worker_pool.h"
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   CountedJobs
+//    Runs jobs on a WorkerPool of its own and counts
+//     them, so the thread which adds them can wait until
+//     all are done and show how far they got. Jobs the
+//     adding thread runs itself can be counted, too.
+//
+//    The destructor waits for the jobs not done yet.
+//     Declared after what the jobs use, it goes first.
+//---------------------------------------------------------
+
+class CountedJobs {
+      mutable std::mutex _mutex;
+      std::condition_variable _cond;
+      int _total;
+      int _done;
+      // Destroyed first, which joins its threads before the counts go.
+      WorkerPool _pool;
+
+   public:
+      CountedJobs(int threads);
+      ~CountedJobs();
+      CountedJobs(const CountedJobs&) = delete;
+      CountedJobs& operator=(const CountedJobs&) = delete;
+
+      // Runs the job on one of the threads.
+      void add(std::function<void()> job);
+      // Runs the jobs one after the other on the same thread, each counted.
+      void addSeries(std::vector<std::function<void()> > jobs);
+      // Counts n jobs the caller runs itself. It calls jobDone() after each.
+      void addOwn(int n);
+      void jobDone();
+      // The jobs done and the jobs added, so far.
+      void progress(int* done, int* total) const;
+      // Waits until all jobs are done. progress, if given, is called on the
+      //  calling thread now and then, with the jobs done and the jobs added.
+      void wait(const std::function<void(int done, int total)>& progress = nullptr);
+      };
+
+} // namespace MusECore
+
+#endif
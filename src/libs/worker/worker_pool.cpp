@@ -0,0 +1,96 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  worker_pool.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <algorithm>
+
+#include "worker_pool.h"
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   WorkerPool
+//---------------------------------------------------------
+
+WorkerPool::WorkerPool(int maxThreads)
+  : _maxThreads(std::max(1, maxThreads)), _quit(false)
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> g(_mutex);
+    _quit = true;
+  }
+  _cond.notify_all();
+  for(std::thread& t : _threads)
+    t.join();
+}
+
+//---------------------------------------------------------
+//   setThreads
+//---------------------------------------------------------
+
+void WorkerPool::setThreads(int n)
+{
+  std::lock_guard<std::mutex> g(_mutex);
+  _maxThreads = std::max(1, n);
+}
+
+//---------------------------------------------------------
+//   add
+//---------------------------------------------------------
+
+void WorkerPool::add(std::function<void()> job)
+{
+  {
+    std::lock_guard<std::mutex> g(_mutex);
+    _jobs.push_back(std::move(job));
+    if(int(_threads.size()) < _maxThreads)
+      _threads.emplace_back(&WorkerPool::run, this);
+  }
+  _cond.notify_one();
+}
+
+//---------------------------------------------------------
+//   run
+//---------------------------------------------------------
+
+void WorkerPool::run()
+{
+  for(;;)
+  {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> g(_mutex);
+      _cond.wait(g, [this]() { return _quit || !_jobs.empty(); });
+      if(_quit)
+        return;
+      job = std::move(_jobs.front());
+      _jobs.pop_front();
+    }
+    job();
+  }
+}
+
+} // namespace MusECore
@@ -0,0 +1,67 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  worker_pool.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __WORKER_POOL_H__
+#define __WORKER_POOL_H__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   WorkerPool
+//    Background threads running jobs in the order they
+//     were added. The threads are started as jobs come
+//     in, up to the set number, and are joined when the
+//     pool is destroyed. Jobs not started by then are
+//     dropped, see CountedJobs for waiting for them.
+//---------------------------------------------------------
+
+class WorkerPool {
+      std::mutex _mutex;
+      std::condition_variable _cond;
+      std::deque<std::function<void()> > _jobs;
+      std::vector<std::thread> _threads;
+      int _maxThreads;
+      bool _quit;
+
+      void run();
+
+   public:
+      WorkerPool(int maxThreads = 1);
+      ~WorkerPool();
+      WorkerPool(const WorkerPool&) = delete;
+      WorkerPool& operator=(const WorkerPool&) = delete;
+
+      void setThreads(int n);
+      void add(std::function<void()> job);
+      };
+
+} // namespace MusECore
+
+#endif
@@ -121,6 +121,7 @@
 #include "part.h"
 //#include "synth.h"
 #include "undo.h"
+#include "track_freeze.h"
 #include "appearance.h"
 #include "arranger.h"
 #include "arrangerview.h"
@@ -146,6 +147,7 @@
 #include "cpu_toolbar.h"
 #include "musemdiarea.h"
 #include "snooper.h"
+#include "dsp_profiler_dialog.h"
 #include "xml.h"
 #ifdef BUILD_EXPERIMENTAL
   #include "rhythm.h"
@@ -497,6 +499,7 @@ MusE::MusE() : QMainWindow()
       shortcutConfig        = nullptr;
       appearance            = nullptr;
       _snooperDialog        = nullptr;
+      _dspProfilerDialog    = nullptr;
       //audioMixer            = 0;
       mixer1                = nullptr;
       mixer2                = nullptr;
@@ -794,6 +797,8 @@ MusE::MusE() : QMainWindow()
 
       viewMarkerAction = markerDock->toggleViewAction();
       viewCliplistAction = clipListDock->toggleViewAction();
+      viewDspProfilerAction = new QAction(tr("DSP Profiler..."), this);
+      viewDspProfilerAction->setStatusTip(tr("Show the time each track and plugin spends processing."));
 
       toggleDocksAction = new QAction(tr("Show Docks"), this);
       toggleDocksAction->setCheckable(true);
@@ -971,6 +976,7 @@ MusE::MusE() : QMainWindow()
       connect(helpDidYouKnow, SIGNAL(triggered()), SLOT(showDidYouKnowDialog()));
       connect(helpAboutAction, SIGNAL(triggered()), SLOT(about()));
       connect(helpSnooperAction, &QAction::triggered, [this]() { startSnooper(); } );
+      connect(viewDspProfilerAction, &QAction::triggered, [this]() { startDspProfiler(); } );
 
       //--------------------------------------------------
       //    Toolbar
@@ -1129,6 +1135,7 @@ MusE::MusE() : QMainWindow()
       menuView->addAction(masterListAction);
       menuView->addAction(viewMarkerAction);
       menuView->addAction(viewCliplistAction);
+      menuView->addAction(viewDspProfilerAction);
       menuView->addSeparator();
       menuView->addAction(toggleDocksAction);
       menuView->addAction(fullscreenAction);
@@ -3954,6 +3961,11 @@ void MusE::deleteParentlessDialogs()
     delete _snooperDialog;
     _snooperDialog = nullptr;
   }
+  if(_dspProfilerDialog)
+  {
+    delete _dspProfilerDialog;
+    _dspProfilerDialog = nullptr;
+  }
   if(metronomeConfig)
   {
     delete metronomeConfig;
@@ -4062,6 +4074,23 @@ void MusE::startSnooper()
           _snooperDialog->show();
       }
 
+//---------------------------------------------------------
+//   startDspProfiler
+//---------------------------------------------------------
+
+void MusE::startDspProfiler()
+      {
+      if (!_dspProfilerDialog)
+            // NOTE: For deleting parentless dialogs and widgets, please add them to MusE::deleteParentlessDialogs().
+            _dspProfilerDialog = new MusEGui::DspProfilerDialog();
+      if(_dspProfilerDialog->isVisible()) {
+          _dspProfilerDialog->raise();
+          _dspProfilerDialog->activateWindow();
+          }
+      else
+          _dspProfilerDialog->show();
+      }
+
 //---------------------------------------------------------
 //   changeConfig
 //    - called whenever configuration has changed
@@ -4326,6 +4355,78 @@ void MusE::bounceToFile(MusECore::AudioOutput* ao)
     MusEGlobal::song->setPlay(true);
 }
 
+//---------------------------------------------------------
+//   freezeTrack
+//    Renders the track's source and effects rack output
+//    over the whole song. See TrackFreeze.
+//---------------------------------------------------------
+
+void MusE::freezeTrack(MusECore::Track* t)
+{
+    if(MusEGlobal::audio->bounce() || MusEGlobal::audio->isRecording() || MusEGlobal::song->freezeRender)
+        return;
+
+    MusECore::AudioTrack* track = MusECore::TrackFreeze::freezableTrack(t);
+    if(!track)
+    {
+        QMessageBox::critical(this, tr("MusE: Freeze Track"),
+            tr("Only wave tracks, synth tracks and midi tracks playing a synth can be frozen"));
+        return;
+    }
+    if(track->off() || track->recordFlag() || track->recMonitor())
+    {
+        QMessageBox::critical(this, tr("MusE: Freeze Track"),
+            tr("Cannot freeze a track which is off, record armed or monitored"));
+        return;
+    }
+    // Already frozen and up to date?
+    if(track->freeze() && !track->freeze()->isStale())
+        return;
+
+    if(MusEGlobal::audio->isPlaying())
+        MusEGlobal::song->setStop(true);
+
+    // Render the whole song, plus a tail.
+    const unsigned end_frame = MusEGlobal::tempomap.tick2frame(MusEGlobal::song->len()) +
+      (unsigned)((double)MusEGlobal::config.freezeTailMs * (double)MusEGlobal::sampleRate / 1000.0);
+
+    MusECore::TrackFreeze* fr = MusECore::TrackFreeze::createRender(track, 0, end_frame);
+    if(!fr)
+    {
+        QMessageBox::critical(this, tr("MusE: Freeze Track"),
+            tr("Cannot create the freeze file in the project directory"));
+        return;
+    }
+
+    // Switch all wave converters to offline settings mode.
+    MusEGlobal::song->setAudioConvertersOfflineOperation(true);
+
+    // Always freewheel. The audio thread writes the file directly.
+    // This will wait a few cycles until freewheel is set and a seek is done.
+    if(!MusEGlobal::audio->msgBounce(MusECore::Pos(0u, false), MusECore::Pos(end_frame, false), true))
+    {
+        MusEGlobal::song->setAudioConvertersOfflineOperation(false);
+        fr->discard();
+        delete fr;
+        return;
+    }
+    MusEGlobal::song->freezeRender = fr;
+    MusEGlobal::song->setPlay(true);
+}
+
+//---------------------------------------------------------
+//   unfreezeTrack
+//---------------------------------------------------------
+
+void MusE::unfreezeTrack(MusECore::Track* t)
+{
+    MusECore::AudioTrack* track = MusECore::TrackFreeze::freezableTrack(t);
+    if(!track || !track->freeze() || MusEGlobal::song->freezeRender)
+        return;
+    MusEGlobal::song->applyOperation(
+      MusECore::UndoOp(MusECore::UndoOp::SetTrackFreeze, track, track->freeze(), nullptr));
+}
+
 
 //---------------------------------------------------------
 //   checkRegionNotNull
@@ -109,6 +109,7 @@ class RouteDialog;
 class CpuToolbar;
 class CpuStatusBar;
 class SnooperDialog;
+class DspProfilerDialog;
 class MasterEdit;
 class MidiEditor;
 class ListEdit;
@@ -205,6 +206,7 @@ class MusE : public QMainWindow
 
     // View Menu actions
     QAction *viewTransportAction, *viewBigtimeAction, *viewMixerAAction, *viewMixerBAction, *viewCliplistAction, *viewMarkerAction;
+    QAction *viewDspProfilerAction;
     QAction *fullscreenAction, *toggleDocksAction;
     QAction *masterGraphicAction, *masterListAction;
 
@@ -274,6 +276,7 @@ class MusE : public QMainWindow
     ShortcutConfig* shortcutConfig;
     Appearance* appearance;
     SnooperDialog* _snooperDialog;
+    DspProfilerDialog* _dspProfilerDialog;
     AudioMixerApp* mixer1;
     AudioMixerApp* mixer2;
     QDockWidget* mixer1Dock;
@@ -439,6 +442,8 @@ public slots:
     void saveAsTemplate();
     void bounceToFile(MusECore::AudioOutput* ao = nullptr);
     void bounceToTrack(MusECore::AudioOutput* ao = nullptr);
+    void freezeTrack(MusECore::Track* t);
+    void unfreezeTrack(MusECore::Track* t);
     void closeEvent(QCloseEvent*event) override;
     void loadProjectFile(const QString&);
 #ifdef USE_SENDPOSTEDEVENTS_FOR_TOPWIN_CLOSE
@@ -483,6 +488,7 @@ public slots:
     void startEditor(MusECore::Track*);
     void startMidiTransformer();
     void startSnooper();
+    void startDspProfiler();
 
     void focusChanged(QWidget* old, QWidget* now);
 
@@ -66,6 +66,7 @@
 #include "drumedit.h"
 #include "utils.h"
 #include "functions.h"
+#include "track_freeze.h"
 
 
 #ifdef DSSI_SUPPORT
@@ -2558,6 +2559,18 @@ void TList::mousePressEvent(QMouseEvent* ev)
                 a->setData(1021);
                 p->addSeparator();
 
+                // A midi track freezes the synth it plays.
+                if (MusECore::AudioTrack* ft = MusECore::TrackFreeze::freezableTrack(t))
+                {
+                    a = p->addAction(tr("Freeze Track"));
+                    a->setData(1022);
+                    a->setEnabled(!MusEGlobal::audio->bounce() && (!ft->freeze() || ft->freeze()->isStale()));
+                    a = p->addAction(tr("Unfreeze Track"));
+                    a->setData(1023);
+                    a->setEnabled(!MusEGlobal::audio->bounce() && ft->freeze());
+                    p->addSeparator();
+                }
+
                 if (t->type()==MusECore::Track::DRUM)
                 {
                     a=p->addAction(tr("Save Track's Drumlist"));
@@ -2648,6 +2661,14 @@ void TList::mousePressEvent(QMouseEvent* ev)
                         }
                             break;
 
+                        case 1022:
+                            MusEGlobal::muse->freezeTrack(t);
+                            break;
+
+                        case 1023:
+                            MusEGlobal::muse->unfreezeTrack(t);
+                            break;
+
                         case 1010:
                             saveTrackDrummap((MusECore::MidiTrack*)t, true);
                             break;
@@ -26,6 +26,7 @@
 #include <set>
 #include <errno.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 #include "app.h"
 #include "song.h"
@@ -33,6 +34,9 @@
 #include "alsamidi.h"
 #include "audioprefetch.h"
 #include "audio.h"
+#include "audio_graph.h"
+#include "audio_anticipator.h"
+#include "dsp_profiler.h"
 #include "tempo.h"
 #include "wave.h"
 #include "midictrl.h"
@@ -143,6 +147,10 @@ Audio::Audio()
       _loopFrame    = 0;
       _loopCount    = 0;
       m_Xruns       = 0;
+      _graphScheduler = new AudioGraphScheduler();
+      _anticipator = new AudioAnticipator();
+      _latencyDirty.store(true);
+      _latencyCorrectionOn = false;
 
       _pos.setType(Pos::FRAMES);
       _pos.setFrame(0);
@@ -177,7 +185,9 @@ Audio::Audio()
       syncFrame     = 0;
 
       state         = STOP;
-      msg           = 0;
+      _msgQueue     = new LockFreeMPSCRingBuffer<AudioMsgCommand>(1024);
+      _msgDoneQueue = new LockFreeMPSCRingBuffer<AudioMsgCommand>(1024);
+      _asyncMsgsPending = 0;
 
       startRecordPos.setType(Pos::FRAMES);  // Tim
       endRecordPos.setType(Pos::FRAMES);
@@ -210,6 +220,19 @@ Audio::Audio()
 
 Audio::~Audio() 
 {
+  if(_graphScheduler)
+    delete _graphScheduler;
+  if(_anticipator)
+    delete _anticipator;
+  // Delete any asynchronous messages which were never completed.
+  AudioMsgCommand cmd;
+  while(_msgQueue->get(cmd))
+    if(cmd.async)
+      delete cmd.msg;
+  while(_msgDoneQueue->get(cmd))
+    delete cmd.msg;
+  delete _msgQueue;
+  delete _msgDoneQueue;
   if(_clockOutputQueue)
     delete[] _clockOutputQueue;
   if(_extClockHistory)
@@ -253,11 +276,22 @@ bool Audio::start()
                }
           }
 
+      // Start any parallel processing workers at the same priority as the audio thread.
+      _graphScheduler->start(MusEGlobal::config.audioGraphWorkerThreads, MusEGlobal::realTimePriority);
+      // The anticipative renderers work ahead, so they must never preempt the audio thread.
+      _anticipator->start(MusEGlobal::config.anticipativeRenderThreads,
+                          MusEGlobal::config.anticipativeRenderLookahead,
+                          MusEGlobal::realTimePriority > 1 ? MusEGlobal::realTimePriority - 1 : 0);
+      // The devices may have changed. Recompute latency correction on the first cycle.
+      latencyChanged();
+
       _running = true;  // Set before we start to avoid error messages in process.
       if(!MusEGlobal::audioDevice->start(MusEGlobal::realTimePriority))
       {
         fprintf(stderr, "Failed to start audio!\n");
         _running = false;
+        _graphScheduler->stop();
+        _anticipator->stop();
         return false;
       }
 
@@ -269,8 +303,9 @@ bool Audio::start()
       MusEGlobal::audioDevice->seekTransport(MusEGlobal::song->cPos());   
       
       // Should be OK to start this 'leisurely' timer only after everything
-      //  else has been started.
-      MusEGlobal::muse->setHeartBeat();
+      //  else has been started. There is no window when rendering headless.
+      if(MusEGlobal::muse)
+        MusEGlobal::muse->setHeartBeat();
       
       return true;
       }
@@ -286,11 +321,14 @@ void Audio::stop(bool)
       //  observed a few times in mixer strip timer handlers (updatexxx). Not sure how
       //  (we're in the graphics thread), but in case something during loading runs
       //  the event loop or something, this should at least not hurt. 2019/01/24 Tim.
-      MusEGlobal::muse->stopHeartBeat();
+      if (MusEGlobal::muse)
+            MusEGlobal::muse->stopHeartBeat();
 
       if (MusEGlobal::audioDevice)
             MusEGlobal::audioDevice->stop();
       _running = false;
+      _graphScheduler->stop();
+      _anticipator->stop();
       }
 
 //---------------------------------------------------------
@@ -446,6 +484,10 @@ bool Audio::sync(int jackState, unsigned frame)
     }
   }
   
+  // Let the anticipative renderer get ahead of the transport before it starts rolling.
+  if(done && state == START_PLAY && !_freewheel)
+    done = _anticipator->prime(_pos.frame());
+
   //fprintf(stderr, "Audio::sync() end: state:%d pos frame:%u\n", state, _pos.frame());
   _syncReady = done;
   return _syncReady;
@@ -628,18 +670,12 @@ void Audio::shutdown()
 
 void Audio::process(unsigned frames)
       {
+      // Commits the profiler probes when the cycle ends, however it ends.
+      DspCycleProfileScope prof;
+
       _curCycleFrames = frames;
       if (!MusEGlobal::checkAudioDevice()) return;
-      if (msg) {
-            processMsg(msg);
-            int sn = msg->serialNo;
-            msg    = 0;    // don't process again
-            int rv = write(fromThreadFdw, &sn, sizeof(int));
-            if (rv != sizeof(int)) {
-                  fprintf(stderr, "audio: write(%d) pipe failed: %s\n",
-                     fromThreadFdw, strerror(errno));
-                  }
-            }
+      processMsgQueue();
 
       OutputList* ol = MusEGlobal::song->outputs();
       if (idle) {
@@ -765,7 +801,7 @@ void Audio::process(unsigned frames)
             if (!freewheel())
                   MusEGlobal::audioPrefetch->msgTick(isRecording(), true);
 
-            if (bounce() && _pos >= MusEGlobal::song->rPos()) {
+            if (bounce() && _pos >= _bounceEnd) {
                   // Need to let the resulting stopRolling take care of resetting bounce.
                   //_bounceState = BounceOff;
                   // This is safe in both Jack 1 and 2.
@@ -856,6 +892,10 @@ void Audio::process(unsigned frames)
             }
           }
 
+      // Keep the anticipative renderer going, or end its session if the transport
+      //  has stopped or jumped.
+      _anticipator->process(samplePos, frames);
+
       process1(samplePos, offset, frames);
       for (iAudioOutput i = ol->begin(); i != ol->end(); ++i)
       {
@@ -926,37 +966,48 @@ void Audio::process1(unsigned samplePos, unsigned offset, unsigned frames)
         //  audio processing, because THAT is done at the very end of this routine.
         // This will also reset the track's processed flag.         Tim.
         track->preProcessAlways();
-
-        // Reset some latency info to prepare for (re)computation.
-        track->prepareLatencyScan();
       }
 
-      // This includes synthesizers.
-      for(ciMidiDevice imd = mdl.cbegin(); imd != mdl.cend(); ++imd) 
+      // Pre-process the metronome.
+      metronome->preProcessAlways();
+
+      // The latency information is cached in the tracks and devices. When correction
+      //  is enabled, it is only recomputed when something has changed. Otherwise it is
+      //  reset every cycle, since anything asking for it computes it on demand.
+      const bool correct_latency = MusEGlobal::config.enableLatencyCorrection;
+      const bool scan_latency = !correct_latency || _latencyDirty.exchange(false) || !_latencyCorrectionOn;
+      _latencyCorrectionOn = correct_latency;
+
+      if(scan_latency)
       {
-        MidiDevice* md = *imd;
-        // Device not in use?
-        if(md->midiPort() < 0 || md->midiPort() >= MusECore::MIDI_PORTS)
-          continue;
+        for(TrackList::size_type it = 0; it < tl_sz; ++it) 
+        {
+          // Reset some latency info to prepare for (re)computation.
+          tl[it]->prepareLatencyScan();
+        }
+
+        // This includes synthesizers.
+        for(ciMidiDevice imd = mdl.cbegin(); imd != mdl.cend(); ++imd) 
+        {
+          MidiDevice* md = *imd;
+          // Device not in use?
+          if(md->midiPort() < 0 || md->midiPort() >= MusECore::MIDI_PORTS)
+            continue;
+
+          // Reset some latency info to prepare for (re)computation.
+          md->prepareLatencyScan();
+        }
 
         // Reset some latency info to prepare for (re)computation.
-        md->prepareLatencyScan();
+        static_cast<AudioTrack*>(metronome)->prepareLatencyScan();
+        static_cast<MidiDevice*>(metronome)->prepareLatencyScan();
       }
-      
-      // Pre-process the metronome.
-      metronome->preProcessAlways();
-      // Reset some latency info to prepare for (re)computation.
-      static_cast<AudioTrack*>(metronome)->prepareLatencyScan();
-      static_cast<MidiDevice*>(metronome)->prepareLatencyScan();
 
       //---------------------------------------------
       // BEGIN Latency correction/compensation processing
-      // TODO: Instead of doing this blindly every cycle, do it only when
-      //        a latency controller changes or a connection is made etc,
-      //        ie only when something changes.
       //---------------------------------------------
 
-      if(MusEGlobal::config.enableLatencyCorrection)
+      if(correct_latency && scan_latency)
       {
         float song_worst_latency = 0.0f;
         
@@ -1373,6 +1424,11 @@ void Audio::process1(unsigned samplePos, unsigned offset, unsigned frames)
       // Audio processing
       //---------------------------------------------
       
+      // Process independent branches on the worker threads first, if enabled.
+      // Their tracks cache the results, which are simply picked up below.
+      if(_graphScheduler->isRunning())
+        _graphScheduler->process(samplePos, frames);
+
       // Process Aux tracks first.
       for(AuxList::size_type it = 0; it < aux_tl_sz; ++it) 
       {
@@ -1418,6 +1474,51 @@ void Audio::process1(unsigned samplePos, unsigned offset, unsigned frames)
       }      
     }
 
+//---------------------------------------------------------
+//   processMsgQueue
+//    process all messages sent before this call, in order
+//---------------------------------------------------------
+
+void Audio::processMsgQueue()
+      {
+      bool async_done = false;
+      // Don't process messages arriving while we are busy, they can wait for the next cycle.
+      const unsigned int sz = _msgQueue->getSize();
+      // Messages change the song, which the anticipative renderer workers must keep off
+      //  meanwhile. If one of them is still busy the messages wait for the next cycle.
+      if (sz != 0 && !_anticipator->pause())
+            return;
+      AudioMsgCommand cmd;
+      for (unsigned int i = 0; i < sz; ++i) {
+            if (!_msgQueue->get(cmd))
+                  break;
+            processMsg(cmd.msg);
+            if (cmd.async) {
+                  // The queue sizes guarantee there is room.
+                  _msgDoneQueue->put(cmd);
+                  async_done = true;
+                  }
+            else {
+                  // Wake up the waiting sender.
+                  int sn = cmd.msg->serialNo;
+                  int rv = write(fromThreadFdw, &sn, sizeof(int));
+                  if (rv != sizeof(int)) {
+                        fprintf(stderr, "audio: write(%d) pipe failed: %s\n",
+                           fromThreadFdw, strerror(errno));
+                        }
+                  }
+            }
+      if (sz != 0) {
+            // Nothing is rendered ahead while idle, the song may be cleared meanwhile.
+            if (idle)
+                  _anticipator->endSession();
+            _anticipator->resume();
+            }
+      // Let the gui call the completion callbacks.
+      if (async_done)
+            sendMsgToGui('M');
+      }
+
 //---------------------------------------------------------
 //   processMsg
 //---------------------------------------------------------
@@ -1427,21 +1528,31 @@ void Audio::processMsg(AudioMsg* msg)
       switch(msg->id) {
             case AUDIO_ROUTEADD:
                   addRoute(msg->sroute, msg->droute);
+                  graphChanged();
                   break;
             case AUDIO_ROUTEREMOVE:
                   removeRoute(msg->sroute, msg->droute);
+                  graphChanged();
                   break;
             case AUDIO_REMOVEROUTES:      
                   removeAllRoutes(msg->sroute, msg->droute);
+                  graphChanged();
                   break;
             case SEQM_SET_AUX:
+                  {
+                  // Only switching a send on or off changes the graph.
+                  const bool wasActive = msg->snode->auxSendActive(msg->ival);
                   msg->snode->setAuxSend(msg->ival, msg->dval);
+                  if(msg->snode->auxSendActive(msg->ival) != wasActive)
+                        graphChanged();
+                  }
                   break;
             case AUDIO_SET_PREFADER:
                   msg->snode->setPrefader(msg->ival);
                   break;
             case AUDIO_SET_CHANNELS:
                   msg->snode->setChannels(msg->ival);
+                  graphChanged();
                   break;
             case AUDIO_SWAP_PLUGINS:
                   msg->snode->swapPlugins(msg->a, msg->b);
@@ -1455,6 +1566,7 @@ void Audio::processMsg(AudioMsg* msg)
 
             case AUDIO_SET_SEND_METRONOME:
                   msg->snode->setSendMetronome((bool)msg->ival);
+                  latencyChanged();
                   break;
             
             case SEQM_RESET_DEVICES:
@@ -1504,6 +1616,9 @@ void Audio::processMsg(AudioMsg* msg)
                   
             case SEQM_IDLE:
                   idle = msg->a;
+                  // Wave files may be edited while idle.
+                  WaveLoopCache::invalidateAll();
+                  graphChanged();
                   if(MusEGlobal::midiSeq)
                     MusEGlobal::midiSeq->sendMsg(msg);
                   break;
@@ -1542,6 +1657,9 @@ void Audio::seek(const Pos& p)
 
         if (MusEGlobal::heavyDebugMsg)
           fprintf(stderr, "Audio::seek frame:%d\n", p.frame());
+
+        // Anything rendered ahead is for the old position.
+        _anticipator->endSession();
           
         _pos        = p;
         if (!MusEGlobal::checkAudioDevice()) return;
@@ -1593,23 +1711,24 @@ void Audio::seek(const Pos& p)
 
 //---------------------------------------------------------
 //   writeTick
-//    called from audio prefetch thread context
-//    write another buffer to soundfile
+//    called from the record writer thread context
+//    write the recorded buffers to soundfile
+//    flush: write out the partly filled batches too
 //---------------------------------------------------------
 
-void Audio::writeTick()
+void Audio::writeTick(bool flush)
       {
       AudioOutput* ao = MusEGlobal::song->bounceOutput;
       if(ao && MusEGlobal::song->outputs()->find(ao) != MusEGlobal::song->outputs()->end())
       {
         if(ao->recordFlag())
-          ao->record();
+          ao->record(flush);
       }
       WaveTrackList* tl = MusEGlobal::song->waves();
       for (iWaveTrack t = tl->begin(); t != tl->end(); ++t) {
             WaveTrack* track = *t;
             if (track->recordFlag())
-                  track->record();
+                  track->record(flush);
             }
       }
 
@@ -1632,27 +1751,30 @@ void Audio::startRolling()
         }
         if (MusEGlobal::song->record()) {
               recording      = true;
+              WaveTrackList* tracks = MusEGlobal::song->waves();
+              for (iWaveTrack i = tracks->begin(); i != tracks->end(); ++i)
+                          (*i)->resetMeter();
+              }
+        // If we are in freewheel mode, directly seek the wave files.
+        // Since the audio converter support was added, the wave files MUST be allowed to
+        //  progress naturally during play, pulled in a stream manner by the particular converter.
+        // Therefore we no longer seek with EVERY data fetch, so do it here, directly.
+        // We CANNOT do this in Audio::seek in response to a transport relocation, because
+        //  the transport (and user) must not be allowed to influence the position during freewheel.
+        // Note that when freewheeling, prefetch is essentially UNUSED. We can ignore it here.
+        // This is needed whether recording (bounce) or not (headless offline render).
+        if(freewheel())
+        {
               WaveTrackList* tracks = MusEGlobal::song->waves();
               for (iWaveTrack i = tracks->begin(); i != tracks->end(); ++i) {
                           WaveTrack* track = *i;
-                          track->resetMeter();
-                          // If we are in freewheel mode, directly seek the wave files.
-                          // Since the audio converter support was added, the wave files MUST be allowed to
-                          //  progress naturally during play, pulled in a stream manner by the particular converter.
-                          // Therefore we no longer seek with EVERY data fetch, so do it here, directly.
-                          // We CANNOT do this in Audio::seek in response to a transport relocation, because
-                          //  the transport (and user) must not be allowed to influence the position during freewheel.
-                          // Note that when freewheeling, prefetch is essentially UNUSED. We can ignore it here.
-                          if(freewheel() /*&& bounce()*/)
-                          {
-                            // Might as well do this. Not costly. Prepare for next 'real' non-freewheel seek?
-                            track->clearPrefetchFifo();
-                            track->setPrefetchWritePos(_pos.frame());
-
-                            track->seekData(_pos.frame());
-                          }
+                          // Might as well do this. Not costly. Prepare for next 'real' non-freewheel seek?
+                          track->clearPrefetchFifo();
+                          track->setPrefetchWritePos(_pos.frame());
+
+                          track->seekData(_pos.frame());
                     }
-              }
+        }
       }
 
       state = PLAY;
@@ -1884,6 +2006,19 @@ void Audio::recordStop(bool restart, Undo* ops)
       {
         if(ao->recordFlag())
         {            
+          // The record writer may still be writing the tail of the bounce.
+          //  Wait for it, as Song::cmdAddRecordedWave() does for wave tracks.
+          int tout = 100; // Ten seconds.
+          while(ao->recordBacklog() != 0)
+          {
+            usleep(100000);
+            if(--tout == 0)
+            {
+              fprintf(stderr, "Audio::recordStop: Error: Timeout waiting for the bounce to be written! Frames left:%u\n",
+                      ao->recordBacklog());
+              break;
+            }
+          }
           MusEGlobal::song->bounceOutput = nullptr;
           ao->setRecFile(nullptr); // if necessary, this automatically deletes _recFile
           operations.push_back(UndoOp(
@@ -1981,6 +2116,34 @@ void Audio::updateMidiClick()
   audioClick = midiClick;
 }
 
+//---------------------------------------------------------
+//   graphChanged
+//---------------------------------------------------------
+
+void Audio::graphChanged()
+      {
+      _graphScheduler->invalidate();
+      _latencyDirty.store(true);
+      }
+
+//---------------------------------------------------------
+//   graphGeneration
+//---------------------------------------------------------
+
+int Audio::graphGeneration() const
+      {
+      return _graphScheduler->generation();
+      }
+
+//---------------------------------------------------------
+//   updateGraph
+//---------------------------------------------------------
+
+void Audio::updateGraph()
+      {
+      _graphScheduler->update();
+      }
+
 //---------------------------------------------------------
 //   sendMsgToGui
 //---------------------------------------------------------
@@ -26,12 +26,14 @@
 #define __AUDIO_H__
 
 #include <stdint.h>
+#include <atomic>
 
 #include "type_defs.h"
 #include "thread.h"
 #include "pos.h"
 #include "route.h"
 #include "event.h"
+#include "lock_free_buffer.h"
 
 
 // Forward declarations:
@@ -50,6 +52,8 @@ class Track;
 class Undo;
 class PendingOperationList;
 class ExtMidiClock;
+class AudioGraphScheduler;
+class AudioAnticipator;
 
 //---------------------------------------------------------
 //   AudioMsgId
@@ -110,6 +114,24 @@ struct AudioMsg : public ThreadMsg {   // this should be an union
       PendingOperationList* pendingOps;
       };
 
+// Completion callback for asynchronous audio messages.
+// It is called in the gui thread after the audio thread has processed the message.
+typedef void (*AudioMsgCallback)(AudioMsg* msg, void* data);
+
+//---------------------------------------------------------
+//   AudioMsgCommand
+//    An entry in the gui to audio thread message queue.
+//---------------------------------------------------------
+
+struct AudioMsgCommand {
+      AudioMsg* msg;
+      // Whether the sender is not waiting for the result.
+      // Asynchronous messages are owned by the queue and deleted after completion.
+      bool async;
+      AudioMsgCallback callback;
+      void* callbackData;
+      };
+
 //---------------------------------------------------------
 //   Audio
 //---------------------------------------------------------
@@ -125,6 +147,8 @@ class Audio {
       bool idle;              // do nothing in idle mode
       bool _freewheel;
       BounceState _bounceState;
+      // Where the current bounce operation ends.
+      Pos _bounceEnd;
       unsigned _loopFrame;     // Startframe of loop if in LOOP mode. Not quite the same as left marker !
       int _loopCount;         // Number of times we have looped so far
 
@@ -182,7 +206,14 @@ class Audio {
 
       State state;
 
-      AudioMsg* msg;
+      // Messages from the gui to the audio thread. Any number of them are
+      //  processed at the start of each cycle, in the order they were sent.
+      LockFreeMPSCRingBuffer<AudioMsgCommand>* _msgQueue;
+      // Asynchronous messages processed by the audio thread, waiting
+      //  for their completion callbacks to be called in the gui thread.
+      LockFreeMPSCRingBuffer<AudioMsgCommand>* _msgDoneQueue;
+      // Number of asynchronous messages sent but not yet completed. Gui thread only.
+      int _asyncMsgsPending;
       int fromThreadFdw, fromThreadFdr;  // message pipe
 
       int sigFd;              // pipe fd for messages to gui
@@ -195,6 +226,16 @@ class Audio {
       unsigned endExternalRecTick;
 
       long m_Xruns;
+
+      // Processes independent track branches in parallel, if enabled.
+      AudioGraphScheduler* _graphScheduler;
+      // Renders playback-only tracks ahead of the transport, if enabled.
+      AudioAnticipator* _anticipator;
+      // Whether the latency correction information must be recomputed
+      //  at the start of the next cycle.
+      std::atomic<bool> _latencyDirty;
+      // Whether latency correction was enabled during the last cycle. Audio thread only.
+      bool _latencyCorrectionOn;
       
       // Can be called by any thread.
       void sendLocalOff();
@@ -207,6 +248,7 @@ class Audio {
 
       void panic();
       void processMsg(AudioMsg* msg);
+      void processMsgQueue();
       void process1(unsigned samplePos, unsigned offset, unsigned samples);
 
       void collectEvents(MidiTrack*, unsigned int startTick, unsigned int endTick,
@@ -243,7 +285,7 @@ class Audio {
       // To be called from audio thread only.
       void reSyncAudio();
       void shutdown();
-      void writeTick();
+      void writeTick(bool flush = false);
 
       // transport:
       // To be called from audio thread only.
@@ -279,7 +321,19 @@ class Audio {
       void msgUpdateSoloStates();
       void msgSetAux(AudioTrack*, int, double);
       void msgPanic();
+      // Sends the message to the audio thread and waits until it has been processed.
       void sendMsg(AudioMsg*);
+      // Sends the message to the audio thread without waiting. The message must be
+      //  allocated with new, it is deleted after the optional callback has been called
+      //  in the gui thread. Messages are always processed in the order they were sent,
+      //  so any later sendMsg() returns only after this one has been processed as well.
+      void sendMsgAsync(AudioMsg* m, AudioMsgCallback callback = nullptr, void* callbackData = nullptr);
+      // Calls the completion callbacks of any processed asynchronous messages.
+      // Call from gui thread only.
+      void processMsgCompletions();
+      // Waits until all messages sent so far have been processed, then calls their
+      //  completion callbacks. Call from gui thread only.
+      void flushMsgs();
       bool sendMessage(AudioMsg* m, bool doUndo);
       void msgRemoveRoute(Route, Route);
       void msgRemoveRoute1(Route, Route); 
@@ -293,6 +347,9 @@ class Audio {
       void msgIdle(bool);
       void msgAudioWait();
       void msgBounce();
+      // Starts a bounce operation from start to end. Freewheel mode is used if
+      //  configured, or always if forceFreewheel is true. Returns false on error.
+      bool msgBounce(const Pos& start, const Pos& end, bool forceFreewheel = false);
       void msgSwapPlugins(AudioTrack*, int, int);
       void msgClearControllerEvents(AudioTrack*, int);
       void msgSeekPrevACEvent(AudioTrack*, int);
@@ -351,6 +408,18 @@ class Audio {
       void initDevices(bool force = true);
 
       void sendMsgToGui(char c);
+      // Tells the audio engine that tracks, routes, channels or aux sends have changed.
+      // Can be called from any thread.
+      void graphChanged();
+      // Builds the parallel processing graph if it changed. Gui thread only, regularly.
+      void updateGraph();
+      // Changes whenever graphChanged() is called.
+      int graphGeneration() const;
+      AudioAnticipator* anticipator() const { return _anticipator; }
+      // Tells the audio engine to recompute latency correction at the start of the
+      //  next cycle, for example when a plugin's latency, a track's monitoring,
+      //  a device or a latency setting has changed. Can be called from any thread.
+      void latencyChanged() { _latencyDirty.store(true); }
       bool bounce() const { return _bounceState == BounceStart || _bounceState == BounceOn; }
 
       long getXruns() { return m_Xruns; }
@@ -0,0 +1,568 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  audio_anticipator.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+
+#include "audio_anticipator.h"
+#include "audio.h"
+#include "globals.h"
+#include "globaldefs.h"
+#include "song.h"
+#include "track.h"
+#include "al/dsp.h"
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   AnticipationBuffer
+//---------------------------------------------------------
+
+AnticipationBuffer::AnticipationBuffer(int channels, unsigned frames, unsigned capacity)
+  : _channels(channels), _frames(frames), _capacity(capacity),
+    _write(0), _read(0), _epoch(0), _nextPos(0), _renderedEpoch(0), _renderedEnd(0)
+{
+  const size_t sz = sizeof(float) * size_t(capacity) * channels * frames;
+#ifdef _WIN32
+  _data = (float *) _aligned_malloc(16, sz);
+  if(_data == nullptr)
+  {
+    fprintf(stderr, "ERROR: AnticipationBuffer: _aligned_malloc returned error: NULL. Aborting!\n");
+    abort();
+  }
+#else
+  int rv = posix_memalign((void**)&_data, 16, sz);
+  if(rv != 0)
+  {
+    fprintf(stderr, "ERROR: AnticipationBuffer: posix_memalign returned error:%d. Aborting!\n", rv);
+    abort();
+  }
+#endif
+  memset(_data, 0, sz);
+  _blocks = new Block[capacity];
+}
+
+AnticipationBuffer::~AnticipationBuffer()
+{
+#ifdef _WIN32
+  _aligned_free(_data);
+#else
+  free(_data);
+#endif
+  delete[] _blocks;
+}
+
+//---------------------------------------------------------
+//   startSession
+//---------------------------------------------------------
+
+void AnticipationBuffer::startSession(unsigned epoch, unsigned pos)
+{
+  _epoch = epoch;
+  _nextPos = pos;
+  // The end must be valid by the time the reader sees the epoch.
+  _renderedEnd.store(pos, std::memory_order_relaxed);
+  _renderedEpoch.store(epoch, std::memory_order_release);
+}
+
+//---------------------------------------------------------
+//   writeBuffers
+//---------------------------------------------------------
+
+void AnticipationBuffer::writeBuffers(float** bp)
+{
+  float* base = _data + size_t(_write.load(std::memory_order_relaxed) % _capacity) * _channels * _frames;
+  for(int i = 0; i < _channels; ++i)
+    bp[i] = base + i * _frames;
+}
+
+//---------------------------------------------------------
+//   push
+//---------------------------------------------------------
+
+void AnticipationBuffer::push()
+{
+  const unsigned w = _write.load(std::memory_order_relaxed);
+  Block& b = _blocks[w % _capacity];
+  b.epoch = _epoch;
+  b.pos = _nextPos;
+  _write.store(w + 1, std::memory_order_release);
+  _nextPos += _frames;
+  _renderedEnd.store(_nextPos, std::memory_order_release);
+}
+
+//---------------------------------------------------------
+//   read
+//---------------------------------------------------------
+
+bool AnticipationBuffer::read(unsigned epoch, unsigned pos, int channels, unsigned nframes, float** dst)
+{
+  const unsigned w = _write.load(std::memory_order_acquire);
+  unsigned r = _read.load(std::memory_order_relaxed);
+  for( ; r != w; ++r)
+  {
+    const Block& b = _blocks[r % _capacity];
+    if(b.epoch != epoch || int(b.pos - pos) < 0)
+      continue;
+    if(b.pos != pos)
+      break;
+
+    float* base = _data + size_t(r % _capacity) * _channels * _frames;
+    if(nframes > _frames)
+      nframes = _frames;
+    for(int i = 0; i < channels; ++i)
+    {
+      if(i < _channels)
+        AL::dsp->cpy(dst[i], base + i * _frames, nframes);
+      else
+        AL::dsp->clear(dst[i], nframes, MusEGlobal::config.useDenormalBias);
+    }
+    _read.store(r + 1, std::memory_order_release);
+    return true;
+  }
+  // Release any stale blocks skipped above.
+  _read.store(r, std::memory_order_release);
+  return false;
+}
+
+//---------------------------------------------------------
+//   rendered
+//---------------------------------------------------------
+
+unsigned AnticipationBuffer::rendered(unsigned epoch, unsigned startPos) const
+{
+  if(_renderedEpoch.load(std::memory_order_acquire) != epoch)
+    return 0;
+  return _renderedEnd.load(std::memory_order_acquire) - startPos;
+}
+
+//---------------------------------------------------------
+//   anticipationWorker
+//---------------------------------------------------------
+
+static void* anticipationWorker(void* p)
+{
+  AudioAnticipator::Worker* w = static_cast<AudioAnticipator::Worker*>(p);
+  w->anticipator->workerLoop(w->index);
+  return nullptr;
+}
+
+//---------------------------------------------------------
+//   AudioAnticipator
+//---------------------------------------------------------
+
+AudioAnticipator::AudioAnticipator()
+{
+  _epoch.store(0);
+  _active.store(false);
+  _paused.store(false);
+  _busy.store(0);
+  _quit.store(false);
+  _startPos.store(0);
+  _curPos.store(0);
+  _nextPos = 0;
+  _primeWait = 0;
+  _blockFrames = 0;
+  _lookahead = 0;
+  _capacity = 0;
+  _numWorkers = 0;
+  _workers = nullptr;
+}
+
+AudioAnticipator::~AudioAnticipator()
+{
+  stop();
+}
+
+//---------------------------------------------------------
+//   start
+//---------------------------------------------------------
+
+void AudioAnticipator::start(int numWorkers, int lookaheadMs, int priority)
+{
+  stop();
+  if(numWorkers <= 0 || MusEGlobal::segmentSize == 0)
+    return;
+
+  _blockFrames = MusEGlobal::segmentSize;
+  _lookahead = lookaheadMs > 0 ? (uint64_t)lookaheadMs * MusEGlobal::sampleRate / 1000 : 0;
+  if(_lookahead < _blockFrames)
+    _lookahead = _blockFrames;
+  // Room for the look-ahead, plus the block being read and the one being written.
+  _capacity = (_lookahead + _blockFrames - 1) / _blockFrames + 2;
+
+  _quit.store(false);
+  _workers = new Worker[numWorkers];
+
+  for(int i = 0; i < numWorkers; ++i)
+  {
+    Worker& w = _workers[_numWorkers];
+    w.anticipator = this;
+    w.index = _numWorkers;
+    sem_init(&w.wakeSem, 0, 0);
+
+    pthread_attr_t* attributes = nullptr;
+    if(MusEGlobal::realTimeScheduling && priority > 0)
+    {
+      attributes = (pthread_attr_t*) malloc(sizeof(pthread_attr_t));
+      pthread_attr_init(attributes);
+      if(pthread_attr_setschedpolicy(attributes, SCHED_FIFO))
+        fprintf(stderr, "AudioAnticipator: Cannot set FIFO scheduling class for worker thread\n");
+      if(pthread_attr_setscope(attributes, PTHREAD_SCOPE_SYSTEM))
+        fprintf(stderr, "AudioAnticipator: Cannot set scheduling scope for worker thread\n");
+      if(pthread_attr_setinheritsched(attributes, PTHREAD_EXPLICIT_SCHED))
+        fprintf(stderr, "AudioAnticipator: Cannot set setinheritsched for worker thread\n");
+      struct sched_param rt_param;
+      memset(&rt_param, 0, sizeof(rt_param));
+      rt_param.sched_priority = priority;
+      if(pthread_attr_setschedparam(attributes, &rt_param))
+        fprintf(stderr, "AudioAnticipator: Cannot set scheduling priority %d for worker thread\n", priority);
+    }
+
+    int rv = pthread_create(&w.thread, attributes, anticipationWorker, &w);
+    // Like Thread::start(), try again without attributes if that failed.
+    if(rv && attributes)
+      rv = pthread_create(&w.thread, nullptr, anticipationWorker, &w);
+
+    if(attributes)
+    {
+      pthread_attr_destroy(attributes);
+      free(attributes);
+    }
+
+    if(rv)
+    {
+      fprintf(stderr, "AudioAnticipator: Creating worker thread failed: %s\n", strerror(rv));
+      sem_destroy(&w.wakeSem);
+      break;
+    }
+    ++_numWorkers;
+  }
+
+  if(_numWorkers == 0)
+  {
+    delete[] _workers;
+    _workers = nullptr;
+  }
+}
+
+//---------------------------------------------------------
+//   stop
+//---------------------------------------------------------
+
+void AudioAnticipator::stop()
+{
+  if(_numWorkers == 0)
+    return;
+
+  _active.store(false);
+  _quit.store(true);
+  for(int i = 0; i < _numWorkers; ++i)
+    sem_post(&_workers[i].wakeSem);
+  for(int i = 0; i < _numWorkers; ++i)
+  {
+    pthread_join(_workers[i].thread, nullptr);
+    sem_destroy(&_workers[i].wakeSem);
+  }
+
+  delete[] _workers;
+  _workers = nullptr;
+  _numWorkers = 0;
+
+  // The block size may be different next time.
+  if(MusEGlobal::song)
+  {
+    const WaveTrackList* wl = MusEGlobal::song->waves();
+    for(ciWaveTrack it = wl->cbegin(); it != wl->cend(); ++it)
+    {
+      WaveTrack* t = static_cast<WaveTrack*>(*it);
+      t->setAnticipationEpoch(0);
+      delete t->takeAnticipationBuffer();
+    }
+  }
+}
+
+//---------------------------------------------------------
+//   canAnticipate
+//---------------------------------------------------------
+
+bool AudioAnticipator::canAnticipate(const WaveTrack* track)
+{
+  return !track->off() && !track->recordFlag() && !track->recMonitor() &&
+         !track->isFrozen() && MusEGlobal::song->bounceTrack != track &&
+         track->totalProcessBuffers() <= MAX_CHANNELS;
+}
+
+//---------------------------------------------------------
+//   allowed
+//---------------------------------------------------------
+
+bool AudioAnticipator::allowed() const
+{
+  // Looping relocates every time around, and freewheel and bounce
+  //  modes process faster than real time anyway.
+  return !MusEGlobal::audio->freewheel() && !MusEGlobal::audio->bounce() && !MusEGlobal::song->loop();
+}
+
+//---------------------------------------------------------
+//   beginSession
+//    Claims the qualifying tracks for a new session.
+//---------------------------------------------------------
+
+void AudioAnticipator::beginSession(unsigned pos)
+{
+  unsigned e = _epoch.load(std::memory_order_relaxed) + 1;
+  if(e == 0)
+    e = 1;
+  _startPos.store(pos);
+  _curPos.store(pos);
+  _nextPos = pos;
+  _primeWait = 0;
+  _epoch.store(e);
+  _active.store(true);
+
+  const WaveTrackList* wl = MusEGlobal::song->waves();
+  for(ciWaveTrack it = wl->cbegin(); it != wl->cend(); ++it)
+  {
+    WaveTrack* t = static_cast<WaveTrack*>(*it);
+    // A buffer from before the block size changed (on a track which was
+    //  restored from the undo list, for example) can't be replaced while
+    //  the track might be reading it. Play such a track live instead.
+    const AnticipationBuffer* b = t->anticipationBuffer();
+    if(b && (b->frames() != _blockFrames || b->capacity() != _capacity))
+      continue;
+    if(canAnticipate(t))
+      t->setAnticipationEpoch(e);
+  }
+}
+
+//---------------------------------------------------------
+//   endSession
+//---------------------------------------------------------
+
+void AudioAnticipator::endSession()
+{
+  if(!_active.load(std::memory_order_relaxed))
+    return;
+  _active.store(false);
+  // The claimed tracks no longer match, and are taken back by the audio thread.
+  unsigned e = _epoch.load(std::memory_order_relaxed) + 1;
+  if(e == 0)
+    e = 1;
+  _epoch.store(e);
+}
+
+//---------------------------------------------------------
+//   primed
+//---------------------------------------------------------
+
+bool AudioAnticipator::primed() const
+{
+  const unsigned e = _epoch.load(std::memory_order_relaxed);
+  const unsigned start = _startPos.load(std::memory_order_relaxed);
+  // Half the look-ahead is enough to start, the rest fills up while playing.
+  unsigned want = _lookahead / 2;
+  if(want < _blockFrames)
+    want = _blockFrames;
+
+  const WaveTrackList* wl = MusEGlobal::song->waves();
+  for(ciWaveTrack it = wl->cbegin(); it != wl->cend(); ++it)
+  {
+    const WaveTrack* t = static_cast<const WaveTrack*>(*it);
+    if(t->anticipationEpoch() != e)
+      continue;
+    const AnticipationBuffer* b = t->anticipationBuffer();
+    if(!b || b->rendered(e, start) < want)
+      return false;
+  }
+  return true;
+}
+
+//---------------------------------------------------------
+//   prime
+//---------------------------------------------------------
+
+bool AudioAnticipator::prime(unsigned pos)
+{
+  if(_numWorkers == 0 || !allowed() || MusEGlobal::segmentSize != _blockFrames)
+    return true;
+
+  if(!_active.load(std::memory_order_relaxed) || _startPos.load(std::memory_order_relaxed) != pos)
+    beginSession(pos);
+  else if(primed())
+    return true;
+
+  // Don't hold up the transport for more than a second if the workers can't keep up.
+  // Late blocks are played as silence.
+  _primeWait += MusEGlobal::segmentSize;
+  return _primeWait >= (unsigned)MusEGlobal::sampleRate;
+}
+
+//---------------------------------------------------------
+//   process
+//---------------------------------------------------------
+
+void AudioAnticipator::process(unsigned pos, unsigned frames)
+{
+  if(_numWorkers == 0 || !_active.load(std::memory_order_relaxed))
+    return;
+
+  bool keep = allowed() && frames == _blockFrames;
+  if(keep)
+  {
+    if(MusEGlobal::audio->isPlaying())
+    {
+      // Relocated without going through sync (by external sync, for example)?
+      keep = pos == _nextPos;
+      _nextPos = pos + frames;
+    }
+    else
+      keep = MusEGlobal::audio->isStarting();
+  }
+  if(!keep)
+  {
+    endSession();
+    return;
+  }
+
+  _curPos.store(pos, std::memory_order_release);
+  for(int i = 0; i < _numWorkers; ++i)
+    sem_post(&_workers[i].wakeSem);
+}
+
+//---------------------------------------------------------
+//   pause
+//---------------------------------------------------------
+
+bool AudioAnticipator::pause()
+{
+  if(_numWorkers == 0)
+    return true;
+  _paused.store(true);
+  return _busy.load() == 0;
+}
+
+//---------------------------------------------------------
+//   resume
+//---------------------------------------------------------
+
+void AudioAnticipator::resume()
+{
+  _paused.store(false);
+}
+
+//---------------------------------------------------------
+//   renderTrack
+//---------------------------------------------------------
+
+bool AudioAnticipator::renderTrack(WaveTrack* track, unsigned epoch)
+{
+  AnticipationBuffer* b = track->anticipationBuffer();
+  if(!b)
+  {
+    b = new AnticipationBuffer(MAX_CHANNELS, _blockFrames, _capacity);
+    track->setAnticipationBuffer(b);
+  }
+  if(b->epoch() != epoch)
+    b->startSession(epoch, _startPos.load());
+
+  const int channels = track->totalProcessBuffers();
+  float* bp[MAX_CHANNELS];
+  while(!b->full())
+  {
+    const unsigned pos = b->nextPos();
+    if(int(pos - _curPos.load(std::memory_order_acquire)) >= int(_lookahead))
+      break;
+    // Wait for the disk.
+    if(track->prefetchFifo()->isEmpty())
+      break;
+
+    // The audio thread checks the busy flag after taking a track back,
+    //  so the checks below must come after setting it.
+    track->setAnticipationBusy(true);
+    if(_paused.load() || _epoch.load() != epoch)
+    {
+      track->setAnticipationBusy(false);
+      return false;
+    }
+    if(track->anticipationEpoch() != epoch)
+    {
+      track->setAnticipationBusy(false);
+      break;
+    }
+    b->writeBuffers(bp);
+    track->renderAnticipated(pos, channels, _blockFrames, bp);
+    track->setAnticipationBusy(false);
+    b->push();
+  }
+  return true;
+}
+
+//---------------------------------------------------------
+//   workerLoop
+//    Each worker takes every n-th wave track, so a track is
+//    only ever rendered by one worker.
+//---------------------------------------------------------
+
+void AudioAnticipator::workerLoop(int index)
+{
+  Worker& w = _workers[index];
+  for(;;)
+  {
+    if(sem_wait(&w.wakeSem) != 0)
+    {
+      if(errno == EINTR)
+        continue;
+      fprintf(stderr, "AudioAnticipator::workerLoop: sem_wait failed: %s\n", strerror(errno));
+      return;
+    }
+    if(_quit.load())
+      return;
+
+    // The audio thread checks the count after pausing,
+    //  so the checks below must come after raising it.
+    _busy.fetch_add(1);
+    if(!_paused.load() && _active.load())
+    {
+      const unsigned epoch = _epoch.load();
+      int n = 0;
+      const WaveTrackList* wl = MusEGlobal::song->waves();
+      for(ciWaveTrack it = wl->cbegin(); it != wl->cend(); ++it, ++n)
+      {
+        if(n % _numWorkers != index)
+          continue;
+        WaveTrack* t = static_cast<WaveTrack*>(*it);
+        if(t->anticipationEpoch() != epoch)
+          continue;
+        if(!renderTrack(t, epoch))
+          break;
+      }
+    }
+    _busy.fetch_sub(1);
+  }
+}
+
+} // namespace MusECore
@@ -0,0 +1,214 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  audio_anticipator.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __AUDIO_ANTICIPATOR_H__
+#define __AUDIO_ANTICIPATOR_H__
+
+#include <atomic>
+#include <pthread.h>
+#include <semaphore.h>
+
+namespace MusECore {
+
+class WaveTrack;
+class AudioAnticipator;
+
+//---------------------------------------------------------
+//   AnticipationBuffer
+//    A ring of blocks rendered ahead for one track.
+//    One renderer worker writes, the audio thread reads.
+//    Each block is stamped with the session and the frame
+//    it was rendered for, so the reader simply skips any
+//    stale blocks left over from an earlier session.
+//---------------------------------------------------------
+
+class AnticipationBuffer {
+      struct Block {
+            unsigned epoch;
+            unsigned pos;
+            };
+
+      int _channels;
+      // Frames per block.
+      unsigned _frames;
+      // Number of blocks.
+      unsigned _capacity;
+      float* _data;
+      Block* _blocks;
+      // Only written by the worker.
+      std::atomic<unsigned> _write;
+      // Only written by the audio thread.
+      std::atomic<unsigned> _read;
+
+      // Worker only. The session being rendered and the next block position.
+      unsigned _epoch;
+      unsigned _nextPos;
+      // How far the current session has been rendered, for priming.
+      std::atomic<unsigned> _renderedEpoch;
+      std::atomic<unsigned> _renderedEnd;
+
+   public:
+      AnticipationBuffer(int channels, unsigned frames, unsigned capacity);
+      ~AnticipationBuffer();
+      AnticipationBuffer(const AnticipationBuffer&) = delete;
+      AnticipationBuffer& operator=(const AnticipationBuffer&) = delete;
+
+      int channels() const { return _channels; }
+      unsigned frames() const { return _frames; }
+      unsigned capacity() const { return _capacity; }
+
+      // Worker thread only.
+      void startSession(unsigned epoch, unsigned pos);
+      unsigned epoch() const { return _epoch; }
+      unsigned nextPos() const { return _nextPos; }
+      bool full() const { return _write.load(std::memory_order_relaxed) -
+                                 _read.load(std::memory_order_acquire) >= _capacity; }
+      // Points bp at the channels of the next free block.
+      void writeBuffers(float** bp);
+      // Publishes the block filled via writeBuffers().
+      void push();
+
+      // Audio thread only.
+      // Copies the block rendered for pos into dst, discarding any stale blocks before it.
+      // Returns false if the block is not there (yet).
+      bool read(unsigned epoch, unsigned pos, int channels, unsigned nframes, float** dst);
+      // Number of frames rendered for the session starting at startPos.
+      unsigned rendered(unsigned epoch, unsigned startPos) const;
+      };
+
+//---------------------------------------------------------
+//   AudioAnticipator
+//
+//   Renders playback-only wave tracks ahead of the transport
+//    on worker threads, so the audio thread only has to mix
+//    them together with the live branches.
+//
+//   A wave track qualifies when it is on, neither record armed
+//    nor monitored, not frozen, and not being bounced to. Its source is
+//    then nothing but the prefetched file data, so its source
+//    and effects rack output is known ahead of time. Volume,
+//    pan, mute, metering and aux sends stay in the audio thread
+//    and respond immediately.
+//
+//   Rendering happens in sessions. A session begins while the
+//    transport is starting (see prime()) and ends when the
+//    transport stops, relocates or loops, or when freewheel or
+//    bounce mode starts. The audio thread claims the qualifying
+//    tracks at the start of a session. A claimed track belongs
+//    to the renderer: the audio thread only takes its rendered
+//    blocks, and outputs silence if a block is late.
+//    A track which stops qualifying during a session is taken
+//    back at once, and after a session ends its tracks are
+//    taken back when the renderer is done with them.
+//
+//   Since the effects rack runs ahead, plugin parameter changes
+//    and unmuting are heard up to the look-ahead time later on
+//    anticipated tracks, and a track taken back in the middle
+//    of a session is silent until the transport catches up
+//    with the data already rendered.
+//
+//   Messages change the song in the audio thread, so the
+//    workers are paused while the audio thread executes them.
+//---------------------------------------------------------
+
+class AudioAnticipator {
+   public:
+      struct Worker {
+            AudioAnticipator* anticipator;
+            int index;
+            pthread_t thread;
+            sem_t wakeSem;
+            };
+
+   private:
+      // The current session. Tracks are claimed for a session by storing
+      //  its epoch in them. Zero is never used, it means not claimed.
+      std::atomic<unsigned> _epoch;
+      std::atomic<bool> _active;
+      // Whether the audio thread wants the workers to keep off the song.
+      std::atomic<bool> _paused;
+      // Number of workers inside a rendering pass.
+      std::atomic<int> _busy;
+      std::atomic<bool> _quit;
+      // Where the current session began, and the audio thread's current position.
+      std::atomic<unsigned> _startPos;
+      std::atomic<unsigned> _curPos;
+
+      // Audio thread only.
+      // The position expected in the next cycle.
+      unsigned _nextPos;
+      // Frames the transport has been held up while priming.
+      unsigned _primeWait;
+
+      // Set by start().
+      unsigned _blockFrames;
+      unsigned _lookahead;
+      unsigned _capacity;
+      int _numWorkers;
+      Worker* _workers;
+
+      // Whether anticipation is possible at all right now.
+      bool allowed() const;
+      void beginSession(unsigned pos);
+      bool primed() const;
+      // Renders whatever the track needs. Returns false if the pass must stop.
+      bool renderTrack(WaveTrack* track, unsigned epoch);
+
+   public:
+      AudioAnticipator();
+      ~AudioAnticipator();
+
+      // Starts the given number of worker threads. Zero disables anticipation.
+      // Call from gui thread only, while audio is not running.
+      void start(int numWorkers, int lookaheadMs, int priority);
+      // Stops the worker threads and frees all the track buffers.
+      // Call from gui thread only, while audio is not running.
+      void stop();
+      bool isRunning() const { return _numWorkers > 0; }
+
+      // Whether the track's output can be rendered ahead.
+      static bool canAnticipate(const WaveTrack* track);
+
+      // Audio thread only.
+      unsigned epoch() const { return _epoch.load(std::memory_order_relaxed); }
+      bool isActive() const { return _active.load(std::memory_order_relaxed); }
+      // Called from Audio::sync() while the transport is starting. Begins a
+      //  session at pos if there is none there yet. Returns true once the
+      //  tracks are far enough ahead for the transport to start rolling.
+      bool prime(unsigned pos);
+      // Ends the current session, if any.
+      void endSession();
+      // Called once per cycle, before the tracks are processed.
+      void process(unsigned pos, unsigned frames);
+      // Asks the workers to keep off the song. Returns true once none of them
+      //  is busy, false if the caller must try again in the next cycle.
+      bool pause();
+      void resume();
+
+      // Worker thread loop.
+      void workerLoop(int index);
+      };
+
+} // namespace MusECore
+
+#endif
@@ -34,20 +34,23 @@ namespace MusECore {
 //   Fifo
 //---------------------------------------------------------
 
-Fifo::Fifo()
+Fifo::Fifo(int depth, int capacity)
       {
       muse_atomic_init(&count);
-      nbuffer = MusEGlobal::fifoLength;
-      buffer  = new FifoBuffer*[nbuffer];
-      for (int i = 0; i < nbuffer; ++i)
-            buffer[i]  = new FifoBuffer;
+      nbuffer = depth > 0 ? depth : MusEGlobal::fifoLength;
+      _capacity = capacity > nbuffer ? capacity : nbuffer;
+      buffer  = new FifoBuffer*[_capacity];
+      for (int i = 0; i < _capacity; ++i)
+            buffer[i]  = nullptr;
       clear();
       }
 
 Fifo::~Fifo()
       {
-      for (int i = 0; i < nbuffer; ++i)
+      for (int i = 0; i < _capacity; ++i)
       {
+        if(!buffer[i])
+          continue;
         if(buffer[i]->buffer)
           free(buffer[i]->buffer);
 
@@ -69,6 +72,49 @@ void Fifo::clear()
   muse_atomic_set(&count, 0);
 }
 
+//---------------------------------------------------------
+//   setDepth
+//---------------------------------------------------------
+
+void Fifo::setDepth(int n)
+{
+  if(n < 1)
+    n = 1;
+  if(n > _capacity)
+    n = _capacity;
+  nbuffer = n;
+  clear();
+}
+
+//---------------------------------------------------------
+//   allocWriteBuffer
+//---------------------------------------------------------
+
+bool Fifo::allocWriteBuffer(MuseCount_t n)
+{
+  if(!buffer[widx])
+    buffer[widx] = new FifoBuffer;
+  FifoBuffer* b = buffer[widx];
+  if (b->maxSize < n) {
+        if (b->buffer)
+        {
+          free(b->buffer);
+          b->buffer = 0;
+        }
+#ifdef _WIN32
+        b->buffer = (float *) _aligned_malloc(16, sizeof(float *) * n);
+        if(b->buffer == nullptr)
+          return true;
+#else
+        int rv = posix_memalign((void**)&(b->buffer), 16, sizeof(float) * n);
+        if(rv != 0 || !b->buffer)
+          return true;
+#endif
+        b->maxSize = n;
+        }
+  return !b->buffer;
+}
+
 //---------------------------------------------------------
 //   put
 //    return true if fifo full
@@ -84,36 +130,12 @@ bool Fifo::put(int segs, MuseCount_t samples, float** src, MuseCount_t pos, floa
             fprintf(stderr, "FIFO %p overrun... %d\n", this, muse_atomic_read(&count));
             return true;
             }
-      FifoBuffer* b = buffer[widx];
-      MuseCount_t n         = segs * samples;
-      if (b->maxSize < n) {
-            if (b->buffer)
-            {
-              free(b->buffer);
-              b->buffer = 0;
-            }
-#ifdef _WIN32
-            b->buffer = (float *) _aligned_malloc(16, sizeof(float *) * n);
-            if(b->buffer == nullptr)
-            {
-               fprintf(stderr, "Fifo::put could not allocate buffer segs:%d samples:%lu pos:%u\n", segs, (unsigned long int) samples, (unsigned int) pos);
-               return true;
-            }
-#else
-            int rv = posix_memalign((void**)&(b->buffer), 16, sizeof(float) * n);
-            if(rv != 0 || !b->buffer)
-            {
-              fprintf(stderr, "Fifo::put could not allocate buffer segs:%d samples:%ld pos:%ld\n", segs, (long int) samples, (long int) pos);
-              return true;
-            }
-#endif
-            b->maxSize = n;
-            }
-      if(!b->buffer)
+      if (allocWriteBuffer(segs * samples))
       {
-        fprintf(stderr, "Fifo::put no buffer! segs:%d samples:%ld pos:%ld\n", segs, (long int) samples, (long int) pos);
+        fprintf(stderr, "Fifo::put could not allocate buffer segs:%d samples:%ld pos:%ld\n", segs, (long int) samples, (long int) pos);
         return true;
       }
+      FifoBuffer* b = buffer[widx];
 
       b->size = samples;
       b->segs = segs;
@@ -146,9 +168,9 @@ bool Fifo::peek(int segs, MuseCount_t samples, float** dst, MuseCount_t* pos, fl
             return true;
             }
       FifoBuffer* b = buffer[ridx];
-      if(!b->buffer)
+      if(!b || !b->buffer)
       {
-        fprintf(stderr, "Fifo::peek/get no buffer! segs:%d samples:%ld b->pos:%ld\n", segs, (long int) samples, (long int) b->pos);
+        fprintf(stderr, "Fifo::peek/get no buffer! segs:%d samples:%ld\n", segs, (long int) samples);
         return true;
       }
 
@@ -216,36 +238,12 @@ bool Fifo::getWriteBuffer(int segs, MuseCount_t samples, float** buf, MuseCount_
 
       if (muse_atomic_read(&count) == nbuffer)
             return true;
-      FifoBuffer* b = buffer[widx];
-      MuseCount_t n = segs * samples;
-      if (b->maxSize < n) {
-            if (b->buffer)
-            {
-              free(b->buffer);
-              b->buffer = 0;
-            }
-#ifdef _WIN32
-            b->buffer = (float *) _aligned_malloc(16, sizeof(float *) * n);
-            if(b->buffer == nullptr)
-            {
-               fprintf(stderr, "Fifo::getWriteBuffer could not allocate buffer segs:%d samples:%ld pos:%ld\n", segs, (long int) samples, (long int) pos);
-               return true;
-            }
-#else
-            int rv = posix_memalign((void**)&(b->buffer), 16, sizeof(float) * n);
-            if(rv != 0 || !b->buffer)
-            {
-              fprintf(stderr, "Fifo::getWriteBuffer could not allocate buffer segs:%d samples:%ld pos:%ld\n", segs, (long int) samples, (long int) pos);
-              return true;
-            }
-#endif
-            b->maxSize = n;
-            }
-      if(!b->buffer)
+      if (allocWriteBuffer(segs * samples))
       {
-        fprintf(stderr, "Fifo::getWriteBuffer no buffer! segs:%d samples:%ld pos:%ld\n", segs, (long int) samples, (long int) pos);
+        fprintf(stderr, "Fifo::getWriteBuffer could not allocate buffer segs:%d samples:%ld pos:%ld\n", segs, (long int) samples, (long int) pos);
         return true;
       }
+      FifoBuffer* b = buffer[widx];
 
       for (int i = 0; i < segs; ++i)
             buf[i] = b->buffer + i * samples;
@@ -52,16 +52,27 @@ struct FifoBuffer {
       };
 
 class Fifo {
-      int nbuffer;
+      int _capacity;          // allocated buffer slots
+      int nbuffer;            // buffers in use, at most _capacity
       int ridx;               // read index; only touched by reader
       int widx;               // write index; only touched by writer
       muse_atomic_t count;    // buffer count; writer increments, reader decrements
-      FifoBuffer** buffer;
+      FifoBuffer** buffer;    // slots get their buffer when first written
+
+      // Makes sure the write slot has a buffer of n samples. Returns true on error.
+      bool allocWriteBuffer(MuseCount_t n);
 
    public:
-      Fifo();
+      // Depth and capacity in buffers. Zero depth means MusEGlobal::fifoLength,
+      //  and the capacity is at least the depth.
+      Fifo(int depth = 0, int capacity = 0);
       ~Fifo();
       void clear();
+      int depth() const    { return nbuffer; }
+      int capacity() const { return _capacity; }
+      // Changes the number of buffers in use, up to capacity(), and clears the fifo.
+      // Like clear(), only while the reader is not reading, ie. by the writer while seeking.
+      void setDepth(int n);
       bool put(int segs, MuseCount_t samples, float** buffer, MuseCount_t pos, float latency);
       bool getWriteBuffer(int, MuseCount_t, float** buffer, MuseCount_t pos);
       void add();
@@ -0,0 +1,533 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  audio_graph.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <map>
+#include <set>
+
+#include "audio_graph.h"
+#include "globals.h"
+#include "song.h"
+#include "track.h"
+#include "route.h"
+
+// For debugging the graph: Uncomment the fprintf section.
+#define DEBUG_AUDIO_GRAPH(dev, format, args...) // fprintf(dev, format, ##args);
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   cpuRelax
+//---------------------------------------------------------
+
+static inline void cpuRelax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#endif
+}
+
+//---------------------------------------------------------
+//   hasActiveAuxSend
+//    Whether the track adds anything to any aux send buffer.
+//    Those buffers are shared, so such tracks must stay serial.
+//---------------------------------------------------------
+
+static bool hasActiveAuxSend(AudioTrack* track, AuxList::size_type naux)
+{
+  if(!track->hasAuxSend())
+    return false;
+  const AuxSendValueList* asl = track->getAuxSendValueList();
+  const AuxSendValueList::size_type sz = asl->size() < naux ? asl->size() : naux;
+  for(AuxSendValueList::size_type i = 0; i < sz; ++i)
+  {
+    // Same threshold as AudioTrack::copyData().
+    if((*asl)[i] > 0.0001)
+      return true;
+  }
+  return false;
+}
+
+//---------------------------------------------------------
+//   graphWorker
+//---------------------------------------------------------
+
+static void* graphWorker(void* p)
+{
+  static_cast<AudioGraphScheduler*>(p)->workerLoop();
+  return nullptr;
+}
+
+//---------------------------------------------------------
+//   AudioGraphScheduler
+//---------------------------------------------------------
+
+AudioGraphScheduler::AudioGraphScheduler()
+{
+  _graph = nullptr;
+  _pendingGraph.store(nullptr);
+  _retiredGraph.store(nullptr);
+  _generation.store(0);
+  _builtGeneration = -1;
+  _readyWrite.store(0);
+  _readyRead.store(0);
+  _workersDone.store(0);
+  _quit.store(false);
+  _numWorkers = 0;
+  _workers = nullptr;
+  _pos = 0;
+  _frames = 0;
+  sem_init(&_wakeSem, 0, 0);
+}
+
+AudioGraphScheduler::~AudioGraphScheduler()
+{
+  stop();
+  sem_destroy(&_wakeSem);
+}
+
+//---------------------------------------------------------
+//   start
+//---------------------------------------------------------
+
+void AudioGraphScheduler::start(int numWorkers, int priority)
+{
+  stop();
+  if(numWorkers <= 0)
+    return;
+
+  _quit.store(false);
+  _workers = new pthread_t[numWorkers];
+
+  for(int i = 0; i < numWorkers; ++i)
+  {
+    pthread_attr_t* attributes = nullptr;
+    if(MusEGlobal::realTimeScheduling && priority > 0)
+    {
+      attributes = (pthread_attr_t*) malloc(sizeof(pthread_attr_t));
+      pthread_attr_init(attributes);
+      if(pthread_attr_setschedpolicy(attributes, SCHED_FIFO))
+        fprintf(stderr, "AudioGraphScheduler: Cannot set FIFO scheduling class for worker thread\n");
+      if(pthread_attr_setscope(attributes, PTHREAD_SCOPE_SYSTEM))
+        fprintf(stderr, "AudioGraphScheduler: Cannot set scheduling scope for worker thread\n");
+      if(pthread_attr_setinheritsched(attributes, PTHREAD_EXPLICIT_SCHED))
+        fprintf(stderr, "AudioGraphScheduler: Cannot set setinheritsched for worker thread\n");
+      struct sched_param rt_param;
+      memset(&rt_param, 0, sizeof(rt_param));
+      rt_param.sched_priority = priority;
+      if(pthread_attr_setschedparam(attributes, &rt_param))
+        fprintf(stderr, "AudioGraphScheduler: Cannot set scheduling priority %d for worker thread\n", priority);
+    }
+
+    int rv = pthread_create(&_workers[_numWorkers], attributes, graphWorker, this);
+    // Like Thread::start(), try again without attributes if that failed.
+    if(rv && attributes)
+      rv = pthread_create(&_workers[_numWorkers], nullptr, graphWorker, this);
+
+    if(attributes)
+    {
+      pthread_attr_destroy(attributes);
+      free(attributes);
+    }
+
+    if(rv)
+    {
+      fprintf(stderr, "AudioGraphScheduler: Creating worker thread failed: %s\n", strerror(rv));
+      break;
+    }
+    ++_numWorkers;
+  }
+
+  if(_numWorkers == 0)
+  {
+    delete[] _workers;
+    _workers = nullptr;
+  }
+
+  invalidate();
+  update();
+}
+
+//---------------------------------------------------------
+//   stop
+//---------------------------------------------------------
+
+void AudioGraphScheduler::stop()
+{
+  if(_numWorkers == 0)
+    return;
+
+  _quit.store(true);
+  for(int i = 0; i < _numWorkers; ++i)
+    sem_post(&_wakeSem);
+  for(int i = 0; i < _numWorkers; ++i)
+    pthread_join(_workers[i], nullptr);
+
+  delete[] _workers;
+  _workers = nullptr;
+  _numWorkers = 0;
+  clearGraphs();
+}
+
+//---------------------------------------------------------
+//   clearGraphs
+//    Deletes all graphs. Audio must not be running.
+//---------------------------------------------------------
+
+void AudioGraphScheduler::clearGraphs()
+{
+  delete _graph;
+  _graph = nullptr;
+  delete _pendingGraph.exchange(nullptr);
+  delete _retiredGraph.exchange(nullptr);
+  _builtGeneration = -1;
+}
+
+//---------------------------------------------------------
+//   update
+//---------------------------------------------------------
+
+void AudioGraphScheduler::update()
+{
+  delete _retiredGraph.exchange(nullptr, std::memory_order_acq_rel);
+
+  if(_numWorkers == 0)
+    return;
+  const int gen = _generation.load(std::memory_order_acquire);
+  if(gen == _builtGeneration)
+    return;
+
+  // Take back a graph the audio thread has not taken yet, it is out of date.
+  delete _pendingGraph.exchange(nullptr, std::memory_order_acq_rel);
+
+  _pendingGraph.store(build(gen), std::memory_order_release);
+  _builtGeneration = gen;
+}
+
+//---------------------------------------------------------
+//   build
+//    Builds the dependency graph from the track routes.
+//    Called from gui thread only.
+//---------------------------------------------------------
+
+AudioGraphScheduler::Graph* AudioGraphScheduler::build(int generation)
+{
+  Graph* g = new Graph(generation);
+
+  const TrackList* tl = MusEGlobal::song->tracks();
+  const AuxList::size_type naux = MusEGlobal::song->auxs()->size();
+
+  // Gather the candidate nodes.
+  std::set<const Track*> candidates;
+  for(ciTrack it = tl->cbegin(); it != tl->cend(); ++it)
+  {
+    if((*it)->isMidiTrack())
+      continue;
+    AudioTrack* atrack = static_cast<AudioTrack*>(*it);
+    switch(atrack->type())
+    {
+      case Track::WAVE:
+      case Track::AUDIO_GROUP:
+      case Track::AUDIO_SOFTSYNTH:
+        if(!hasActiveAuxSend(atrack, naux))
+          candidates.insert(atrack);
+      break;
+
+      default:
+      break;
+    }
+  }
+
+  // Drop any candidate fed by a track which is neither a candidate itself
+  //  nor an audio input without aux sends. Repeat until nothing changes,
+  //  since dropping one candidate can disqualify those it feeds.
+  bool changed = true;
+  while(changed)
+  {
+    changed = false;
+    for(std::set<const Track*>::iterator in = candidates.begin(); in != candidates.end(); )
+    {
+      bool ok = true;
+      const RouteList* rl = (*in)->inRoutes();
+      for(ciRoute ir = rl->cbegin(); ir != rl->cend(); ++ir)
+      {
+        if(ir->type != Route::TRACK_ROUTE || !ir->track || ir->track->isMidiTrack())
+          continue;
+        AudioTrack* src = static_cast<AudioTrack*>(ir->track);
+        if(src->type() == Track::AUDIO_INPUT && !hasActiveAuxSend(src, naux))
+          continue;
+        if(candidates.find(src) == candidates.end())
+        {
+          ok = false;
+          break;
+        }
+      }
+      if(ok)
+        ++in;
+      else
+      {
+        in = candidates.erase(in);
+        changed = true;
+      }
+    }
+  }
+
+  // Keep the nodes in track list order.
+  std::map<const Track*, int> nodeIndex;
+  for(ciTrack it = tl->cbegin(); it != tl->cend(); ++it)
+  {
+    if(candidates.find(*it) == candidates.end())
+      continue;
+    nodeIndex[*it] = g->nodes.size();
+    g->nodes.push_back(static_cast<AudioTrack*>(*it));
+  }
+
+  const int n = g->nodes.size();
+
+  // Count the dependencies and successors of each node, and gather the audio inputs.
+  std::set<const Track*> preNodes;
+  g->nodeDeps.assign(n, 0);
+  g->succStart.assign(n + 1, 0);
+  for(int i = 0; i < n; ++i)
+  {
+    const RouteList* rl = g->nodes[i]->inRoutes();
+    for(ciRoute ir = rl->cbegin(); ir != rl->cend(); ++ir)
+    {
+      if(ir->type != Route::TRACK_ROUTE || !ir->track || ir->track->isMidiTrack())
+        continue;
+      std::map<const Track*, int>::const_iterator is = nodeIndex.find(ir->track);
+      if(is != nodeIndex.cend())
+      {
+        ++g->succStart[is->second + 1];
+        ++g->nodeDeps[i];
+      }
+      else if(preNodes.insert(ir->track).second)
+        g->preNodes.push_back(static_cast<AudioTrack*>(ir->track));
+    }
+  }
+  for(int i = 0; i < n; ++i)
+    g->succStart[i + 1] += g->succStart[i];
+
+  // Fill in the successors.
+  g->succ.assign(g->succStart[n], 0);
+  std::vector<int> fill(g->succStart.cbegin(), g->succStart.cend() - 1);
+  for(int i = 0; i < n; ++i)
+  {
+    const RouteList* rl = g->nodes[i]->inRoutes();
+    for(ciRoute ir = rl->cbegin(); ir != rl->cend(); ++ir)
+    {
+      if(ir->type != Route::TRACK_ROUTE || !ir->track || ir->track->isMidiTrack())
+        continue;
+      std::map<const Track*, int>::const_iterator is = nodeIndex.find(ir->track);
+      if(is != nodeIndex.cend())
+        g->succ[fill[is->second]++] = i;
+    }
+  }
+
+  // Routes should never be circular, but a cycle would stall the workers forever.
+  // Make sure every node can be reached in dependency order.
+  {
+    std::vector<int> deps(g->nodeDeps);
+    std::vector<int> ready;
+    for(int i = 0; i < n; ++i)
+      if(deps[i] == 0)
+        ready.push_back(i);
+    int reached = 0;
+    while(!ready.empty())
+    {
+      const int node = ready.back();
+      ready.pop_back();
+      ++reached;
+      for(int s = g->succStart[node]; s < g->succStart[node + 1]; ++s)
+        if(--deps[g->succ[s]] == 0)
+          ready.push_back(g->succ[s]);
+    }
+    if(reached != n)
+    {
+      fprintf(stderr, "AudioGraphScheduler: Circular routes detected. Using serial processing.\n");
+      g->nodes.clear();
+      g->nodeDeps.clear();
+      g->succStart.clear();
+      g->succ.clear();
+      g->preNodes.clear();
+      return g;
+    }
+  }
+
+  if(n > 0)
+  {
+    g->pendingDeps = new std::atomic<int>[n];
+    g->readyQueue = new std::atomic<int>[n];
+  }
+
+  DEBUG_AUDIO_GRAPH(stderr, "AudioGraphScheduler::build: nodes:%d edges:%d audio inputs:%d\n",
+                    n, int(g->succ.size()), int(g->preNodes.size()));
+  return g;
+}
+
+//---------------------------------------------------------
+//   push
+//    Makes a node available to all threads.
+//---------------------------------------------------------
+
+inline void AudioGraphScheduler::push(int node)
+{
+  const int slot = _readyWrite.fetch_add(1, std::memory_order_relaxed);
+  _graph->readyQueue[slot].store(node, std::memory_order_release);
+}
+
+//---------------------------------------------------------
+//   processNode
+//---------------------------------------------------------
+
+void AudioGraphScheduler::processNode(int node)
+{
+  AudioTrack* track = _graph->nodes[node];
+  // No destination channels. This only fills the track's own output cache,
+  //  exactly like processing an unconnected track does.
+  track->copyData(_pos, -1, track->channels(), 0, -1, -1, _frames, nullptr);
+
+  for(int s = _graph->succStart[node]; s < _graph->succStart[node + 1]; ++s)
+  {
+    const int succ = _graph->succ[s];
+    if(_graph->pendingDeps[succ].fetch_sub(1, std::memory_order_acq_rel) == 1)
+      push(succ);
+  }
+}
+
+//---------------------------------------------------------
+//   runJobs
+//    Claims and processes nodes until all nodes of the cycle are claimed.
+//---------------------------------------------------------
+
+void AudioGraphScheduler::runJobs()
+{
+  const int n = _graph->nodes.size();
+  for(;;)
+  {
+    int idx = _readyRead.load(std::memory_order_relaxed);
+    if(idx >= n)
+      return;
+    if(!_readyRead.compare_exchange_weak(idx, idx + 1, std::memory_order_acq_rel))
+      continue;
+    // The slot is ours. Its node may not be ready yet, but some other thread
+    //  is processing one of its dependencies, so it will be soon.
+    int node;
+    while((node = _graph->readyQueue[idx].load(std::memory_order_acquire)) < 0)
+      cpuRelax();
+    processNode(node);
+  }
+}
+
+//---------------------------------------------------------
+//   workerLoop
+//---------------------------------------------------------
+
+void AudioGraphScheduler::workerLoop()
+{
+  for(;;)
+  {
+    while(sem_wait(&_wakeSem) == -1 && errno == EINTR)
+      ;
+    if(_quit.load(std::memory_order_acquire))
+      return;
+    runJobs();
+    _workersDone.fetch_add(1, std::memory_order_release);
+  }
+}
+
+//---------------------------------------------------------
+//   process
+//---------------------------------------------------------
+
+void AudioGraphScheduler::process(unsigned pos, unsigned frames)
+{
+  if(_numWorkers == 0)
+    return;
+
+  // Take the graph for the current routes, if the gui thread has built it.
+  // The one it replaces is handed back for deleting, one at a time.
+  const int gen = _generation.load(std::memory_order_acquire);
+  if(!_graph || _graph->generation != gen)
+  {
+    Graph* g = _pendingGraph.load(std::memory_order_acquire);
+    if(g && g->generation == gen && _retiredGraph.load(std::memory_order_acquire) == nullptr &&
+       _pendingGraph.compare_exchange_strong(g, nullptr, std::memory_order_acq_rel))
+    {
+      _retiredGraph.store(_graph, std::memory_order_release);
+      _graph = g;
+    }
+    // Otherwise the serial pass does it all, the graph may refer to tracks which are gone.
+    if(!_graph || _graph->generation != gen)
+      return;
+  }
+
+  const int n = _graph->nodes.size();
+  if(n == 0)
+    return;
+
+  // Audio inputs read the device ports, so keep them on this thread.
+  for(std::vector<AudioTrack*>::const_iterator it = _graph->preNodes.cbegin(); it != _graph->preNodes.cend(); ++it)
+  {
+    if(!(*it)->processed())
+      (*it)->copyData(pos, -1, (*it)->channels(), 0, -1, -1, frames, nullptr);
+  }
+
+  _pos = pos;
+  _frames = frames;
+  _readyWrite.store(0, std::memory_order_relaxed);
+  _workersDone.store(0, std::memory_order_relaxed);
+  for(int i = 0; i < n; ++i)
+  {
+    _graph->pendingDeps[i].store(_graph->nodeDeps[i], std::memory_order_relaxed);
+    _graph->readyQueue[i].store(-1, std::memory_order_relaxed);
+  }
+  for(int i = 0; i < n; ++i)
+  {
+    if(_graph->nodeDeps[i] == 0)
+      push(i);
+  }
+  _readyRead.store(0, std::memory_order_release);
+
+  for(int i = 0; i < _numWorkers; ++i)
+    sem_post(&_wakeSem);
+
+  // Help out.
+  runJobs();
+
+  // Wait for all workers to finish. Every node has been claimed by now,
+  //  so this only waits for the nodes still being processed.
+  for(int spins = 0; _workersDone.load(std::memory_order_acquire) < _numWorkers; ++spins)
+  {
+    if(spins < 1024)
+      cpuRelax();
+    else
+      sched_yield();
+  }
+}
+
+} // namespace MusECore
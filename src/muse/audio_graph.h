@@ -0,0 +1,150 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  audio_graph.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __AUDIO_GRAPH_H__
+#define __AUDIO_GRAPH_H__
+
+#include <atomic>
+#include <vector>
+#include <pthread.h>
+#include <semaphore.h>
+
+namespace MusECore {
+
+class AudioTrack;
+
+//---------------------------------------------------------
+//   AudioGraphScheduler
+//
+//   Processes independent audio track branches in parallel,
+//    before Audio::process1() runs its usual serial pass.
+//
+//   AudioTrack::copyData() already caches each track's output
+//    for the rest of the cycle. So if every track which can be
+//    processed independently has already been processed (in
+//    dependency order) by the time the AudioOutputs pull their
+//    data, the serial pass simply picks up the cached results.
+//
+//   Only Wave, Group and Synth tracks without active aux sends
+//    (and whose sources qualify as well) take part. Everything
+//    which touches shared buffers - aux sends, aux and output
+//    tracks, the metronome - stays on the serial path, so the
+//    result is bit-identical to the serial path.
+//
+//   The dependency graph is built from the tracks' RouteLists
+//    by the gui thread, in update(), after invalidate() has been
+//    called. The audio thread picks the new graph up at the start
+//    of a cycle and hands the old one back for deleting, so it
+//    never allocates. Until the graph for the current routes has
+//    arrived, it processes everything serially.
+//
+//   The worker threads and the calling (audio) thread claim ready
+//    nodes from a shared lock-free queue, so an idle thread picks
+//    up whatever is ready next.
+//---------------------------------------------------------
+
+class AudioGraphScheduler {
+      struct Graph {
+            // The invalidate() count this graph was built for.
+            int generation;
+            // Parallel nodes.
+            std::vector<AudioTrack*> nodes;
+            // Number of graph predecessors of each node.
+            std::vector<int> nodeDeps;
+            // Successors of node i are succ[succStart[i]] to succ[succStart[i + 1] - 1].
+            std::vector<int> succStart;
+            std::vector<int> succ;
+            // Audio inputs feeding any node. These are processed serially,
+            //  by the calling thread, before the nodes are dispatched.
+            std::vector<AudioTrack*> preNodes;
+            // Per-cycle state, one per node.
+            std::atomic<int>* pendingDeps;
+            std::atomic<int>* readyQueue;
+
+            Graph(int gen) : generation(gen), pendingDeps(nullptr), readyQueue(nullptr) {}
+            ~Graph() { delete[] pendingDeps; delete[] readyQueue; }
+            };
+
+      // The graph used by the audio thread, or null. Only the audio thread touches it.
+      Graph* _graph;
+      // Built by the gui thread, waiting to be taken by the audio thread.
+      std::atomic<Graph*> _pendingGraph;
+      // Replaced by the audio thread, waiting to be deleted by the gui thread.
+      std::atomic<Graph*> _retiredGraph;
+      // Counts invalidate() calls.
+      std::atomic<int> _generation;
+      // The generation update() last built a graph for. Gui thread only.
+      int _builtGeneration;
+
+      std::atomic<int> _readyWrite;
+      std::atomic<int> _readyRead;
+      // Number of workers which have finished with the current cycle.
+      std::atomic<int> _workersDone;
+
+      std::atomic<bool> _quit;
+
+      int _numWorkers;
+      pthread_t* _workers;
+      sem_t _wakeSem;
+
+      // Current cycle parameters.
+      unsigned _pos;
+      unsigned _frames;
+
+      static Graph* build(int generation);
+      void clearGraphs();
+      void push(int node);
+      void processNode(int node);
+      void runJobs();
+
+   public:
+      AudioGraphScheduler();
+      ~AudioGraphScheduler();
+
+      // Starts the given number of worker threads. Zero disables parallel processing.
+      // Call from gui thread only, while audio is not running.
+      void start(int numWorkers, int priority);
+      // Stops the worker threads. Call from gui thread only, while audio is not running.
+      void stop();
+      bool isRunning() const { return _numWorkers > 0; }
+
+      // Marks the graph for rebuilding. Until it is rebuilt, everything is processed serially.
+      // Can be called from any thread.
+      void invalidate() { _generation.fetch_add(1, std::memory_order_acq_rel); }
+      // The number of invalidate() calls so far.
+      int generation() const { return _generation.load(std::memory_order_acquire); }
+      // Rebuilds the graph if it was invalidated, and deletes the ones the audio thread
+      //  is done with. Call from gui thread only, regularly.
+      void update();
+
+      // Processes all parallel nodes for this cycle, returning when they are all finished.
+      // Call from audio thread only, after preProcessAlways() and processMidi().
+      void process(unsigned pos, unsigned frames);
+
+      // Worker thread loop.
+      void workerLoop();
+      };
+
+} // namespace MusECore
+
+#endif
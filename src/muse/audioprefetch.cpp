@@ -24,9 +24,15 @@
 #ifndef _WIN32
 #include <poll.h>
 #endif
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
+#include <errno.h>
 //#include <limits.h>
+#include <algorithm>
 
 #include "audioprefetch.h"
 #include "globals.h"
@@ -34,6 +40,8 @@
 #include "song.h"
 #include "audio.h"
 #include "sync.h"
+#include "track_freeze.h"
+#include "gconfig.h"
 
 // For debugging transport timing: Uncomment the fprintf section.
 #define AUDIO_PREFETCH_DEBUG_TRANSPORT_SYNC(dev, format, args...) // fprintf(dev, format, ##args);
@@ -44,8 +52,29 @@ MusECore::AudioPrefetch* audioPrefetch = nullptr;
 
 namespace MusECore {
 
+//---------------------------------------------------------
+//   prefetchFifoBlocks
+//    Number of segments holding the given time.
+//---------------------------------------------------------
+
+static unsigned prefetchFifoBlocks(int ms)
+{
+  const unsigned seg = MusEGlobal::segmentSize ? MusEGlobal::segmentSize : 1;
+  const uint64_t frames = uint64_t(ms > 0 ? ms : 0) * MusEGlobal::sampleRate / 1000;
+  unsigned n = (frames + seg - 1) / seg;
+  // Enough for a few batches, and for the audio thread to peek ahead a little.
+  if(n < 8)
+    n = 8;
+  return n;
+}
+
 void initAudioPrefetch()  
 {
+  // The fifos hold a time's worth of audio, whatever the segment size.
+  MusEGlobal::fifoLength = prefetchFifoBlocks(MusEGlobal::config.prefetchReadaheadMs);
+  MusEGlobal::fifoMaxLength = prefetchFifoBlocks(MusEGlobal::config.prefetchMaxReadaheadMs);
+  if(MusEGlobal::fifoMaxLength < MusEGlobal::fifoLength)
+    MusEGlobal::fifoMaxLength = MusEGlobal::fifoLength;
   MusEGlobal::audioPrefetch = new AudioPrefetch("Prefetch");
 }
 
@@ -74,6 +103,24 @@ AudioPrefetch::AudioPrefetch(const char* name)
       {
       seekPos  = ~0;
       seekCount.store(0);
+      _nextJob.store(0);
+      _passType = FillPass;
+      _passSeekPos = 0;
+      _passDoSeek = false;
+      _passDoLoops = false;
+      _passLPos = 0;
+      _passRPos = 0;
+      _passBatch = 1;
+      _numWorkers = 0;
+      _workers = nullptr;
+      _quit.store(false);
+      _batchBuffers = nullptr;
+      _batchFrames = 0;
+      sem_init(&_doneSem, 0, 0);
+      _recWriterRunning = false;
+      _recQuit.store(false);
+      _recFlush.store(false);
+      sem_init(&_recWakeSem, 0, 0);
       }
 
 //---------------------------------------------------------
@@ -104,6 +151,276 @@ void AudioPrefetch::start(int priority, void *)
 
 AudioPrefetch::~AudioPrefetch()
       {
+      stopWorkers();
+      stopRecordWriter();
+      sem_destroy(&_doneSem);
+      sem_destroy(&_recWakeSem);
+      }
+
+//---------------------------------------------------------
+//   threadStart
+//    called from the prefetch thread when it starts
+//---------------------------------------------------------
+
+void AudioPrefetch::threadStart(void*)
+      {
+      startWorkers(MusEGlobal::config.prefetchThreads);
+      startRecordWriter();
+      }
+
+//---------------------------------------------------------
+//   threadStop
+//---------------------------------------------------------
+
+void AudioPrefetch::threadStop()
+      {
+      stopWorkers();
+      stopRecordWriter();
+      }
+
+//---------------------------------------------------------
+//   prefetchWorker
+//---------------------------------------------------------
+
+static void* prefetchWorker(void* p)
+      {
+      AudioPrefetch::Worker* w = (AudioPrefetch::Worker*)p;
+      w->prefetch->workerLoop(w->index);
+      return nullptr;
+      }
+
+//---------------------------------------------------------
+//   startWorkers
+//    The workers run at the prefetch thread's (normal) priority.
+//---------------------------------------------------------
+
+void AudioPrefetch::startWorkers(int numWorkers)
+      {
+      stopWorkers();
+      _quit.store(false);
+      if(numWorkers <= 0)
+        return;
+
+      _workers = new Worker[numWorkers];
+      for(int i = 0; i < numWorkers; ++i)
+      {
+        Worker& w = _workers[_numWorkers];
+        w.prefetch = this;
+        w.index = _numWorkers;
+        sem_init(&w.wakeSem, 0, 0);
+        const int rv = pthread_create(&w.thread, nullptr, prefetchWorker, &w);
+        if(rv)
+        {
+          fprintf(stderr, "AudioPrefetch: Creating worker thread failed: %s\n", strerror(rv));
+          sem_destroy(&w.wakeSem);
+          break;
+        }
+        ++_numWorkers;
+      }
+
+      if(_numWorkers == 0)
+      {
+        delete[] _workers;
+        _workers = nullptr;
+      }
+      }
+
+//---------------------------------------------------------
+//   stopWorkers
+//---------------------------------------------------------
+
+void AudioPrefetch::stopWorkers()
+      {
+      if(_numWorkers > 0)
+      {
+        _quit.store(true);
+        for(int i = 0; i < _numWorkers; ++i)
+          sem_post(&_workers[i].wakeSem);
+        for(int i = 0; i < _numWorkers; ++i)
+        {
+          pthread_join(_workers[i].thread, nullptr);
+          sem_destroy(&_workers[i].wakeSem);
+        }
+        delete[] _workers;
+        _workers = nullptr;
+      }
+
+      // The number of batch buffers depends on the number of workers.
+      freeBatchBuffers();
+      _numWorkers = 0;
+      // In case the prefetch thread was cancelled while waiting for a pass.
+      while(sem_trywait(&_doneSem) == 0) ;
+      }
+
+//---------------------------------------------------------
+//   recordWriter
+//---------------------------------------------------------
+
+static void* recordWriter(void* p)
+      {
+      ((AudioPrefetch*)p)->recordWriterLoop();
+      return nullptr;
+      }
+
+//---------------------------------------------------------
+//   startRecordWriter
+//    The writer runs at the prefetch thread's (normal) priority.
+//---------------------------------------------------------
+
+void AudioPrefetch::startRecordWriter()
+      {
+      stopRecordWriter();
+      _recQuit.store(false);
+      const int rv = pthread_create(&_recWriter, nullptr, recordWriter, this);
+      if(rv)
+      {
+        fprintf(stderr, "AudioPrefetch: Creating record writer thread failed: %s\n", strerror(rv));
+        return;
+      }
+      _recWriterRunning = true;
+      }
+
+//---------------------------------------------------------
+//   stopRecordWriter
+//---------------------------------------------------------
+
+void AudioPrefetch::stopRecordWriter()
+      {
+      if(!_recWriterRunning)
+        return;
+      _recQuit.store(true);
+      sem_post(&_recWakeSem);
+      pthread_join(_recWriter, nullptr);
+      _recWriterRunning = false;
+      while(sem_trywait(&_recWakeSem) == 0) ;
+      }
+
+//---------------------------------------------------------
+//   recordWriterLoop
+//---------------------------------------------------------
+
+void AudioPrefetch::recordWriterLoop()
+      {
+      // The drain below may swallow the post which asks to quit, so the flag
+      //  is checked again before every wait.
+      while(!_recQuit.load())
+      {
+        while(sem_wait(&_recWakeSem) == -1 && errno == EINTR)
+          ;
+        if(_recQuit.load())
+          break;
+        // Ticks which came in while writing are all served by one pass.
+        while(sem_trywait(&_recWakeSem) == 0) ;
+        if(_recQuit.load())
+          break;
+        MusEGlobal::audio->writeTick(_recFlush.exchange(false));
+      }
+      }
+
+//---------------------------------------------------------
+//   workerLoop
+//---------------------------------------------------------
+
+void AudioPrefetch::workerLoop(int index)
+      {
+      Worker& w = _workers[index];
+      for(;;)
+      {
+        sem_wait(&w.wakeSem);
+        if(_quit.load())
+          break;
+        runJobs(index + 1);
+        sem_post(&_doneSem);
+      }
+      }
+
+//---------------------------------------------------------
+//   freeBatchBuffers
+//---------------------------------------------------------
+
+void AudioPrefetch::freeBatchBuffers()
+      {
+      if(!_batchBuffers)
+        return;
+      for(int i = 0; i <= _numWorkers; ++i)
+        free(_batchBuffers[i]);
+      delete[] _batchBuffers;
+      _batchBuffers = nullptr;
+      _batchFrames = 0;
+      }
+
+//---------------------------------------------------------
+//   allocBatchBuffers
+//---------------------------------------------------------
+
+bool AudioPrefetch::allocBatchBuffers(unsigned frames)
+      {
+      if(_batchBuffers && _batchFrames >= frames)
+        return true;
+      if(!_batchBuffers)
+      {
+        _batchBuffers = new float*[_numWorkers + 1];
+        for(int i = 0; i <= _numWorkers; ++i)
+          _batchBuffers[i] = nullptr;
+      }
+      for(int i = 0; i <= _numWorkers; ++i)
+      {
+        free(_batchBuffers[i]);
+        _batchBuffers[i] = nullptr;
+        if(posix_memalign((void**)&_batchBuffers[i], 16, sizeof(float) * frames * MAX_CHANNELS) != 0 || !_batchBuffers[i])
+        {
+          fprintf(stderr, "AudioPrefetch: Cannot allocate batch buffer\n");
+          _batchBuffers[i] = nullptr;
+          _batchFrames = 0;
+          return false;
+        }
+      }
+      _batchFrames = frames;
+      return true;
+      }
+
+//---------------------------------------------------------
+//   runPass
+//---------------------------------------------------------
+
+void AudioPrefetch::runPass()
+      {
+      if(_jobs.empty())
+        return;
+      _nextJob.store(0);
+      // No point in waking more workers than there are jobs for.
+      int woken = std::min(_numWorkers, int(_jobs.size()) - 1);
+      for(int i = 0; i < woken; ++i)
+        sem_post(&_workers[i].wakeSem);
+      runJobs(0);
+      for(int i = 0; i < woken; ++i)
+        sem_wait(&_doneSem);
+      }
+
+//---------------------------------------------------------
+//   runJobs
+//---------------------------------------------------------
+
+void AudioPrefetch::runJobs(int index)
+      {
+      const int n = _jobs.size();
+      for(int i = _nextJob.fetch_add(1); i < n; i = _nextJob.fetch_add(1))
+      {
+        if(_quit.load(std::memory_order_relaxed))
+          break;
+        WaveTrack* track = _jobs[i].track;
+        if(_passType == SeekPass)
+        {
+          const int target = track->prefetchStats()->targetDepth.load(std::memory_order_relaxed);
+          track->prefetchFifo()->setDepth(target > 0 ? target : int(MusEGlobal::fifoLength));
+          track->clearPrefetchFifo();
+          track->setPrefetchWritePos(_passSeekPos);
+          track->seekData(_passSeekPos);
+          track->loopCache()->setStreamStale(false);
+        }
+        else
+          fillTrack(_jobs[i], _batchBuffers ? _batchBuffers[index] : nullptr);
+      }
       }
 
 //---------------------------------------------------------
@@ -121,7 +438,13 @@ void AudioPrefetch::processMsg1(const void* m)
                         fprintf(stderr, "AudioPrefetch::processMsg1: PREFETCH_TICK: isRecTick running:%d seekCount:%d\n",
                                 isRunning(), seekCount.load());
                         #endif
-                        MusEGlobal::audio->writeTick();
+                        // Only the tick sent at stop is no play tick. It writes out the last batches.
+                        if(!msg->_isPlayTick)
+                          _recFlush.store(true);
+                        if(_recWriterRunning)
+                          sem_post(&_recWakeSem);
+                        else
+                          MusEGlobal::audio->writeTick(_recFlush.exchange(false));
                   }
 
                   // Indicate do not seek file before each read.
@@ -216,6 +539,20 @@ void AudioPrefetch::prefetch(bool doSeek)
         rpos_frame = MusEGlobal::song->rPos().frame();
       }
 
+      _passType = FillPass;
+      _passDoSeek = doSeek;
+      _passDoLoops = do_loops;
+      _passLPos = lpos_frame;
+      _passRPos = rpos_frame;
+      _passBatch = MusEGlobal::config.prefetchBatchSegments;
+      if(_passBatch < 1 || MusEGlobal::segmentSize == 0)
+        _passBatch = 1;
+      if(_passBatch > (unsigned)MusEGlobal::fifoLength)
+        _passBatch = MusEGlobal::fifoLength;
+      if(_passBatch > 1 && !allocBatchBuffers(_passBatch * MusEGlobal::segmentSize))
+        _passBatch = 1;
+
+      _jobs.clear();
       WaveTrackList* tl = MusEGlobal::song->waves();
       for (iWaveTrack it = tl->begin(); it != tl->end(); ++it) {
             WaveTrack* track = *it;
@@ -223,8 +560,20 @@ void AudioPrefetch::prefetch(bool doSeek)
             if(track->off())
               continue;
 
-            Fifo* fifo = track->prefetchFifo();
-            const int empty_count = fifo->getEmptyCount();
+            const int empty_count = track->prefetchFifo()->getEmptyCount();
+            const int fill = track->prefetchFifo()->depth() - empty_count;
+
+            // Keep statistics of the margin left when refilling during play.
+            //  After a seek the fifo is always empty, that says nothing.
+            if(!doSeek)
+            {
+              PrefetchStats* st = track->prefetchStats();
+              st->fill.store(fill, std::memory_order_relaxed);
+              const int min_fill = st->minFill.load(std::memory_order_relaxed);
+              if(min_fill < 0 || fill < min_fill)
+                st->minFill.store(fill, std::memory_order_relaxed);
+              adaptDepth(track, fill);
+            }
 
             // Diagnostics.
             //if(empty_count >= 256)
@@ -237,57 +586,220 @@ void AudioPrefetch::prefetch(bool doSeek)
               continue;
             }
 
-            unsigned int write_pos = track->prefetchWritePos();
-            if (write_pos == ~0U) {
-                  fprintf(stderr, "AudioPrefetch::prefetch: invalid track write position\n");
-                  continue;
-                  }
+            Job job;
+            job.track = track;
+            job.fill = fill;
+            // Get going again soon after a seek. A deeper fifo fills up while playing.
+            job.limit = doSeek ? std::min(empty_count, int(MusEGlobal::fifoLength)) : empty_count;
+            _jobs.push_back(job);
+            }
 
-            int ch           = track->channels();
-            float* bp[ch];
+      // Emptiest first.
+      std::sort(_jobs.begin(), _jobs.end());
+      runPass();
 
-            AUDIO_PREFETCH_DEBUG_TRANSPORT_SYNC(stderr, "AudioPrefetch::prefetch: Filling empty_count:%d do_loops:%d lpos_frame:%d rpos_frame:%d\n",
-                    empty_count, do_loops, lpos_frame, rpos_frame);
+      // Frozen tracks play their rendered output.
+      TrackList* all = MusEGlobal::song->tracks();
+      for (iTrack it = all->begin(); it != all->end(); ++it) {
+            if((*it)->isMidiTrack())
+              continue;
+            AudioTrack* track = static_cast<AudioTrack*>(*it);
+            if(track->off() || !track->isFrozen())
+              continue;
+            track->freeze()->prefetch(do_loops, lpos_frame, rpos_frame);
+            }
+      }
+
+//---------------------------------------------------------
+//   adaptDepth
+//---------------------------------------------------------
+
+void AudioPrefetch::adaptDepth(WaveTrack* track, int fill)
+      {
+      PrefetchStats* st = track->prefetchStats();
+      const Fifo* fifo = track->prefetchFifo();
+      const int depth = fifo->depth();
+      int target = st->targetDepth.load(std::memory_order_relaxed);
+      if(target <= 0)
+        target = MusEGlobal::fifoLength;
+
+      const unsigned underruns = st->underruns.load(std::memory_order_relaxed);
+      // The statistics may have been reset.
+      if(underruns < st->seenUnderruns)
+        st->seenUnderruns = underruns;
+
+      int want = target;
+      if(underruns != st->seenUnderruns)
+      {
+        st->seenUnderruns = underruns;
+        want = std::max(target, depth * 2);
+      }
+      // Down to a quarter of the normal readahead while playing: The reads are
+      //  barely keeping up. Once per depth, until a seek puts the raised one in place.
+      else if(target <= depth && fill < std::min(depth, int(MusEGlobal::fifoLength)) / 4)
+        want = depth + depth / 2;
+
+      if(want > fifo->capacity())
+        want = fifo->capacity();
+      if(want > target)
+      {
+        st->targetDepth.store(want, std::memory_order_relaxed);
+        st->depthRaises.fetch_add(1, std::memory_order_relaxed);
+      }
+      }
+
+//---------------------------------------------------------
+//   fillTrack
+//    Fills the track's empty fifo blocks, reading up to a
+//     batch of blocks at a time into the batch buffer.
+//---------------------------------------------------------
+
+void AudioPrefetch::fillTrack(const Job& job, float* batchBuffer)
+      {
+      WaveTrack* track = job.track;
+      Fifo* fifo = track->prefetchFifo();
+      int empty_count = std::min(fifo->getEmptyCount(), job.limit);
+
+      unsigned int write_pos = track->prefetchWritePos();
+      if (write_pos == ~0U) {
+            fprintf(stderr, "AudioPrefetch::prefetch: invalid track write position\n");
+            return;
+            }
+
+      const unsigned seg = MusEGlobal::segmentSize;
+      const unsigned batch = batchBuffer ? _passBatch : 1;
+      const int ch = track->channels();
+      float* bp[ch];
+      PrefetchStats* st = track->prefetchStats();
+      bool doSeek = _passDoSeek;
+
+      // Blocks inside the loop region are kept in memory on the first pass
+      //  and copied from there on the later ones.
+      WaveLoopCache* lc = nullptr;
+      if(_passDoLoops)
+      {
+        if(track->loopCache()->setRegion(_passLPos >= seg ? _passLPos - seg : 0, _passRPos, ch))
+          lc = track->loopCache();
+      }
+      else if(track->loopCache()->bytes())
+        track->loopCache()->release();
+
+      AUDIO_PREFETCH_DEBUG_TRANSPORT_SYNC(stderr, "AudioPrefetch::prefetch: Filling empty_count:%d do_loops:%d lpos_frame:%d rpos_frame:%d\n",
+              empty_count, _passDoLoops, _passLPos, _passRPos);
 
-            // Fill up the empty buffers.
-            for(int i = 0; i < empty_count; ++i)
+      // Fill up the empty buffers.
+      while(empty_count > 0)
+      {
+        if(_passDoLoops)
+        {
+          unsigned n = _passRPos - write_pos;
+
+          AUDIO_PREFETCH_DEBUG_TRANSPORT_SYNC(stderr, "  do loops: write_pos:%d n:%d segmentSize:%d\n",
+                  write_pos, n, seg);
+
+          if (n < seg)
+          {
+            // adjust loop start so we get exact loop len
+            if (n > _passLPos)
+                  n = 0;
+            write_pos = _passLPos - n;
+            AUDIO_PREFETCH_DEBUG_TRANSPORT_SYNC(stderr, "  looping: new write_pos:%d\n", write_pos);
+
+            track->setPrefetchWritePos(write_pos);
+            track->seekData(write_pos);
+            if(lc)
+              lc->setStreamStale(false);
+          }
+        }
+
+        if(lc)
+        {
+          if(lc->contains(write_pos, seg))
+          {
+            if (fifo->getWriteBuffer(ch, seg, bp, write_pos))
+            {
+              fprintf(stderr, "AudioPrefetch::prefetch: No write buffer!\n");
+              break;
+            }
+            lc->read(write_pos, seg, bp);
+            fifo->add();
+            write_pos += seg;
+            track->setPrefetchWritePos(write_pos);
+            // The sound files did not move along. Seek them before reading again.
+            lc->setStreamStale(true);
+            --empty_count;
+            continue;
+          }
+          if(lc->streamStale())
+          {
+            track->seekData(write_pos);
+            lc->setStreamStale(false);
+          }
+        }
+
+        // How many blocks can be read in one go: Up to a batch, but not past the loop end.
+        unsigned k = 1;
+        while(k < batch && int(k) < empty_count)
+        {
+          if(_passDoLoops && _passRPos - (write_pos + k * seg) < seg)
+            break;
+          ++k;
+        }
+
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+
+        if(k == 1)
+        {
+          // Straight into the fifo.
+          if (fifo->getWriteBuffer(ch, seg, bp, write_pos))
+          {
+            fprintf(stderr, "AudioPrefetch::prefetch: No write buffer!\n");
+            break;
+          }
+          // True = do overwrite.
+          track->readData(write_pos, seg, bp, doSeek, true);
+          if(lc)
+            lc->store(write_pos, seg, bp);
+          fifo->add();
+          write_pos += seg;
+          track->setPrefetchWritePos(write_pos);
+        }
+        else
+        {
+          for(int i = 0; i < ch; ++i)
+            bp[i] = batchBuffer + i * _batchFrames;
+          // True = do overwrite.
+          track->readData(write_pos, k * seg, bp, doSeek, true);
+          if(lc)
+            lc->store(write_pos, k * seg, bp);
+
+          float* wbp[ch];
+          for(unsigned b = 0; b < k; ++b)
+          {
+            if (fifo->getWriteBuffer(ch, seg, wbp, write_pos))
             {
-              if(do_loops)
-              {
-                unsigned n = rpos_frame - write_pos;
-
-                AUDIO_PREFETCH_DEBUG_TRANSPORT_SYNC(stderr, "  do loops: write_pos:%d n:%d segmentSize:%d\n",
-                        write_pos, n, MusEGlobal::segmentSize);
-
-                if (n < MusEGlobal::segmentSize)
-                {
-                  // adjust loop start so we get exact loop len
-                  if (n > lpos_frame)
-                        n = 0;
-                  write_pos = lpos_frame - n;
-                  AUDIO_PREFETCH_DEBUG_TRANSPORT_SYNC(stderr, "  looping: new write_pos:%d\n", write_pos);
-
-                  track->setPrefetchWritePos(write_pos);
-                  track->seekData(write_pos);
-                }
-              }
-
-              if (fifo->getWriteBuffer(ch, MusEGlobal::segmentSize, bp, write_pos))
-              {
-                fprintf(stderr, "AudioPrefetch::prefetch: No write buffer!\n");
-                break;
-              }
-
-              // True = do overwrite.
-              track->fetchData(write_pos, MusEGlobal::segmentSize, bp, doSeek, true);
-              
-              // Only the first fetch should seek if required. Reset the flag now.
-              doSeek = false;
-              
-              write_pos += MusEGlobal::segmentSize;
-              track->setPrefetchWritePos(write_pos);
+              fprintf(stderr, "AudioPrefetch::prefetch: No write buffer!\n");
+              empty_count = 0;
+              break;
             }
+            for(int i = 0; i < ch; ++i)
+              memcpy(wbp[i], bp[i] + b * seg, sizeof(float) * seg);
+            fifo->add();
+            write_pos += seg;
+            track->setPrefetchWritePos(write_pos);
           }
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        st->blocksRead.fetch_add(k, std::memory_order_relaxed);
+        st->readUs.fetch_add((t1.tv_sec - t0.tv_sec) * 1000000L + (t1.tv_nsec - t0.tv_nsec) / 1000L,
+                             std::memory_order_relaxed);
+
+        // Only the first fetch should seek if required. Reset the flag now.
+        doSeek = false;
+        empty_count -= k;
+      }
       }
 
 //---------------------------------------------------------
@@ -316,12 +828,27 @@ void AudioPrefetch::seek(unsigned seekTo)
         return;
       }
 
+      // Seeking can take a while with resampling, so spread it over the workers, too.
+      _passType = SeekPass;
+      _passSeekPos = seekTo;
+      _jobs.clear();
       WaveTrackList* tl = MusEGlobal::song->waves();
       for (iWaveTrack it = tl->begin(); it != tl->end(); ++it) {
-            WaveTrack* track = *it;
-            track->clearPrefetchFifo();
-            track->setPrefetchWritePos(seekTo);
-            track->seekData(seekTo);
+            Job job;
+            job.track = *it;
+            job.fill = 0;
+            job.limit = 0;
+            _jobs.push_back(job);
+            }
+      runPass();
+
+      TrackList* all = MusEGlobal::song->tracks();
+      for (iTrack it = all->begin(); it != all->end(); ++it) {
+            if((*it)->isMidiTrack())
+              continue;
+            AudioTrack* track = static_cast<AudioTrack*>(*it);
+            if(track->isFrozen())
+              track->freeze()->seek(seekTo);
             }
 
       // Indicate do a seek command before read (only on the first fetch).
@@ -25,22 +25,121 @@
 #define __AUDIOPREFETCH_H__
 
 #include <atomic>
+#include <vector>
+#include <pthread.h>
+#include <semaphore.h>
 
 #include "thread.h"
 
 namespace MusECore {
 
+class WaveTrack;
+
 //---------------------------------------------------------
 //   AudioPrefetch
+//
+//   Reads wave track data from disk ahead of the transport
+//    into each track's prefetch fifo.
+//
+//   The prefetch thread receives the tick and seek messages.
+//    Each seek or fill pass is split into one job per track,
+//    which the prefetch thread and a pool of worker threads
+//    take in turn, so one slow file or a heavily resampled
+//    part does not hold up all the other tracks. Fill jobs
+//    are taken emptiest fifo first, and each job reads up to
+//    config.prefetchBatchSegments blocks at a time.
+//
+//   The fifos hold config.prefetchReadaheadMs of audio. When
+//    a track underruns, or its fifo runs low while playing,
+//    its depth is raised, up to config.prefetchMaxReadaheadMs.
+//    The new depth is used from the next seek on, since the
+//    fifo can only be resized while it is cleared. A seek only
+//    fills the normal depth before it is done, the rest is
+//    filled while playing.
+//
+//   Every track reads its own sound file instances (wave
+//    events never share them, not even between clones), so
+//    the jobs are independent. A pass ends when all of its
+//    jobs are done, so the message handling stays as it was.
+//
+//   Recording ticks wake a separate record writer thread,
+//    which moves the record fifos into the tracks' record
+//    batches and writes them, so writing never holds up
+//    reading and the other way round. The tick sent at stop
+//    makes it write out the last batches.
 //---------------------------------------------------------
 
 class AudioPrefetch : public Thread {
+   public:
+      struct Worker {
+            AudioPrefetch* prefetch;
+            int index;
+            pthread_t thread;
+            sem_t wakeSem;
+            };
+
+   private:
+      enum PassType { SeekPass, FillPass };
+      struct Job {
+            WaveTrack* track;
+            // Filled fifo blocks when the pass began. Emptiest goes first.
+            int fill;
+            // The most blocks to fill.
+            int limit;
+            bool operator<(const Job& j) const { return fill < j.fill; }
+            };
+
       unsigned seekPos; // remember last seek to optimize seeks
 
+      // The current pass. Set up by the prefetch thread before waking the workers.
+      std::vector<Job> _jobs;
+      std::atomic<int> _nextJob;
+      PassType _passType;
+      unsigned _passSeekPos;
+      bool _passDoSeek;
+      bool _passDoLoops;
+      unsigned _passLPos;
+      unsigned _passRPos;
+      unsigned _passBatch;
+
+      int _numWorkers;
+      Worker* _workers;
+      sem_t _doneSem;
+      std::atomic<bool> _quit;
+      // The record writer thread.
+      pthread_t _recWriter;
+      bool _recWriterRunning;
+      sem_t _recWakeSem;
+      std::atomic<bool> _recQuit;
+      // Whether the next write should write out the batches too.
+      std::atomic<bool> _recFlush;
+
+      // One batch buffer for the prefetch thread (index 0) and each worker.
+      float** _batchBuffers;
+      // Frames per channel in each batch buffer.
+      unsigned _batchFrames;
+
       virtual void processMsg1(const void*);
+      virtual void threadStart(void*);
+      virtual void threadStop();
       void prefetch(bool doSeek);
       void seek(unsigned pos);
 
+      void startWorkers(int numWorkers);
+      void stopWorkers();
+      void startRecordWriter();
+      void stopRecordWriter();
+      // Makes sure the batch buffers hold frames per channel. Prefetch thread only, between passes.
+      bool allocBatchBuffers(unsigned frames);
+      void freeBatchBuffers();
+      // Runs the jobs of the current pass on all the threads, and waits for them.
+      void runPass();
+      // Takes jobs until there are none left. index is 0 for the prefetch thread, or the worker's index + 1.
+      void runJobs(int index);
+      void fillTrack(const Job& job, float* batchBuffer);
+      // Raises the track's fifo depth if it underran or ran low. Prefetch thread only.
+      void adaptDepth(WaveTrack* track, int fill);
+
       std::atomic<int> seekCount;
 
    public:
@@ -53,6 +152,11 @@ class AudioPrefetch : public Thread {
       void msgSeek(unsigned samplePos, bool force=false);
       
       bool seekDone() const;
+
+      // Record writer thread loop.
+      void recordWriterLoop();
+      // Worker thread loop.
+      void workerLoop(int index);
       };
 
 } // namespace MusECore
@@ -26,6 +26,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <map>
+#include <set>
+#include <vector>
+#include <algorithm>
 
 #include <QMessageBox>
 
@@ -48,6 +51,7 @@
 #include "latency_compensator.h"
 #include "ticksynth.h"
 #include "xml_statistics.h"
+#include "track_freeze.h"
 
 namespace MusECore {
 
@@ -299,6 +303,10 @@ AudioTrack::AudioTrack(TrackType t, int channels)
       _sendMetronome = false;
       _prefader = false;
       _efxPipe  = new Pipeline();
+      _freeze = nullptr;
+      _reachesOutput = false;
+      _reachesOutputValid = false;
+      _reachesOutputGeneration = 0;
       recFileNumber = 1;
       _channels = 0;
       _automationType = AUTO_OFF;
@@ -344,6 +352,10 @@ AudioTrack::AudioTrack(const AudioTrack& t, int flags)
       _processed      = false;
       _haveData       = false;
       _efxPipe        = new Pipeline();                 // Start off with a new pipeline.
+      _freeze         = nullptr;                        // A copy is not frozen.
+      _reachesOutput = false;
+      _reachesOutputValid = false;
+      _reachesOutputGeneration = 0;
       recFileNumber = 1;
 
       CtrlList *cl = new CtrlList(AC_VOLUME,"Volume",0.0,3.16227766017 /* roughly 10 db */, VAL_LOG);
@@ -563,6 +575,12 @@ AudioTrack::~AudioTrack()
 {
       delete _efxPipe;
 
+      if(_freeze)
+      {
+        _freeze->discard();
+        delete _freeze;
+      }
+
       if(audioInSilenceBuf)
         free(audioInSilenceBuf);
 
@@ -972,6 +990,9 @@ bool AudioTrack::useLatencyCorrection() const
 
 float AudioTrack::selfLatencyAudio(int /*channel*/) const
 {
+  // The plugins of a frozen track are off. Its output carries their latency.
+  if(isFrozen())
+    return _freeze->latency();
   if(!_efxPipe)
     return 0.0;
   return _efxPipe->latency();
@@ -1290,8 +1311,11 @@ float AudioTrack::getWorstPluginLatencyAudio()
     return _latencyInfo._worstPluginLatency;
 
   float worst_lat = 0.0f;
+  // The output of a frozen track carries the latency it was rendered with.
+  if(isFrozen())
+    worst_lat = _freeze->latency();
   // Include the effects rack latency.
-  if(_efxPipe)
+  else if(_efxPipe)
     worst_lat += _efxPipe->latency();
   
   _latencyInfo._worstPluginLatency = worst_lat;
@@ -1925,6 +1949,8 @@ void AudioTrack::writeProperties(int level, Xml& xml) const
                   (*ip)->writeConfiguration(level, xml);
             }
       _controller.write(level, xml);
+      if (_freeze)
+            _freeze->write(level, xml);
       }
 
 //---------------------------------------------------------
@@ -1992,6 +2018,16 @@ bool AudioTrack::readProperties(Xml& xml, const QString& tag)
       }
       else if (tag == "auxSend")
             readAuxSend(xml);
+      else if (tag == "freeze") {
+            TrackFreeze* f = TrackFreeze::readFromXml(xml, this);
+            if (f) {
+                  if (_freeze) {
+                        _freeze->discard();
+                        delete _freeze;
+                        }
+                  _freeze = f;
+                  }
+            }
       else if (tag == "prefader")
             _prefader = xml.parseInt();
       else if (tag == "sendMetronome")
@@ -2232,7 +2268,73 @@ void AudioTrack::guiHeartBeat()
 {
   auto p = efxPipe();
   if(p)
+  {
+    // Plugins left uninstantiated by a lazy project load are made
+    //  once the track is switched on and routed to an output.
+    if(p->hasPendingInstances() && !off() && reachesAudioOutput())
+      p->makePendingInstances();
     p->guiHeartBeat();
+  }
+}
+
+//---------------------------------------------------------
+//   reachesAudioOutput
+//    Worked out again only after routes, aux sends or
+//     tracks changed, see Audio::graphChanged().
+//---------------------------------------------------------
+
+bool AudioTrack::reachesAudioOutput() const
+{
+  const int gen = MusEGlobal::audio->graphGeneration();
+  if(!_reachesOutputValid || _reachesOutputGeneration != gen)
+  {
+    _reachesOutput = findAudioOutput();
+    _reachesOutputValid = true;
+    _reachesOutputGeneration = gen;
+  }
+  return _reachesOutput;
+}
+
+//---------------------------------------------------------
+//   findAudioOutput
+//---------------------------------------------------------
+
+bool AudioTrack::findAudioOutput() const
+{
+  std::set<const Track*> visited;
+  std::vector<const AudioTrack*> todo;
+  todo.push_back(this);
+  visited.insert(this);
+  const AuxList* al = MusEGlobal::song->auxs();
+  while(!todo.empty())
+  {
+    const AudioTrack* t = todo.back();
+    todo.pop_back();
+    if(t->type() == AUDIO_OUTPUT)
+      return true;
+
+    const RouteList* rl = t->outRoutes();
+    for(ciRoute ir = rl->begin(); ir != rl->end(); ++ir)
+    {
+      if(ir->type != Route::TRACK_ROUTE || !ir->track || ir->track->isMidiTrack())
+        continue;
+      if(visited.insert(ir->track).second)
+        todo.push_back(static_cast<const AudioTrack*>(ir->track));
+    }
+
+    if(!t->hasAuxSend())
+      continue;
+    const std::size_t sz = std::min(t->_auxSend.size(), al->size());
+    for(std::size_t i = 0; i < sz; ++i)
+    {
+      if(t->_auxSend[i] <= 0.0001)
+        continue;
+      const AudioAux* aux = al->index(i);
+      if(visited.insert(aux).second)
+        todo.push_back(aux);
+    }
+  }
+  return false;
 }
 
 //---------------------------------------------------------
@@ -3042,6 +3144,7 @@ bool AudioTrack::prepareRecording()
       // For bounce operations: Reset these.
       _recFilePos = 0;
       _previousLatency = 0.0f;
+      _recBatch.resetStats();
 
       return true;
 }
@@ -0,0 +1,385 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//  dsp_profiler_dialog.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <QTabWidget>
+#include <QTreeWidget>
+#include <QTreeWidgetItem>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTimer>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QShowEvent>
+#include <QHideEvent>
+
+#include "dsp_profiler_dialog.h"
+#include "dsp_profiler.h"
+#include "globals.h"
+#include "song.h"
+#include "track.h"
+#include "synth.h"
+#include "ticksynth.h"
+#include "plugin.h"
+
+namespace MusEGui {
+
+const int DspProfilerDialog::_updateInterval = 500;
+
+//---------------------------------------------------------
+//   DspProfilerItem
+//    Sorts the figure columns by value rather than by text.
+//---------------------------------------------------------
+
+class DspProfilerItem : public QTreeWidgetItem
+{
+  public:
+    DspProfilerItem(QTreeWidget* parent) : QTreeWidgetItem(parent) { }
+
+    bool operator<(const QTreeWidgetItem& other) const override
+    {
+      const int col = treeWidget() ? treeWidget()->sortColumn() : 0;
+      if(col >= DspProfilerDialog::ColAvg)
+        return data(col, Qt::UserRole).toDouble() < other.data(col, Qt::UserRole).toDouble();
+      return QTreeWidgetItem::operator<(other);
+    }
+};
+
+//---------------------------------------------------------
+//   PrefetchStatsItem
+//---------------------------------------------------------
+
+class PrefetchStatsItem : public QTreeWidgetItem
+{
+  public:
+    PrefetchStatsItem(QTreeWidget* parent) : QTreeWidgetItem(parent) { }
+
+    bool operator<(const QTreeWidgetItem& other) const override
+    {
+      const int col = treeWidget() ? treeWidget()->sortColumn() : 0;
+      if(col >= DspProfilerDialog::PfColFill)
+        return data(col, Qt::UserRole).toDouble() < other.data(col, Qt::UserRole).toDouble();
+      return QTreeWidgetItem::operator<(other);
+    }
+};
+
+//---------------------------------------------------------
+//   DspProfilerDialog
+//---------------------------------------------------------
+
+DspProfilerDialog::DspProfilerDialog(QWidget* parent)
+  : QDialog(parent, Qt::Window)
+{
+  setObjectName(QStringLiteral("dsp profiler dialog"));
+  setWindowTitle(tr("DSP Profiler"));
+
+  _tree = new QTreeWidget(this);
+  _tree->setColumnCount(ColCount);
+  _tree->setHeaderLabels(QStringList()
+    << tr("Name") << tr("Type") << tr("Track")
+    << tr("Avg (us)") << tr("p99 (us)") << tr("Max (us)") << tr("Min (us)")
+    << tr("Avg %") << tr("Max %"));
+  _tree->setRootIsDecorated(false);
+  _tree->setAlternatingRowColors(true);
+  _tree->setUniformRowHeights(true);
+  _tree->setSortingEnabled(true);
+  _tree->sortByColumn(ColMax, Qt::DescendingOrder);
+  _tree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+  _prefetchTree = new QTreeWidget(this);
+  _prefetchTree->setColumnCount(PfColCount);
+  _prefetchTree->setHeaderLabels(QStringList()
+    << tr("Track") << tr("Fill") << tr("Readahead (ms)") << tr("Min fill") << tr("Underruns")
+    << tr("Blocks read") << tr("Read (us/block)") << tr("Loop cache") << tr("Record backlog (ms)"));
+  _prefetchTree->headerItem()->setToolTip(PfColFill,
+    tr("Prefetched blocks left when the track was last refilled, out of the fifo depth"));
+  _prefetchTree->headerItem()->setToolTip(PfColReadahead,
+    tr("How far ahead the track is read. It grows after underruns or slow reads,\n"
+       "from the next seek on. A pending raise is shown after the arrow"));
+  _prefetchTree->headerItem()->setToolTip(PfColMinFill,
+    tr("The fewest prefetched blocks left at a refill. Near zero means the disk barely kept up"));
+  _prefetchTree->headerItem()->setToolTip(PfColLoopCache,
+    tr("Memory holding the track's loop region, how much of the region is in it,\n"
+       "and how many blocks were played from it instead of the disk"));
+  _prefetchTree->headerItem()->setToolTip(PfColRecBacklog,
+    tr("Recorded audio not written to disk yet, the most there was since recording\n"
+       "started, and the blocks lost because the record fifo was full"));
+  _prefetchTree->setRootIsDecorated(false);
+  _prefetchTree->setAlternatingRowColors(true);
+  _prefetchTree->setUniformRowHeights(true);
+  _prefetchTree->setSortingEnabled(true);
+  _prefetchTree->sortByColumn(PfColMinFill, Qt::AscendingOrder);
+  _prefetchTree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+  QTabWidget* tabs = new QTabWidget(this);
+  tabs->addTab(_tree, tr("DSP"));
+  tabs->addTab(_prefetchTree, tr("Disk Prefetch"));
+
+  _infoLabel = new QLabel(this);
+
+  QPushButton* resetButton = new QPushButton(tr("Reset"), this);
+  resetButton->setToolTip(tr("Discard the figures gathered so far"));
+  connect(resetButton, &QPushButton::clicked, [this]() { resetClicked(); } );
+
+  QHBoxLayout* hl = new QHBoxLayout;
+  hl->addWidget(_infoLabel, 1);
+  hl->addWidget(resetButton);
+
+  QVBoxLayout* vl = new QVBoxLayout(this);
+  vl->addWidget(tabs);
+  vl->addLayout(hl);
+
+  _timer = new QTimer(this);
+  _timer->setInterval(_updateInterval);
+  connect(_timer, &QTimer::timeout, [this]() { updateStats(); } );
+
+  resize(720, 420);
+}
+
+//---------------------------------------------------------
+//   showEvent
+//---------------------------------------------------------
+
+void DspProfilerDialog::showEvent(QShowEvent* e)
+{
+  QDialog::showEvent(e);
+  if(e->spontaneous())
+    return;
+  MusEGlobal::dspProfiler.acquire();
+  _timer->start();
+}
+
+//---------------------------------------------------------
+//   hideEvent
+//---------------------------------------------------------
+
+void DspProfilerDialog::hideEvent(QHideEvent* e)
+{
+  QDialog::hideEvent(e);
+  if(e->spontaneous())
+    return;
+  _timer->stop();
+  MusEGlobal::dspProfiler.release();
+}
+
+//---------------------------------------------------------
+//   resetClicked
+//---------------------------------------------------------
+
+void DspProfilerDialog::resetClicked()
+{
+  MusEGlobal::dspProfiler.reset();
+  const MusECore::WaveTrackList* wl = MusEGlobal::song->waves();
+  for(MusECore::ciWaveTrack it = wl->cbegin(); it != wl->cend(); ++it)
+    static_cast<MusECore::WaveTrack*>(*it)->prefetchStats()->reset();
+  updateStats();
+}
+
+//---------------------------------------------------------
+//   updateProbe
+//---------------------------------------------------------
+
+void DspProfilerDialog::updateProbe(const MusECore::DspProbe* probe,
+  const QString& name, const QString& type, const QString& track)
+{
+  MusECore::DspProbeStats st;
+  if(!probe->stats(&st))
+    return;
+  _seen.insert(probe);
+
+  QTreeWidgetItem* item = _items.value(probe);
+  if(!item)
+  {
+    item = new DspProfilerItem(_tree);
+    for(int col = ColAvg; col < ColCount; ++col)
+      item->setTextAlignment(col, Qt::AlignRight | Qt::AlignVCenter);
+    _items.insert(probe, item);
+  }
+  item->setText(ColName, name);
+  item->setText(ColType, type);
+  item->setText(ColTrack, track);
+
+  const double vals[ColCount - ColAvg] = { st.avgUs, st.p99Us, st.maxUs, st.minUs, st.avgLoad, st.maxLoad };
+  for(int col = ColAvg; col < ColCount; ++col)
+  {
+    const double v = vals[col - ColAvg];
+    item->setText(col, QString::number(v, 'f', col >= ColAvgLoad ? 2 : 1));
+    item->setData(col, Qt::UserRole, v);
+  }
+}
+
+//---------------------------------------------------------
+//   updateStats
+//---------------------------------------------------------
+
+void DspProfilerDialog::updateStats()
+{
+  MusECore::DspProfiler& prof = MusEGlobal::dspProfiler;
+  _seen.clear();
+
+  // Avoid resorting for every single change.
+  _tree->setSortingEnabled(false);
+
+  updateProbe(prof.cycleProbe(), tr("Audio cycle"), tr("Total"), QString());
+  updateProbe(prof.midiProbe(), tr("Midi processing"), tr("Midi"), QString());
+
+  const MusECore::TrackList* tl = MusEGlobal::song->tracks();
+  for(MusECore::ciTrack it = tl->cbegin(); it != tl->cend(); ++it)
+  {
+    if((*it)->isMidiTrack())
+      continue;
+    MusECore::AudioTrack* at = static_cast<MusECore::AudioTrack*>(*it);
+    updateProbe(at->dspProbe(), at->name(), tr("Track"), at->name());
+    if(at->type() == MusECore::Track::AUDIO_SOFTSYNTH)
+    {
+      MusECore::SynthI* si = static_cast<MusECore::SynthI*>(at);
+      updateProbe(si->synthDspProbe(), si->synth() ? si->synth()->name() : si->name(), tr("Synth"), at->name());
+    }
+    const MusECore::Pipeline* pl = at->efxPipe();
+    if(!pl)
+      continue;
+    for(MusECore::ciPluginI ip = pl->cbegin(); ip != pl->cend(); ++ip)
+    {
+      MusECore::PluginI* p = *ip;
+      if(p)
+        updateProbe(p->dspProbe(), p->name(), tr("Plugin"), at->name());
+    }
+  }
+
+  if(MusECore::metronome)
+    updateProbe(MusECore::metronome->dspProbe(), tr("Metronome"), tr("Track"), QString());
+
+  // Remove the items of things which are gone.
+  for(auto it = _items.begin(); it != _items.end(); )
+  {
+    if(_seen.contains(it.key()))
+    {
+      ++it;
+      continue;
+    }
+    delete it.value();
+    it = _items.erase(it);
+  }
+
+  _tree->setSortingEnabled(true);
+
+  updatePrefetchStats();
+
+  _infoLabel->setText(tr("Cycle period: %1 us. Figures are per cycle, over the last %2 cycles.")
+    .arg(prof.cyclePeriodUs(), 0, 'f', 0).arg(int(MusECore::DspProbe::HistorySize)));
+}
+
+//---------------------------------------------------------
+//   updatePrefetchStats
+//---------------------------------------------------------
+
+void DspProfilerDialog::updatePrefetchStats()
+{
+  _prefetchTree->setSortingEnabled(false);
+
+  QSet<const MusECore::WaveTrack*> seen;
+  const MusECore::WaveTrackList* wl = MusEGlobal::song->waves();
+  for(MusECore::ciWaveTrack it = wl->cbegin(); it != wl->cend(); ++it)
+  {
+    MusECore::WaveTrack* t = static_cast<MusECore::WaveTrack*>(*it);
+    seen.insert(t);
+    QTreeWidgetItem* item = _prefetchItems.value(t);
+    if(!item)
+    {
+      item = new PrefetchStatsItem(_prefetchTree);
+      for(int col = PfColFill; col < PfColCount; ++col)
+        item->setTextAlignment(col, Qt::AlignRight | Qt::AlignVCenter);
+      _prefetchItems.insert(t, item);
+    }
+
+    const MusECore::PrefetchStats* st = t->prefetchStats();
+    const int fill = st->fill.load(std::memory_order_relaxed);
+    const int min_fill = st->minFill.load(std::memory_order_relaxed);
+    const unsigned underruns = st->underruns.load(std::memory_order_relaxed);
+    const unsigned long blocks = st->blocksRead.load(std::memory_order_relaxed);
+    const unsigned long read_us = st->readUs.load(std::memory_order_relaxed);
+    const double us_per_block = blocks ? double(read_us) / double(blocks) : 0.0;
+    const int depth = t->prefetchFifo()->depth();
+    int target = st->targetDepth.load(std::memory_order_relaxed);
+    if(target <= 0)
+      target = MusEGlobal::fifoLength;
+    const double block_ms = MusEGlobal::sampleRate > 0 ?
+      1000.0 * double(MusEGlobal::segmentSize) / double(MusEGlobal::sampleRate) : 0.0;
+    const int depth_ms = int(depth * block_ms + 0.5);
+
+    item->setText(PfColTrack, t->name());
+    item->setText(PfColFill, QString("%1 / %2").arg(fill).arg(depth));
+    item->setData(PfColFill, Qt::UserRole, fill);
+    item->setText(PfColReadahead, target == depth ? QString::number(depth_ms) :
+      QString("%1 -> %2").arg(depth_ms).arg(int(target * block_ms + 0.5)));
+    item->setData(PfColReadahead, Qt::UserRole, depth_ms);
+    item->setText(PfColMinFill, min_fill < 0 ? QString("-") : QString::number(min_fill));
+    item->setData(PfColMinFill, Qt::UserRole, min_fill < 0 ? depth : min_fill);
+    item->setText(PfColUnderruns, QString::number(underruns));
+    item->setData(PfColUnderruns, Qt::UserRole, underruns);
+    item->setText(PfColBlocks, QString::number(blocks));
+    item->setData(PfColBlocks, Qt::UserRole, double(blocks));
+    item->setText(PfColReadTime, QString::number(us_per_block, 'f', 1));
+    item->setData(PfColReadTime, Qt::UserRole, us_per_block);
+
+    const MusECore::WaveLoopCache* lc = t->loopCache();
+    const size_t lc_bytes = lc->bytes();
+    const unsigned lc_region = lc->regionFrames();
+    if(lc_bytes == 0 || lc_region == 0)
+      item->setText(PfColLoopCache, QString("-"));
+    else
+      item->setText(PfColLoopCache, tr("%1 MB, %2%, %3 hits")
+        .arg(double(lc_bytes) / (1024.0 * 1024.0), 0, 'f', 1)
+        .arg(int(100.0 * double(lc->storedFrames()) / double(lc_region)))
+        .arg(lc->hits()));
+    item->setData(PfColLoopCache, Qt::UserRole, double(lc_bytes));
+
+    const MusECore::RecordBatch* rb = t->recordBatch();
+    const unsigned backlog = t->recordBacklog();
+    const unsigned rec_overruns = rb->overruns();
+    const double frame_ms = MusEGlobal::sampleRate > 0 ? 1000.0 / double(MusEGlobal::sampleRate) : 0.0;
+    if(!t->recordFlag() && rb->peakBacklog() == 0)
+      item->setText(PfColRecBacklog, QString("-"));
+    else
+      item->setText(PfColRecBacklog, tr("%1 (peak %2), %3 lost")
+        .arg(int(backlog * frame_ms + 0.5))
+        .arg(int(rb->peakBacklog() * frame_ms + 0.5))
+        .arg(rec_overruns));
+    item->setData(PfColRecBacklog, Qt::UserRole, double(rb->peakBacklog()) + 1e9 * rec_overruns);
+  }
+
+  // Remove the items of tracks which are gone.
+  for(auto it = _prefetchItems.begin(); it != _prefetchItems.end(); )
+  {
+    if(seen.contains(it.key()))
+    {
+      ++it;
+      continue;
+    }
+    delete it.value();
+    it = _prefetchItems.erase(it);
+  }
+
+  _prefetchTree->setSortingEnabled(true);
+}
+
+} // namespace MusEGui
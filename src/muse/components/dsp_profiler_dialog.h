@@ -0,0 +1,88 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//  dsp_profiler_dialog.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __DSP_PROFILER_DIALOG_H__
+#define __DSP_PROFILER_DIALOG_H__
+
+#include <QDialog>
+#include <QHash>
+#include <QSet>
+
+class QTreeWidget;
+class QTreeWidgetItem;
+class QLabel;
+class QTimer;
+class QShowEvent;
+class QHideEvent;
+
+namespace MusECore {
+class DspProbe;
+class WaveTrack;
+}
+
+namespace MusEGui {
+
+//---------------------------------------------------------
+//   DspProfilerDialog
+//    Lists the processing time of every track and plugin,
+//    as recorded by the dsp profiler. Profiling is on while
+//    the dialog is visible. A second page shows how far ahead
+//    the disk prefetch keeps each wave track.
+//---------------------------------------------------------
+
+class DspProfilerDialog : public QDialog {
+      Q_OBJECT
+
+   public:
+      enum Cols { ColName = 0, ColType, ColTrack, ColAvg, ColP99, ColMax, ColMin, ColAvgLoad, ColMaxLoad, ColCount };
+      enum PrefetchCols { PfColTrack = 0, PfColFill, PfColReadahead, PfColMinFill, PfColUnderruns, PfColBlocks, PfColReadTime, PfColLoopCache, PfColRecBacklog, PfColCount };
+
+   private:
+      // In milliseconds.
+      static const int _updateInterval;
+
+      QTreeWidget* _tree;
+      QLabel* _infoLabel;
+      QTimer* _timer;
+      QHash<const MusECore::DspProbe*, QTreeWidgetItem*> _items;
+      // The items seen during the current update.
+      QSet<const MusECore::DspProbe*> _seen;
+
+      QTreeWidget* _prefetchTree;
+      QHash<const MusECore::WaveTrack*, QTreeWidgetItem*> _prefetchItems;
+
+      void updateProbe(const MusECore::DspProbe* probe, const QString& name, const QString& type, const QString& track);
+      void updateStats();
+      void updatePrefetchStats();
+      void resetClicked();
+
+   protected:
+      void showEvent(QShowEvent*) override;
+      void hideEvent(QHideEvent*) override;
+
+   public:
+      DspProfilerDialog(QWidget* parent = nullptr);
+      };
+
+} // namespace MusEGui
+
+#endif
@@ -321,6 +321,8 @@ void GlobalSettingsConfig::apply()
       MusEGlobal::config.correctUnterminatedOutBranchLatency = latencyOutBranchUntermButton->isChecked();
       MusEGlobal::config.commonProjectLatency = latencyProjectCommonButton->isChecked();
       MusEGlobal::config.monitoringAffectsLatency = latencyMonitorAffectingButton->isChecked();
+      // The latency correction settings may have changed.
+      MusEGlobal::audio->latencyChanged();
       
       MusEGlobal::config.startSong   = startSongEntry->text() == "<default>" ? "" : startSongEntry->text();
       MusEGlobal::config.startMode   = startSongGroup->checkedId();
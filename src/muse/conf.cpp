@@ -810,6 +810,8 @@ void readConfiguration(Xml& xml, bool doReadMidiPortConfig, bool doReadGlobalCon
                               MusEGlobal::config.preferKnobsVsSliders = xml.parseInt();
                         else if (tag == "showControlValues")
                               MusEGlobal::config.showControlValues = xml.parseInt();
+                        else if (tag == "showDspLoad")
+                              MusEGlobal::config.showDspLoad = xml.parseInt();
                         else if (tag == "monitorOnRecord")
                               MusEGlobal::config.monitorOnRecord = xml.parseInt();
                         else if (tag == "momentaryMute")
@@ -1356,6 +1358,46 @@ void readConfiguration(Xml& xml, bool doReadMidiPortConfig, bool doReadGlobalCon
                         
                         else if (tag == "minControlProcessPeriod")
                               MusEGlobal::config.minControlProcessPeriod = xml.parseUInt();
+                        else if (tag == "audioGraphWorkerThreads")
+                              MusEGlobal::config.audioGraphWorkerThreads = xml.parseInt();
+                        else if (tag == "anticipativeRenderThreads")
+                              MusEGlobal::config.anticipativeRenderThreads = xml.parseInt();
+                        else if (tag == "anticipativeRenderLookahead")
+                              MusEGlobal::config.anticipativeRenderLookahead = xml.parseInt();
+                        else if (tag == "freezeTailMs")
+                              MusEGlobal::config.freezeTailMs = xml.parseInt();
+                        else if (tag == "prefetchThreads")
+                              MusEGlobal::config.prefetchThreads = xml.parseInt();
+                        else if (tag == "prefetchBatchSegments")
+                              MusEGlobal::config.prefetchBatchSegments = xml.parseInt();
+                        else if (tag == "mappedWaveRead")
+                              MusEGlobal::config.mappedWaveRead = xml.parseInt();
+                        else if (tag == "prefetchReadaheadMs")
+                              MusEGlobal::config.prefetchReadaheadMs = xml.parseInt();
+                        else if (tag == "prefetchMaxReadaheadMs")
+                              MusEGlobal::config.prefetchMaxReadaheadMs = xml.parseInt();
+                        else if (tag == "loopCacheMB")
+                              MusEGlobal::config.loopCacheMB = xml.parseInt();
+                        else if (tag == "waveOverviewThreads")
+                              MusEGlobal::config.waveOverviewThreads = xml.parseInt();
+                        else if (tag == "decodeCacheMB")
+                              MusEGlobal::config.decodeCacheMB = xml.parseInt();
+                        else if (tag == "convertCacheMB")
+                              MusEGlobal::config.convertCacheMB = xml.parseInt();
+                        else if (tag == "recordBatchMs")
+                              MusEGlobal::config.recordBatchMs = xml.parseInt();
+                        else if (tag == "waveLoadThreads")
+                              MusEGlobal::config.waveLoadThreads = xml.parseInt();
+                        else if (tag == "automationSliceTolerance")
+                              MusEGlobal::config.automationSliceTolerance = xml.parseDouble();
+                        else if (tag == "pluginBridgeMode")
+                              MusEGlobal::config.pluginBridgeMode = xml.parseInt();
+                        else if (tag == "lazyPluginInstances")
+                              MusEGlobal::config.lazyPluginInstances = xml.parseInt();
+                        else if (tag == "pluginLoadThreads")
+                              MusEGlobal::config.pluginLoadThreads = xml.parseInt();
+                        else if (tag == "decodeThreads")
+                              MusEGlobal::config.decodeThreads = xml.parseInt();
                         else if (tag == "guiRefresh")
                               MusEGlobal::config.guiRefresh = xml.parseInt();
                         else if (tag == "userInstrumentsDir")                        // Obsolete
@@ -2041,6 +2083,26 @@ void MusE::writeGlobalConfiguration(int level, MusECore::Xml& xml) const
       xml.intTag(level, "commonProjectLatency", MusEGlobal::config.commonProjectLatency);
 
       xml.uintTag(level, "minControlProcessPeriod", MusEGlobal::config.minControlProcessPeriod);
+      xml.intTag(level, "audioGraphWorkerThreads", MusEGlobal::config.audioGraphWorkerThreads);
+      xml.intTag(level, "anticipativeRenderThreads", MusEGlobal::config.anticipativeRenderThreads);
+      xml.intTag(level, "anticipativeRenderLookahead", MusEGlobal::config.anticipativeRenderLookahead);
+      xml.intTag(level, "freezeTailMs", MusEGlobal::config.freezeTailMs);
+      xml.intTag(level, "prefetchThreads", MusEGlobal::config.prefetchThreads);
+      xml.intTag(level, "prefetchBatchSegments", MusEGlobal::config.prefetchBatchSegments);
+      xml.intTag(level, "mappedWaveRead", MusEGlobal::config.mappedWaveRead);
+      xml.intTag(level, "prefetchReadaheadMs", MusEGlobal::config.prefetchReadaheadMs);
+      xml.intTag(level, "prefetchMaxReadaheadMs", MusEGlobal::config.prefetchMaxReadaheadMs);
+      xml.intTag(level, "loopCacheMB", MusEGlobal::config.loopCacheMB);
+      xml.intTag(level, "waveOverviewThreads", MusEGlobal::config.waveOverviewThreads);
+      xml.intTag(level, "decodeCacheMB", MusEGlobal::config.decodeCacheMB);
+      xml.intTag(level, "convertCacheMB", MusEGlobal::config.convertCacheMB);
+      xml.intTag(level, "recordBatchMs", MusEGlobal::config.recordBatchMs);
+      xml.intTag(level, "waveLoadThreads", MusEGlobal::config.waveLoadThreads);
+      xml.doubleTag(level, "automationSliceTolerance", MusEGlobal::config.automationSliceTolerance);
+      xml.intTag(level, "pluginBridgeMode", MusEGlobal::config.pluginBridgeMode);
+      xml.intTag(level, "lazyPluginInstances", MusEGlobal::config.lazyPluginInstances);
+      xml.intTag(level, "pluginLoadThreads", MusEGlobal::config.pluginLoadThreads);
+      xml.intTag(level, "decodeThreads", MusEGlobal::config.decodeThreads);
       xml.intTag(level, "guiRefresh", MusEGlobal::config.guiRefresh);
       
       xml.intTag(level, "extendedMidi", MusEGlobal::config.extendedMidi);
@@ -2117,6 +2179,7 @@ void MusE::writeGlobalConfiguration(int level, MusECore::Xml& xml) const
       xml.intTag(level, "audioEffectsRackVisibleItems", MusEGlobal::config.audioEffectsRackVisibleItems);
       xml.intTag(level, "preferKnobsVsSliders", MusEGlobal::config.preferKnobsVsSliders);
       xml.intTag(level, "showControlValues", MusEGlobal::config.showControlValues);
+      xml.intTag(level, "showDspLoad", MusEGlobal::config.showDspLoad);
       xml.intTag(level, "monitorOnRecord", MusEGlobal::config.monitorOnRecord);
       xml.intTag(level, "momentaryMute", MusEGlobal::config.momentaryMute);
       xml.intTag(level, "momentarySolo", MusEGlobal::config.momentarySolo);
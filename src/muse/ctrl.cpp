@@ -27,6 +27,8 @@
 // Turn on debugging messages
 //#define _CTRL_DEBUG_
 
+#include <algorithm>
+
 #include <QLocale>
 
 #include "muse_math.h"
@@ -810,6 +812,316 @@ double CtrlList::interpolate(unsigned int frame, const CtrlInterpolate& interp)
   return rv;
 }
 
+//---------------------------------------------------------
+//   fillRamp
+//   Fills buffer with the values interpolate() gives for the n
+//    frames from frame on. The constants of the segment are
+//    worked out once, instead of for every frame, so filling a
+//    frame costs about a multiply and an add, and the loops can
+//    be vectorized.
+//---------------------------------------------------------
+
+void CtrlList::fillRamp(unsigned int frame, unsigned int n, const CtrlInterpolate& interp, double* buffer) const
+{
+  const unsigned int frame1 = interp.sFrame;
+  const unsigned int frame2 = interp.eFrame;
+  const double val1 = interp.sVal;
+  const double val2 = interp.eVal;
+
+  unsigned int k = 0;
+  while(k < n)
+  {
+    const unsigned int f = frame + k;
+
+    // Up to the start of the segment and from its end on, interpolate() gives the same value for every frame.
+    if(!interp.eFrameValid || f >= frame2 || f <= frame1 || val1 == val2)
+    {
+      unsigned int m = n - k;
+      if(interp.eFrameValid && f < frame2)
+      {
+        unsigned int end = frame2;
+        if(f <= frame1 && val1 != val2 && frame1 + 1 < end)
+          end = frame1 + 1;
+        if(end - f < m)
+          m = end - f;
+      }
+      const double v = interpolate(f, interp);
+      for(unsigned int i = 0; i < m; ++i)
+        buffer[k + i] = v;
+      k += m;
+      continue;
+    }
+
+    // Inside the segment.
+    const unsigned int m = std::min(n - k, frame2 - f);
+    double* dst = buffer + k;
+    const double off = double(f - frame1);
+    const double len = double(frame2 - frame1);
+    switch(_valueType)
+    {
+      case VAL_LOG:
+      {
+        const double clmax = museMax(_min, _max);
+        const double clmin = museMin(_min, _max);
+        const double clmin_lim = museRangeMinValHint(
+          clmin, clmax,
+          true,
+          false,
+          _displayHint == MusECore::CtrlList::DisplayLogDB,
+          MusEGlobal::config.minSlider,
+          0.05);
+        const double db1 = 20.0*fast_log10(val1 <= clmin_lim ? clmin_lim : val1);
+        const double db2 = 20.0*fast_log10(val2 <= clmin_lim ? clmin_lim : val2);
+        const double slope = (db2 - db1) / len;
+        // A line in dB is a constant ratio from frame to frame. The exact value is taken
+        //  every few frames, so the rounding errors of the ratio do not add up.
+        const double ratio = exp10(slope / 20.0);
+        unsigned int i = 0;
+        while(i < m)
+        {
+          double v = exp10((db1 + (off + double(i)) * slope) / 20.0);
+          const unsigned int end = std::min(m, i + 32);
+          for( ; i < end; ++i)
+          {
+            dst[i] = v;
+            v *= ratio;
+          }
+        }
+      }
+      break;
+
+      case VAL_LINEAR:
+      {
+        const double slope = (val2 - val1) / len;
+        for(unsigned int i = 0; i < m; ++i)
+          dst[i] = val1 + (off + double(i)) * slope;
+      }
+      break;
+
+      case VAL_INT:
+      {
+        const double slope = (val2 - val1) / len;
+        const double mint = trunc(museMin(_min, _max));
+        const double maxt = trunc(museMax(_min, _max));
+        for(unsigned int i = 0; i < m; ++i)
+        {
+          // Round halfway cases, and keep within the bounds, like interpolate().
+          const double v = round(val1 + (off + double(i)) * slope);
+          dst[i] = v < mint ? mint : (v > maxt ? maxt : v);
+        }
+      }
+      break;
+
+      case VAL_BOOL:
+      case VAL_ENUM:
+        for(unsigned int i = 0; i < m; ++i)
+          dst[i] = val1;
+      break;
+    }
+    k += m;
+  }
+}
+
+//---------------------------------------------------------
+//   rampChange
+//---------------------------------------------------------
+
+double CtrlList::rampChange(const CtrlInterpolate& interp) const
+{
+  if(!interp.eFrameValid || interp.eFrame <= interp.sFrame)
+    return 0.0;
+  const double len = double(interp.eFrame - interp.sFrame);
+  switch(_valueType)
+  {
+    case VAL_LOG:
+    {
+      // Log controllers ramp in dB. Compare with the range in dB.
+      const double clmax = museMax(_min, _max);
+      const double clmin = museMin(_min, _max);
+      const double clmin_lim = museRangeMinValHint(
+        clmin, clmax,
+        true,
+        false,
+        _displayHint == MusECore::CtrlList::DisplayLogDB,
+        MusEGlobal::config.minSlider,
+        0.05);
+      const double dbmin = 20.0*fast_log10(clmin_lim);
+      const double dbmax = 20.0*fast_log10(clmax <= clmin_lim ? clmin_lim : clmax);
+      if(dbmax <= dbmin)
+        return -1.0;
+      const double db1 = 20.0*fast_log10(interp.sVal <= clmin_lim ? clmin_lim : interp.sVal);
+      const double db2 = 20.0*fast_log10(interp.eVal <= clmin_lim ? clmin_lim : interp.eVal);
+      return fabs(db2 - db1) / len / (dbmax - dbmin);
+    }
+
+    case VAL_LINEAR:
+    case VAL_INT:
+    {
+      const double range = fabs(_max - _min);
+      if(range <= 0.0)
+        return -1.0;
+      return fabs(interp.eVal - interp.sVal) / len / range;
+    }
+
+    case VAL_BOOL:
+    case VAL_ENUM:
+      // These hold their value up to the end of the segment.
+    break;
+  }
+  return 0.0;
+}
+
+//---------------------------------------------------------
+//   sliceFramesForChange
+//---------------------------------------------------------
+
+static unsigned long sliceFramesForChange(double change, unsigned long minFrames, unsigned long maxFrames)
+{
+  // Without a usable range, run the shortest slices.
+  if(change < 0.0)
+    return minFrames;
+  const double tolerance = MusEGlobal::config.automationSliceTolerance;
+  unsigned long frames = maxFrames;
+  if(change > 0.0 && tolerance / change < double(maxFrames))
+    frames = (unsigned long)(tolerance / change);
+  frames -= frames % minFrames;
+  return frames < minFrames ? minFrames : frames;
+}
+
+//---------------------------------------------------------
+//   sliceFrames
+//   Plugins are run in slices, each with the controller values
+//    at its start. While a value ramps, a slice ends once the
+//    ramp moved further than the tolerance, instead of every
+//    minFrames, so slow ramps cost fewer plugin runs.
+//---------------------------------------------------------
+
+unsigned long CtrlList::sliceFrames(unsigned int frame, const CtrlInterpolate& interp,
+                                    unsigned long minFrames, unsigned long maxFrames) const
+{
+  if(MusEGlobal::config.automationSliceTolerance <= 0.0 || minFrames == 0 || maxFrames <= minFrames ||
+     !interp.doInterp || !interp.eFrameValid || interp.eFrame <= interp.sFrame || frame >= interp.eFrame)
+    return minFrames;
+  return sliceFramesForChange(rampChange(interp), minFrames, maxFrames);
+}
+
+//---------------------------------------------------------
+//   prepareRamp
+//   Works out the constants of interp's segment, so that a
+//    value inside it costs about a multiply and an add, and
+//    an exp10 for log controllers.
+//---------------------------------------------------------
+
+void CtrlList::prepareRamp(const CtrlInterpolate& interp, CtrlRamp* ramp) const
+{
+  ramp->sFrame = interp.sFrame;
+  ramp->eFrame = interp.eFrame;
+  ramp->eFrameValid = interp.eFrameValid;
+  ramp->sVal = interp.sVal;
+  ramp->eVal = interp.eVal;
+  ramp->valid = true;
+
+  // Frames at or after the end, and before the start, all get the same value.
+  ramp->endVal = interpolate(interp.eFrameValid ? interp.eFrame : 0, interp);
+  ramp->startVal = (interp.eFrameValid && interp.eFrame > 0) ?
+    interpolate(std::min(interp.sFrame, interp.eFrame - 1), interp) : ramp->endVal;
+
+  ramp->base = interp.sVal;
+  ramp->slope = 0.0;
+  ramp->lo = museMin(_min, _max);
+  ramp->hi = museMax(_min, _max);
+  ramp->change = rampChange(interp);
+  if(!interp.eFrameValid || interp.eFrame <= interp.sFrame)
+    return;
+
+  const double len = double(interp.eFrame - interp.sFrame);
+  switch(_valueType)
+  {
+    case VAL_LOG:
+    {
+      const double clmin_lim = museRangeMinValHint(
+        ramp->lo, ramp->hi,
+        true,
+        false,
+        _displayHint == MusECore::CtrlList::DisplayLogDB,
+        MusEGlobal::config.minSlider,
+        0.05);
+      const double db1 = 20.0*fast_log10(interp.sVal <= clmin_lim ? clmin_lim : interp.sVal);
+      const double db2 = 20.0*fast_log10(interp.eVal <= clmin_lim ? clmin_lim : interp.eVal);
+      ramp->base = db1;
+      ramp->slope = (db2 - db1) / len;
+    }
+    break;
+
+    case VAL_INT:
+      ramp->lo = trunc(ramp->lo);
+      ramp->hi = trunc(ramp->hi);
+      ramp->slope = (interp.eVal - interp.sVal) / len;
+    break;
+
+    case VAL_LINEAR:
+      ramp->slope = (interp.eVal - interp.sVal) / len;
+    break;
+
+    case VAL_BOOL:
+    case VAL_ENUM:
+    break;
+  }
+}
+
+//---------------------------------------------------------
+//   rampValue
+//---------------------------------------------------------
+
+double CtrlList::rampValue(unsigned int frame, const CtrlInterpolate& interp, CtrlRamp* ramp) const
+{
+  if(!ramp->isFor(interp))
+    prepareRamp(interp, ramp);
+
+  // The same cases as interpolate().
+  if(!interp.eFrameValid || frame >= interp.eFrame)
+    return ramp->endVal;
+  if(frame <= interp.sFrame || interp.sVal == interp.eVal)
+    return ramp->startVal;
+
+  const double off = double(frame - interp.sFrame);
+  switch(_valueType)
+  {
+    case VAL_LOG:
+      return exp10((ramp->base + off * ramp->slope) / 20.0);
+
+    case VAL_LINEAR:
+      return ramp->base + off * ramp->slope;
+
+    case VAL_INT:
+    {
+      // Round halfway cases, and keep within the bounds, like interpolate().
+      const double v = round(ramp->base + off * ramp->slope);
+      return v < ramp->lo ? ramp->lo : (v > ramp->hi ? ramp->hi : v);
+    }
+
+    case VAL_BOOL:
+    case VAL_ENUM:
+    break;
+  }
+  return interp.sVal;
+}
+
+//---------------------------------------------------------
+//   rampSliceFrames
+//---------------------------------------------------------
+
+unsigned long CtrlList::rampSliceFrames(unsigned int frame, const CtrlInterpolate& interp, CtrlRamp* ramp,
+                                        unsigned long minFrames, unsigned long maxFrames) const
+{
+  if(MusEGlobal::config.automationSliceTolerance <= 0.0 || minFrames == 0 || maxFrames <= minFrames ||
+     !interp.doInterp || !interp.eFrameValid || interp.eFrame <= interp.sFrame || frame >= interp.eFrame)
+    return minFrames;
+  if(!ramp->isFor(interp))
+    prepareRamp(interp, ramp);
+  return sliceFramesForChange(ramp->change, minFrames, maxFrames);
+}
+
 //---------------------------------------------------------
 //   value
 //   Returns value at frame.
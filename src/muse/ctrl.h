@@ -81,6 +81,39 @@ struct CtrlInterpolate {
                       bool end_stop = false, bool do_interpolate = false);
       };
 
+//---------------------------------------------------------
+//   CtrlRamp
+//    The constants of the segment a CtrlInterpolate
+//     describes, worked out once by CtrlList::rampValue()
+//     and rampSliceFrames() and kept by the caller, so the
+//     slices of a plugin run do not work them out again.
+//---------------------------------------------------------
+
+struct CtrlRamp {
+      // The interpolation the constants were worked out for.
+      unsigned int sFrame;
+      unsigned int eFrame;
+      bool   eFrameValid;
+      double sVal;
+      double eVal;
+      bool   valid;
+      // The values interpolate() gives before and after the segment.
+      double startVal;
+      double endVal;
+      // Value at the start of the segment and its change per frame, in dB for log controllers.
+      double base;
+      double slope;
+      // Bounds of integer controllers.
+      double lo;
+      double hi;
+      // What CtrlList::rampChange() gives for the segment.
+      double change;
+      CtrlRamp() : valid(false) {}
+      bool isFor(const CtrlInterpolate& interp) const {
+            return valid && sFrame == interp.sFrame && eFrame == interp.eFrame &&
+                   eFrameValid == interp.eFrameValid && sVal == interp.sVal && eVal == interp.eVal; }
+      };
+
 //---------------------------------------------------------
 //   CtrlVal
 //    controller "event"
@@ -278,6 +311,11 @@ class CtrlList : public CtrlList_t {
       int _valueUnit;
       DisplayHints _displayHint;
 
+      // How much interp's ramp moves per frame, as a part of the range.
+      // Zero if not at all, negative if the range is empty.
+      double rampChange(const CtrlInterpolate& interp) const;
+      void prepareRamp(const CtrlInterpolate& interp, CtrlRamp* ramp) const;
+
    public:
       CtrlList(bool dontShow=false);
       CtrlList(int id, bool dontShow=false);
@@ -336,6 +374,18 @@ class CtrlList : public CtrlList_t {
       void setValueType(CtrlValueType t);
       void getInterpolation(unsigned int frame, bool cur_val_only, CtrlInterpolate* interp) const;
       double interpolate(unsigned int frame, const CtrlInterpolate& interp) const;
+      // Fills buffer with the values interpolate() gives for the n frames from frame on.
+      void fillRamp(unsigned int frame, unsigned int n, const CtrlInterpolate& interp, double* buffer) const;
+      // How many frames from frame on, up to maxFrames, a plugin may run with the value interp
+      //  has at frame, before the ramp moves further than config.automationSliceTolerance.
+      // A multiple of minFrames, and at least minFrames.
+      unsigned long sliceFrames(unsigned int frame, const CtrlInterpolate& interp,
+                                unsigned long minFrames, unsigned long maxFrames) const;
+      // The same as interpolate() and sliceFrames(), with the segment's constants
+      //  kept in ramp. They are worked out again when interp changes.
+      double rampValue(unsigned int frame, const CtrlInterpolate& interp, CtrlRamp* ramp) const;
+      unsigned long rampSliceFrames(unsigned int frame, const CtrlInterpolate& interp, CtrlRamp* ramp,
+                                    unsigned long minFrames, unsigned long maxFrames) const;
 
       double value(unsigned int frame, bool cur_val_only = false,
                    unsigned int* nextFrame = nullptr, bool* nextFrameValid = nullptr) const;
@@ -0,0 +1,60 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  current_preload.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __CURRENT_PRELOAD_H__
+#define __CURRENT_PRELOAD_H__
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   CurrentPreload
+//    The preload of type T which loading code hands its
+//     work to, while a project is read. T derives from
+//     CurrentPreload<T>. Only the gui thread uses it.
+//---------------------------------------------------------
+
+template <class T>
+class CurrentPreload {
+      static CurrentPreload* _current;
+
+   protected:
+      CurrentPreload() { }
+      ~CurrentPreload() { release(); }
+
+   public:
+      // The current preload, or null.
+      static T* current() { return static_cast<T*>(_current); }
+      void makeCurrent() { _current = this; }
+      // Stops being current, if it is.
+      void release() {
+            if(_current == this)
+                  _current = nullptr;
+            }
+      };
+
+template <class T>
+CurrentPreload<T>* CurrentPreload<T>::_current = nullptr;
+
+} // namespace MusECore
+
+#endif
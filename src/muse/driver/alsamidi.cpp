@@ -993,7 +993,7 @@ void MidiAlsaDevice::processMidi(unsigned int curFrame)
       }
     }
 
-    // Transfer the playback lock-free buffer events to the playback sorted multi-set.
+    // Transfer the playback lock-free buffer events to the playback queue.
     const unsigned int pb_buf_sz = eventBuffers(MidiDevice::PlaybackBuffer)->getSize();
     for(unsigned int i = 0; i < pb_buf_sz; ++i)
     {
@@ -1010,21 +1010,20 @@ void MidiAlsaDevice::processMidi(unsigned int curFrame)
   if(do_process)
   {
 
-    iMPEvent impe_pb = _outPlaybackEvents.begin();
     iMPEvent impe_us = _outUserEvents.begin();
     bool using_pb;
 
     while(1)
     {
-      if(impe_pb != _outPlaybackEvents.end() && impe_us != _outUserEvents.end())
-        using_pb = *impe_pb < *impe_us;
-      else if(impe_pb != _outPlaybackEvents.end())
+      if(!_outPlaybackEvents.empty() && impe_us != _outUserEvents.end())
+        using_pb = _outPlaybackEvents.front() < *impe_us;
+      else if(!_outPlaybackEvents.empty())
         using_pb = true;
       else if(impe_us != _outUserEvents.end())
         using_pb = false;
       else break;
 
-      const MidiPlayEvent& e = using_pb ? *impe_pb : *impe_us;
+      const MidiPlayEvent& e = using_pb ? _outPlaybackEvents.front() : *impe_us;
 
       #ifdef ALSA_DEBUG
       fprintf(stderr, "INFO: MidiAlsaDevice::processMidi() evTime:%u curFrame:%u\n", e.time(), curFrame);
@@ -1085,7 +1084,7 @@ void MidiAlsaDevice::processMidi(unsigned int curFrame)
       // Successfully processed event. Remove it from FIFO.
       // C++11.
       if(using_pb)
-        impe_pb = _outPlaybackEvents.erase(impe_pb);
+        _outPlaybackEvents.pop_front();
       else
         impe_us = _outUserEvents.erase(impe_us);
     }
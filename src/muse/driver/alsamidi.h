@@ -31,6 +31,7 @@
 #include <alsa/asoundlib.h>
 
 #include "mpevent.h"
+#include "mpevent_queue.h"
 #include "mididev.h"
 
 #endif // ALSA_SUPPORT
@@ -54,7 +55,7 @@ class MidiAlsaDevice : public MidiDevice {
       // The audio thread will gather the events in _playEvents for the 
       //  convenience of its sorting, then dump them to this FIFO so that 
       //  a driver or device may read it, possibly from another thread (ALSA driver).
-      SeqMPEventList _outPlaybackEvents;
+      MPEventQueue _outPlaybackEvents;
       SeqMPEventList _outUserEvents;
      
       // Return false if event is delivered.
@@ -65,6 +65,12 @@ class DummyAudioDevice : public AudioDevice {
       uint64_t _timeUSAtCycleStart[2];
       unsigned _frameCounter[2];
       unsigned _criticalVariablesIdx;
+
+      // Offline mode: No thread is started. Cycles are driven by runOfflineAudioCycle()
+      //  as fast as they can be processed, and every registered port gets its own
+      //  buffer so that the output of each port can be read back after a cycle.
+      bool _offline;
+      float* allocBuffer() const;
       
    public:
       // Time in microseconds at which the driver was created.
@@ -89,7 +95,7 @@ class DummyAudioDevice : public AudioDevice {
         _criticalVariablesIdx = idx;
       }
 
-      DummyAudioDevice();
+      DummyAudioDevice(bool offline = false, int sampleRate = 0);
       virtual ~DummyAudioDevice()
       { 
         free(buffer); 
@@ -113,6 +119,9 @@ class DummyAudioDevice : public AudioDevice {
       virtual unsigned framesAtCycleStart() const { return _framesAtCycleStart[_criticalVariablesIdx]; }
       virtual unsigned framesSinceCycleStart() const 
       { 
+        // There is no wall clock to follow when rendering offline.
+        if(_offline)
+          return 0;
         const uint64_t ct = systemTimeUS();
         DEBUG_DUMMY(stderr, "DummyAudioDevice::framesSinceCycleStart systemTimeUS:%lu timeUSAtCycleStart:%lu\n", 
                 ct, _timeUSAtCycleStart[_criticalVariablesIdx]);
@@ -125,13 +134,16 @@ class DummyAudioDevice : public AudioDevice {
         return f;
       }
 
-      virtual float* getBuffer(void* /*port*/, unsigned long nframes)
+      virtual float* getBuffer(void* port, unsigned long nframes)
             {
             if (nframes > MusEGlobal::segmentSize) {
                   fprintf(stderr, "DummyAudioDevice::getBuffer nframes > segment size\n");
                   
                   exit(-1);
                   }
+            // In offline mode the port handle is the port's own buffer.
+            if (_offline && port)
+                  return (float*)port;
             return buffer;
             }
 
@@ -142,15 +154,26 @@ class DummyAudioDevice : public AudioDevice {
 
       virtual const char* clientName() { return "MusE"; }
       
-      virtual void* registerOutPort(const char*, bool) {
+      virtual void* registerOutPort(const char*, bool midi) {
+            if (_offline && !midi)
+                  return allocBuffer();
             return (void*)1;
             }
-      virtual void* registerInPort(const char*, bool) {
+      virtual void* registerInPort(const char*, bool midi) {
+            if (_offline && !midi)
+                  return allocBuffer();
             return (void*)2;
             }
       virtual AudioDevice::PortType portType(void*) const { return UnknownType; }
       virtual AudioDevice::PortDirection portDirection(void*) const { return UnknownDirection; }
-      virtual void unregisterPort(void*) {}
+      virtual void unregisterPort(void* port) {
+            if (_offline && port)
+#ifdef _WIN32
+                  _aligned_free(port);
+#else
+                  free(port);
+#endif
+            }
       virtual bool connect(void* /*src*/, void* /*dst*/) { return false; }
       virtual bool connect(const char* /*src*/, const char* /*dst*/) { return false; }
       virtual bool disconnect(void* /*src*/, void* /*dst*/) { return false; }
@@ -180,56 +203,72 @@ class DummyAudioDevice : public AudioDevice {
       bool freewheelMode() const { return _freewheelMode; }
       virtual void setFreewheel(bool v) { _freewheelMode = v; }
       virtual int setMaster(bool, bool /*unconditional*/ = false) { return 1; }
+
+      bool isOffline() const { return _offline; }
+      void runCycle();
       };
 
 DummyAudioDevice* dummyAudio = 0;
 
-DummyAudioDevice::DummyAudioDevice() : AudioDevice()
+DummyAudioDevice::DummyAudioDevice(bool offline, int sampleRate) : AudioDevice()
       {
         _freewheelMode = false;
+        _offline = offline;
 //       MusEGlobal::sampleRate = MusEGlobal::config.dummyAudioSampleRate;
 //       MusEGlobal::segmentSize = MusEGlobal::config.dummyAudioBufSize;
         
-      MusEGlobal::sampleRate = MusEGlobal::config.deviceAudioSampleRate;
+      MusEGlobal::sampleRate = sampleRate > 0 ? sampleRate : MusEGlobal::config.deviceAudioSampleRate;
       // Make sure the AL namespace variables mirror our variables.
       AL::sampleRate = MusEGlobal::sampleRate;
       MusEGlobal::segmentSize = MusEGlobal::config.deviceAudioBufSize;
       MusEGlobal::projectSampleRate = MusEGlobal::sampleRate;
       
+      buffer = allocBuffer();
+
+      dummyThread = 0;
+      _start_timeUS = systemTimeUS();
+      _criticalVariablesIdx = 0;
+      for(unsigned x = 0; x < 2; ++x)
+      {
+        _timeUSAtCycleStart[x] = 0;
+        _framesAtCycleStart[x] = 0;
+        _frameCounter[x] = 0;
+      }
+      }
+
+
+//---------------------------------------------------------
+//   allocBuffer
+//    Returns a segment sized buffer filled with silence.
+//---------------------------------------------------------
+
+float* DummyAudioDevice::allocBuffer() const
+      {
+      float* buf;
 #ifdef _WIN32
-  buffer = (float *) _aligned_malloc(16, sizeof(float) * MusEGlobal::segmentSize);
-  if(buffer == nullptr)
+  buf = (float *) _aligned_malloc(16, sizeof(float) * MusEGlobal::segmentSize);
+  if(buf == nullptr)
   {
-      fprintf(stderr, "ERROR: DummyAudioDevice ctor: _aligned_malloc returned error: NULL. Aborting!\n");
+      fprintf(stderr, "ERROR: DummyAudioDevice::allocBuffer: _aligned_malloc returned error: NULL. Aborting!\n");
       abort();
   }
 #else
-      int rv = posix_memalign((void**)&buffer, 16, sizeof(float) * MusEGlobal::segmentSize);
+      int rv = posix_memalign((void**)&buf, 16, sizeof(float) * MusEGlobal::segmentSize);
       if(rv != 0)
       {
-        fprintf(stderr, "ERROR: DummyAudioDevice ctor: posix_memalign returned error:%d. Aborting!\n", rv);
+        fprintf(stderr, "ERROR: DummyAudioDevice::allocBuffer: posix_memalign returned error:%d. Aborting!\n", rv);
         abort();
       }
 #endif
       if(MusEGlobal::config.useDenormalBias)
       {
         for(unsigned q = 0; q < MusEGlobal::segmentSize; ++q)
-          buffer[q] = MusEGlobal::denormalBias;
+          buf[q] = MusEGlobal::denormalBias;
       }
       else
-        memset(buffer, 0, sizeof(float) * MusEGlobal::segmentSize);
-
-      dummyThread = 0;
-      _start_timeUS = systemTimeUS();
-      _criticalVariablesIdx = 0;
-      for(unsigned x = 0; x < 2; ++x)
-      {
-        _timeUSAtCycleStart[x] = 0;
-        _framesAtCycleStart[x] = 0;
-        _frameCounter[x] = 0;
+        memset(buf, 0, sizeof(float) * MusEGlobal::segmentSize);
+      return buf;
       }
-      }
-
 
 //---------------------------------------------------------
 //   exitDummyAudio
@@ -255,6 +294,35 @@ bool initDummyAudio()
       return false;
       }
 
+//---------------------------------------------------------
+//   initOfflineAudio
+//    Creates a dummy device without a driver thread,
+//     for rendering faster than real time.
+//     Cycles must be driven with runOfflineAudioCycle().
+//    A sampleRate of zero uses the configured rate.
+//---------------------------------------------------------
+
+bool initOfflineAudio(int sampleRate)
+      {
+      dummyAudio = new DummyAudioDevice(true, sampleRate);
+      MusEGlobal::audioDevice = dummyAudio;
+      return false;
+      }
+
+//---------------------------------------------------------
+//   runOfflineAudioCycle
+//    Runs one segment of audio processing in the calling thread.
+//    Returns false if there is no offline device.
+//---------------------------------------------------------
+
+bool runOfflineAudioCycle()
+      {
+      if(!dummyAudio || !dummyAudio->isOffline())
+        return false;
+      dummyAudio->runCycle();
+      return true;
+      }
+
 //---------------------------------------------------------
 //   outputPorts
 //---------------------------------------------------------
@@ -319,6 +387,18 @@ static void* dummyLoop(void* ptr)
       pthread_exit(0);
       }
 
+//---------------------------------------------------------
+//   runCycle
+//    Offline counterpart of one dummyLoop iteration.
+//---------------------------------------------------------
+
+void DummyAudioDevice::runCycle()
+      {
+      setCriticalVariables(MusEGlobal::segmentSize);
+      if(MusEGlobal::audio->isRunning())
+        processTransport(MusEGlobal::segmentSize);
+      }
+
 //---------------------------------------------------------
 //   start
 //   Returns true on success.
@@ -327,6 +407,8 @@ static void* dummyLoop(void* ptr)
 bool DummyAudioDevice::start(int priority)
 {
       _realTimePriority = priority;
+      if(_offline)
+        return true;
       pthread_attr_t* attributes = 0;
 
       if (MusEGlobal::realTimeScheduling && _realTimePriority > 0) {
@@ -374,6 +456,8 @@ bool DummyAudioDevice::start(int priority)
 
 void DummyAudioDevice::stop ()
       {
+      if(_offline)
+        return;
       pthread_cancel(dummyThread);
       pthread_join(dummyThread, 0);
       dummyThread = 0;
@@ -1064,6 +1064,10 @@ void JackAudioDevice::graphChanged()
 
   // Reset this now.
   muse_atomic_set(&atomicGraphChangedPending, 0);
+
+  // Port latencies may have changed along with the graph.
+  if(MusEGlobal::audio)
+    MusEGlobal::audio->latencyChanged();
   
   jackCallbackEvents.clear();
   // Find the last GraphChanged event, if any.
@@ -1338,7 +1338,7 @@ void MidiJackDevice::processMidi(unsigned int curFrame)
       }
     }
 
-    // Transfer the playback lock-free buffer events to the playback sorted multi-set.
+    // Transfer the playback lock-free buffer events to the playback queue.
     const unsigned int pb_buf_sz = eventBuffers(MidiDevice::PlaybackBuffer)->getSize();
     for(unsigned int i = 0; i < pb_buf_sz; ++i)
     {
@@ -1355,21 +1355,20 @@ void MidiJackDevice::processMidi(unsigned int curFrame)
   if(port_buf)
   {
 
-    iMPEvent impe_pb = _outPlaybackEvents.begin();
     iMPEvent impe_us = _outUserEvents.begin();
     bool using_pb;
 
     while(1)
     {
-      if(impe_pb != _outPlaybackEvents.end() && impe_us != _outUserEvents.end())
-        using_pb = *impe_pb < *impe_us;
-      else if(impe_pb != _outPlaybackEvents.end())
+      if(!_outPlaybackEvents.empty() && impe_us != _outUserEvents.end())
+        using_pb = _outPlaybackEvents.front() < *impe_us;
+      else if(!_outPlaybackEvents.empty())
         using_pb = true;
       else if(impe_us != _outUserEvents.end())
         using_pb = false;
       else break;
 
-      const MidiPlayEvent& ev = using_pb ? *impe_pb : *impe_us;
+      const MidiPlayEvent& ev = using_pb ? _outPlaybackEvents.front() : *impe_us;
 
       if(ev.time() >= (curFrame + MusEGlobal::segmentSize))
       {
@@ -1384,7 +1383,7 @@ void MidiJackDevice::processMidi(unsigned int curFrame)
       // Successfully processed event. Remove it from FIFO.
       // C++11.
       if(using_pb)
-        impe_pb = _outPlaybackEvents.erase(impe_pb);
+        _outPlaybackEvents.pop_front();
       else
         impe_us = _outUserEvents.erase(impe_us);
     }
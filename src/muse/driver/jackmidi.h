@@ -34,6 +34,7 @@
 #include "mididev.h"
 #include "route.h"
 #include "mpevent.h"
+#include "mpevent_queue.h"
 
 namespace MusECore {
 
@@ -54,7 +55,7 @@ class MidiJackDevice : public MidiDevice {
       jack_port_t* _in_client_jackport;
       jack_port_t* _out_client_jackport;
       
-      MPEventList _outPlaybackEvents;
+      MPEventQueue _outPlaybackEvents;
       MPEventList _outUserEvents;
       
       virtual QString open();
@@ -0,0 +1,251 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  dsp_profiler.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <algorithm>
+#include <unistd.h>
+
+#include "dsp_profiler.h"
+#include "globals.h"
+#include "song.h"
+#include "track.h"
+#include "synth.h"
+#include "ticksynth.h"
+#include "plugin.h"
+
+namespace MusEGlobal {
+MusECore::DspProfiler dspProfiler;
+}
+
+namespace MusECore {
+
+thread_local uint64_t DspTrackProfileScope::_nested = 0;
+
+static uint64_t monotonicNs()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return uint64_t(t.tv_sec) * 1000000000ULL + t.tv_nsec;
+}
+
+//---------------------------------------------------------
+//   DspProbe
+//---------------------------------------------------------
+
+DspProbe::DspProbe()
+  : _accum(0), _count(0), _generation(0)
+{
+  for(int i = 0; i < HistorySize; ++i)
+    _history[i].store(0, std::memory_order_relaxed);
+}
+
+//---------------------------------------------------------
+//   commit
+//---------------------------------------------------------
+
+void DspProbe::commit(unsigned generation)
+{
+  const uint64_t t = _accum.exchange(0, std::memory_order_relaxed);
+  unsigned count = _count.load(std::memory_order_relaxed);
+  const bool is_new = _generation.load(std::memory_order_relaxed) != generation;
+  if(is_new)
+    count = 0;
+  _history[count % HistorySize].store(t > UINT32_MAX ? UINT32_MAX : uint32_t(t), std::memory_order_relaxed);
+  _count.store(count + 1, std::memory_order_release);
+  // Only claim the new generation once the count has been reset.
+  if(is_new)
+    _generation.store(generation, std::memory_order_release);
+}
+
+//---------------------------------------------------------
+//   stats
+//---------------------------------------------------------
+
+bool DspProbe::stats(DspProbeStats* s) const
+{
+  if(_generation.load(std::memory_order_acquire) != MusEGlobal::dspProfiler.generation())
+    return false;
+  const unsigned count = _count.load(std::memory_order_acquire);
+  if(count == 0)
+    return false;
+
+  const unsigned n = count < (unsigned)HistorySize ? count : (unsigned)HistorySize;
+  uint32_t v[HistorySize];
+  for(unsigned i = 0; i < n; ++i)
+    v[i] = _history[(count - n + i) % HistorySize].load(std::memory_order_relaxed);
+
+  uint64_t sum = 0;
+  uint32_t mn = UINT32_MAX;
+  uint32_t mx = 0;
+  for(unsigned i = 0; i < n; ++i)
+  {
+    sum += v[i];
+    mn = std::min(mn, v[i]);
+    mx = std::max(mx, v[i]);
+  }
+  // The 99th percentile. With few cycles this is simply the maximum.
+  const unsigned p99_idx = (n * 99 + 99) / 100 - 1;
+  std::nth_element(v, v + p99_idx, v + n);
+
+  DspProfiler& prof = MusEGlobal::dspProfiler;
+  s->cycles = n;
+  s->minUs = prof.ticksToUs(mn);
+  s->maxUs = prof.ticksToUs(mx);
+  s->avgUs = prof.ticksToUs(sum) / double(n);
+  s->p99Us = prof.ticksToUs(v[p99_idx]);
+  const double period = prof.cyclePeriodUs();
+  s->avgLoad = period > 0.0 ? 100.0 * s->avgUs / period : 0.0;
+  s->maxLoad = period > 0.0 ? 100.0 * s->maxUs / period : 0.0;
+  return true;
+}
+
+//---------------------------------------------------------
+//   DspProfiler
+//---------------------------------------------------------
+
+DspProfiler::DspProfiler()
+  : _enabled(false), _generation(1), _users(0), _usPerTick(0.0)
+{
+  _calTicks = dspProfilerTicks();
+  _calNs = monotonicNs();
+}
+
+//---------------------------------------------------------
+//   calibrate
+//    Measures the tick rate against the monotonic clock over
+//    the whole time since startup, which gets more accurate
+//    the longer we run.
+//---------------------------------------------------------
+
+void DspProfiler::calibrate()
+{
+  uint64_t ns = monotonicNs() - _calNs;
+  // Make sure the interval is long enough to mean anything.
+  if(ns < 10000000)
+  {
+    usleep((10000000 - ns) / 1000);
+    ns = monotonicNs() - _calNs;
+  }
+  const uint64_t ticks = dspProfilerTicks() - _calTicks;
+  if(ticks != 0)
+    _usPerTick = double(ns) / 1000.0 / double(ticks);
+}
+
+//---------------------------------------------------------
+//   acquire
+//---------------------------------------------------------
+
+void DspProfiler::acquire()
+{
+  if(_users++ == 0)
+  {
+    calibrate();
+    reset();
+    _enabled.store(true, std::memory_order_release);
+  }
+}
+
+//---------------------------------------------------------
+//   release
+//---------------------------------------------------------
+
+void DspProfiler::release()
+{
+  if(_users > 0 && --_users == 0)
+    _enabled.store(false, std::memory_order_release);
+}
+
+//---------------------------------------------------------
+//   reset
+//    The probes see the new generation when they are next
+//    committed, and start over. Until then they report no data.
+//---------------------------------------------------------
+
+void DspProfiler::reset()
+{
+  _generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+//---------------------------------------------------------
+//   ticksToUs
+//---------------------------------------------------------
+
+double DspProfiler::ticksToUs(uint64_t ticks)
+{
+  if(_usPerTick == 0.0)
+    calibrate();
+  return double(ticks) * _usPerTick;
+}
+
+//---------------------------------------------------------
+//   cyclePeriodUs
+//---------------------------------------------------------
+
+double DspProfiler::cyclePeriodUs() const
+{
+  if(MusEGlobal::sampleRate <= 0)
+    return 0.0;
+  return 1000000.0 * double(MusEGlobal::segmentSize) / double(MusEGlobal::sampleRate);
+}
+
+//---------------------------------------------------------
+//   endCycle
+//    Called by the audio thread at the end of each cycle.
+//    Track deletion is synchronized with the audio thread,
+//    so the track list can be walked safely here.
+//---------------------------------------------------------
+
+void DspProfiler::endCycle(uint64_t cycleStartTicks)
+{
+  _cycleProbe.add(dspProfilerTicks() - cycleStartTicks);
+
+  const unsigned gen = _generation.load(std::memory_order_acquire);
+  const TrackList* tl = MusEGlobal::song->tracks();
+  for(ciTrack it = tl->cbegin(); it != tl->cend(); ++it)
+  {
+    if((*it)->isMidiTrack())
+      continue;
+    AudioTrack* at = static_cast<AudioTrack*>(*it);
+    at->dspProbe()->commit(gen);
+    if(at->type() == Track::AUDIO_SOFTSYNTH)
+      static_cast<SynthI*>(at)->synthDspProbe()->commit(gen);
+    const Pipeline* pl = at->efxPipe();
+    if(!pl)
+      continue;
+    for(ciPluginI ip = pl->cbegin(); ip != pl->cend(); ++ip)
+    {
+      if(*ip)
+        (*ip)->dspProbe()->commit(gen);
+    }
+  }
+
+  if(metronome)
+  {
+    metronome->dspProbe()->commit(gen);
+    metronome->synthDspProbe()->commit(gen);
+  }
+
+  _midiProbe.commit(gen);
+  _cycleProbe.commit(gen);
+}
+
+} // namespace MusECore
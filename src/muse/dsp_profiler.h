@@ -0,0 +1,240 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  dsp_profiler.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __DSP_PROFILER_H__
+#define __DSP_PROFILER_H__
+
+#include <atomic>
+#include <stdint.h>
+#include <time.h>
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   dspProfilerTicks
+//    A cheap time stamp: The TSC on x86, the virtual counter
+//    on aarch64, otherwise the monotonic clock in nanoseconds.
+//    DspProfiler calibrates the ticks against the clock.
+//---------------------------------------------------------
+
+inline uint64_t dspProfilerTicks()
+{
+#if defined(__i386__) || defined(__x86_64__)
+  return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+  uint64_t v;
+  asm volatile("mrs %0, cntvct_el0" : "=r" (v));
+  return v;
+#else
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return uint64_t(t.tv_sec) * 1000000000ULL + t.tv_nsec;
+#endif
+}
+
+//---------------------------------------------------------
+//   DspProbeStats
+//---------------------------------------------------------
+
+struct DspProbeStats
+{
+  // Number of cycles the figures were taken from.
+  unsigned cycles;
+  // Time spent per cycle, in microseconds.
+  double minUs;
+  double avgUs;
+  double maxUs;
+  double p99Us;
+  // Average and maximum time as a percentage of the cycle period.
+  double avgLoad;
+  double maxLoad;
+};
+
+//---------------------------------------------------------
+//   DspProbe
+//    The time one object (a track, a plugin...) spends
+//    processing in each cycle. Time is accumulated during the
+//    cycle from any thread, then committed once per cycle by
+//    the audio thread into a history ring, which the gui
+//    reads without locking.
+//---------------------------------------------------------
+
+class DspProbe
+{
+  public:
+    // Number of cycles kept. About 5 seconds at 48kHz / 512 frames.
+    enum { HistorySize = 512 };
+
+  private:
+    std::atomic<uint64_t> _accum;
+    std::atomic<uint32_t> _history[HistorySize];
+    // Number of cycles committed since the last reset.
+    std::atomic<unsigned> _count;
+    // The profiler generation the history belongs to. See DspProfiler::reset().
+    std::atomic<unsigned> _generation;
+
+  public:
+    DspProbe();
+    DspProbe(const DspProbe&) = delete;
+    DspProbe& operator=(const DspProbe&) = delete;
+
+    inline void add(uint64_t ticks) { _accum.fetch_add(ticks, std::memory_order_relaxed); }
+    // Audio thread only, once per cycle.
+    void commit(unsigned generation);
+    // Gui thread only. Returns false if there is no data yet.
+    // The newest entries may be overwritten while being read,
+    //  which is acceptable for statistics.
+    bool stats(DspProbeStats* s) const;
+};
+
+//---------------------------------------------------------
+//   DspProfiler
+//    Commits all the probes at the end of each audio cycle.
+//    Profiling is only on while something in the gui wants
+//    the figures (see acquire() and release()), so it costs
+//    just one flag test per probe otherwise.
+//---------------------------------------------------------
+
+class DspProfiler
+{
+    std::atomic<bool> _enabled;
+    std::atomic<unsigned> _generation;
+    // Gui thread only.
+    int _users;
+    uint64_t _calTicks;
+    uint64_t _calNs;
+    double _usPerTick;
+
+    // Audio::processMidi().
+    DspProbe _midiProbe;
+    // The whole Audio::process() cycle.
+    DspProbe _cycleProbe;
+
+    void calibrate();
+
+  public:
+    DspProfiler();
+
+    inline bool enabled() const { return _enabled.load(std::memory_order_relaxed); }
+    inline unsigned generation() const { return _generation.load(std::memory_order_acquire); }
+
+    // Gui thread. Profiling is on while there is at least one user.
+    void acquire();
+    void release();
+    // Gui thread. Discards all the histories.
+    void reset();
+
+    // Audio thread. Ends the cycle which began at cycleStartTicks.
+    void endCycle(uint64_t cycleStartTicks);
+
+    inline DspProbe* midiProbe() { return &_midiProbe; }
+    inline DspProbe* cycleProbe() { return &_cycleProbe; }
+
+    // Gui thread.
+    double ticksToUs(uint64_t ticks);
+    // The current cycle period, in microseconds.
+    double cyclePeriodUs() const;
+};
+
+} // namespace MusECore
+
+namespace MusEGlobal {
+extern MusECore::DspProfiler dspProfiler;
+}
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   DspProfileScope
+//    Adds the time spent in the enclosing scope to a probe,
+//    if profiling is on.
+//---------------------------------------------------------
+
+class DspProfileScope
+{
+    DspProbe* _probe;
+    uint64_t _start;
+
+  public:
+    inline DspProfileScope(DspProbe* probe)
+      : _probe(MusEGlobal::dspProfiler.enabled() ? probe : nullptr),
+        _start(_probe ? dspProfilerTicks() : 0) { }
+    inline ~DspProfileScope() { if(_probe) _probe->add(dspProfilerTicks() - _start); }
+};
+
+//---------------------------------------------------------
+//   DspTrackProfileScope
+//    Like DspProfileScope, but the time spent in nested track
+//    scopes on the same thread is excluded. A track pulls the
+//    data of the tracks routed into it on demand, so without
+//    this each track would also be charged for its sources.
+//---------------------------------------------------------
+
+class DspTrackProfileScope
+{
+    static thread_local uint64_t _nested;
+
+    DspProbe* _probe;
+    uint64_t _start;
+    uint64_t _outerNested;
+
+  public:
+    inline DspTrackProfileScope(DspProbe* probe)
+      : _probe(MusEGlobal::dspProfiler.enabled() ? probe : nullptr), _start(0), _outerNested(0)
+    {
+      if(!_probe)
+        return;
+      _outerNested = _nested;
+      _nested = 0;
+      _start = dspProfilerTicks();
+    }
+    inline ~DspTrackProfileScope()
+    {
+      if(!_probe)
+        return;
+      const uint64_t total = dspProfilerTicks() - _start;
+      _probe->add(total - _nested);
+      _nested = _outerNested + total;
+    }
+};
+
+//---------------------------------------------------------
+//   DspCycleProfileScope
+//    Wraps a whole audio cycle, and commits all the probes
+//    when it ends.
+//---------------------------------------------------------
+
+class DspCycleProfileScope
+{
+    uint64_t _start;
+    bool _on;
+
+  public:
+    inline DspCycleProfileScope()
+      : _start(0), _on(MusEGlobal::dspProfiler.enabled()) { if(_on) _start = dspProfilerTicks(); }
+    inline ~DspCycleProfileScope() { if(_on) MusEGlobal::dspProfiler.endCycle(_start); }
+};
+
+} // namespace MusECore
+
+#endif
@@ -63,6 +63,7 @@
 #include "popupmenu.h"
 #include "lock_free_buffer.h"
 #include "pluglist.h"
+#include "plugin_bridge.h"
 
 namespace MusECore {
 
@@ -134,7 +135,7 @@ void initDSSI()
 //---------------------------------------------------------
 
 DssiSynth::DssiSynth(const MusEPlugin::PluginScanInfoStruct& info) 
- : Synth(info), handle(nullptr), dssi(nullptr), df(nullptr)
+ : Synth(info), handle(nullptr), dssi(nullptr), _bridge(nullptr), df(nullptr)
 
 {
   _isDssiVst = info._type == MusEPlugin::PluginScanInfoStruct::PluginTypeDSSIVST;
@@ -256,6 +257,13 @@ SynthIF* DssiSynth::createSIF(SynthI* synti)
           // Hack: Blacklist vst plugins in-place, configurable for now. 
           if((_inports != _outports) || (_isDssiVst && !MusEGlobal::config.vstInPlace))
             _requiredFeatures |= PluginNoInPlaceProcessing;
+
+          // DSSI-VST runs its plugins out of process already.
+          if(!_isDssiVst && MusEGlobal::config.pluginBridgeMode != PluginBridgeOff)
+          {
+            _bridge = new DssiBridgeDescriptor(MusEGlobal::config.pluginBridgeMode, info.filePath(), dssi);
+            dssi = _bridge->descriptor();
+          }
         }  
       }  
       
@@ -1311,6 +1319,10 @@ bool DssiSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsigned nf
 {
   const unsigned long syncFrame = MusEGlobal::audio->curSyncFrame();
 
+  // The slices below wait for a bridged synth no longer than the period, all together.
+  if(_synth->_bridge && _handle)
+    static_cast<PluginBridge*>(_handle)->startCycle(nframes);
+
   #ifdef DSSI_DEBUG_PROCESS
   fprintf(stderr, "DssiSynthIF::getData: pos:%u ports:%d nframes:%u syncFrame:%lu\n", pos, ports, nframes, syncFrame);
   #endif
@@ -1529,6 +1541,8 @@ bool DssiSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsigned nf
             if((samps & min_per_mask) != 0)
               samps += min_per;
           }
+          else if(ci.doInterp && cl)
+            samps = cl->rampSliceFrames(slice_frame, ci, &_controls[k].ramp, min_per, samps);
           else
             samps = min_per;
 
@@ -1538,7 +1552,7 @@ bool DssiSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsigned nf
         }
 
         if(ci.doInterp && cl)
-          _controls[k].val = cl->interpolate(MusEGlobal::audio->isPlaying() ? slice_frame : pos, ci);
+          _controls[k].val = cl->rampValue(MusEGlobal::audio->isPlaying() ? slice_frame : pos, ci, &_controls[k].ramp);
         else
           _controls[k].val = ci.sVal;
 
@@ -1665,7 +1679,7 @@ bool DssiSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsigned nf
             synti->_outUserEvents.insert(buf_ev);
         }
 
-        // Transfer the playback lock-free buffer events to the playback sorted multi-set.
+        // Transfer the playback lock-free buffer events to the playback queue.
         const unsigned int pb_buf_sz = synti->eventBuffers(MidiDevice::PlaybackBuffer)->getSize();
         for(unsigned int i = 0; i < pb_buf_sz; ++i)
         {
@@ -1678,13 +1692,7 @@ bool DssiSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsigned nf
       if(_curActiveState && we)
       {
         // Count how many events we need.
-        for(ciMPEvent impe = synti->_outPlaybackEvents.begin(); impe != synti->_outPlaybackEvents.end(); ++impe)
-        {
-          const MidiPlayEvent& e = *impe;
-          if(e.time() >= (syncFrame + sample + slice_samps))
-            break;
-          ++nevents;
-        }
+        nevents += synti->_outPlaybackEvents.countBefore(syncFrame + sample + slice_samps);
         for(ciMPEvent impe = synti->_outUserEvents.begin(); impe != synti->_outUserEvents.end(); ++impe)
         {
           const MidiPlayEvent& e = *impe;
@@ -1699,22 +1707,21 @@ bool DssiSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsigned nf
       // Don't bother if not 'running'.
       if(_curActiveState && we)
       {
-        iMPEvent impe_pb = synti->_outPlaybackEvents.begin();
         iMPEvent impe_us = synti->_outUserEvents.begin();
         bool using_pb;
 
         unsigned long event_counter = 0;
         while(1)
         {
-          if(impe_pb != synti->_outPlaybackEvents.end() && impe_us != synti->_outUserEvents.end())
-            using_pb = *impe_pb < *impe_us;
-          else if(impe_pb != synti->_outPlaybackEvents.end())
+          if(!synti->_outPlaybackEvents.empty() && impe_us != synti->_outUserEvents.end())
+            using_pb = synti->_outPlaybackEvents.front() < *impe_us;
+          else if(!synti->_outPlaybackEvents.empty())
             using_pb = true;
           else if(impe_us != synti->_outUserEvents.end())
             using_pb = false;
           else break;
 
-          const MidiPlayEvent& e = using_pb ? *impe_pb : *impe_us;
+          const MidiPlayEvent& e = using_pb ? synti->_outPlaybackEvents.front() : *impe_us;
 
           #ifdef DSSI_DEBUG
           fprintf(stderr, "DssiSynthIF::getData eventFifos event time:%d\n", e.time());
@@ -1747,7 +1754,7 @@ bool DssiSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsigned nf
           // Done with buffer's event. Remove it.
           // C++11.
           if(using_pb)
-            impe_pb = synti->_outPlaybackEvents.erase(impe_pb);
+            synti->_outPlaybackEvents.pop_front();
           else
             impe_us = synti->_outUserEvents.erase(impe_us);
         }
@@ -1830,6 +1837,8 @@ void DssiSynth::incInstances(int val)
               dlclose(handle);
             }
             handle = 0;
+            delete _bridge;
+            _bridge = nullptr;
             dssi = nullptr;
             df   = nullptr;
             iIdx.clear(); 
@@ -1840,6 +1849,19 @@ void DssiSynth::incInstances(int val)
       }
 }
 
+//---------------------------------------------------------
+//   latency
+//---------------------------------------------------------
+
+float DssiSynthIF::latency() const
+{
+  float l = SynthIF::latency();
+  // A pipelined plugin host is behind on top of that.
+  if(_curActiveState && _synth->_bridge && _handle)
+    l += static_cast<PluginBridge*>(_handle)->latency();
+  return l;
+}
+
 //---------------------------------------------------------
 //   guiHeartBeat
 //---------------------------------------------------------
@@ -1848,6 +1870,19 @@ void DssiSynthIF::guiHeartBeat()
 {
   SynthIF::guiHeartBeat();
 
+  if(_synth->_bridge && _handle)
+  {
+    PluginBridge* b = static_cast<PluginBridge*>(_handle);
+    b->update();
+    // Made again for a new period size, with the audio processing idled.
+    if(b->maxFrames() != MusEGlobal::segmentSize)
+    {
+      MusEGlobal::audio->msgIdle(true);
+      b->resize(MusEGlobal::segmentSize);
+      MusEGlobal::audio->msgIdle(false);
+    }
+  }
+
   #ifdef OSC_SUPPORT
   int chn = 0;  // TODO: Channel?
   int hb, lb, pr;
@@ -78,10 +78,15 @@ struct Port;
 //   DssiSynth
 //---------------------------------------------------------
 
+class DssiBridgeDescriptor;
+
 class DssiSynth : public Synth {
    protected:
       void* handle;
       const DSSI_Descriptor* dssi;
+      // Runs the instances in plugin hosts, see PluginBridge. dssi points
+      //  to its descriptor then. Null if they run in here.
+      DssiBridgeDescriptor* _bridge;
       DSSI_Descriptor_Function df;
       unsigned long _portCount, _inports, _outports, _controlInPorts, _controlOutPorts;
       std::vector<unsigned long> iIdx;  // Audio input index to port number.
@@ -154,6 +159,7 @@ class DssiSynthIF : public SynthIF
       virtual SynthI* dssiSynthI()   { return synti; }
       
       virtual void guiHeartBeat();
+      virtual float latency() const;
       virtual bool hasGui() const { return true; }
       virtual bool nativeGuiVisible() const;                                        
       virtual void showNativeGui(bool);                                              
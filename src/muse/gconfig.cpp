@@ -405,7 +405,28 @@ GlobalConfigValues config = {
       true,                         // audioAutomationDrawDiscrete
       true,                         // audioAutomationShowBoxes
       true,                         // audioAutomationOptimize
-      2                             // audioAutomationPointRadius
+      2,                            // audioAutomationPointRadius
+      0,                            // audioGraphWorkerThreads
+      false,                        // showDspLoad
+      0,                            // anticipativeRenderThreads
+      300,                          // anticipativeRenderLookahead
+      3000,                         // freezeTailMs
+      2,                            // prefetchThreads
+      4,                            // prefetchBatchSegments
+      true,                         // mappedWaveRead
+      3000,                         // prefetchReadaheadMs
+      12000,                        // prefetchMaxReadaheadMs
+      512,                          // loopCacheMB
+      2,                            // waveOverviewThreads
+      16,                           // decodeCacheMB
+      0,                            // convertCacheMB
+      500,                          // recordBatchMs
+      4,                            // waveLoadThreads
+      0.001,                        // automationSliceTolerance
+      0,                            // pluginBridgeMode
+      false,                        // lazyPluginInstances
+      4,                            // pluginLoadThreads
+      2                             // decodeThreads
 };
 
 } // namespace MusEGlobal
@@ -447,6 +447,57 @@ struct GlobalConfigValues {
       bool audioAutomationShowBoxes;
       bool audioAutomationOptimize;
       int audioAutomationPointRadius;
+      // Number of extra worker threads processing independent track branches in parallel.
+      // Zero processes all tracks serially in the audio thread.
+      int audioGraphWorkerThreads;
+      // Whether mixer strips show the time the track spends processing.
+      bool showDspLoad;
+      // Number of worker threads rendering playback-only wave tracks ahead of the transport.
+      // Zero renders all tracks in the audio thread, in the cycle they are played.
+      int anticipativeRenderThreads;
+      // How far ahead of the transport those tracks are rendered, in milliseconds.
+      int anticipativeRenderLookahead;
+      // How long to keep rendering past the end of the song when freezing a track,
+      //  to catch reverb tails and such, in milliseconds.
+      int freezeTailMs;
+      // Number of extra threads reading wave track data from disk, besides the prefetch thread.
+      int prefetchThreads;
+      // Most prefetch fifo blocks read from disk in one go per track.
+      int prefetchBatchSegments;
+      // Whether uncompressed wave files are read through a memory mapping instead of libsndfile.
+      bool mappedWaveRead;
+      // How much wave track data the prefetch reads ahead of the transport, in milliseconds.
+      int prefetchReadaheadMs;
+      // How far a track's readahead may grow after underruns or slow reads, in milliseconds.
+      int prefetchMaxReadaheadMs;
+      // Memory for keeping the loop region of wave tracks, in megabytes. Zero = off.
+      int loopCacheMB;
+      // Threads building the peak files of wave files in the background.
+      int waveOverviewThreads;
+      // Decoded audio kept for each compressed (FLAC, Ogg) wave file, in megabytes. Zero = decode directly.
+      int decodeCacheMB;
+      // Disk space for copies of wave files converted to the project sample rate, in megabytes. Zero = off.
+      int convertCacheMB;
+      // Recorded audio collected per track before it is written to disk, in milliseconds.
+      int recordBatchMs;
+      // Threads opening the wave files of a project while it is loaded.
+      int waveLoadThreads;
+      // How far an automation ramp may move, as a part of the controller's range, before
+      //  plugins are run with its new value. Zero = every minControlProcessPeriod.
+      double automationSliceTolerance;
+      // How LADSPA and DSSI plugins and DSSI synths are run: 0 = in the audio thread,
+      //  1 = each in its own process, 2 = each in its own process, one period behind.
+      //  See PluginBridgeMode. LV2, native VST and DSSI-VST ones are not bridged.
+      int pluginBridgeMode;
+      // Leave the plugins of tracks which are off or not routed to an output
+      //  uninstantiated when loading a project, until they are needed.
+      //  Synths are always made while the project is read, only their racks wait.
+      bool lazyPluginInstances;
+      // Number of threads making the effect plugin instances when loading a project.
+      //  Synths are not made on them.
+      int pluginLoadThreads;
+      // Threads decoding compressed wave files ahead, shared by all files.
+      int decodeThreads;
       };
 
 
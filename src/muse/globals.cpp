@@ -33,8 +33,8 @@ namespace MusEGlobal {
 
 int sampleRate   = 44100;
 unsigned segmentSize  = 1024U;    // segmentSize in frames (set by JACK)
-unsigned fifoLength =  128;       // 131072/segmentSize
-                                  // 131072 - magic number that gives a sufficient buffer size
+unsigned fifoLength =  128;       // config.prefetchReadaheadMs worth of segments
+unsigned fifoMaxLength = 512;     // config.prefetchMaxReadaheadMs worth of segments
 int segmentCount = 2;
 
 //   NOTE: For now, this is TEMPORARILY set to the project sample rate during song loading,
@@ -55,6 +55,7 @@ extern const float denormalBias;
 extern int sampleRate;
 extern unsigned segmentSize;
 extern unsigned fifoLength; // inversely proportional to segmentSize
+extern unsigned fifoMaxLength; // the most a track's prefetch fifo may grow to
 extern int segmentCount;
 extern int projectSampleRate;
 extern const int numAudioSampleRates;
@@ -738,6 +738,8 @@ class LockFreeMPSCRingBuffer
         return true;
       }
 
+      // Returns the actual capacity, which is the requested capacity rounded up to a power of 2.
+      inline unsigned int capacity() const { return _capacity; }
       // This is only for the reader.
       // Returns the number of items in the buffer.
       inline unsigned int getSize() const { return _size.load(); }
@@ -5298,6 +5298,10 @@ bool LV2SynthIF::getData(MidiPort *, unsigned int pos, int ports, unsigned int n
                             samps += min_per;
                         }
                     }
+                    else if(ci.doInterp && cl)
+                    {
+                        samps = cl->rampSliceFrames(slice_frame, ci, &_controls[k].ramp, min_per, samps);
+                    }
                     else
                     {
                         samps = min_per;
@@ -5312,7 +5316,7 @@ bool LV2SynthIF::getData(MidiPort *, unsigned int pos, int ports, unsigned int n
 
                 if(ci.doInterp && cl)
                 {
-                    _controls[k].val = cl->interpolate(MusEGlobal::audio->isPlaying() ? slice_frame : pos, ci);
+                    _controls[k].val = cl->rampValue(MusEGlobal::audio->isPlaying() ? slice_frame : pos, ci, &_controls[k].ramp);
                 }
                 else
                 {
@@ -5489,7 +5493,7 @@ bool LV2SynthIF::getData(MidiPort *, unsigned int pos, int ports, unsigned int n
                         synti->_outUserEvents.insert(buf_ev);
                 }
 
-                // Transfer the playback lock-free buffer events to the playback sorted multi-set.
+                // Transfer the playback lock-free buffer events to the playback queue.
                 const unsigned int pb_buf_sz = synti->eventBuffers(MidiDevice::PlaybackBuffer)->getSize();
                 for(unsigned int i = 0; i < pb_buf_sz; ++i)
                 {
@@ -5501,21 +5505,20 @@ bool LV2SynthIF::getData(MidiPort *, unsigned int pos, int ports, unsigned int n
               // Don't bother if not 'running'.
               if(_curActiveState && we)
               {
-                iMPEvent impe_pb = synti->_outPlaybackEvents.begin();
                 iMPEvent impe_us = synti->_outUserEvents.begin();
                 bool using_pb;
 
                 while(1)
                 {
-                    if(impe_pb != synti->_outPlaybackEvents.end() && impe_us != synti->_outUserEvents.end())
-                        using_pb = *impe_pb < *impe_us;
-                    else if(impe_pb != synti->_outPlaybackEvents.end())
+                    if(!synti->_outPlaybackEvents.empty() && impe_us != synti->_outUserEvents.end())
+                        using_pb = synti->_outPlaybackEvents.front() < *impe_us;
+                    else if(!synti->_outPlaybackEvents.empty())
                         using_pb = true;
                     else if(impe_us != synti->_outUserEvents.end())
                         using_pb = false;
                     else break;
 
-                    const MidiPlayEvent& e = using_pb ? *impe_pb : *impe_us;
+                    const MidiPlayEvent& e = using_pb ? synti->_outPlaybackEvents.front() : *impe_us;
 
     #ifdef LV2_DEBUG
                     fprintf(stderr, "LV2SynthIF::getData eventFifos event time:%d\n", e.time());
@@ -5544,7 +5547,7 @@ bool LV2SynthIF::getData(MidiPort *, unsigned int pos, int ports, unsigned int n
                     // Done with buffer's event. Remove it.
                     // C++11.
                     if(using_pb)
-                        impe_pb = synti->_outPlaybackEvents.erase(impe_pb);
+                        synti->_outPlaybackEvents.pop_front();
                     else
                         impe_us = synti->_outUserEvents.erase(impe_us);
                 }
@@ -7342,6 +7345,10 @@ bool LV2PluginWrapper::hasNativeGui() const
 
 void LV2PluginWrapper::showNativeGui(PluginI *p, bool bShow)
 {
+    if(!bShow && p->instancesPending())
+        return;
+    if(p->makePendingInstances())
+        return;
     assert(p->instances > 0);
     LV2PluginWrapper_State *state = (LV2PluginWrapper_State *)p->handle [0];
 
@@ -7360,6 +7367,8 @@ void LV2PluginWrapper::showNativeGui(PluginI *p, bool bShow)
 
 bool LV2PluginWrapper::nativeGuiVisible(const PluginI *p) const
 {
+    if(p->instancesPending())
+        return false;
     assert(p->instances > 0);
     LV2PluginWrapper_State *state = (LV2PluginWrapper_State *)p->handle [0];
     return (state->widget != nullptr);
@@ -7399,6 +7408,8 @@ void LV2PluginWrapper::setCustomData(LADSPA_Handle handle, const std::vector<QSt
 
 void LV2PluginWrapper::populatePresetsMenu(PluginI *p, MusEGui::PopupMenu *menu)
 {
+    if(p->makePendingInstances())
+        return;
     assert(p->instances > 0);
     LV2PluginWrapper_State *state = (LV2PluginWrapper_State *)p->handle [0];
     assert(state != nullptr);
@@ -7409,6 +7420,8 @@ void LV2PluginWrapper::populatePresetsMenu(PluginI *p, MusEGui::PopupMenu *menu)
 
 void LV2PluginWrapper::applyPreset(PluginI *p, void *preset)
 {
+    if(p->makePendingInstances())
+        return;
     assert(p->instances > 0);
     LV2PluginWrapper_State *state = (LV2PluginWrapper_State *)p->handle [0];
     assert(state != nullptr);
@@ -84,6 +84,7 @@
 #include "audio_convert/audio_converter_settings_group.h"
 #include "wave.h"
 #include "conf.h"
+#include "offline_render.h"
 
 #ifdef HAVE_LASH
 #include <lash/lash.h>
@@ -104,6 +105,7 @@
 
 namespace MusECore {
 extern bool initDummyAudio();
+extern bool initOfflineAudio(int sampleRate);
 #ifdef HAVE_RTAUDIO
 extern bool initRtAudio(bool forceDefault = false);
 #endif
@@ -312,7 +314,8 @@ enum CommandLineParseResult
 
 CommandLineParseResult parseCommandLine(
   QCommandLineParser &parser, QString *errorMessage,
-  QString& open_filename, AudioDriverSelect& audioType, bool& force_plugin_rescan, bool& dont_plugin_rescan)
+  QString& open_filename, AudioDriverSelect& audioType, bool& force_plugin_rescan, bool& dont_plugin_rescan,
+  MusECore::OfflineRenderSettings& render_settings)
 {
   parser.setApplicationDescription(APP_DESCRIPTION);
   const QString version_string(VERSION);
@@ -401,6 +404,17 @@ CommandLineParseResult parseCommandLine(
   QCommandLineOption option_s("s", QCoreApplication::translate("main", "Debug mode: trace sync\n"));
   parser.addOption(option_s);
 
+  QCommandLineOption option_render("render", QCoreApplication::translate("main",
+    "Render the given project headless, without gui or audio server, and quit.\n"
+    "Each audio output (or each --render-track) is written to dir as a wave file."), "dir");
+  parser.addOption(option_render);
+  QCommandLineOption option_render_track("render-track", QCoreApplication::translate("main",
+    "With --render: Render this track instead of the audio outputs. Can be given more than once."), "name");
+  parser.addOption(option_render_track);
+  QCommandLineOption option_render_threads("render-threads", QCoreApplication::translate("main",
+    "With --render: Number of file writer threads (default: one per file)"), "n");
+  parser.addOption(option_render_threads);
+
 #ifdef PYTHON_SUPPORT
   QCommandLineOption option_y("y", QCoreApplication::translate("main", "Enable Python control support")); 
   parser.addOption(option_y);
@@ -491,6 +505,25 @@ CommandLineParseResult parseCommandLine(
   if(parser.isSet(option_s))
     MusEGlobal::debugSync = true;
 
+  if(parser.isSet(option_render))
+  {
+    if(open_filename.isEmpty())
+    {
+      *errorMessage = "Error: --render requires a project file";
+      return CommandLineError;
+    }
+    render_settings.projectFile = open_filename;
+    render_settings.outputDir = parser.value(option_render);
+    render_settings.tracks = parser.values(option_render_track);
+    if(parser.isSet(option_render_threads))
+      render_settings.writerThreads = parser.value(option_render_threads).toInt();
+    // No realtime requirements when rendering.
+    MusEGlobal::realTimeScheduling = false;
+#ifdef HAVE_LASH
+    MusEGlobal::useLASH = false;
+#endif
+  }
+
   if(parser.isSet(option_u))
     MusEGlobal::unityWorkaround = true;
 
@@ -661,6 +694,18 @@ int main(int argc, char* argv[])
         if (QStyleFactory::keys().contains(MusEGlobal::defaultStyle, Qt::CaseInsensitive))
             QApplication::setStyle(MusEGlobal::defaultStyle);
 
+        // When rendering headless there may be no display at all.
+        // Pre-scan for it, since the application must be created before parsing.
+        for(int i = 1; i < argc_copy; ++i)
+        {
+          if(argv_copy[i] && (strcmp(argv_copy[i], "--render") == 0 || strncmp(argv_copy[i], "--render=", 9) == 0))
+          {
+            if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+              qputenv("QT_QPA_PLATFORM", "offscreen");
+            break;
+          }
+        }
+
         //========================
         //  Application instance:
         //========================
@@ -1048,12 +1093,13 @@ int main(int argc, char* argv[])
         AudioDriverSelect audioType = DriverConfigSetting;
         bool force_plugin_rescan = false;
         bool dont_plugin_rescan = false;
+        MusECore::OfflineRenderSettings render_settings;
         // A block because we don't want ths hanging around. Use it then lose it.
         {
           QCommandLineParser parser;
           QString errorMessage;
           switch (parseCommandLine(parser, &errorMessage, open_filename,
-                                   audioType, force_plugin_rescan, dont_plugin_rescan))
+                                   audioType, force_plugin_rescan, dont_plugin_rescan, render_settings))
           {
             case CommandLineOk:
                 break;
@@ -1234,7 +1280,7 @@ int main(int argc, char* argv[])
 
         QString splash_prefix;
         QSplashScreen* muse_splash = nullptr;
-        if (MusEGlobal::config.showSplashScreen) {
+        if (MusEGlobal::config.showSplashScreen && !render_settings.enabled()) {
             QPixmap splsh(MusEGlobal::museGlobalShare + "/splash.jpg");
 
             if (!splsh.isNull()) {
@@ -1348,11 +1394,19 @@ int main(int argc, char* argv[])
         if (MusEGlobal::loadMESS)
           MusECore::initMidiSynth(); // Need to do this now so that Add Track -> Synth menu is populated when MusE is created.
 
-        MusEGlobal::muse = new MusEGui::MusE();
-        app.setMuse(MusEGlobal::muse);
-        
-        MusEGui::init_function_dialogs();
-        MusEGui::retranslate_function_dialogs();
+        if(render_settings.enabled())
+        {
+          // No main window. Create what it would own.
+          MusECore::initOfflineRender();
+        }
+        else
+        {
+          MusEGlobal::muse = new MusEGui::MusE();
+          app.setMuse(MusEGlobal::muse);
+
+          MusEGui::init_function_dialogs();
+          MusEGui::retranslate_function_dialogs();
+        }
 
         if(muse_splash)
         {
@@ -1390,7 +1444,12 @@ int main(int argc, char* argv[])
 #ifdef HAVE_LASH
         bool using_jack = false;
 #endif
-        if (MusEGlobal::debugMode) {
+        if (render_settings.enabled()) {
+            // Run at the project's own rate if it has one, to avoid resampling.
+            fprintf(stderr, "Using offline audio driver for rendering\n");
+            MusECore::initOfflineAudio(MusECore::readOfflineRenderSampleRate(render_settings.projectFile));
+        }
+        else if (MusEGlobal::debugMode) {
             MusEGlobal::realTimeScheduling = false;
             MusECore::initDummyAudio();
         }
@@ -1493,8 +1552,7 @@ int main(int argc, char* argv[])
         // Jack says: "Cannot use real-time scheduling (RR/10)(1: Operation not permitted)". The kernel is non-RT.
         // I cannot seem to find a reliable answer to the question, even with dummy audio and system calls.
 
-        // setup the prefetch fifo length now that the segmentSize is known
-        MusEGlobal::fifoLength = 131072 / MusEGlobal::segmentSize;
+        // setup the prefetch fifo length now that the sampleRate and segmentSize are known
         MusECore::initAudioPrefetch();
 
         // Set up the wave module now that sampleRate and segmentSize are known.
@@ -1503,7 +1561,13 @@ int main(int argc, char* argv[])
           &MusEGlobal::audioConverterPluginList,
           &MusEGlobal::defaultAudioConverterSettings,
           MusEGlobal::sampleRate,
-          MusEGlobal::segmentSize);
+          MusEGlobal::segmentSize,
+          MusEGlobal::config.mappedWaveRead,
+          MusEGlobal::config.waveOverviewThreads,
+          MusEGlobal::config.decodeCacheMB,
+          MusEGlobal::cachePath.isEmpty() ? QString() : MusEGlobal::cachePath + "/converted",
+          MusEGlobal::config.convertCacheMB,
+          MusEGlobal::config.decodeThreads);
         
         if(muse_splash)
         {
@@ -1639,97 +1703,105 @@ int main(int argc, char* argv[])
               }
 #endif
 
-        qDebug() << "->" << qPrintable(QTime::currentTime().toString("hh:mm:ss.zzz"))
-                 << "Populating Track context menu...";
-
-        if(muse_splash)
+        if(render_settings.enabled())
         {
-          muse_splash->showMessage(splash_prefix + QString(" Populating Track context menu..."),
-                                   Qt::AlignLeft|Qt::AlignBottom, Qt::yellow);
-          qApp->processEvents();
+          rv = MusECore::renderOffline(render_settings);
+          MusECore::exitOfflineRender();
         }
+        else
+        {
+          qDebug() << "->" << qPrintable(QTime::currentTime().toString("hh:mm:ss.zzz"))
+                   << "Populating Track context menu...";
 
-        MusEGlobal::muse->populateAddTrack(); // could possibly be done in a thread.
+          if(muse_splash)
+          {
+            muse_splash->showMessage(splash_prefix + QString(" Populating Track context menu..."),
+                                     Qt::AlignLeft|Qt::AlignBottom, Qt::yellow);
+            qApp->processEvents();
+          }
 
-        qDebug() << "->" << qPrintable(QTime::currentTime().toString("hh:mm:ss.zzz"))
-                 << "Show GUI...";
+          MusEGlobal::muse->populateAddTrack(); // could possibly be done in a thread.
 
-        MusEGlobal::muse->show();
+          qDebug() << "->" << qPrintable(QTime::currentTime().toString("hh:mm:ss.zzz"))
+                   << "Show GUI...";
 
-        // Let the configuration settings take effect. Do not save.
-        MusEGlobal::muse->changeConfig(false);
-        // Set style and stylesheet, and do not force the style
-        //MusEGui::updateThemeAndStyle(); // Works better if called just after app created, above.
+          MusEGlobal::muse->show();
 
-        MusEGlobal::muse->seqStart();
-        MusEGlobal::muse->initStatusBar();
-        
-        // If the sequencer object was created, report timing.
-        if(MusEGlobal::midiSeq)
-          MusEGlobal::midiSeq->checkAndReportTimingResolution();
+          // Let the configuration settings take effect. Do not save.
+          MusEGlobal::muse->changeConfig(false);
+          // Set style and stylesheet, and do not force the style
+          //MusEGui::updateThemeAndStyle(); // Works better if called just after app created, above.
 
-        //--------------------------------------------------
-        // Set the audio device sync timeout value.
-        //--------------------------------------------------
-        // Enforce a 30 second timeout.
-        // TODO: Split this up and have user adjustable normal (2 or 10 second default) value,
-        //        plus a contribution from the total required precount time.
-        //       Too bad we likely can't set it dynamically in the audio sync callback.
-        // NOTE: This is also enforced casually in Song:seqSignal after a stop, start, or seek.
-        MusEGlobal::audioDevice->setSyncTimeout(30000000);
+          MusEGlobal::muse->seqStart();
+          MusEGlobal::muse->initStatusBar();
+        
+          // If the sequencer object was created, report timing.
+          if(MusEGlobal::midiSeq)
+            MusEGlobal::midiSeq->checkAndReportTimingResolution();
+
+          //--------------------------------------------------
+          // Set the audio device sync timeout value.
+          //--------------------------------------------------
+          // Enforce a 30 second timeout.
+          // TODO: Split this up and have user adjustable normal (2 or 10 second default) value,
+          //        plus a contribution from the total required precount time.
+          //       Too bad we likely can't set it dynamically in the audio sync callback.
+          // NOTE: This is also enforced casually in Song:seqSignal after a stop, start, or seek.
+          MusEGlobal::audioDevice->setSyncTimeout(30000000);
               
-        //--------------------------------------------------
-        // Auto-fill the midi ports, if appropriate.
-        // Only if NOT actually opening an existing file.
-        // FIXME: Maybe check if it's a .med file (song may populate)
-        //         or .mid file (always populate) or .wav file etc.
-        //--------------------------------------------------
-        if(MusEGlobal::populateMidiPortsOnStart &&
-           ((!open_filename.isEmpty() && !QFile(open_filename).exists()) ||
-           (open_filename.isEmpty() &&
-           (MusEGlobal::config.startMode == 1 || MusEGlobal::config.startMode == 2) &&
-           !MusEGlobal::config.startSongLoadConfig)))
-          MusECore::populateMidiPorts();
-
-        if(muse_splash)
-        {
-            muse_splash->showMessage(splash_prefix + QString(" Click to close splash screen..."),
-                                     Qt::AlignLeft|Qt::AlignBottom, Qt::yellow);
+          //--------------------------------------------------
+          // Auto-fill the midi ports, if appropriate.
+          // Only if NOT actually opening an existing file.
+          // FIXME: Maybe check if it's a .med file (song may populate)
+          //         or .mid file (always populate) or .wav file etc.
+          //--------------------------------------------------
+          if(MusEGlobal::populateMidiPortsOnStart &&
+             ((!open_filename.isEmpty() && !QFile(open_filename).exists()) ||
+             (open_filename.isEmpty() &&
+             (MusEGlobal::config.startMode == 1 || MusEGlobal::config.startMode == 2) &&
+             !MusEGlobal::config.startSongLoadConfig)))
+            MusECore::populateMidiPorts();
+
+          if(muse_splash)
+          {
+              muse_splash->showMessage(splash_prefix + QString(" Click to close splash screen..."),
+                                       Qt::AlignLeft|Qt::AlignBottom, Qt::yellow);
 
-          // From this point on, slap a timer on it so that it stays up for few seconds,
-          //  since closing it now might be too short display time.
-            QTimer::singleShot(3000, muse_splash, SLOT(close()));
-        }
+            // From this point on, slap a timer on it so that it stays up for few seconds,
+            //  since closing it now might be too short display time.
+              QTimer::singleShot(3000, muse_splash, SLOT(close()));
+          }
 
-        qDebug() << "->" << qPrintable(QTime::currentTime().toString("hh:mm:ss.zzz"))
-                 << "Load default project";
+          qDebug() << "->" << qPrintable(QTime::currentTime().toString("hh:mm:ss.zzz"))
+                   << "Load default project";
 
-        //--------------------------------------------------
-        // Load the default song.
-        //--------------------------------------------------
-        // When restarting, override with the last project file name used.
-        if(last_project_filename.isEmpty())
-        {
-          MusEGlobal::muse->loadDefaultSong(open_filename, false, false);
-        }
-        else
-        {
-          MusEGlobal::muse->loadDefaultSong(
-            last_project_filename, last_project_was_template, last_project_loaded_config);
-        }
+          //--------------------------------------------------
+          // Load the default song.
+          //--------------------------------------------------
+          // When restarting, override with the last project file name used.
+          if(last_project_filename.isEmpty())
+          {
+            MusEGlobal::muse->loadDefaultSong(open_filename, false, false);
+          }
+          else
+          {
+            MusEGlobal::muse->loadDefaultSong(
+              last_project_filename, last_project_was_template, last_project_loaded_config);
+          }
 
-        QTimer::singleShot(100, MusEGlobal::muse, SLOT(showDidYouKnowDialogIfEnabled()));
+          QTimer::singleShot(100, MusEGlobal::muse, SLOT(showDidYouKnowDialogIfEnabled()));
 
-        //--------------------------------------------------
-        // Start the application...
-        //--------------------------------------------------
+          //--------------------------------------------------
+          // Start the application...
+          //--------------------------------------------------
 
-        qDebug() << "->" << qPrintable(QTime::currentTime().toString("hh:mm:ss.zzz"))
-                 << "Start application loop...";
+          qDebug() << "->" << qPrintable(QTime::currentTime().toString("hh:mm:ss.zzz"))
+                   << "Start application loop...";
 
-        qDebug() << "Total start-up time:" << timer.elapsed() << "ms";
+          qDebug() << "Total start-up time:" << timer.elapsed() << "ms";
 
-        rv = app.exec();
+          rv = app.exec();
+        }
 
         //--------------------------------------------------
         // ... Application finished.
@@ -1756,12 +1828,13 @@ int main(int argc, char* argv[])
         MusECore::exitMidiSequencer();
 
         // Grab the restart flag before deleting muse.
-        is_restarting = MusEGlobal::muse->restartingApp();
+        is_restarting = MusEGlobal::muse && MusEGlobal::muse->restartingApp();
         
         if (is_restarting)
             qDebug() << "\n->" << qPrintable(QTime::currentTime().toString("hh:mm:ss.zzz"))
                      << "Restarting application...";
 
+        if(MusEGlobal::muse)
         {
           // If the current project file name exists, set the last_project_filename
           //  variable so that if restarting, it starts with that file.
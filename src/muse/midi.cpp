@@ -53,6 +53,7 @@
 #include "sig.h"
 #include "keyevent.h"
 #include "track.h"
+#include "dsp_profiler.h"
 
 // REMOVE Tim. Persistent routes. Added. Make this permanent later if it works OK and makes good sense.
 #define _USE_MIDI_ROUTE_PER_CHANNEL_
@@ -1631,6 +1632,8 @@ bool processMidiToAudioControl(
 
 void Audio::processMidi(unsigned int frames)
       {
+      DspProfileScope prof(MusEGlobal::dspProfiler.midiProbe());
+
       const bool extsync = MusEGlobal::extSyncFlag;
       const bool playing = isPlaying();
       const unsigned int segSize = MusEGlobal::segmentSize;
@@ -198,6 +198,11 @@ AudioMixerApp::AudioMixerApp(QWidget* parent, MusEGlobal::MixerConfig* c, bool d
       momentarySoloId->setData(MOMENTARY_SOLO);
       momentarySoloId->setCheckable(true);
 
+      showDspLoadId = new QAction(tr("Show DSP Load"), actionItems);
+      showDspLoadId->setData(SHOW_DSP_LOAD);
+      showDspLoadId->setCheckable(true);
+      showDspLoadId->setStatusTip(tr("Show the time each track and its effects spend processing, per audio cycle."));
+
       // Add the group actions so far.
       menuView->addActions(actionItems->actions());
 
@@ -755,6 +760,7 @@ void AudioMixerApp::menuViewAboutToShow()
   monOnRecArmId->setChecked(MusEGlobal::config.monitorOnRecord);
   momentaryMuteId->setChecked(MusEGlobal::config.momentaryMute);
   momentarySoloId->setChecked(MusEGlobal::config.momentarySolo);
+  showDspLoadId->setChecked(MusEGlobal::config.showDspLoad);
 
   // Check that there is only one strip selected.
   int numsel = 0;
@@ -834,6 +840,13 @@ void AudioMixerApp::menuViewGroupTriggered(QAction* act)
         MusEGlobal::muse->changeConfig(true); // Save settings immediately, and use simple version.
       }
     break;
+    case SHOW_DSP_LOAD:
+      if(MusEGlobal::config.showDspLoad != checked)
+      {
+        MusEGlobal::config.showDspLoad = checked;
+        MusEGlobal::muse->changeConfig(true); // Save settings immediately, and use simple version.
+      }
+    break;
     case CHANGE_TRACK_NAME:
       changeTrackNameTriggered();
     break;
@@ -96,6 +96,7 @@ class AudioMixerApp : public QMainWindow {
         MOMENTARY_SOLO = -2005,
         CHANGE_TRACK_NAME = -2006,
         ADVANCED_ROUTER = -2007,
+        SHOW_DSP_LOAD = -2008,
 
         SHOW_MIDI_TRACKS = -3000,
         SHOW_DRUM_TRACKS = -3001,
@@ -141,6 +142,7 @@ class AudioMixerApp : public QMainWindow {
       QAction* monOnRecArmId;
       QAction* momentaryMuteId;
       QAction* momentarySoloId;
+      QAction* showDspLoadId;
       QMenu* menuAudEffRackVisibleItems;
       QActionGroup* audEffRackVisibleGroup;
       QAction* changeTrackNameId;
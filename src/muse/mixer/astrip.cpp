@@ -39,6 +39,7 @@
 #include <QAction>
 #include <QGridLayout>
 #include <QPushButton>
+#include <QLabel>
 
 #include "app.h"
 #include "globals.h"
@@ -60,6 +61,7 @@
 #include "utils.h"
 #include "muse_math.h"
 #include "operations.h"
+#include "dsp_profiler.h"
 
 // Forwards from header:
 #include <QHBoxLayout>
@@ -840,6 +842,8 @@ void AudioStrip::heartBeat()
    _upperRack->updateComponents();
 //   _infoRack->updateComponents();
    _lowerRack->updateComponents();
+   if(_dspProfiling)
+     updateDspLoad();
 
 //    if(_recMonitor && _recMonitor->isChecked() && MusEGlobal::blinkTimerPhase != _recMonitor->blinkPhase())
 //      _recMonitor->setBlinkPhase(MusEGlobal::blinkTimerPhase);
@@ -847,6 +851,60 @@ void AudioStrip::heartBeat()
    Strip::heartBeat();
 }
 
+//---------------------------------------------------------
+//   setDspProfiling
+//---------------------------------------------------------
+
+void AudioStrip::setDspProfiling(bool on)
+{
+  if(on == _dspProfiling)
+    return;
+  _dspProfiling = on;
+  if(on)
+    MusEGlobal::dspProfiler.acquire();
+  else
+    MusEGlobal::dspProfiler.release();
+  _dspLoadLabel->setText(QString());
+  _dspLoadLabel->setToolTip(QString());
+  _dspLoadLabel->setVisible(on);
+}
+
+//---------------------------------------------------------
+//   updateDspLoad
+//---------------------------------------------------------
+
+void AudioStrip::updateDspLoad()
+{
+  MusECore::AudioTrack* at = static_cast<MusECore::AudioTrack*>(track);
+  MusECore::DspProbeStats st;
+  if(!at->dspProbe()->stats(&st))
+    return;
+
+  _dspLoadLabel->setText(QString("%1%").arg(st.avgLoad, 0, 'f', 1));
+  // Highlight tracks which alone take up a large part of the cycle.
+  if(st.maxLoad >= 50.0)
+    _dspLoadLabel->setStyleSheet("QLabel { color : red; }");
+  else
+    _dspLoadLabel->setStyleSheet(_dspLoadDefStyle);
+
+  QString tt = tr("Track: avg %1 us, p99 %2 us, max %3 us")
+    .arg(st.avgUs, 0, 'f', 1).arg(st.p99Us, 0, 'f', 1).arg(st.maxUs, 0, 'f', 1);
+  if(at->type() == MusECore::Track::AUDIO_SOFTSYNTH &&
+     static_cast<MusECore::SynthI*>(at)->synthDspProbe()->stats(&st))
+    tt += tr("\nSynth: avg %1 us, max %2 us").arg(st.avgUs, 0, 'f', 1).arg(st.maxUs, 0, 'f', 1);
+  const MusECore::Pipeline* pl = at->efxPipe();
+  if(pl)
+  {
+    for(MusECore::ciPluginI ip = pl->cbegin(); ip != pl->cend(); ++ip)
+    {
+      MusECore::PluginI* p = *ip;
+      if(p && p->dspProbe()->stats(&st))
+        tt += tr("\n%1: avg %2 us, max %3 us").arg(p->name()).arg(st.avgUs, 0, 'f', 1).arg(st.maxUs, 0, 'f', 1);
+    }
+  }
+  _dspLoadLabel->setToolTip(tt);
+}
+
 void AudioStrip::updateRackSizes(bool upper, bool lower)
 {
 //   const QFontMetrics fm = fontMetrics();
@@ -943,6 +1001,8 @@ void AudioStrip::configChanged()
   // Set the strip label's font.
   setLabelText();
 
+  setDspProfiling(MusEGlobal::config.showDspLoad);
+
   slider->setFillColor(MusEGlobal::config.audioVolumeSliderColor);
   slider->setHandleColor(MusEGlobal::config.audioVolumeHandleColor);
 
@@ -1420,6 +1480,7 @@ void AudioStrip::updateChannels()
 AudioStrip::~AudioStrip()
       {
         DEBUG_AUDIO_STRIP(stderr, "~AudioStrip:%p\n", this);
+        setDspProfiling(false);
       }
 
 //---------------------------------------------------------
@@ -1897,6 +1958,22 @@ AudioStrip::AudioStrip(QWidget* parent, MusECore::AudioTrack* at, bool hasHandle
       connect(autoType, SIGNAL(activated(int)), SLOT(setAutomationType(int)));
       bottomLayout->addWidget(autoType, 2, 0, 1, 2);
 
+      //---------------------------------------------------
+      //    dsp load
+      //---------------------------------------------------
+
+      _dspProfiling = false;
+      _dspLoadLabel = new QLabel(this);
+      _dspLoadLabel->setObjectName("DspLoadLabel");
+      _dspLoadLabel->setAlignment(Qt::AlignCenter);
+      _dspLoadLabel->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Minimum);
+      _dspLoadLabel->setStatusTip(tr("Average time this track spends processing, in percent of the audio cycle. "
+                                     "Hover for details."));
+      _dspLoadLabel->ensurePolished();
+      _dspLoadDefStyle = _dspLoadLabel->styleSheet();
+      bottomLayout->addWidget(_dspLoadLabel, 4, 0, 1, 2);
+      setDspProfiling(MusEGlobal::config.showDspLoad);
+
       addGridLayout(bottomLayout, _bottomPos);
 
       grid->setColumnStretch(2, 10);
@@ -34,6 +34,7 @@
 
 // Forward declarations:
 class QHBoxLayout;
+class QLabel;
 
 namespace MusECore {
 class AudioTrack;
@@ -255,6 +256,12 @@ class AudioStrip : public Strip {
       ClipperLabel* _clipperLabel[MusECore::MAX_CHANNELS];
       QHBoxLayout* _clipperLayout;
 
+      // Shows the track's processing time. Only while the showDspLoad setting is on,
+      //  in which case the strip is also a user of the dsp profiler.
+      QLabel* _dspLoadLabel;
+      bool _dspProfiling;
+      QString _dspLoadDefStyle;
+
       void setClipperTooltip(int ch);
       void colorAutoType();
 
@@ -263,6 +270,8 @@ class AudioStrip : public Strip {
       void updateChannels();
       void updateRackSizes(bool upper, bool lower);
       void setStripStyle();
+      void setDspProfiling(bool on);
+      void updateDspLoad();
 
    private slots:
       void recMonitorToggled(bool);
@@ -26,6 +26,7 @@
 #include <sndfile.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <algorithm>
 
 #include <QString>
 
@@ -44,6 +45,7 @@
 #include "wavepreview.h"
 #include "al/dsp.h"
 #include "latency_compensator.h"
+#include "track_freeze.h"
 
 // REMOVE Tim. Persistent routes. Added. Make this permanent later if it works OK and makes good sense.
 #define _USE_SIMPLIFIED_SOLO_CHAIN_
@@ -63,6 +65,9 @@
 
 namespace MusECore {
 
+// Frames of automation ramps worked out at once while processing.
+static const unsigned long ctrlRampFrames = 256;
+
 //---------------------------------------------------------
 //   setSolo
 //---------------------------------------------------------
@@ -529,6 +534,9 @@ void AudioTrack::processTrackCtrls(unsigned pos, int trackChans, unsigned nframe
         float *sp1, *sp2, *dp1, *dp2;
         sp1 = sp2 = dp1 = dp2 = nullptr;
         double _volume, v, _pan, v1, v2;
+        // The automated volume and pan of the next frames, while they ramp.
+        double vol_ramp[ctrlRampFrames];
+        double pan_ramp[ctrlRampFrames];
 
         if(trackChans == 1)
         {
@@ -553,7 +561,10 @@ void AudioTrack::processTrackCtrls(unsigned pos, int trackChans, unsigned nframe
           {
             for( ; k < nsamp; ++k)
             {
-              _volume = vol_ctrl->interpolate(slice_frame + k, vol_interp);
+              const unsigned long r = k % ctrlRampFrames;
+              if(r == 0)
+                vol_ctrl->fillRamp(slice_frame + k, std::min(nsamp - k, ctrlRampFrames), vol_interp, vol_ramp);
+              _volume = vol_ramp[r];
               v = _volume * _gain;
               if(v > _curVolume)
               {
@@ -584,52 +595,24 @@ void AudioTrack::processTrackCtrls(unsigned pos, int trackChans, unsigned nframe
               _volume = vol_interp.sVal;
             _controls[AC_VOLUME].dval = _volume;    // Update the port.
             v = _volume * _gain;
-            if(v > _curVolume)
+            if(v != _curVolume)
             {
-              //fprintf(stderr, "A %f %f\n", v, _curVolume);
-              if(_curVolume == 0.0)
+              //fprintf(stderr, "A/B %f %f\n", v, _curVolume);
+              const bool up = v > _curVolume;
+              if(up && _curVolume == 0.0)
                 _curVolume = 0.001;  // Kick-start it from zero at -30dB.
-              for( ; k < nsamp; ++k)
+              // Each channel ramps the same way, from the same starting volume.
+              const double start_vol = _curVolume;
+              for(int ch = start_ch; ch < trackChans; ++ch)
               {
-                _curVolume *= up_fact;
-                if(_curVolume >= v)
-                {
-                  _curVolume = v;
-                  break;
-                }
-                const unsigned long smp = sample + k;
-                for(int ch = start_ch; ch < trackChans; ++ch)
-                  *(outBuffers[ch] + smp) = *(buffer[ch] + smp) * _curVolume;
-              }
-            }
-            else
-            if(v < _curVolume)
-            {
-              //fprintf(stderr, "B %f %f\n", v, _curVolume);
-              for( ; k < nsamp; ++k)
-              {
-                _curVolume *= down_fact;
-                if(_curVolume <= v || _curVolume <= 0.001)  // Or if less than -30dB.
-                {
-                  _curVolume = v;
-                  break;
-                }
-                const unsigned long smp = sample + k;
-                for(int ch = start_ch; ch < trackChans; ++ch)
-                  *(outBuffers[ch] + smp) = *(buffer[ch] + smp) * _curVolume;
+                _curVolume = start_vol;
+                k = AL::dsp->rampGain(outBuffers[ch] + sample, buffer[ch] + sample, nsamp,
+                                      _curVolume, up ? up_fact : down_fact, v, 0.001);  // Or if less than -30dB.
               }
             }
 
-            const unsigned long next_smp = sample + nsamp;
-            float* o_buf_p;
-            const float* buf_p;
             for(int ch = start_ch; ch < trackChans; ++ch)
-            {
-              o_buf_p = outBuffers[ch];
-              buf_p = buffer[ch];
-              for(unsigned long smp = sample + k; smp < next_smp; ++smp)
-                o_buf_p[smp] = buf_p[smp] * _curVolume;
-            }
+              AL::dsp->cpyWithGain(outBuffers[ch] + sample + k, buffer[ch] + sample + k, nsamp - k, _curVolume);
           }
         }
 
@@ -638,9 +621,16 @@ void AudioTrack::processTrackCtrls(unsigned pos, int trackChans, unsigned nframe
         {
           for( ; k < nsamp; ++k)
           {
-            _volume = vol_ctrl->interpolate(slice_frame + k, vol_interp);
+            const unsigned long r = k % ctrlRampFrames;
+            if(r == 0)
+            {
+              const unsigned long ramp_n = std::min(nsamp - k, ctrlRampFrames);
+              vol_ctrl->fillRamp(slice_frame + k, ramp_n, vol_interp, vol_ramp);
+              pan_ctrl->fillRamp(slice_frame + k, ramp_n, pan_interp, pan_ramp);
+            }
+            _volume = vol_ramp[r];
             v = _volume * _gain;
-            _pan = pan_ctrl->interpolate(slice_frame + k, pan_interp);
+            _pan = pan_ramp[r];
             v1 = v * (1.0 - _pan);
             v2 = v * (1.0 + _pan);
             if(v1 > _curVol1)
@@ -699,74 +689,35 @@ void AudioTrack::processTrackCtrls(unsigned pos, int trackChans, unsigned nframe
           v = _volume * _gain;
           v1  = v * (1.0 - _pan);
           v2  = v * (1.0 + _pan);
-          if(v1 > _curVol1)
+
+          unsigned long k1 = 0;
+          if(v1 != _curVol1)
           {
-            //fprintf(stderr, "C %f %f \n", v1, _curVol1);
-            if(_curVol1 == 0.0)
+            //fprintf(stderr, "C/D %f %f \n", v1, _curVol1);
+            const bool up = v1 > _curVol1;
+            if(up && _curVol1 == 0.0)
               _curVol1 = 0.001;  // Kick-start it from zero at -30dB.
-            for( ; k < nsamp; ++k)
-            {
-              _curVol1 *= up_fact;
-              if(_curVol1 >= v1)
-              {
-                _curVol1 = v1;
-                break;
-              }
-              *dp1++ = *sp1++ * _curVol1;
-            }
+            k1 = AL::dsp->rampGain(dp1, sp1, nsamp, _curVol1, up ? up_fact : down_fact, v1, 0.001);  // Or if less than -30dB.
           }
-          else
-          if(v1 < _curVol1)
-          {
-            //fprintf(stderr, "D %f %f \n", v1, _curVol1);
-            for( ; k < nsamp; ++k)
-            {
-              _curVol1 *= down_fact;
-              if(_curVol1 <= v1 || _curVol1 <= 0.001)  // Or if less than -30dB.
-              {
-                _curVol1 = v1;
-                break;
-              }
-              *dp1++ = *sp1++ * _curVol1;
-            }
-          }
-          for( ; k < nsamp; ++k)
-            *dp1++ = *sp1++ * _curVol1;
 
-          k = 0;
-          if(v2 > _curVol2)
+          unsigned long k2 = 0;
+          if(v2 != _curVol2)
           {
-            //fprintf(stderr, "E %f %f \n", v2, _curVol2);
-            if(_curVol2 == 0.0)
+            //fprintf(stderr, "E/F %f %f \n", v2, _curVol2);
+            const bool up = v2 > _curVol2;
+            if(up && _curVol2 == 0.0)
               _curVol2 = 0.001;  // Kick-start it from zero at -30dB.
-            for( ; k < nsamp; ++k)
-            {
-              _curVol2 *= up_fact;
-              if(_curVol2 >= v2)
-              {
-                _curVol2 = v2;
-                break;
-              }
-              *dp2++ = *sp2++ * _curVol2;
-            }
+            k2 = AL::dsp->rampGain(dp2, sp2, nsamp, _curVol2, up ? up_fact : down_fact, v2, 0.001);  // Or if less than -30dB.
           }
+
+          // A mono track is panned into both extra mix buffers in one pass.
+          if(trackChans == 1 && k1 == 0 && k2 == 0)
+            AL::dsp->mixStereoPan(dp1, dp2, sp1, nsamp, _curVol1, _curVol2);
           else
-          if(v2 < _curVol2)
           {
-            //fprintf(stderr, "F %f %f \n", v2, _curVol2);
-            for( ; k < nsamp; ++k)
-            {
-              _curVol2 *= down_fact;
-              if(_curVol2 <= v2 || _curVol2 <= 0.001)   // Or if less than -30dB.
-              {
-                _curVol2 = v2;
-                break;
-              }
-              *dp2++ = *sp2++ * _curVol2;
-            }
+            AL::dsp->cpyWithGain(dp1 + k1, sp1 + k1, nsamp - k1, _curVol1);
+            AL::dsp->cpyWithGain(dp2 + k2, sp2 + k2, nsamp - k2, _curVol2);
           }
-          for( ; k < nsamp; ++k)
-            *dp2++ = *sp2++ * _curVol2;
         }
       }
 
@@ -805,6 +756,8 @@ void AudioTrack::copyData(unsigned pos,
   fprintf(stderr, "MusE: AudioTrack::copyData name:%s processed:%d _haveData:%d\n", name().toLatin1().constData(), processed(), _haveData);
   #endif
 
+  DspTrackProfileScope prof(&_dspProbe);
+
   if(srcStartChan == -1)
     srcStartChan = 0;
   if(dstStartChan == -1)
@@ -874,8 +827,7 @@ void AudioTrack::copyData(unsigned pos,
             {
               if(addArray ? addArray[c + dstStartChan] : add)
               {
-                for(unsigned k = 0; k < nframes; ++k)
-                  *dp++ += *sp++;
+                AL::dsp->mix(dp, sp, nframes);
               }
               else
                 AL::dsp->cpy(dp, sp, nframes);
@@ -912,8 +864,7 @@ void AudioTrack::copyData(unsigned pos,
             {
               if((addArray ? addArray[dstStartChan] : add) || sch != 0)
               {
-                for(unsigned k = 0; k < nframes; ++k)
-                  *dp++ += *sp++;
+                AL::dsp->mix(dp, sp, nframes);
               }
               else
                 AL::dsp->cpy(dp, sp, nframes);
@@ -946,8 +897,7 @@ void AudioTrack::copyData(unsigned pos,
           {
             if(addArray ? addArray[c + dstStartChan] : add)
             {
-              for(unsigned k = 0; k < nframes; ++k)
-                *dp++ += *sp++;
+              AL::dsp->mix(dp, sp, nframes);
             }
             else
               AL::dsp->cpy(dp, sp, nframes);
@@ -1006,6 +956,8 @@ void AudioTrack::copyData(unsigned pos,
       _meter[i] = 0.0;
 
     const bool isOff = off();
+    // A frozen track plays its rendered output, with its synth and plugins deactivated.
+    const bool isFrozenTrack = !isOff && isFrozen();
     // If this is a synth track, set the synth plugin active or inactive as appropriate.
     if(isSynthTrack())
     {
@@ -1015,14 +967,23 @@ void AudioTrack::copyData(unsigned pos,
       {
         // Activate or deactivate the plugin now, depending on the desired track and plugin active states.
         // The two calls will do nothing if already in the desired state.
-        if(isOff)
+        if(isOff || isFrozenTrack)
           sif->deactivate();
         else
           sif->activate();
       }
     }
 
-    if(isOff)
+    // Has the anticipative renderer already run the source and effects rack?
+    // Then only the volume, pan, metering and sends are left to do here.
+    const bool anticipated = getAnticipatedData(pos, srcTotalOutChans, nframes, _dataBuffers);
+    // Otherwise, if frozen, the rendered output takes the place of the source and effects rack.
+    const bool frozen = isFrozenTrack && !anticipated;
+    if(frozen)
+      getFrozenData(pos, srcTotalOutChans, nframes, _dataBuffers);
+    const bool rendered = anticipated || frozen;
+
+    if(isOff && !anticipated)
     {
       #ifdef NODE_DEBUG_PROCESS
       fprintf(stderr, "MusE: AudioTrack::copyData name:%s dstChannels:%d Off, zeroing buffers\n", name().toLatin1().constData(), availDstChannels);
@@ -1066,7 +1027,7 @@ void AudioTrack::copyData(unsigned pos,
     //  so still call getData before it. Off is NOT meant to be toggled rapidly, but mute is !
     // Since the meters are cleared above, getData can contribute (add) to them directly and return HaveMeterDataOnly
     //  if it does not want to pass the audio for listening.
-    if(!getData(pos, srcTotalOutChans, nframes, buffer))
+    if(!rendered && !getData(pos, srcTotalOutChans, nframes, buffer))
     {
       #ifdef NODE_DEBUG_PROCESS
       fprintf(stderr, "MusE: AudioTrack::copyData name:%s srcTotalOutChans:%d zeroing buffers\n", name().toLatin1().constData(), srcTotalOutChans);
@@ -1092,7 +1053,16 @@ void AudioTrack::copyData(unsigned pos,
     //---------------------------------------------------
 
     // Allow it to process even if muted so that when mute is turned off, left-over buffers (reverb tails etc) can die away.
-    _efxPipe->apply(pos, trackChans, nframes, true, buffer);
+    if(!rendered)
+      _efxPipe->apply(pos, trackChans, nframes, true, buffer);
+    // Keep the plugins of a frozen track deactivated, but let their controls follow along.
+    else if(frozen)
+      _efxPipe->apply(pos, trackChans, nframes, false, nullptr);
+
+    // Is this track being frozen? Hand the effects rack output to the render.
+    TrackFreeze* freeze_render = MusEGlobal::song->freezeRender;
+    if(freeze_render && freeze_render->track() == this)
+      freeze_render->capture(pos, srcTotalOutChans, nframes, buffer);
 
     //---------------------------------------------------
     // apply volume, pan
@@ -1109,14 +1079,13 @@ void AudioTrack::copyData(unsigned pos,
     // FIXME TODO Need multichannel changes here?
     for(int c = 0; c < trackChans; ++c)
     {
-      meter[c] = 0.0;
-      float* sp = (c >= valid_out_bufs) ? buffer[c] : outBuffers[c]; // Optimize: Don't all valid outBuffers just for meters
-      for(unsigned k = 0; k < nframes; ++k)
-      {
-        const double f = fabs(*sp++); // If the track is mono pan has no effect on meters.
-        if(f > meter[c])
-          meter[c] = f;
-      }
+      // If the track is mono pan has no effect on meters.
+      if(c >= valid_out_bufs)
+        // Prefader is on. The unprocessed buffer is what is metered, and passed on,
+        //  so copy it to the output buffer while metering.
+        meter[c] = AL::dsp->cpyWithGainAndPeak(outBuffers[c], buffer[c], nframes, 1.0f, 0.0f);
+      else
+        meter[c] = AL::dsp->peak(outBuffers[c], nframes, 0.0f);
       if(meter[c] > _meter[c])
         _meter[c] = meter[c];
       if(_meter[c] > _peak[c])
@@ -1149,7 +1118,8 @@ void AudioTrack::copyData(unsigned pos,
     }
 
     // Copy whole blocks that we can get away with here outside of the track control processing loop.
-    for(i = valid_out_bufs; i < srcTotalOutChans; ++i)
+    // Any channels up to trackChans were either processed by the track controls or copied by the metering above.
+    for(i = trackChans; i < srcTotalOutChans; ++i)
       AL::dsp->cpy(outBuffers[i], buffer[i], nframes);
 
     // We now have some data! Set to true.
@@ -1177,8 +1147,7 @@ void AudioTrack::copyData(unsigned pos,
           {
             float* db = dst[ch % a->channels()]; // no matter whether there's one or two dst buffers
             float* sb = outBuffers[ch];
-            for(unsigned f = 0; f < nframes; ++f)
-              *db++ += (*sb++ * m);   // add to mix
+            AL::dsp->mixWithGain(db, sb, nframes, m);   // add to mix
           }
         }
         else if(trackChans==1 && auxChannels==2)  // copy mono to both channels
@@ -1187,8 +1156,7 @@ void AudioTrack::copyData(unsigned pos,
           {
             float* db = dst[ch % a->channels()];
             float* sb = outBuffers[0];
-            for(unsigned f = 0; f < nframes; ++f)
-              *db++ += (*sb++ * m);   // add to mix
+            AL::dsp->mixWithGain(db, sb, nframes, m);   // add to mix
           }
         }
       }
@@ -1238,8 +1206,7 @@ void AudioTrack::copyData(unsigned pos,
           {
             if(addArray ? addArray[c + dstStartChan] : add)
             {
-              for(unsigned k = 0; k < nframes; ++k)
-                *dp++ += *sp++;
+              AL::dsp->mix(dp, sp, nframes);
             }
             else
               AL::dsp->cpy(dp, sp, nframes);
@@ -1276,8 +1243,7 @@ void AudioTrack::copyData(unsigned pos,
           {
             if((addArray ? addArray[dstStartChan] : add) || sch != 0)
             {
-              for(unsigned k = 0; k < nframes; ++k)
-                *dp++ += *sp++;
+              AL::dsp->mix(dp, sp, nframes);
             }
             else
               AL::dsp->cpy(dp, sp, nframes);
@@ -1310,8 +1276,7 @@ void AudioTrack::copyData(unsigned pos,
         {
           if(addArray ? addArray[c + dstStartChan] : add)
           {
-            for(unsigned k = 0; k < nframes; ++k)
-              *dp++ += *sp++;
+            AL::dsp->mix(dp, sp, nframes);
           }
           else
             AL::dsp->cpy(dp, sp, nframes);
@@ -1513,6 +1478,7 @@ bool AudioTrack::putFifo(int channels, unsigned long n, float** bp)
   if(fifo.put(channels, n, bp, fin_frame, route_worst_case_latency))
   {
     fprintf(stderr, "AudioTrack::putFifo: fifo overrun: frame:%d, channels:%d, nframes:%lu\n", fin_frame, channels, n);
+    _recBatch.noteOverrun();
     return false;
   }
   
@@ -1896,6 +1862,35 @@ void AudioTrack::setOff(bool val)
             resetAllMeter();
       }
 
+//---------------------------------------------------------
+//   setFreeze
+//---------------------------------------------------------
+
+void AudioTrack::setFreeze(TrackFreeze* f)
+      {
+      _freeze = f;
+      if (_freeze)
+            _freeze->installed();
+      }
+
+//---------------------------------------------------------
+//   isFrozen
+//---------------------------------------------------------
+
+bool AudioTrack::isFrozen() const
+      {
+      return _freeze && !_freeze->isStale() && !recordFlag() && !recMonitor();
+      }
+
+//---------------------------------------------------------
+//   getFrozenData
+//---------------------------------------------------------
+
+void AudioTrack::getFrozenData(unsigned pos, int channels, unsigned nframes, float** bp)
+      {
+      _freeze->getData(pos, channels, nframes, bp);
+      }
+
 //---------------------------------------------------------
 //   setPrefader
 //---------------------------------------------------------
@@ -1922,12 +1917,14 @@ bool WaveTrack::canEnableRecord() const
 //   record
 //---------------------------------------------------------
 
-void AudioTrack::record()
+void AudioTrack::record(bool flush)
       {
+      std::lock_guard<std::mutex> g(_recordMutex);
       MuseCount_t pos = 0;
       float latency = 0.0f;
       const bool use_latency_corr = useLatencyCorrection();
       float* buffer[_channels];
+      _recBatch.notePeakBacklog(recordBacklog());
       while(fifo.getCount()) {
             if (fifo.get(_channels, MusEGlobal::segmentSize, buffer, &pos, &latency)) {
                   fprintf(stderr, "AudioTrack::record(): empty fifo\n");
@@ -2026,9 +2023,7 @@ void AudioTrack::record()
                         // Reference counting diagnostics.
                         // fprintf(stderr, "AudioTrack::record _recFile ref count:%d\n", _recFile.getRefCount());
 
-                        // FIXME If we are to support writing compressed file types, we probably shouldn't be seeking here. REMOVE Tim. Wave.
-                        _recFile->seek(pos, 0);
-                        _recFile->write(_channels, buffer, MusEGlobal::segmentSize, MusEGlobal::config.liveWaveUpdate);
+                        _recBatch.add(_recFile, _channels, pos, buffer, MusEGlobal::segmentSize);
                       }
                     }
 
@@ -2037,6 +2032,17 @@ void AudioTrack::record()
                     fprintf(stderr, "AudioNode::record(): no recFile\n");
                     }
             }
+      if (flush && _recFile)
+            _recBatch.flush(_recFile);
+      }
+
+//---------------------------------------------------------
+//   recordBacklog
+//---------------------------------------------------------
+
+unsigned AudioTrack::recordBacklog()
+      {
+      return unsigned(fifo.getCount()) * MusEGlobal::segmentSize + _recBatch.pending();
       }
 
 //---------------------------------------------------------
@@ -2281,7 +2287,20 @@ CtrlListList* AudioTrack::noEraseController()             { return &_noEraseCont
 const CtrlListList* AudioTrack::noEraseController() const { return &_noEraseController; }
 
 SndFileR AudioTrack::recFile() const           { return _recFile; }
-void AudioTrack::setRecFile(SndFileR sf)       { _recFile = sf; }
+void AudioTrack::setRecFile(SndFileR sf)
+{
+  // Waits for the record writer, if it is still writing after the gui gave up waiting.
+  std::lock_guard<std::mutex> g(_recordMutex);
+  // Recording into the old file is over. Write what was collected for it,
+  //  then give back the space reserved for it.
+  if(!(sf == _recFile))
+  {
+    if(_recFile)
+      _recBatch.flush(_recFile);
+    _recBatch.finish();
+  }
+  _recFile = sf;
+}
 
 //---------------------------------------------------------
 //   setParam
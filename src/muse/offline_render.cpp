@@ -0,0 +1,689 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  offline_render.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <poll.h>
+#include <time.h>
+#include <vector>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include "offline_render.h"
+#include "al/dsp.h"
+#include "audio.h"
+#include "audiodev.h"
+#include "audioprefetch.h"
+#include "conf.h"
+#include "filedialog.h"
+#include "gconfig.h"
+#include "globals.h"
+#include "midiseq.h"
+#include "rasterizer.h"
+#include "route.h"
+#include "song.h"
+#include "songfile_discovery.h"
+#include "tempo.h"
+#include "ticksynth.h"
+#include "track.h"
+#include "undo.h"
+#include "wave.h"
+#include "xml.h"
+
+namespace MusECore {
+
+extern bool runOfflineAudioCycle();
+extern void exitDummyAudio();
+extern void exitOSC();
+extern void exitMidiAlsa();
+
+//---------------------------------------------------------
+//   RenderTarget
+//    One rendered file, fed from an audio output's ports.
+//---------------------------------------------------------
+
+struct RenderTarget {
+      AudioOutput* output;
+      int channels;
+      QString path;
+      SndFile* file;
+      bool error;
+
+      RenderTarget() : output(nullptr), channels(0), file(nullptr), error(false) {}
+      };
+
+//---------------------------------------------------------
+//   RenderWriter
+//    Writes the blocks of one or more targets to their files
+//     in a thread of its own, so that file writing overlaps
+//     with the audio processing.
+//    Each slot of the block ring holds one cycle's worth of
+//     frames for all of the writer's targets, channel after channel.
+//---------------------------------------------------------
+
+class RenderWriter {
+      static const int numSlots = 32;
+
+      std::vector<RenderTarget*> _targets;
+      int _totalChannels;
+      unsigned _segSize;
+      float* _data;
+      // Frames in each slot. Zero tells the thread to quit.
+      unsigned _frames[numSlots];
+      int _writeSlot;
+      int _readSlot;
+      sem_t _freeSem;
+      sem_t _fullSem;
+      pthread_t _thread;
+      bool _running;
+
+   public:
+      RenderWriter()
+            {
+            _totalChannels = 0;
+            _segSize = 0;
+            _data = nullptr;
+            _writeSlot = 0;
+            _readSlot = 0;
+            _running = false;
+            }
+      ~RenderWriter()
+            {
+            if (_running)
+                  finish();
+            delete[] _data;
+            }
+
+      void addTarget(RenderTarget* t) { _targets.push_back(t); _totalChannels += t->channels; }
+      const std::vector<RenderTarget*>& targets() const { return _targets; }
+      bool start(unsigned segSize);
+      float* beginBlock();
+      void commitBlock(unsigned frames);
+      void finish();
+      void run();
+      };
+
+static void* renderWriterLoop(void* arg)
+      {
+      ((RenderWriter*)arg)->run();
+      return nullptr;
+      }
+
+//---------------------------------------------------------
+//   start
+//    Returns true on success.
+//---------------------------------------------------------
+
+bool RenderWriter::start(unsigned segSize)
+      {
+      _segSize = segSize;
+      _data = new float[(size_t)numSlots * _totalChannels * _segSize];
+      sem_init(&_freeSem, 0, numSlots);
+      sem_init(&_fullSem, 0, 0);
+      const int rv = pthread_create(&_thread, nullptr, renderWriterLoop, this);
+      if (rv) {
+            fprintf(stderr, "RenderWriter: creating writer thread failed: %s\n", strerror(rv));
+            sem_destroy(&_freeSem);
+            sem_destroy(&_fullSem);
+            return false;
+            }
+      _running = true;
+      return true;
+      }
+
+//---------------------------------------------------------
+//   beginBlock
+//    Waits for a free slot and returns its buffer, to be
+//     filled with the targets' channels one after another.
+//---------------------------------------------------------
+
+float* RenderWriter::beginBlock()
+      {
+      while (sem_wait(&_freeSem) != 0 && errno == EINTR)
+            ;
+      return _data + (size_t)_writeSlot * _totalChannels * _segSize;
+      }
+
+void RenderWriter::commitBlock(unsigned frames)
+      {
+      _frames[_writeSlot] = frames;
+      _writeSlot = (_writeSlot + 1) % numSlots;
+      sem_post(&_fullSem);
+      }
+
+//---------------------------------------------------------
+//   finish
+//    Writes any remaining blocks and waits for the thread.
+//---------------------------------------------------------
+
+void RenderWriter::finish()
+      {
+      beginBlock();
+      commitBlock(0);
+      pthread_join(_thread, nullptr);
+      sem_destroy(&_freeSem);
+      sem_destroy(&_fullSem);
+      _running = false;
+      }
+
+//---------------------------------------------------------
+//   run
+//---------------------------------------------------------
+
+void RenderWriter::run()
+      {
+      float* bufs[MusECore::MAX_CHANNELS];
+      for (;;) {
+            while (sem_wait(&_fullSem) != 0 && errno == EINTR)
+                  ;
+            const unsigned frames = _frames[_readSlot];
+            if (frames == 0)
+                  break;
+            float* src = _data + (size_t)_readSlot * _totalChannels * _segSize;
+            for (RenderTarget* t : _targets) {
+                  for (int ch = 0; ch < t->channels; ++ch) {
+                        bufs[ch] = src;
+                        src += _segSize;
+                        }
+                  if (!t->error && t->file->write(t->channels, bufs, frames, false) != frames) {
+                        fprintf(stderr, "Offline render: error writing %s\n", t->path.toLocal8Bit().constData());
+                        t->error = true;
+                        }
+                  }
+            _readSlot = (_readSlot + 1) % numSlots;
+            sem_post(&_freeSem);
+            }
+      }
+
+//---------------------------------------------------------
+//   discoverSampleRate
+//    Returns the project sample rate from the song file,
+//     or zero if it has none.
+//---------------------------------------------------------
+
+static int discoverSampleRate(const QString& projectFile)
+      {
+      const QFileInfo fi(projectFile);
+      bool popenFlag;
+      FILE* f = MusEGui::fileOpen(nullptr, fi.filePath(), QString(".med"), "r", popenFlag, true);
+      if (f == nullptr)
+            return 0;
+      Xml xml(f);
+      SongfileDiscovery d_list(fi.absolutePath());
+      d_list.readSongfile(xml);
+      popenFlag ? pclose(f) : fclose(f);
+      if (d_list._waveList._projectSampleRateValid)
+            return d_list._waveList._projectSampleRate;
+      return 0;
+      }
+
+int readOfflineRenderSampleRate(const QString& projectFile)
+      {
+      return discoverSampleRate(projectFile);
+      }
+
+//---------------------------------------------------------
+//   readProject
+//    Reads the <muse> element of a song file, without the
+//     gui parts (toplevels). Mirrors MusE::read().
+//---------------------------------------------------------
+
+static void readProject(Xml& xml)
+      {
+      bool skipmode = true;
+      for (;;) {
+            Xml::Token token = xml.parse();
+            const QString& tag = xml.s1();
+            switch (token) {
+                  case Xml::Error:
+                  case Xml::End:
+                        return;
+                  case Xml::TagStart:
+                        if (skipmode && tag == "muse")
+                              skipmode = false;
+                        else if (skipmode)
+                              break;
+                        else if (tag == "configuration")
+                              readConfiguration(xml, true, false);
+                        else if (tag == "song") {
+                              MusEGlobal::song->read(xml, false);
+                              MusEGlobal::song->resolveSongfileReferences();
+                              MusEGlobal::song->changeMidiCtrlCacheEvents(true, true, true, true, true);
+                              MusEGlobal::audio->msgUpdateSoloStates();
+                              }
+                        else
+                              xml.skip(tag);
+                        break;
+                  case Xml::Attribut:
+                        if (tag == "version") {
+                              int major = xml.s2().section('.', 0, 0).toInt();
+                              int minor = xml.s2().section('.', 1, 1).toInt();
+                              xml.setVersion(major, minor);
+                              }
+                        break;
+                  case Xml::TagEnd:
+                        if (!skipmode && tag == "muse")
+                              return;
+                  default:
+                        break;
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   loadProject
+//    Returns true on success.
+//---------------------------------------------------------
+
+static bool loadProject(const QString& projectFile)
+      {
+      const QFileInfo fi(projectFile);
+      if (!fi.isReadable()) {
+            fprintf(stderr, "Offline render: cannot read project %s\n", projectFile.toLocal8Bit().constData());
+            return false;
+            }
+      MusEGlobal::museProject = fi.absolutePath();
+      QDir::setCurrent(MusEGlobal::museProject);
+
+      const int rate = discoverSampleRate(projectFile);
+      MusEGlobal::projectSampleRate = rate ? rate : MusEGlobal::sampleRate;
+      if (MusEGlobal::projectSampleRate != MusEGlobal::sampleRate)
+            fprintf(stderr, "Offline render: project rate %dHz differs from render rate %dHz, resampling\n",
+               MusEGlobal::projectSampleRate, MusEGlobal::sampleRate);
+
+      bool popenFlag;
+      FILE* f = MusEGui::fileOpen(nullptr, fi.filePath(), QString(".med"), "r", popenFlag, true);
+      if (f == nullptr) {
+            fprintf(stderr, "Offline render: cannot open project %s: %s\n",
+               projectFile.toLocal8Bit().constData(), strerror(errno));
+            return false;
+            }
+      Xml xml(f);
+      readProject(xml);
+      const bool fileError = ferror(f);
+      popenFlag ? pclose(f) : fclose(f);
+      if (fileError) {
+            fprintf(stderr, "Offline render: error reading project %s\n", projectFile.toLocal8Bit().constData());
+            return false;
+            }
+      return true;
+      }
+
+//---------------------------------------------------------
+//   addStemOutput
+//    Adds a hidden output fed only by the given track,
+//     so that the track can be captured on its own.
+//---------------------------------------------------------
+
+static AudioOutput* addStemOutput(AudioTrack* track)
+      {
+      QString name = track->name() + QString(" (render)");
+      for (int i = 2; MusEGlobal::song->findTrack(name); ++i)
+            name = track->name() + QString(" (render %1)").arg(i);
+
+      AudioOutput* ao = new AudioOutput();
+      ao->setName(name);
+      ao->setChannels(track->channels());
+      ao->setSendMetronome(false);
+
+      Undo operations;
+      operations.push_back(UndoOp(UndoOp::AddTrack, -1, ao));
+      operations.push_back(UndoOp(UndoOp::AddRoute, Route(track), Route(ao)));
+      MusEGlobal::song->applyOperationGroup(operations, Song::OperationExecute);
+      return ao;
+      }
+
+//---------------------------------------------------------
+//   fileNameFor
+//---------------------------------------------------------
+
+static QString fileNameFor(const QString& trackName)
+      {
+      QString s = trackName;
+      for (int i = 0; i < s.size(); ++i) {
+            const QChar c = s.at(i);
+            if (c == '/' || c == '\\' || c == ':' || c.isSpace())
+                  s[i] = '_';
+            }
+      return s + QString(".wav");
+      }
+
+//---------------------------------------------------------
+//   collectTargets
+//    Returns true on success.
+//---------------------------------------------------------
+
+static bool collectTargets(const OfflineRenderSettings& settings, std::vector<RenderTarget*>& targets)
+      {
+      std::vector<std::pair<AudioOutput*, QString> > outs;
+      if (settings.tracks.isEmpty()) {
+            OutputList* ol = MusEGlobal::song->outputs();
+            for (iAudioOutput i = ol->begin(); i != ol->end(); ++i)
+                  outs.push_back(std::make_pair(*i, (*i)->name()));
+            }
+      else {
+            for (const QString& name : settings.tracks) {
+                  Track* t = MusEGlobal::song->findTrack(name);
+                  if (!t) {
+                        fprintf(stderr, "Offline render: no track named %s\n", name.toLocal8Bit().constData());
+                        return false;
+                        }
+                  if (t->isMidiTrack()) {
+                        fprintf(stderr, "Offline render: %s is not an audio track\n", name.toLocal8Bit().constData());
+                        return false;
+                        }
+                  if (t->type() == Track::AUDIO_OUTPUT)
+                        outs.push_back(std::make_pair(static_cast<AudioOutput*>(t), name));
+                  else
+                        outs.push_back(std::make_pair(addStemOutput(static_cast<AudioTrack*>(t)), name));
+                  }
+            }
+      if (outs.empty()) {
+            fprintf(stderr, "Offline render: nothing to render\n");
+            return false;
+            }
+
+      const QDir dir(settings.outputDir);
+      for (const std::pair<AudioOutput*, QString>& o : outs) {
+            RenderTarget* t = new RenderTarget();
+            t->output = o.first;
+            t->channels = o.first->channels();
+            t->path = dir.absoluteFilePath(fileNameFor(o.second));
+            targets.push_back(t);
+            }
+      return true;
+      }
+
+//---------------------------------------------------------
+//   openTargets
+//    Returns true on success.
+//---------------------------------------------------------
+
+static bool openTargets(std::vector<RenderTarget*>& targets)
+      {
+      for (RenderTarget* t : targets) {
+            // Do not append to, or pick up the stale wave cache of, a previous render.
+            QFile::remove(t->path);
+            QFileInfo fi(t->path);
+            QFile::remove(fi.absolutePath() + QString("/") + fi.completeBaseName() + QString(".wca"));
+
+            t->file = new SndFile(t->path, false, true);
+            t->file->setFormat(SF_FORMAT_WAV | SF_FORMAT_FLOAT, t->channels, MusEGlobal::sampleRate);
+            if (t->file->openWrite()) {
+                  fprintf(stderr, "Offline render: cannot create %s\n", t->path.toLocal8Bit().constData());
+                  return false;
+                  }
+            }
+      return true;
+      }
+
+//---------------------------------------------------------
+//   drainAudioSignals
+//    Stands in for Song::seqSignal(), which is not connected
+//     without the gui. The messages to the gui are dropped,
+//     but completed asynchronous messages must be released.
+//---------------------------------------------------------
+
+static void drainAudioSignals()
+      {
+      const int fd = MusEGlobal::audio->getFromThreadFdr();
+      struct pollfd pfd;
+      pfd.fd = fd;
+      pfd.events = POLLIN;
+      char buffer[256];
+      while (poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN)) {
+            if (::read(fd, buffer, sizeof(buffer)) <= 0)
+                  break;
+            }
+      MusEGlobal::audio->processMsgCompletions();
+      }
+
+// Give up when the transport does not start, or stops moving, for this long.
+// Longer than the sync timeout set below, which a slow seek may take.
+static const double noProgressTimeout = 60.0;
+
+static double elapsedSeconds(const struct timespec& since)
+      {
+      struct timespec now;
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      return (now.tv_sec - since.tv_sec) + (now.tv_nsec - since.tv_nsec) * 1e-9;
+      }
+
+//---------------------------------------------------------
+//   startPrefetch
+//    The prefetch is not used for reading while freewheeling,
+//     but the transport waits for it to complete seeks.
+//---------------------------------------------------------
+
+static bool startPrefetch()
+      {
+      if (MusEGlobal::audioPrefetch->isRunning())
+            return true;
+      MusEGlobal::audioPrefetch->start(0);
+      for (int i = 0; i < 60; ++i) {
+            if (MusEGlobal::audioPrefetch->isRunning())
+                  return true;
+            sleep(1);
+            }
+      fprintf(stderr, "Offline render: timeout waiting for audio disk prefetch thread to run\n");
+      return false;
+      }
+
+//---------------------------------------------------------
+//   initOfflineRender
+//---------------------------------------------------------
+
+void initOfflineRender()
+      {
+      MusEGlobal::globalRasterizer = new MusEGui::Rasterizer(MusEGlobal::config.division);
+      MusEGlobal::song = new Song("song");
+      // Nothing is listening.
+      MusEGlobal::song->blockSignals(true);
+      }
+
+//---------------------------------------------------------
+//   renderOffline
+//---------------------------------------------------------
+
+int renderOffline(const OfflineRenderSettings& settings)
+      {
+      if (!QDir().mkpath(settings.outputDir)) {
+            fprintf(stderr, "Offline render: cannot create directory %s\n", settings.outputDir.toLocal8Bit().constData());
+            return 1;
+            }
+      // Resolve the output directory before loading changes the current directory.
+      OfflineRenderSettings s = settings;
+      s.outputDir = QDir(settings.outputDir).absolutePath();
+
+      if (!loadProject(s.projectFile))
+            return 1;
+
+      std::vector<RenderTarget*> targets;
+      bool ok = collectTargets(s, targets) && openTargets(targets);
+
+      // Render the whole song.
+      const unsigned startFrame = 0;
+      const unsigned endFrame = MusEGlobal::tempomap.tick2frame(MusEGlobal::song->len());
+      if (ok && endFrame <= startFrame) {
+            fprintf(stderr, "Offline render: the song is empty\n");
+            ok = false;
+            }
+
+      // Everything which sends messages to the audio engine must be done before it
+      //  is started, since nothing else will be running its cycles.
+      std::vector<RenderWriter*> writers;
+      if (ok) {
+            MusEGlobal::song->setLoop(false);
+            MusEGlobal::song->setAudioConvertersOfflineOperation(true);
+            MusEGlobal::audio->setFreewheel(true);
+
+            const int numWriters = s.writerThreads > 0 && s.writerThreads < (int)targets.size() ?
+                                   s.writerThreads : (int)targets.size();
+            for (int i = 0; i < numWriters; ++i)
+                  writers.push_back(new RenderWriter());
+            for (size_t i = 0; i < targets.size(); ++i)
+                  writers[i % numWriters]->addTarget(targets[i]);
+            for (RenderWriter* w : writers)
+                  if (!w->start(MusEGlobal::segmentSize))
+                        ok = false;
+            }
+
+      if (ok)
+            ok = startPrefetch() && MusEGlobal::audio->start();
+
+      unsigned rendered = 0;
+      struct timespec startTime;
+      clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+      if (ok) {
+            MusEGlobal::audioDevice->setSyncTimeout(30000000);
+            MusEGlobal::audioDevice->seekTransport(startFrame);
+            MusEGlobal::audioDevice->startTransport();
+
+            fprintf(stderr, "Offline render: %s, %u frames to %d file(s)\n",
+               s.projectFile.toLocal8Bit().constData(), endFrame - startFrame, (int)targets.size());
+
+            const unsigned segSize = MusEGlobal::segmentSize;
+            bool started = false;
+            struct timespec progressTime = startTime;
+            for (;;) {
+                  // A failed driver or a transport which never reaches the end
+                  //  must not keep a headless render spinning forever.
+                  if (elapsedSeconds(progressTime) > noProgressTimeout) {
+                        fprintf(stderr, "Offline render: the transport %s for %.0f s, giving up\n",
+                           started ? "has not moved" : "did not start", noProgressTimeout);
+                        ok = false;
+                        break;
+                        }
+
+                  if (!MusEGlobal::audio->isPlaying()) {
+                        // Stopped by itself, for example at the end of the song.
+                        if (started)
+                              break;
+                        // While syncing, give the prefetch thread time to finish seeking.
+                        if (!MusEGlobal::audioPrefetch->seekDone())
+                              usleep(1000);
+                        }
+
+                  const unsigned pos = MusEGlobal::audio->pos().frame();
+                  runOfflineAudioCycle();
+                  drainAudioSignals();
+
+                  if (!MusEGlobal::audio->isPlaying())
+                        continue;
+                  started = true;
+                  const unsigned next = MusEGlobal::audio->pos().frame();
+                  if (next <= pos)
+                        continue;
+                  clock_gettime(CLOCK_MONOTONIC, &progressTime);
+                  const unsigned frames = (next < endFrame ? next : endFrame) - pos;
+
+                  // Hand the cycle's output to the writers.
+                  for (RenderWriter* w : writers) {
+                        float* dst = w->beginBlock();
+                        for (RenderTarget* t : w->targets()) {
+                              for (int ch = 0; ch < t->channels; ++ch) {
+                                    void* port = t->output->jackPort(ch);
+                                    if (port)
+                                          AL::dsp->cpy(dst, MusEGlobal::audioDevice->getBuffer(port, segSize), frames);
+                                    else
+                                          memset(dst, 0, sizeof(float) * frames);
+                                    dst += segSize;
+                                    }
+                              }
+                        w->commitBlock(frames);
+                        }
+
+                  rendered += frames;
+                  if (next >= endFrame)
+                        break;
+                  }
+
+            MusEGlobal::audio->stop(true);
+            }
+
+      for (RenderWriter* w : writers)
+            delete w;
+
+      const double secs = elapsedSeconds(startTime);
+      for (RenderTarget* t : targets) {
+            if (t->file) {
+                  t->file->close();
+                  if (t->error)
+                        ok = false;
+                  else if (ok)
+                        fprintf(stderr, "Offline render: wrote %s\n", t->path.toLocal8Bit().constData());
+                  delete t->file;
+                  }
+            delete t;
+            }
+
+      if (ok) {
+            if (rendered < endFrame - startFrame)
+                  fprintf(stderr, "Offline render: transport stopped early, %u of %u frames rendered\n",
+                     rendered, endFrame - startFrame);
+            fprintf(stderr, "Offline render: %u frames in %.2f s (%.1fx real time)\n", rendered, secs,
+               secs > 0.0 ? ((double)rendered / MusEGlobal::sampleRate) / secs : 0.0);
+            }
+
+      MusEGlobal::audio->setFreewheel(false);
+      return ok ? 0 : 1;
+      }
+
+//---------------------------------------------------------
+//   exitOfflineRender
+//    The headless counterpart of the cleanup in MusE::closeEvent().
+//---------------------------------------------------------
+
+void exitOfflineRender()
+      {
+      if (MusEGlobal::audio && MusEGlobal::audio->isRunning())
+            MusEGlobal::audio->stop(true);
+      if (MusEGlobal::audioPrefetch)
+            MusEGlobal::audioPrefetch->stop(true);
+
+      exitDummyAudio();
+      exitMetronome();
+      MusEGlobal::song->cleanupForQuit();
+      exitMidiAlsa();
+      AL::exitDsp();
+      exitOSC();
+
+      delete MusEGlobal::audioPrefetch;
+      MusEGlobal::audioPrefetch = nullptr;
+      delete MusEGlobal::audio;
+      MusEGlobal::audio = nullptr;
+      exitMidiSequencer();
+      delete MusEGlobal::song;
+      MusEGlobal::song = nullptr;
+      delete MusEGlobal::globalRasterizer;
+      MusEGlobal::globalRasterizer = nullptr;
+      }
+
+} // namespace MusECore
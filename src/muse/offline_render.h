@@ -0,0 +1,79 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  offline_render.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __OFFLINE_RENDER_H__
+#define __OFFLINE_RENDER_H__
+
+#include <QString>
+#include <QStringList>
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   OfflineRenderSettings
+//    Filled from the command line (--render etc).
+//---------------------------------------------------------
+
+struct OfflineRenderSettings {
+      // Project (.med) file to render.
+      QString projectFile;
+      // Directory to write the rendered files into. Empty = not rendering.
+      QString outputDir;
+      // Names of the tracks to render. Empty = all audio outputs.
+      QStringList tracks;
+      // Number of file writer threads. Zero = one per rendered file.
+      int writerThreads;
+
+      OfflineRenderSettings() : writerThreads(0) {}
+      bool enabled() const { return !outputDir.isEmpty(); }
+      };
+
+//---------------------------------------------------------
+//   Headless offline rendering
+//
+//   Renders a project without any gui, as fast as possible:
+//    The audio engine is run in freewheel mode on the offline
+//    dummy audio device (see initOfflineAudio()), with cycles
+//    driven directly from the calling thread. Each audio output,
+//    or each selected track, is written to its own file in the
+//    output directory by a pool of writer threads.
+//
+//   The sequence in main() is:
+//    readOfflineRenderSampleRate(), initOfflineAudio(),
+//    initOfflineRender(), the usual core initialization,
+//    renderOffline(), exitOfflineRender().
+//---------------------------------------------------------
+
+// Returns the project sample rate stored in the project file, or zero if none.
+// Used to run the offline device at the project rate, avoiding resampling.
+extern int readOfflineRenderSampleRate(const QString& projectFile);
+// Creates the song and other core objects normally owned by the main window.
+extern void initOfflineRender();
+// Loads the project and renders it. Returns the process exit code.
+extern int renderOffline(const OfflineRenderSettings& settings);
+// Stops and destroys everything created for rendering.
+extern void exitOfflineRender();
+
+} // namespace MusECore
+
+#endif
@@ -27,6 +27,7 @@
 #include "muse_time.h"
 #include "config.h"
 #include "gconfig.h"
+#include "audio.h"
 
 // Forwards from header:
 #include "tempo.h" 
@@ -167,6 +168,7 @@ unsigned int PendingOperationItem::getIndex() const
     case SetTrackSolo:
     case SetTrackRecMonitor:
     case SetTrackOff:
+    case SetTrackFreeze:
     case ModifyPartName:
     case ModifySongLength:
     case AddMidiCtrlValList:
@@ -1077,6 +1079,16 @@ SongChangedStruct_t PendingOperationItem::executeRTStage()
       _track->setOff(_boolA);
       flags |= SC_MUTE;
     break;
+
+    case SetTrackFreeze:
+    {
+      DEBUG_OPERATIONS(stderr, "PendingOperationItem::executeRTStage SetTrackFreeze track:%p freeze:%p\n", _track, _track_freeze);
+      static_cast<AudioTrack*>(_track)->setFreeze(_track_freeze);
+      // The plugin latencies seen by the graph have changed.
+      MusEGlobal::audio->latencyChanged();
+      flags |= SC_TRACK_MODIFIED;
+    }
+    break;
     
     
     case AddPart:
@@ -1872,6 +1884,16 @@ SongChangedStruct_t PendingOperationList::executeRTStage()
     MusEGlobal::song->updateSoloStates();
     _sc_flags |= SC_SOLO;
   } 
+
+  // Let the audio engine know that its track graph must be rebuilt.
+  if(_sc_flags & (SC_TRACK_INSERTED | SC_TRACK_REMOVED | SC_TRACK_MOVED | SC_ROUTE | SC_CHANNELS | SC_AUX))
+    MusEGlobal::audio->graphChanged();
+  // Let the audio engine know that its latency correction must be recomputed.
+  // Track off state, monitoring, record arming, plugin racks, midi ports and
+  //  metronome settings all affect the latency of a branch.
+  else if(_sc_flags & (SC_MUTE | SC_RECFLAG | SC_TRACK_REC_MONITOR | SC_RACK |
+                       SC_CONFIG | SC_METRONOME | SC_EXTERNAL_MIDI_SYNC | SC_MIDI_TRACK_PROP))
+    MusEGlobal::audio->latencyChanged();
   
   // To avoid doing this item by item, do it here.
   StretchList* sl;
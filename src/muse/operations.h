@@ -54,6 +54,7 @@ class MetroAccentsMap;
 class AudioConverterSettingsGroup;
 class AudioConverterPluginI;
 class MidiRemote;
+class TrackFreeze;
 
 typedef std::list < iMidiCtrlValList > MidiCtrlValListIterators_t;
 typedef MidiCtrlValListIterators_t::iterator iMidiCtrlValListIterators_t;
@@ -159,7 +160,7 @@ struct PendingOperationItem
     ModifyMidiDeviceAddress,         ModifyMidiDeviceFlags,       ModifyMidiDeviceName,
     SetInstrument,
     AddTrack,          DeleteTrack,  MoveTrack,                   ModifyTrackName,
-    SetTrackRecord, SetTrackMute, SetTrackSolo, SetTrackRecMonitor, SetTrackOff,
+    SetTrackRecord, SetTrackMute, SetTrackSolo, SetTrackRecMonitor, SetTrackOff, SetTrackFreeze,
     ModifyTrackDrumMapItem, ReplaceTrackDrumMapPatchList,         UpdateDrumMaps,
     AddPart,           DeletePart,   MovePart, SelectPart, ModifyPartStart, ModifyPartLength,  ModifyPartName,
     AddEvent,          DeleteEvent,  SelectEvent,  ModifyEventList,
@@ -281,6 +282,7 @@ struct PendingOperationItem
     MuseFrame_t _museFrame;
     AudioConverterPluginI* _audio_converter;
     CtrlList::PasteEraseOptions _audio_ctrl_paste_erase_opts;
+    TrackFreeze* _track_freeze;
   };
   
   union {
@@ -433,6 +435,10 @@ struct PendingOperationItem
    // type is SetTrackRecord, SetTrackMute, SetTrackSolo, SetTrackRecMonitor, SetTrackOff
   PendingOperationItem(Track* track, bool v, PendingOperationType type)
     { _type = type; _track = track; _boolA = v; }
+
+  // The freeze may be null. Ownership is not taken.
+  PendingOperationItem(AudioTrack* track, TrackFreeze* freeze, PendingOperationType type = SetTrackFreeze)
+    { _type = type; _track = track; _track_freeze = freeze; }
     
     
   PendingOperationItem(Part* part, const QString* new_name, PendingOperationType type = ModifyPartName)
@@ -56,6 +56,8 @@
 #include "pluginsettings.h"
 #include "switch.h"
 #include "hex_float.h"
+#include "plugin_bridge.h"
+#include "plugin_preload.h"
 
 #ifdef LV2_SUPPORT
 #include "lv2host.h"
@@ -740,6 +742,7 @@ Plugin::Plugin()
   _pluginBypassType = PluginBypassTypeEmulatedEnableFunction;
   _pluginLatencyReportingType = PluginLatencyTypeNone;
   _pluginFreewheelType = PluginFreewheelTypeNone;
+  _bridgeMode = PluginBridgeOff;
 
   #ifdef DSSI_SUPPORT
   dssi_descr = nullptr;
@@ -980,6 +983,9 @@ int Plugin::incReferences(int val)
       // Hack: Blacklist vst plugins in-place, configurable for now.
       if ((_inports != _outports) || (_isDssiVst && !MusEGlobal::config.vstInPlace))
         _requiredFeatures |= PluginNoInPlaceProcessing;
+
+      // DSSI-VST runs its plugins out of process already.
+      _bridgeMode = _isDssiVst ? PluginBridgeOff : MusEGlobal::config.pluginBridgeMode;
     }
   }
 
@@ -1052,8 +1058,100 @@ PluginBypassType Plugin::pluginBypassType() const { return _pluginBypassType; }
 PluginFreewheelType Plugin::pluginFreewheelType() const { return _pluginFreewheelType; }
 float Plugin::getPluginLatency(void* /*handle*/) { return 0.0; }
 
+//---------------------------------------------------------
+//   activate
+//   deactivate
+//   cleanup
+//   connectPort
+//---------------------------------------------------------
+
+void Plugin::activate(LADSPA_Handle handle)
+{
+  if(_bridgeMode != PluginBridgeOff)
+    static_cast<PluginBridge*>(handle)->activate();
+  else if (plugin && plugin->activate)
+    plugin->activate(handle);
+}
+
+void Plugin::deactivate(LADSPA_Handle handle)
+{
+  if(_bridgeMode != PluginBridgeOff)
+    static_cast<PluginBridge*>(handle)->deactivate();
+  else if (plugin && plugin->deactivate)
+    plugin->deactivate(handle);
+}
+
+void Plugin::cleanup(LADSPA_Handle handle)
+{
+  if(_bridgeMode != PluginBridgeOff)
+    delete static_cast<PluginBridge*>(handle);
+  else if (plugin && plugin->cleanup)
+    plugin->cleanup(handle);
+}
+
+void Plugin::connectPort(LADSPA_Handle handle, unsigned long port, float* value)
+{
+  if(_bridgeMode != PluginBridgeOff)
+    static_cast<PluginBridge*>(handle)->connectPort(port, value);
+  else if(plugin)
+    plugin->connect_port(handle, port, value);
+}
+
+float Plugin::bridgeLatency(LADSPA_Handle handle) const
+{
+  if(_bridgeMode == PluginBridgeOff || !handle)
+    return 0.0;
+  return static_cast<PluginBridge*>(handle)->latency();
+}
+
+bool Plugin::bridgeResizeNeeded(LADSPA_Handle handle) const
+{
+  if(_bridgeMode == PluginBridgeOff || !handle)
+    return false;
+  return static_cast<PluginBridge*>(handle)->maxFrames() != MusEGlobal::segmentSize;
+}
+
+void Plugin::resizeBridge(LADSPA_Handle handle)
+{
+  if(_bridgeMode != PluginBridgeOff && handle)
+    static_cast<PluginBridge*>(handle)->resize(MusEGlobal::segmentSize);
+}
+
+void Plugin::bridgeStartCycle(LADSPA_Handle handle, unsigned long frames)
+{
+  if(_bridgeMode != PluginBridgeOff && handle)
+    static_cast<PluginBridge*>(handle)->startCycle(frames);
+}
+
+void Plugin::bridgeUpdate(LADSPA_Handle handle)
+{
+  if(_bridgeMode != PluginBridgeOff && handle)
+    static_cast<PluginBridge*>(handle)->update();
+}
+
+#ifdef DSSI_SUPPORT
+char* Plugin::configure(LADSPA_Handle handle, const char* key, const char* value)
+{
+  if(_bridgeMode != PluginBridgeOff)
+    return handle ? static_cast<PluginBridge*>(handle)->configure(key, value) : nullptr;
+  if(dssi_descr && dssi_descr->configure)
+    return dssi_descr->configure(handle, key, value);
+  return nullptr;
+}
+#endif
+
+//---------------------------------------------------------
+//   apply
+//---------------------------------------------------------
+
 void Plugin::apply(LADSPA_Handle handle, unsigned long n, float /*latency_corr*/)
 {
+  if(_bridgeMode != PluginBridgeOff)
+  {
+    static_cast<PluginBridge*>(handle)->run(n);
+    return;
+  }
+
 #ifdef DSSI_SUPPORT
   if(isDssiPlugin() && dssi_descr)
   {
@@ -1221,6 +1319,8 @@ Pipeline::Pipeline()
       for(int i = 0; i < MusECore::MAX_CHANNELS; ++i)
         buffer[i] = nullptr;
       initBuffers();
+      _lastLatency = 0.0f;
+      _lastLatencyCorrection = 0.0f;
 
       for (int i = 0; i < MusECore::PipelineDepth; ++i)
             push_back(nullptr);
@@ -1236,6 +1336,8 @@ Pipeline::Pipeline(const Pipeline& p, AudioTrack* t)
       for(int i = 0; i < MusECore::MAX_CHANNELS; ++i)
         buffer[i] = nullptr;
       initBuffers();
+      _lastLatency = 0.0f;
+      _lastLatencyCorrection = 0.0f;
 
       for(int i = 0; i < MusECore::PipelineDepth; ++i)
       {
@@ -1669,7 +1771,7 @@ void Pipeline::showNativeGui(int idx, bool flag)
 
 #endif
       #ifdef OSC_SUPPORT
-         if (p)
+         if (p && (!flag || !p->makePendingInstances()))
             p->oscIF().oscShowGui(flag);
       #endif
       }
@@ -1762,6 +1864,66 @@ void Pipeline::guiHeartBeat()
     if(p)
       p->guiHeartBeat();
   }
+  resizeBridges();
+}
+
+//---------------------------------------------------------
+//   resizeBridges
+//    Bridged plugins take at most the period they were made
+//     for in one go. When the period size changed, they are
+//     made for the new one, with the audio processing idled.
+//---------------------------------------------------------
+
+void Pipeline::resizeBridges()
+{
+  bool needed = false;
+  for(int i = 0; i < MusECore::PipelineDepth && !needed; i++)
+  {
+    const PluginI* p = (*this)[i];
+    needed = p && p->bridgeResizeNeeded();
+  }
+  if(!needed)
+    return;
+
+  MusEGlobal::audio->msgIdle(true);
+  for(int i = 0; i < MusECore::PipelineDepth; i++)
+  {
+    PluginI* p = (*this)[i];
+    if(p)
+      p->resizeBridges();
+  }
+  MusEGlobal::audio->msgIdle(false);
+}
+
+//---------------------------------------------------------
+//   hasPendingInstances
+//    Whether any plugin still waits for its instances.
+//    The ones which failed to be made are not counted.
+//---------------------------------------------------------
+
+bool Pipeline::hasPendingInstances() const
+{
+  for(int i = 0; i < MusECore::PipelineDepth; i++)
+  {
+    const PluginI* p = (*this)[i];
+    if(p && p->instancesPending() && !p->instancesFailed())
+      return true;
+  }
+  return false;
+}
+
+//---------------------------------------------------------
+//   makePendingInstances
+//---------------------------------------------------------
+
+void Pipeline::makePendingInstances()
+{
+  for(int i = 0; i < MusECore::PipelineDepth; i++)
+  {
+    PluginI* p = (*this)[i];
+    if(p)
+      p->makePendingInstances();
+  }
 }
 
 //---------------------------------------------------------
@@ -1778,12 +1940,14 @@ void Pipeline::apply(unsigned pos, unsigned long ports, unsigned long nframes, b
       const int sz = size();
       float latency_corr_offsets[sz];
       float latency_corr_offset = 0.0f;
+      float latency_total = 0.0f;
       for(int i = sz - 1; i >= 0; --i)
       {
         const PluginI* p = (*this)[i];
         if(!p)
           continue;
         const float lat = p->latency();
+        latency_total += lat;
         // If the transport affects audio latency, it means we can completely correct
         //  for the latency by adjusting the transport, therefore meaning zero
         //  resulting audio latency. As far as the rest of the app knows, the plugin
@@ -1796,11 +1960,24 @@ void Pipeline::apply(unsigned pos, unsigned long ports, unsigned long nframes, b
           latency_corr_offset -= lat;
       }
 
+      // The latency correction is only recomputed when something changes.
+      // If any plugin's latency has changed (for example its latency port changed,
+      //  or it was activated or bypassed), tell the audio engine to recompute it.
+      if(latency_total != _lastLatency || latency_corr_offset != _lastLatencyCorrection)
+      {
+        _lastLatency = latency_total;
+        _lastLatencyCorrection = latency_corr_offset;
+        MusEGlobal::audio->latencyChanged();
+      }
+
       for (int i = 0; i < sz; ++i) {
             PluginI* p = (*this)[i];
-            if(!p)
+            // A plugin without instances yet passes the audio through.
+            if(!p || p->instancesPending())
               continue;
 
+            DspProfileScope prof(p->dspProbe());
+
             const float corr_offset = latency_corr_offsets[i];
             // If the plugin has a bypass control we let it run so it can do the pass-through,
             //  where bypass can be smoother (anti-zipper) than our simpler on/off scheme,
@@ -2233,6 +2410,8 @@ void PluginI::init()
       _on               = true;
       initControlValues = false;
       _showNativeGuiPending = false;
+      _instancesPending = false;
+      _instancesFailed = false;
       }
 
 PluginI::PluginI() : PluginIBase()
@@ -2302,6 +2481,9 @@ void PluginI::updateControllers()
 void PluginI::setChannels(int c)
 {
       channel = c;
+      // The instances are made for the channels when they are made.
+      if(instancesPending())
+            return;
 
       unsigned long ins = _plugin->inports();
       unsigned long outs = _plugin->outports();
@@ -2406,7 +2588,7 @@ void PluginI::setChannels(int c)
         // Set current configuration values.
         if(isDssiPlugin() && _plugin->dssi_descr->configure)
         {
-          char *rv = _plugin->dssi_descr->configure(handle[i], DSSI_PROJECT_DIRECTORY_KEY,
+          char *rv = _plugin->configure(handle[i], DSSI_PROJECT_DIRECTORY_KEY,
               MusEGlobal::museProject.toLatin1().constData()); //MusEGlobal::song->projectPath()
 
           if(rv)
@@ -2464,14 +2646,26 @@ double PluginI::defaultOutValue(unsigned long param) const
   return _plugin->defaultValue(controlsOut[param].idx);
 }
 
-void PluginI::setCustomData(const std::vector<QString>&
+void PluginI::setCustomData(const std::vector<QString>& customParams)
+{
+   if(_plugin == nullptr)
+      return;
+
+   // Kept until there are instances to give it to.
+   if(instancesPending())
+   {
+      _pendingCustomData.insert(_pendingCustomData.end(), customParams.begin(), customParams.end());
+      return;
+   }
+   applyCustomData(customParams);
+}
+
+void PluginI::applyCustomData(const std::vector<QString>&
 #if defined(LV2_SUPPORT) || defined(VST_NATIVE_SUPPORT)
   customParams
 #endif
 )
 {
-   if(_plugin == nullptr)
-      return;
 
 #ifdef LV2_SUPPORT
    if(_plugin->isLV2Plugin()) //now only do it for lv2 plugs
@@ -2500,6 +2694,16 @@ void PluginI::setCustomData(const std::vector<QString>&
 
 LADSPA_Handle Plugin::instantiate(PluginI *)
 {
+  if(_bridgeMode != PluginBridgeOff)
+  {
+    PluginBridge* b = PluginBridge::create(_bridgeMode, filePath(), plugin, _isDssi,
+                                           MusEGlobal::sampleRate, MusEGlobal::segmentSize,
+                                           MusEGlobal::realTimeScheduling ? MusEGlobal::realTimePriority : 0);
+    if(b == nullptr)
+      fprintf(stderr, "Plugin::instantiate() Error: plugin:%s bridged instantiate failed!\n", plugin->Label);
+    return b;
+  }
+
   LADSPA_Handle h = plugin->instantiate(plugin, MusEGlobal::sampleRate);
   if(h == nullptr)
   {
@@ -2538,39 +2742,6 @@ bool PluginI::initPluginInstance(Plugin* plug, int c)
       _name  = _plugin->name() + inst;
       _label = _plugin->label() + inst;
 
-      unsigned long ins = plug->inports();
-      unsigned long outs = plug->outports();
-      if(outs)
-      {
-        instances = channel / outs;
-        if(instances < 1)
-          instances = 1;
-      }
-      else
-      if(ins)
-      {
-        instances = channel / ins;
-        if(instances < 1)
-          instances = 1;
-      }
-      else
-        instances = 1;
-
-      handle = new LADSPA_Handle[instances];
-      for(int i = 0; i < instances; ++i)
-        handle[i]=nullptr;
-
-      for(int i = 0; i < instances; ++i)
-      {
-        #ifdef PLUGIN_DEBUGIN
-        fprintf(stderr, "PluginI::initPluginInstance instance:%d\n", i);
-        #endif
-
-        handle[i] = _plugin->instantiate(this);
-        if(handle[i] == nullptr)
-          return true;
-      }
-
       unsigned long ports = _plugin->ports();
 
       controlPorts = 0;
@@ -2607,8 +2778,6 @@ bool PluginI::initPluginInstance(Plugin* plug, int c)
             controls[curPort].val    = val;
             controls[curPort].tmpVal = val;
             controls[curPort].enCtrl  = true;
-            for(int i = 0; i < instances; ++i)
-              _plugin->connectPort(handle[i], k, &controls[curPort].val);
             ++curPort;
           }
           else
@@ -2618,12 +2787,6 @@ bool PluginI::initPluginInstance(Plugin* plug, int c)
             controlsOut[curOutPort].val     = 0.0;
             controlsOut[curOutPort].tmpVal  = 0.0;
             controlsOut[curOutPort].enCtrl  = false;
-            // Connect only the first instance's output controls.
-            // We don't have a mechanism to display the other instances' outputs.
-            _plugin->connectPort(handle[0], k, &controlsOut[curOutPort].val);
-            // Connect the rest to dummy ports.
-            for(int i = 1; i < instances; ++i)
-              _plugin->connectPort(handle[i], k, &controlsOutDummy[curOutPort].val);
             ++curOutPort;
           }
         }
@@ -2671,13 +2834,85 @@ bool PluginI::initPluginInstance(Plugin* plug, int c)
       }
 #endif
 
+      // While a project loads, the instances are made once it is read.
+      if(PluginPreload::current())
+      {
+        _instancesPending = true;
+        return false;
+      }
+
+      return createInstances();
+      }
+
+//---------------------------------------------------------
+//   createInstances
+//    Makes the instances for the channels, and connects
+//     their control ports.
+//    return true on error
+//---------------------------------------------------------
+
+bool PluginI::createInstances()
+      {
+      unsigned long ins = _plugin->inports();
+      unsigned long outs = _plugin->outports();
+      int ni;
+      if(outs)
+      {
+        ni = channel / outs;
+        if(ni < 1)
+          ni = 1;
+      }
+      else
+      if(ins)
+      {
+        ni = channel / ins;
+        if(ni < 1)
+          ni = 1;
+      }
+      else
+        ni = 1;
+
+      LADSPA_Handle* handles = new LADSPA_Handle[ni];
+      for(int i = 0; i < ni; ++i)
+        handles[i]=nullptr;
+
+      for(int i = 0; i < ni; ++i)
+      {
+        #ifdef PLUGIN_DEBUGIN
+        fprintf(stderr, "PluginI::createInstances instance:%d\n", i);
+        #endif
+
+        handles[i] = _plugin->instantiate(this);
+        if(handles[i] == nullptr)
+        {
+          for(int k = 0; k < i; ++k)
+            _plugin->cleanup(handles[k]);
+          delete[] handles;
+          return true;
+        }
+      }
+
+      for(unsigned long k = 0; k < controlPorts; ++k)
+        for(int i = 0; i < ni; ++i)
+          _plugin->connectPort(handles[i], controls[k].idx, &controls[k].val);
+
+      for(unsigned long k = 0; k < controlOutPorts; ++k)
+      {
+        // Connect only the first instance's output controls.
+        // We don't have a mechanism to display the other instances' outputs.
+        _plugin->connectPort(handles[0], controlsOut[k].idx, &controlsOut[k].val);
+        // Connect the rest to dummy ports.
+        for(int i = 1; i < ni; ++i)
+          _plugin->connectPort(handles[i], controlsOut[k].idx, &controlsOutDummy[k].val);
+      }
+
 #ifdef DSSI_SUPPORT
         // Set current configuration values.
         if(isDssiPlugin() && _plugin->dssi_descr->configure)
         {
-          for(int i = 0; i < instances; ++i)
+          for(int i = 0; i < ni; ++i)
           {
-            char *rv = _plugin->dssi_descr->configure(handle[i], DSSI_PROJECT_DIRECTORY_KEY,
+            char *rv = _plugin->configure(handles[i], DSSI_PROJECT_DIRECTORY_KEY,
                 MusEGlobal::museProject.toLatin1().constData()); //MusEGlobal::song->projectPath()
 
             if(rv)
@@ -2689,9 +2924,73 @@ bool PluginI::initPluginInstance(Plugin* plug, int c)
         }
 #endif
 
+      // While the instances are pending, the audio thread does not look at
+      //  these. makePendingInstances() hands them over with _instancesPending.
+      handle = handles;
+      instances = ni;
       return false;
       }
 
+//---------------------------------------------------------
+//   makePendingInstances
+//    return true on error
+//---------------------------------------------------------
+
+bool PluginI::makePendingInstances()
+      {
+      if(!instancesPending())
+        return false;
+      if(_instancesFailed)
+        return true;
+
+      if(createInstances())
+      {
+        fprintf(stderr, "Error initializing plugin instance (%s, %s, %s)\n",
+          _plugin->lib().toLatin1().constData(),
+          _plugin->uri().toLatin1().constData(),
+          _plugin->label().toLatin1().constData());
+        _instancesFailed = true;
+        return true;
+      }
+
+      // Give them the state which was read for them.
+      if(!_pendingCustomData.empty())
+      {
+        applyCustomData(_pendingCustomData);
+        _pendingCustomData.clear();
+      }
+
+      // The audio thread may use them from now on. The release goes with the
+      //  acquire in instancesPending(), the audio thread checks it before it
+      //  reads handle or instances.
+      _instancesPending.store(false, std::memory_order_release);
+      return false;
+      }
+
+//---------------------------------------------------------
+//   bridgeResizeNeeded
+//   resizeBridges
+//---------------------------------------------------------
+
+bool PluginI::bridgeResizeNeeded() const
+      {
+      if(instancesPending())
+        return false;
+      for(int i = 0; i < instances; ++i)
+        if(_plugin->bridgeResizeNeeded(handle[i]))
+          return true;
+      return false;
+      }
+
+void PluginI::resizeBridges()
+      {
+      if(instancesPending())
+        return;
+      for(int i = 0; i < instances; ++i)
+        if(_plugin->bridgeResizeNeeded(handle[i]))
+          _plugin->resizeBridge(handle[i]);
+      }
+
 //---------------------------------------------------------
 //   connect
 //---------------------------------------------------------
@@ -2782,6 +3081,9 @@ float PluginI::latency() const
   // Do not report any latency if the plugin is not active.
   if(!_curActiveState)
     return 0.0;
+  // Nor before its instances are made, they may be being made right now.
+  if(instancesPending())
+    return 0.0;
 
   switch(pluginBypassType())
   {
@@ -2805,8 +3107,11 @@ float PluginI::latency() const
     break;
   }
 
+  // A pipelined bridge adds its own period to whatever the plugin reports.
+  const float bridged = handle ? _plugin->bridgeLatency(handle[0]) : 0.0;
+
   if(cquirks()._overrideReportedLatency)
-    return cquirks()._latencyOverrideValue;
+    return cquirks()._latencyOverrideValue + bridged;
 
   switch(pluginLatencyReportingType())
   {
@@ -2815,16 +3120,16 @@ float PluginI::latency() const
 
     case PluginLatencyTypeFunction:
       // FIXME We can only deal with one instance's output for now. Just take the first instance's.
-      if(handle[0])
-        return _plugin->getPluginLatency(handle[0]);
+      if(handle && handle[0])
+        return _plugin->getPluginLatency(handle[0]) + bridged;
     break;
 
     case PluginLatencyTypePort:
       if(latencyOutPortIndex() < controlOutPorts)
-        return controlsOut[latencyOutPortIndex()].val;
+        return controlsOut[latencyOutPortIndex()].val + bridged;
     break;
   }
-  return 0.0;
+  return bridged;
 }
 
 bool PluginI::usesTransportSource() const          { return _plugin->usesTimePosition(); };
@@ -2895,6 +3200,13 @@ void PluginI::writeConfiguration(int level, Xml& xml)
          }
       }
 #endif
+      // No instances yet, the state is still the one which was read.
+      if(instancesPending())
+      {
+         for(const QString& customData : _pendingCustomData)
+            xml.strTag(level, "customData", customData);
+      }
+
       for (unsigned long i = 0; i < controlPorts; ++i) {
             unsigned long idx = controls[i].idx;
             const QString s("control name=\"%1\" val=\"%2\" /");
@@ -3202,7 +3514,7 @@ void PluginI::showNativeGui()
   {
         if (_oscif.oscGuiVisible())
                 _oscif.oscShowGui(false);
-        else
+        else if (!makePendingInstances())
                 _oscif.oscShowGui(true);
   }
   #endif
@@ -3232,7 +3544,7 @@ void PluginI::showNativeGui(
   }
 #endif
   #ifdef OSC_SUPPORT
-  if(_plugin)
+  if(_plugin && (!flag || !makePendingInstances()))
   {
     _oscif.oscShowGui(flag);
   }
@@ -3264,6 +3576,11 @@ bool PluginI::nativeGuiVisible() const
 void PluginI::guiHeartBeat()
 {
   PluginIBase::guiHeartBeat();
+  if(!instancesPending())
+  {
+    for(int i = 0; i < instances; ++i)
+      _plugin->bridgeUpdate(handle[i]);
+  }
 #ifdef OSC_SUPPORT
   // Update the DSSI UI's controls if needed, if it exists.
   if(plugin() && isDssiPlugin())
@@ -3345,6 +3662,13 @@ void PluginI::apply(unsigned pos, unsigned long n,
   else
     deactivate();
 
+  // Bridged instances wait for their processes at most n frames long in all, for all slices.
+  if(_curActiveState)
+  {
+    for(int i = 0; i < instances; ++i)
+      _plugin->bridgeStartCycle(handle[i], n);
+  }
+
   //  Normally if the plugin is inactive or off we tell it to connect to dummy audio ports.
   //  But this can change depending on detected bypass type, below.
   bool connectToDummyAudioPorts = !_curActiveState || !isOn;
@@ -3491,6 +3815,8 @@ void PluginI::apply(unsigned pos, unsigned long n,
             if((samps & min_per_mask) != 0)
               samps += min_per;
           }
+          else if(ci.doInterp && cl)
+            samps = cl->rampSliceFrames(slice_frame, ci, &controls[k].ramp, min_per, samps);
           else
             samps = min_per;
 
@@ -3500,7 +3826,7 @@ void PluginI::apply(unsigned pos, unsigned long n,
         }
 
         if(ci.doInterp && cl)
-          controls[k].val = cl->interpolate(MusEGlobal::audio->isPlaying() ? slice_frame : pos, ci);
+          controls[k].val = cl->rampValue(MusEGlobal::audio->isPlaying() ? slice_frame : pos, ci, &controls[k].ramp);
         else
           controls[k].val = ci.sVal;
 
@@ -3680,7 +4006,7 @@ value
             return 0;
             }
 
-      char* message = dssi_descr->configure(handle, key, value);
+      char* message = configure(handle, key, value);
       if (message) {
             printf("Plugin::oscConfigure on configure '%s' '%s', plugin '%s' returned error '%s'\n",
                key, value, plugin->Label, message);
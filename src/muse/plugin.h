@@ -25,6 +25,7 @@
 #ifndef __PLUGIN_H__
 #define __PLUGIN_H__
 
+#include <atomic>
 #include <list>
 #include <vector>
 #include <QSet>
@@ -44,6 +45,7 @@
 #include "ctrl.h"
 #include "controlfifo.h"
 #include "config.h"
+#include "dsp_profiler.h"
 
 #ifdef OSC_SUPPORT
 #include "osc.h"
@@ -142,6 +144,9 @@ class Plugin {
 
       PluginFeatures_t _requiredFeatures;
 
+      // How the instances are run, a PluginBridgeMode. Chosen when the library is loaded.
+      int _bridgeMode;
+
    public:
       Plugin();
       Plugin(const MusEPlugin::PluginScanInfoStruct&);
@@ -170,24 +175,28 @@ class Plugin {
       inline bool isVstNativePlugin() const { return _isVstNativePlugin; } //inline it to use in RT audio thread
       inline bool isVstNativeSynth() const { return _isVstNativeSynth; }
 
+      // If the instances run bridged, the handles are PluginBridges.
       virtual LADSPA_Handle instantiate(PluginI *);
-      virtual void activate(LADSPA_Handle handle) {
-            if (plugin && plugin->activate)
-                  plugin->activate(handle);
-            }
-      virtual void deactivate(LADSPA_Handle handle) {
-            if (plugin && plugin->deactivate)
-                  plugin->deactivate(handle);
-            }
-      virtual void cleanup(LADSPA_Handle handle) {
-            if (plugin && plugin->cleanup)
-                  plugin->cleanup(handle);
-            }
-      virtual void connectPort(LADSPA_Handle handle, unsigned long port, float* value) {
-            if(plugin)
-              plugin->connect_port(handle, port, value);
-            }
+      virtual void activate(LADSPA_Handle handle);
+      virtual void deactivate(LADSPA_Handle handle);
+      virtual void cleanup(LADSPA_Handle handle);
+      virtual void connectPort(LADSPA_Handle handle, unsigned long port, float* value);
       virtual void apply(LADSPA_Handle handle, unsigned long n, float /*latency_corr*/ = 0.0f);
+      // The frames a bridged instance is behind, zero if not bridged.
+      float bridgeLatency(LADSPA_Handle handle) const;
+      // Whether a bridged instance was made for another period size than the current one.
+      bool bridgeResizeNeeded(LADSPA_Handle handle) const;
+      // Restarts a bridged instance for the current period size.
+      //  The audio thread must not run it meanwhile.
+      void resizeBridge(LADSPA_Handle handle);
+      // Starts a cycle of frames for a bridged instance. Audio thread.
+      void bridgeStartCycle(LADSPA_Handle handle, unsigned long frames);
+      // Notices a bridged instance whose process ended. Gui thread.
+      void bridgeUpdate(LADSPA_Handle handle);
+      #ifdef DSSI_SUPPORT
+      // Calls configure() of a DSSI instance, bridged or not. Returns what it returned.
+      char* configure(LADSPA_Handle handle, const char* key, const char* value);
+      #endif
 
       #ifdef OSC_SUPPORT
       int oscConfigure(LADSPA_Handle handle, const char* key, const char* value);
@@ -305,6 +314,8 @@ struct Port {
       
       bool enCtrl;  // Enable controller stream.
       CtrlInterpolate interp;
+      // The constants of interp's segment, kept over the run slices.
+      CtrlRamp ramp;
       };
 
 //---------------------------------------------------------
@@ -530,8 +541,21 @@ class PluginI : public PluginIBase {
       OscEffectIF _oscif;
       #endif
       bool _showNativeGuiPending;
+      // Time spent in apply() each cycle.
+      DspProbe _dspProbe;
+
+      // The instances are not made yet, see makePendingInstances(). The audio
+      //  thread passes the audio through until they are. Set by the gui thread.
+      std::atomic<bool> _instancesPending;
+      // Making the pending instances failed. Not tried again.
+      bool _instancesFailed;
+      // LV2 and VST state read while the instances were pending. Given to them
+      //  once they are made, and saved as it is until then.
+      std::vector<QString> _pendingCustomData;
 
       void init();
+      bool createInstances();
+      void applyCustomData(const std::vector<QString>& customParams);
 
    protected:
       void activate();
@@ -555,12 +579,24 @@ class PluginI : public PluginIBase {
 
       void setTrack(AudioTrack* t)   { _track = t; }
       AudioTrack* track() const      { return _track; }
+      DspProbe* dspProbe()           { return &_dspProbe; }
       unsigned long pluginID() const { return _plugin->id(); }
       void setID(int i);
       int id() const                 { return _id; }
       void updateControllers();
 
+      // Sets the instance up for the plugin. The plugin's instances are made later,
+      //  by makePendingInstances(), if a PluginPreload is current.
       bool initPluginInstance(Plugin*, int channels);
+      bool instancesPending() const { return _instancesPending.load(std::memory_order_acquire); }
+      // Makes the instances if they are pending. Returns true on error, or if
+      //  making them failed before. Gui thread, or a PluginPreload thread.
+      bool makePendingInstances();
+      bool instancesFailed() const { return _instancesFailed; }
+      // Whether the bridged instances were made for another period size. Gui thread.
+      bool bridgeResizeNeeded() const;
+      // Restarts them for the current one. The audio thread must be idle.
+      void resizeBridges();
       void setChannels(int);
       void connect(unsigned long ports, bool connectAllToDummyPorts, unsigned long offset, float** src, float** dst);
       void apply(unsigned pos, unsigned long n,
@@ -655,6 +691,9 @@ class PluginI : public PluginIBase {
 class Pipeline : public std::vector<PluginI*> {
    private:
       float* buffer[MusECore::MAX_CHANNELS];
+      // Plugin latencies seen by the last apply(), to detect changes.
+      float _lastLatency;
+      float _lastLatencyCorrection;
       void initBuffers();
    public:
       Pipeline();
@@ -681,6 +720,11 @@ class Pipeline : public std::vector<PluginI*> {
       bool guiVisible(int);
       bool nativeGuiVisible(int);
       void guiHeartBeat();
+      bool hasPendingInstances() const;
+      // Gui thread only.
+      void makePendingInstances();
+      // Gui thread only.
+      void resizeBridges();
 
       void apply(unsigned pos, unsigned long ports, unsigned long nframes, bool wantActive, float** buffer);
 
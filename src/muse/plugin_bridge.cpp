@@ -0,0 +1,907 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  plugin_bridge.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <QByteArray>
+
+#include "config.h"
+#include "plugin_bridge.h"
+#include "globals.h"
+
+extern char** environ;
+
+using namespace MusEPlugin;
+
+namespace MusECore {
+
+// How long the gui thread waits for a new process to load its plugin.
+static const int bridgeStartMs = 10000;
+// How long the gui thread waits for a process to quit before killing it.
+static const int bridgeQuitMs = 1000;
+// How long a request waits for its answer.
+static const int bridgeRequestMs = 2000;
+
+static uint32_t bridgeRingFrames(unsigned long maxFrames)
+{
+  // Room for a few periods, so a pipelined process can fall a bit behind.
+  uint32_t n = 1;
+  while(n < maxFrames * 4)
+    n <<= 1;
+  return n;
+}
+
+static uint32_t bridgeEventSize(bool dssi)
+{
+#ifdef DSSI_SUPPORT
+  return dssi ? sizeof(snd_seq_event_t) : 0;
+#else
+  (void)dssi;
+  return 0;
+#endif
+}
+
+static void bridgeSignal(int fd)
+{
+  const uint64_t one = 1;
+  // Can only fail if the counter would overflow, then the other side is awake anyway.
+  if(write(fd, &one, sizeof(one)) != sizeof(one)) { }
+}
+
+//---------------------------------------------------------
+//   PluginBridge
+//---------------------------------------------------------
+
+PluginBridge::PluginBridge(int mode, const QString& path, const LADSPA_Descriptor* descr, bool dssi,
+                           unsigned long sampleRate, unsigned long maxFrames, int priority)
+  : _mode(mode), _dssi(dssi), _maxFrames(maxFrames), _path(path), _label(QString(descr->Label)),
+    _sampleRate(sampleRate), _priority(priority),
+    _pid(-1), _shmFd(-1), _requestFd(-1), _replyFd(-1), _parentFd(-1),
+    _shm(MAP_FAILED), _header(nullptr),
+    _layout(0, 0, 0, 0, 0, 0),
+    _inFlight(0), _skip(0), _stalled(false), _active(false), _exited(false), _exitStatus(0), _lostFrames(0),
+    _programControls(0)
+#ifdef DSSI_SUPPORT
+    , _programSelected(false), _bank(0), _program(0), _requestsLost(false)
+#endif
+{
+  _deadline.tv_sec = 0;
+  _deadline.tv_nsec = 0;
+  _ports.assign(descr->PortCount, nullptr);
+  for(unsigned long k = 0; k < descr->PortCount; ++k)
+  {
+    const LADSPA_PortDescriptor pd = descr->PortDescriptors[k];
+    if(LADSPA_IS_PORT_AUDIO(pd))
+      (LADSPA_IS_PORT_INPUT(pd) ? _audioIns : _audioOuts).push_back(k);
+    else if(LADSPA_IS_PORT_CONTROL(pd))
+      (LADSPA_IS_PORT_INPUT(pd) ? _controlIns : _controlOuts).push_back(k);
+  }
+  _layout = BridgeShmLayout(_audioIns.size(), _audioOuts.size(), _controlIns.size(), _controlOuts.size(),
+                            bridgeRingFrames(maxFrames), bridgeEventSize(_dssi) * BridgeMaxEvents);
+}
+
+PluginBridge::~PluginBridge()
+{
+  stop();
+}
+
+//---------------------------------------------------------
+//   stop
+//    Ends the process and frees what start() made.
+//---------------------------------------------------------
+
+void PluginBridge::stop()
+{
+  if(_pid > 0)
+  {
+    if(!_exited && _header)
+    {
+      send(BridgeQuit, 0, 0);
+      for(int ms = 0; ms < bridgeQuitMs && !_exited; ms += 10)
+      {
+        usleep(10000);
+        checkExited();
+      }
+    }
+    if(!_exited)
+    {
+      fprintf(stderr, "PluginBridge: plugin host %d does not quit, killing it\n", _pid);
+      kill(_pid, SIGKILL);
+      waitpid(_pid, &_exitStatus, 0);
+      _exited.store(true);
+    }
+    else if(!WIFEXITED(_exitStatus) || WEXITSTATUS(_exitStatus) != 0)
+      fprintf(stderr, "PluginBridge: plugin host %d ended abnormally, status:%d, %lu frames lost\n",
+              _pid, _exitStatus, _lostFrames);
+  }
+
+  if(_shm != MAP_FAILED)
+    munmap(_shm, _layout.total);
+  if(_shmFd >= 0)
+    close(_shmFd);
+  if(_requestFd >= 0)
+    close(_requestFd);
+  if(_replyFd >= 0)
+    close(_replyFd);
+  if(_parentFd >= 0)
+    close(_parentFd);
+
+  _pid = -1;
+  _shmFd = _requestFd = _replyFd = _parentFd = -1;
+  _shm = MAP_FAILED;
+  _header = nullptr;
+}
+
+//---------------------------------------------------------
+//   create
+//---------------------------------------------------------
+
+PluginBridge* PluginBridge::create(int mode, const QString& path, const LADSPA_Descriptor* descr, bool dssi,
+                                   unsigned long sampleRate, unsigned long maxFrames, int priority)
+{
+  PluginBridge* b = new PluginBridge(mode, path, descr, dssi, sampleRate, maxFrames, priority);
+  if(!b->start())
+  {
+    delete b;
+    return nullptr;
+  }
+  return b;
+}
+
+//---------------------------------------------------------
+//   start
+//---------------------------------------------------------
+
+bool PluginBridge::start()
+{
+  _shmFd = memfd_create("muse-plugin-bridge", MFD_CLOEXEC);
+  if(_shmFd < 0 || ftruncate(_shmFd, _layout.total) != 0)
+  {
+    fprintf(stderr, "PluginBridge: cannot create shared memory: %s\n", strerror(errno));
+    return false;
+  }
+  _shm = mmap(nullptr, _layout.total, PROT_READ | PROT_WRITE, MAP_SHARED, _shmFd, 0);
+  if(_shm == MAP_FAILED)
+  {
+    fprintf(stderr, "PluginBridge: cannot map shared memory: %s\n", strerror(errno));
+    return false;
+  }
+
+  const uint32_t ringFrames = bridgeRingFrames(_maxFrames);
+  _header = new (_shm) BridgeShmHeader();
+  _header->magic       = BridgeShmMagic;
+  _header->version     = BridgeShmVersion;
+  _header->sampleRate  = _sampleRate;
+  _header->portCount   = _ports.size();
+  _header->audioIns    = _audioIns.size();
+  _header->audioOuts   = _audioOuts.size();
+  _header->controlIns  = _controlIns.size();
+  _header->controlOuts = _controlOuts.size();
+  _header->ringFrames  = ringFrames;
+  _header->maxFrames   = _maxFrames;
+  _header->dssi        = _dssi;
+  _header->eventSize   = bridgeEventSize(_dssi);
+  _header->maxEvents   = _header->eventSize ? BridgeMaxEvents : 0;
+  _header->state.store(BridgeStarting);
+  _header->commandWrite.store(0);
+  _header->inputWrite.store(0);
+  _header->commandRead.store(0);
+  _header->inputRead.store(0);
+  _header->outputWrite.store(0);
+  _header->outputRead.store(0);
+  _header->requestRead.store(0);
+  _header->requestWrite.store(0);
+  _header->programControls.store(0);
+
+  // The process only ever writes the reply and blocks reading the request.
+  _requestFd = eventfd(0, EFD_CLOEXEC);
+  _replyFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if(_requestFd < 0 || _replyFd < 0)
+  {
+    fprintf(stderr, "PluginBridge: cannot create eventfd: %s\n", strerror(errno));
+    return false;
+  }
+
+  QString prog;
+  const QByteArray appDir = qgetenv("APPDIR");
+  if (!appDir.isEmpty())
+      prog = appDir + QString(BINDIR) + QString("/muse_plugin_bridge");
+  else
+      prog = QString(BINDIR) + QString("/muse_plugin_bridge");
+
+  // The process keeps the read end, it reads end of file once MusE is gone.
+  int parentPipe[2];
+  if(pipe2(parentPipe, O_CLOEXEC) != 0)
+  {
+    fprintf(stderr, "PluginBridge: cannot create pipe: %s\n", strerror(errno));
+    return false;
+  }
+  _parentFd = parentPipe[1];
+
+  const std::string progStr = prog.toLocal8Bit().constData();
+  const std::string pathStr = _path.toLocal8Bit().constData();
+  const std::string labelStr = _label.toLocal8Bit().constData();
+  const std::string priorityStr = std::to_string(_priority);
+  char* const argv[] = { const_cast<char*>(progStr.c_str()),
+                         const_cast<char*>(pathStr.c_str()),
+                         const_cast<char*>(labelStr.c_str()),
+                         const_cast<char*>(priorityStr.c_str()),
+                         nullptr };
+
+  // posix_spawn() does not copy MusE's memory the way fork() does, so the
+  //  audio threads do not run into copy-on-write faults meanwhile.
+  // The descriptors are moved out of the way of the fixed numbers first,
+  //  dup2() then puts them into place without close-on-exec.
+  const int fds[4] = { _shmFd, _requestFd, _replyFd, parentPipe[0] };
+  const int targets[4] = { BridgeShmFd, BridgeRequestFd, BridgeReplyFd, BridgeParentFd };
+  int moved[4] = { -1, -1, -1, -1 };
+  bool ok = true;
+  for(int i = 0; i < 4 && ok; ++i)
+  {
+    moved[i] = fcntl(fds[i], F_DUPFD_CLOEXEC, 10);
+    ok = moved[i] >= 0;
+  }
+
+  int rv = errno;
+  if(ok)
+  {
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    for(int i = 0; i < 4; ++i)
+      posix_spawn_file_actions_adddup2(&actions, moved[i], targets[i]);
+    rv = posix_spawn(&_pid, argv[0], &actions, nullptr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    ok = rv == 0;
+  }
+  for(int i = 0; i < 4; ++i)
+    if(moved[i] >= 0)
+      close(moved[i]);
+  close(parentPipe[0]);
+  if(!ok)
+  {
+    _pid = -1;
+    fprintf(stderr, "PluginBridge: cannot start %s: %s\n", progStr.c_str(), strerror(rv));
+    return false;
+  }
+
+  if(!waitReady())
+  {
+    fprintf(stderr, "PluginBridge: plugin host for %s in %s did not start\n",
+            labelStr.c_str(), pathStr.c_str());
+    return false;
+  }
+  return true;
+}
+
+//---------------------------------------------------------
+//   waitReady
+//---------------------------------------------------------
+
+bool PluginBridge::waitReady()
+{
+  for(int ms = 0; ms < bridgeStartMs; ms += 100)
+  {
+    const uint32_t state = _header->state.load(std::memory_order_acquire);
+    if(state == BridgeReady)
+    {
+      uint64_t v;
+      if(read(_replyFd, &v, sizeof(v)) < 0) { }
+      return true;
+    }
+    if(state == BridgeFailed)
+      break;
+    checkExited();
+    if(_exited)
+      break;
+    pollfd p = { _replyFd, POLLIN, 0 };
+    poll(&p, 1, 100);
+  }
+  return false;
+}
+
+//---------------------------------------------------------
+//   checkExited
+//---------------------------------------------------------
+
+void PluginBridge::checkExited()
+{
+  if(_exited || _pid <= 0)
+    return;
+  if(waitpid(_pid, &_exitStatus, WNOHANG) == _pid)
+    _exited.store(true);
+}
+
+//---------------------------------------------------------
+//   connectPort
+//---------------------------------------------------------
+
+void PluginBridge::connectPort(unsigned long port, float* buffer)
+{
+  if(port < _ports.size())
+    _ports[port] = buffer;
+}
+
+//---------------------------------------------------------
+//   activate
+//   deactivate
+//---------------------------------------------------------
+
+void PluginBridge::activate()
+{
+  _active = true;
+  send(BridgeActivate, 0, 0);
+}
+
+void PluginBridge::deactivate()
+{
+  _active = false;
+  send(BridgeDeactivate, 0, 0);
+}
+
+//---------------------------------------------------------
+//   resize
+//---------------------------------------------------------
+
+bool PluginBridge::resize(unsigned long maxFrames)
+{
+#ifdef DSSI_SUPPORT
+  std::lock_guard<std::mutex> lock(_requestMutex);
+#endif
+  stop();
+
+  _maxFrames = maxFrames;
+  _layout = BridgeShmLayout(_audioIns.size(), _audioOuts.size(), _controlIns.size(), _controlOuts.size(),
+                            bridgeRingFrames(maxFrames), bridgeEventSize(_dssi) * BridgeMaxEvents);
+  _inFlight = 0;
+  _skip = 0;
+  _stalled = false;
+  _exited.store(false);
+  _exitStatus = 0;
+  _programControls = 0;
+#ifdef DSSI_SUPPORT
+  _requestsLost = false;
+#endif
+
+  if(!start())
+  {
+    fprintf(stderr, "PluginBridge: cannot restart plugin host for %lu frames\n", maxFrames);
+    stop();
+    _exited.store(true);
+    return false;
+  }
+
+#ifdef DSSI_SUPPORT
+  for(const auto& c : _configured)
+  {
+    char* message = sendConfigure(c.first.c_str(), c.second.c_str());
+    if(message)
+      free(message);
+  }
+  if(_programSelected && send(BridgeSelectProgram, 0, 0, nullptr, 0, _bank, _program))
+  {
+    // The control values MusE has now stay, not the ones the program sets.
+    for(int ms = 0; ms < bridgeQuitMs && _header->programControls.load(std::memory_order_acquire) == 0; ms += 10)
+      usleep(10000);
+    _programControls = _header->programControls.load(std::memory_order_acquire);
+  }
+#endif
+
+  if(_active)
+    send(BridgeActivate, 0, 0);
+  return true;
+}
+
+//---------------------------------------------------------
+//   latency
+//---------------------------------------------------------
+
+unsigned long PluginBridge::latency() const
+{
+  return _mode == PluginBridgePipelined ? _maxFrames : 0;
+}
+
+//---------------------------------------------------------
+//   send
+//    Queues a command, with frames of input starting at
+//     offset in the connected buffers and the events for
+//     BridgeRun. Returns false if there was no room.
+//---------------------------------------------------------
+
+bool PluginBridge::send(uint32_t type, unsigned long frames, unsigned long offset,
+                        const void* events, unsigned long eventCount,
+                        unsigned long bank, unsigned long program)
+{
+  // No process could be started.
+  if(!_header)
+    return false;
+  const uint32_t cmdPos = _header->commandWrite.load(std::memory_order_relaxed);
+  if(cmdPos - _header->commandRead.load(std::memory_order_acquire) >= BridgeCommands)
+    return false;
+
+  const uint32_t ringFrames = _header->ringFrames;
+  const uint32_t inPos = _header->inputWrite.load(std::memory_order_relaxed);
+  if(type == BridgeRun)
+  {
+    if(inPos - _header->inputRead.load(std::memory_order_acquire) + frames > ringFrames)
+      return false;
+    for(size_t i = 0; i < _audioIns.size(); ++i)
+    {
+      const float* src = _ports[_audioIns[i]];
+      if(src)
+        bridgeRingWrite(_layout.inputRing(_shm, ringFrames, i), ringFrames, inPos, src + offset, frames);
+    }
+  }
+
+  BridgeCommand* c = _layout.command(_shm, cmdPos);
+  c->type = type;
+  c->frames = frames;
+  c->events = 0;
+  c->bank = bank;
+  c->program = program;
+  c->programControls = _programControls;
+  float* controls = BridgeShmLayout::commandControls(c);
+  for(size_t i = 0; i < _controlIns.size(); ++i)
+  {
+    const float* v = _ports[_controlIns[i]];
+    controls[i] = v ? *v : 0.0f;
+  }
+
+#ifdef DSSI_SUPPORT
+  snd_seq_event_t* dst = (snd_seq_event_t*)BridgeShmLayout::commandEvents(c, _controlIns.size());
+  const snd_seq_event_t* src = (const snd_seq_event_t*)events;
+  for(unsigned long i = 0; i < eventCount && c->events < _header->maxEvents; ++i)
+  {
+    // The data of sysex and other variable length events stays in here, they are dropped.
+    if((src[i].flags & SND_SEQ_EVENT_LENGTH_MASK) == SND_SEQ_EVENT_LENGTH_VARIABLE)
+      continue;
+    dst[c->events] = src[i];
+    dst[c->events].time.tick = src[i].time.tick > offset ? src[i].time.tick - offset : 0;
+    ++c->events;
+  }
+#else
+  (void)events;
+  (void)eventCount;
+#endif
+
+  if(type == BridgeRun)
+    _header->inputWrite.store(inPos + frames, std::memory_order_release);
+  _header->commandWrite.store(cmdPos + 1, std::memory_order_release);
+  bridgeSignal(_requestFd);
+  return true;
+}
+
+//---------------------------------------------------------
+//   startCycle
+//---------------------------------------------------------
+
+void PluginBridge::startCycle(unsigned long frames)
+{
+  const long ns = long(1000000000.0 * double(frames) / double(_sampleRate));
+  clock_gettime(CLOCK_MONOTONIC, &_deadline);
+  _deadline.tv_sec += ns / 1000000000L;
+  _deadline.tv_nsec += ns % 1000000000L;
+  if(_deadline.tv_nsec >= 1000000000L)
+  {
+    _deadline.tv_sec += 1;
+    _deadline.tv_nsec -= 1000000000L;
+  }
+}
+
+//---------------------------------------------------------
+//   waitReply
+//    Waits for the process to finish a command, until the
+//     deadline of the cycle. Returns false if it did not.
+//---------------------------------------------------------
+
+bool PluginBridge::waitReply()
+{
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  const long ns = (_deadline.tv_sec - now.tv_sec) * 1000000000L + (_deadline.tv_nsec - now.tv_nsec);
+  if(ns <= 0)
+    return false;
+  const timespec timeout = { ns / 1000000000L, ns % 1000000000L };
+  pollfd p = { _replyFd, POLLIN, 0 };
+  if(ppoll(&p, 1, &timeout, nullptr) <= 0)
+    return false;
+  uint64_t v;
+  if(read(_replyFd, &v, sizeof(v)) < 0) { }
+  return true;
+}
+
+//---------------------------------------------------------
+//   receive
+//    Copies up to frames of output to offset in the
+//     connected buffers, waiting for them if asked to.
+//     Returns the frames copied.
+//---------------------------------------------------------
+
+unsigned long PluginBridge::receive(unsigned long frames, unsigned long offset, bool wait)
+{
+  const uint32_t ringFrames = _header->ringFrames;
+  uint32_t pos = _header->outputRead.load(std::memory_order_relaxed);
+  uint32_t avail = _header->outputWrite.load(std::memory_order_acquire) - pos;
+
+  while(wait && !_stalled && avail < _skip + frames)
+  {
+    if(!waitReply())
+      _stalled = true;
+    avail = _header->outputWrite.load(std::memory_order_acquire) - pos;
+  }
+
+  // Late frames first, their place in the outputs is taken already.
+  const uint32_t skip = avail < _skip ? avail : _skip;
+  pos += skip;
+  avail -= skip;
+  _skip -= skip;
+  if(_skip == 0)
+    _stalled = false;
+
+  const uint32_t n = avail < frames ? avail : frames;
+  for(size_t i = 0; i < _audioOuts.size(); ++i)
+  {
+    float* dst = _ports[_audioOuts[i]];
+    if(dst)
+      bridgeRingRead(_layout.outputRing(_shm, ringFrames, i), ringFrames, pos, dst + offset, n);
+  }
+  _header->outputRead.store(pos + n, std::memory_order_release);
+
+  const float* ctrlOut = _layout.controlOutValues(_shm);
+  for(size_t i = 0; i < _controlOuts.size(); ++i)
+  {
+    float* dst = _ports[_controlOuts[i]];
+    if(dst)
+      *dst = ctrlOut[i];
+  }
+  return n;
+}
+
+//---------------------------------------------------------
+//   takeProgramControls
+//    Copies the control values a selected program left
+//     behind to the connected buffers, once.
+//---------------------------------------------------------
+
+void PluginBridge::takeProgramControls()
+{
+  if(!_header)
+    return;
+  const uint32_t n = _header->programControls.load(std::memory_order_acquire);
+  if(n == _programControls)
+    return;
+  const float* values = _layout.programControlValues(_shm);
+  for(size_t i = 0; i < _controlIns.size(); ++i)
+  {
+    float* dst = _ports[_controlIns[i]];
+    if(dst)
+      *dst = values[i];
+  }
+  _programControls = n;
+}
+
+//---------------------------------------------------------
+//   run
+//   process
+//---------------------------------------------------------
+
+void PluginBridge::run(unsigned long n)
+{
+  process(n, nullptr, 0);
+}
+
+void PluginBridge::process(unsigned long n, const void* events, unsigned long eventCount)
+{
+  const unsigned long target = latency();
+  unsigned long offset = 0;
+  unsigned long event = 0;
+  while(n > 0)
+  {
+    const unsigned long frames = n < _maxFrames ? n : _maxFrames;
+
+    // The events in these frames, the last run takes any left over.
+    const void* runEvents = nullptr;
+    unsigned long runEventCount = 0;
+#ifdef DSSI_SUPPORT
+    const snd_seq_event_t* ev = (const snd_seq_event_t*)events;
+    while(event + runEventCount < eventCount
+          && (frames == n || ev[event + runEventCount].time.tick < offset + frames))
+      ++runEventCount;
+    runEvents = ev + event;
+#else
+    (void)events;
+    (void)eventCount;
+#endif
+    event += runEventCount;
+
+    takeProgramControls();
+    if(!_exited && send(BridgeRun, frames, offset, runEvents, runEventCount))
+      _inFlight += frames;
+    else
+      _lostFrames += frames;
+
+    // Take back what keeps the process the wanted latency behind. Less at the
+    //  start when it has not got that far yet, and nothing if it fell behind.
+    unsigned long want = _inFlight > target ? _inFlight - target : 0;
+    if(want > frames)
+    {
+      _skip += want - frames;
+      _inFlight -= want - frames;
+      want = frames;
+    }
+    const unsigned long got = want ? receive(want, offset + frames - want, _mode == PluginBridgeSync) : 0;
+    _inFlight -= want;
+    // Frames the process still owes are thrown away once they arrive.
+    _skip += want - got;
+    if(want > got)
+      _lostFrames += want - got;
+
+    // Silence in front of what came back.
+    const unsigned long silent = frames - want;
+    for(size_t i = 0; i < _audioOuts.size(); ++i)
+    {
+      float* dst = _ports[_audioOuts[i]];
+      if(!dst)
+        continue;
+      memset(dst + offset, 0, sizeof(float) * silent);
+      if(got < want)
+        memset(dst + offset + frames - (want - got), 0, sizeof(float) * (want - got));
+    }
+
+    offset += frames;
+    n -= frames;
+  }
+}
+
+#ifdef DSSI_SUPPORT
+
+//---------------------------------------------------------
+//   runSynth
+//---------------------------------------------------------
+
+void PluginBridge::runSynth(unsigned long n, const snd_seq_event_t* events, unsigned long eventCount)
+{
+  process(n, events, eventCount);
+}
+
+//---------------------------------------------------------
+//   selectProgram
+//---------------------------------------------------------
+
+void PluginBridge::selectProgram(unsigned long bank, unsigned long program)
+{
+  _programSelected = true;
+  _bank = bank;
+  _program = program;
+  if(_exited || !send(BridgeSelectProgram, 0, 0, nullptr, 0, bank, program))
+    return;
+  if(_mode == PluginBridgeSync)
+  {
+    while(_header->programControls.load(std::memory_order_acquire) == _programControls && waitReply())
+      ;
+  }
+  takeProgramControls();
+}
+
+//---------------------------------------------------------
+//   ask
+//    Wakes the process for the request in the slot, and
+//     waits for the answer. _requestMutex is held.
+//---------------------------------------------------------
+
+bool PluginBridge::ask()
+{
+  if(!_header || _exited || _requestsLost)
+    return false;
+  const uint32_t request = _header->requestWrite.load(std::memory_order_relaxed) + 1;
+  _header->requestWrite.store(request, std::memory_order_release);
+  bridgeSignal(_requestFd);
+  for(int ms = 0; ms < bridgeRequestMs; ++ms)
+  {
+    if(_header->requestRead.load(std::memory_order_acquire) == request)
+      return true;
+    usleep(1000);
+  }
+  fprintf(stderr, "PluginBridge: plugin host %d does not answer, not asking it anymore\n", _pid);
+  _requestsLost = true;
+  return false;
+}
+
+//---------------------------------------------------------
+//   configure
+//---------------------------------------------------------
+
+char* PluginBridge::configure(const char* key, const char* value)
+{
+  std::lock_guard<std::mutex> lock(_requestMutex);
+  _configured[key] = value;
+  return sendConfigure(key, value);
+}
+
+char* PluginBridge::sendConfigure(const char* key, const char* value)
+{
+  const size_t keyLen = strlen(key);
+  const size_t valueLen = strlen(value);
+  if(keyLen + valueLen + 2 >= BridgeRequestText)
+    return strdup("value too long to be sent to the plugin host");
+  if(!_header)
+    return nullptr;
+
+  BridgeRequest* r = _layout.requestSlot(_shm);
+  r->type = BridgeConfigure;
+  memcpy(r->text, key, keyLen + 1);
+  memcpy(r->text + keyLen + 1, value, valueLen + 1);
+  if(!ask() || !r->result)
+    return nullptr;
+  return strdup(r->text + keyLen + valueLen + 2);
+}
+
+//---------------------------------------------------------
+//   getProgram
+//---------------------------------------------------------
+
+const DSSI_Program_Descriptor* PluginBridge::getProgram(unsigned long index)
+{
+  std::lock_guard<std::mutex> lock(_requestMutex);
+  if(!_header)
+    return nullptr;
+  BridgeRequest* r = _layout.requestSlot(_shm);
+  r->type = BridgeGetProgram;
+  r->index = index;
+  if(!ask() || !r->result)
+    return nullptr;
+  _programName = r->text;
+  _programDescr.Bank = r->bank;
+  _programDescr.Program = r->program;
+  _programDescr.Name = _programName.c_str();
+  return &_programDescr;
+}
+
+//---------------------------------------------------------
+//   getMidiControllerForPort
+//---------------------------------------------------------
+
+int PluginBridge::getMidiControllerForPort(unsigned long port)
+{
+  std::lock_guard<std::mutex> lock(_requestMutex);
+  if(!_header)
+    return DSSI_NONE;
+  BridgeRequest* r = _layout.requestSlot(_shm);
+  r->type = BridgeGetMidiController;
+  r->index = port;
+  if(!ask())
+    return DSSI_NONE;
+  return r->result;
+}
+
+//---------------------------------------------------------
+//   DssiBridgeDescriptor
+//---------------------------------------------------------
+
+DssiBridgeDescriptor::DssiBridgeDescriptor(int mode, const QString& path, const DSSI_Descriptor* plugin)
+  : _dssi(*plugin), _ladspa(*plugin->LADSPA_Plugin), _mode(mode), _path(path)
+{
+  // The plugin's own data is of no use in here, it runs in the process.
+  _ladspa.ImplementationData = this;
+  _ladspa.instantiate = instantiate;
+  _ladspa.connect_port = connectPort;
+  _ladspa.activate = activate;
+  _ladspa.run = run;
+  _ladspa.run_adding = nullptr;
+  _ladspa.set_run_adding_gain = nullptr;
+  _ladspa.deactivate = deactivate;
+  _ladspa.cleanup = cleanup;
+
+  _dssi.LADSPA_Plugin = &_ladspa;
+  _dssi.configure = plugin->configure ? configure : nullptr;
+  _dssi.get_program = plugin->get_program ? getProgram : nullptr;
+  _dssi.select_program = plugin->select_program ? selectProgram : nullptr;
+  _dssi.get_midi_controller_for_port = plugin->get_midi_controller_for_port ? getMidiControllerForPort : nullptr;
+  // The process falls back to the plugin's other run functions.
+  _dssi.run_synth = runSynth;
+  _dssi.run_synth_adding = nullptr;
+  _dssi.run_multiple_synths = nullptr;
+  _dssi.run_multiple_synths_adding = nullptr;
+}
+
+LADSPA_Handle DssiBridgeDescriptor::instantiate(const LADSPA_Descriptor* descr, unsigned long sampleRate)
+{
+  const DssiBridgeDescriptor* d = static_cast<const DssiBridgeDescriptor*>(descr->ImplementationData);
+  return PluginBridge::create(d->_mode, d->_path, descr, true, sampleRate, MusEGlobal::segmentSize,
+                              MusEGlobal::realTimeScheduling ? MusEGlobal::realTimePriority : 0);
+}
+
+// The handle is null if the process could not be started.
+void DssiBridgeDescriptor::connectPort(LADSPA_Handle handle, unsigned long port, LADSPA_Data* buffer)
+{
+  if(handle)
+    static_cast<PluginBridge*>(handle)->connectPort(port, buffer);
+}
+
+void DssiBridgeDescriptor::activate(LADSPA_Handle handle)
+{
+  if(handle)
+    static_cast<PluginBridge*>(handle)->activate();
+}
+
+void DssiBridgeDescriptor::run(LADSPA_Handle handle, unsigned long n)
+{
+  if(handle)
+    static_cast<PluginBridge*>(handle)->run(n);
+}
+
+void DssiBridgeDescriptor::deactivate(LADSPA_Handle handle)
+{
+  if(handle)
+    static_cast<PluginBridge*>(handle)->deactivate();
+}
+
+void DssiBridgeDescriptor::cleanup(LADSPA_Handle handle)
+{
+  delete static_cast<PluginBridge*>(handle);
+}
+
+char* DssiBridgeDescriptor::configure(LADSPA_Handle handle, const char* key, const char* value)
+{
+  return handle ? static_cast<PluginBridge*>(handle)->configure(key, value) : nullptr;
+}
+
+const DSSI_Program_Descriptor* DssiBridgeDescriptor::getProgram(LADSPA_Handle handle, unsigned long index)
+{
+  return handle ? static_cast<PluginBridge*>(handle)->getProgram(index) : nullptr;
+}
+
+void DssiBridgeDescriptor::selectProgram(LADSPA_Handle handle, unsigned long bank, unsigned long program)
+{
+  if(handle)
+    static_cast<PluginBridge*>(handle)->selectProgram(bank, program);
+}
+
+int DssiBridgeDescriptor::getMidiControllerForPort(LADSPA_Handle handle, unsigned long port)
+{
+  return handle ? static_cast<PluginBridge*>(handle)->getMidiControllerForPort(port) : DSSI_NONE;
+}
+
+void DssiBridgeDescriptor::runSynth(LADSPA_Handle handle, unsigned long n,
+                                    snd_seq_event_t* events, unsigned long eventCount)
+{
+  if(handle)
+    static_cast<PluginBridge*>(handle)->runSynth(n, events, eventCount);
+}
+
+#endif // DSSI_SUPPORT
+
+} // namespace MusECore
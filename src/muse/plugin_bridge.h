@@ -0,0 +1,249 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  plugin_bridge.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __PLUGIN_BRIDGE_H__
+#define __PLUGIN_BRIDGE_H__
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <time.h>
+#include <sys/types.h>
+#include <vector>
+
+#include <QString>
+
+#include "config.h"
+#include <ladspa.h>
+#ifdef DSSI_SUPPORT
+#include <dssi.h>
+#endif
+
+#include "plugin_bridge_shm.h"
+
+namespace MusECore {
+
+// How LADSPA and DSSI plugins and DSSI synths are run, config.pluginBridgeMode.
+//  LV2, native VST and DSSI-VST plugins always run in the audio thread,
+//  DSSI-VST runs its plugins in a process of its own anyway.
+enum PluginBridgeMode {
+      // In the audio thread, the usual way.
+      PluginBridgeOff = 0,
+      // In a muse_plugin_bridge process. The audio thread waits for the result.
+      PluginBridgeSync,
+      // In a muse_plugin_bridge process, one period behind. The audio thread
+      //  never waits, the period is reported as the plugin's latency.
+      PluginBridgePipelined
+      };
+
+//---------------------------------------------------------
+//   PluginBridge
+//    One instance of a LADSPA or DSSI plugin, running in its
+//     own muse_plugin_bridge process. A plugin which crashes
+//     or hangs there takes only its own process down, its
+//     outputs are silent from then on.
+//
+//    Stands in for the LADSPA handle: the calls are the
+//     same, and connectPort() takes the same buffers. run()
+//     copies the inputs and control values into shared
+//     memory and wakes the process, and copies back what
+//     it has computed.
+//
+//    Created and destroyed by the gui thread. run() and
+//     selectProgram() are called by the audio thread and
+//     do not allocate. configure(), getProgram() and
+//     getMidiControllerForPort() ask the process and wait
+//     for the answer, any thread but the audio thread.
+//---------------------------------------------------------
+
+class PluginBridge {
+      int _mode;
+      // A DSSI plugin, the process runs it with run_synth().
+      bool _dssi;
+      unsigned long _maxFrames;
+      // What the process is started with.
+      QString _path;
+      QString _label;
+      unsigned long _sampleRate;
+      int _priority;
+      pid_t _pid;
+      int _shmFd;
+      int _requestFd;
+      int _replyFd;
+      // The write end of the pipe the process watches to see MusE is gone.
+      int _parentFd;
+      void* _shm;
+      MusEPlugin::BridgeShmHeader* _header;
+      MusEPlugin::BridgeShmLayout _layout;
+
+      // The buffer connected to each port.
+      std::vector<float*> _ports;
+      // The ports of each kind, in port order.
+      std::vector<unsigned long> _audioIns;
+      std::vector<unsigned long> _audioOuts;
+      std::vector<unsigned long> _controlIns;
+      std::vector<unsigned long> _controlOuts;
+
+      // Frames sent to the process and not yet taken back.
+      unsigned long _inFlight;
+      // Frames which came too late and are thrown away once they arrive.
+      unsigned long _skip;
+      // The process did not keep up. Do not wait for it until it caught up.
+      bool _stalled;
+      // Until when the audio thread may wait for the process in this cycle.
+      timespec _deadline;
+      // The plugin was activated, and is activated again in a new process.
+      bool _active;
+      // The process is gone. Only the gui thread reaps it and sets this.
+      std::atomic<bool> _exited;
+      int _exitStatus;
+      // Frames replaced by silence, because the process was late or gone.
+      unsigned long _lostFrames;
+      // The control values of selected programs taken back so far, see BridgeCommand.
+      uint32_t _programControls;
+
+#ifdef DSSI_SUPPORT
+      // The program selected last, selected again in a new process.
+      bool _programSelected;
+      unsigned long _bank;
+      unsigned long _program;
+      // Serializes the requests, and guards what they keep.
+      std::mutex _requestMutex;
+      // A request was not answered in time. The process may still be
+      //  working on it, so it is not asked anything anymore.
+      bool _requestsLost;
+      // What configure() was called with, sent again to a new process.
+      std::map<std::string, std::string> _configured;
+      // What getProgram() returns.
+      DSSI_Program_Descriptor _programDescr;
+      std::string _programName;
+#endif
+
+      PluginBridge(int mode, const QString& path, const LADSPA_Descriptor* descr, bool dssi,
+                   unsigned long sampleRate, unsigned long maxFrames, int priority);
+      bool start();
+      void stop();
+      bool waitReady();
+      bool send(uint32_t type, unsigned long frames, unsigned long offset,
+                const void* events = nullptr, unsigned long eventCount = 0,
+                unsigned long bank = 0, unsigned long program = 0);
+      unsigned long receive(unsigned long frames, unsigned long offset, bool wait);
+      bool waitReply();
+      void takeProgramControls();
+      void process(unsigned long n, const void* events, unsigned long eventCount);
+      void checkExited();
+#ifdef DSSI_SUPPORT
+      bool ask();
+      char* sendConfigure(const char* key, const char* value);
+#endif
+
+   public:
+      ~PluginBridge();
+      PluginBridge(const PluginBridge&) = delete;
+      PluginBridge& operator=(const PluginBridge&) = delete;
+
+      // Starts the process for the plugin in the library at path, the DSSI plugin
+      //  of descr if dssi is set. It runs the plugin with realtime priority if
+      //  priority is not zero. Returns null if it could not be started.
+      static PluginBridge* create(int mode, const QString& path, const LADSPA_Descriptor* descr, bool dssi,
+                                  unsigned long sampleRate, unsigned long maxFrames, int priority);
+
+      void connectPort(unsigned long port, float* buffer);
+      void activate();
+      void deactivate();
+      // Starts a cycle of frames. The run() calls in it wait for the
+      //  process no longer than that, all together. Audio thread.
+      void startCycle(unsigned long frames);
+      void run(unsigned long n);
+#ifdef DSSI_SUPPORT
+      // The DSSI calls. The events' ticks count from the start of the run.
+      void runSynth(unsigned long n, const snd_seq_event_t* events, unsigned long eventCount);
+      // The plugin sets its control inputs for the program, they are copied to the
+      //  connected buffers once the process has done so, in this run in sync mode.
+      void selectProgram(unsigned long bank, unsigned long program);
+      char* configure(const char* key, const char* value);
+      // The program stays valid until the next call.
+      const DSSI_Program_Descriptor* getProgram(unsigned long index);
+      int getMidiControllerForPort(unsigned long port);
+#endif
+      // Notices a process which ended. Gui thread, regularly.
+      void update() { checkExited(); }
+
+      // The most frames the process takes in one go, the period it was made for.
+      unsigned long maxFrames() const { return _maxFrames; }
+      // Starts a new process taking up to maxFrames in one go, for a new period size.
+      //  The plugin's own state starts over, the controls are sent with each run anyway,
+      //  and the configure() values and the program are sent again.
+      //  The audio thread must not run the plugin meanwhile. Returns false if the new
+      //  process could not be started, the outputs are silent then.
+      bool resize(unsigned long maxFrames);
+
+      // The frames the outputs are behind the inputs.
+      unsigned long latency() const;
+      unsigned long lostFrames() const { return _lostFrames; }
+      };
+
+#ifdef DSSI_SUPPORT
+
+//---------------------------------------------------------
+//   DssiBridgeDescriptor
+//    A copy of a DSSI plugin's descriptor whose functions
+//     run the plugin in PluginBridges. The handles it makes
+//     are PluginBridges. Used in place of the plugin's own
+//     descriptor while its library is loaded.
+//---------------------------------------------------------
+
+class DssiBridgeDescriptor {
+      DSSI_Descriptor _dssi;
+      LADSPA_Descriptor _ladspa;
+      int _mode;
+      QString _path;
+
+      static LADSPA_Handle instantiate(const LADSPA_Descriptor* descr, unsigned long sampleRate);
+      static void connectPort(LADSPA_Handle handle, unsigned long port, LADSPA_Data* buffer);
+      static void activate(LADSPA_Handle handle);
+      static void run(LADSPA_Handle handle, unsigned long n);
+      static void deactivate(LADSPA_Handle handle);
+      static void cleanup(LADSPA_Handle handle);
+      static char* configure(LADSPA_Handle handle, const char* key, const char* value);
+      static const DSSI_Program_Descriptor* getProgram(LADSPA_Handle handle, unsigned long index);
+      static void selectProgram(LADSPA_Handle handle, unsigned long bank, unsigned long program);
+      static int getMidiControllerForPort(LADSPA_Handle handle, unsigned long port);
+      static void runSynth(LADSPA_Handle handle, unsigned long n,
+                           snd_seq_event_t* events, unsigned long eventCount);
+
+   public:
+      // Runs the plugin in the library at path the way mode says, a PluginBridgeMode.
+      DssiBridgeDescriptor(int mode, const QString& path, const DSSI_Descriptor* plugin);
+      DssiBridgeDescriptor(const DssiBridgeDescriptor&) = delete;
+      DssiBridgeDescriptor& operator=(const DssiBridgeDescriptor&) = delete;
+
+      const DSSI_Descriptor* descriptor() const { return &_dssi; }
+      };
+
+#endif // DSSI_SUPPORT
+
+} // namespace MusECore
+
+#endif
@@ -0,0 +1,105 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  plugin_preload.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <map>
+#include <vector>
+
+#include "plugin_preload.h"
+#include "plugin.h"
+#include "track.h"
+#include "song.h"
+#include "gconfig.h"
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   PluginPreload
+//---------------------------------------------------------
+
+PluginPreload::PluginPreload(int threads)
+  : _jobs(threads)
+{
+}
+
+//---------------------------------------------------------
+//   instantiate
+//---------------------------------------------------------
+
+void PluginPreload::instantiate(const std::function<void(int done, int total)>& progress)
+{
+  release();
+
+  // The instances of one plugin are made one after the other on the same
+  //  thread, a plugin library need not allow making them concurrently.
+  std::map<const Plugin*, std::vector<PluginI*> > threaded;
+  std::vector<PluginI*> gui;
+
+  const TrackList* tl = MusEGlobal::song->tracks();
+  for(ciTrack it = tl->cbegin(); it != tl->cend(); ++it)
+  {
+    if((*it)->isMidiTrack())
+      continue;
+    AudioTrack* t = static_cast<AudioTrack*>(*it);
+    Pipeline* pl = t->efxPipe();
+    if(!pl || !pl->hasPendingInstances())
+      continue;
+    if(MusEGlobal::config.lazyPluginInstances && (t->off() || !t->reachesAudioOutput()))
+      continue;
+    for(int i = 0; i < PipelineDepth; ++i)
+    {
+      PluginI* p = (*pl)[i];
+      if(!p || !p->instancesPending())
+        continue;
+      if(p->isLV2Plugin() || p->isVstNativePlugin())
+        gui.push_back(p);
+      else
+        threaded[p->plugin()].push_back(p);
+    }
+  }
+
+  _jobs.addOwn(gui.size());
+  for(const auto& e : threaded)
+  {
+    std::vector<std::function<void()> > jobs;
+    for(PluginI* p : e.second)
+      jobs.push_back([p]() { p->makePendingInstances(); });
+    _jobs.addSeries(std::move(jobs));
+  }
+
+  int guiDone = 0;
+  for(PluginI* p : gui)
+  {
+    p->makePendingInstances();
+    _jobs.jobDone();
+    if(progress && (++guiDone % 8) == 0)
+    {
+      int done, total;
+      _jobs.progress(&done, &total);
+      progress(done, total);
+    }
+  }
+
+  _jobs.wait(progress);
+}
+
+} // namespace MusECore
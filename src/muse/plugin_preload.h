@@ -0,0 +1,79 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  plugin_preload.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __PLUGIN_PRELOAD_H__
+#define __PLUGIN_PRELOAD_H__
+
+#include <functional>
+
+#include "counted_jobs.h"
+#include "current_preload.h"
+
+namespace MusECore {
+
+class PluginI;
+
+//---------------------------------------------------------
+//   PluginPreload
+//    Makes the plugin instances of a project after the
+//     song file was read, instead of one by one while
+//     reading it. Plugins which only need their library
+//     are made on a few threads. LV2 and VST plugins are
+//     made on the gui thread, their hosts share state
+//     which is not guarded. Bridged plugins are made on
+//     the threads too: their plugin hosts watch a pipe
+//     of MusE's, not the thread which started them, so
+//     they stay when the thread ends.
+//
+//    While a preload is current, PluginI::initPluginInstance()
+//     only sets the plugin up and leaves its instances
+//     pending. instantiate() makes them. With
+//     config.lazyPluginInstances, the plugins of tracks
+//     which are off or do not reach an audio output are
+//     left pending, their tracks make them once needed.
+//
+//    Synths are not made here. Their instances are made
+//     while the song file is read, as before, only the
+//     plugins in their effect racks wait for the preload.
+//
+//    Only the gui thread uses it.
+//---------------------------------------------------------
+
+class PluginPreload : public CurrentPreload<PluginPreload> {
+      // Waits for the jobs not done yet when destroyed.
+      CountedJobs _jobs;
+
+   public:
+      PluginPreload(int threads);
+      PluginPreload(const PluginPreload&) = delete;
+      PluginPreload& operator=(const PluginPreload&) = delete;
+
+      // Stops being current, and makes the pending instances of the song's
+      //  tracks. Returns when they are made. progress, if given, is called
+      //  now and then, with the plugins done and the plugins to make.
+      void instantiate(const std::function<void(int done, int total)>& progress = nullptr);
+      };
+
+} // namespace MusECore
+
+#endif
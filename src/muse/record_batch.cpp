@@ -0,0 +1,224 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  record_batch.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "record_batch.h"
+#include "gconfig.h"
+#include "globals.h"
+
+namespace MusECore {
+
+// How many batches ahead of the written frames disk space is reserved.
+static const int reserveBatches = 16;
+
+//---------------------------------------------------------
+//   RecordBatch
+//---------------------------------------------------------
+
+RecordBatch::RecordBatch()
+  : _channels(0), _buffers(nullptr), _capacity(0), _start(0), _frames(0),
+    _fd(-1), _reserved(0), _pending(0), _peakBacklog(0), _overruns(0)
+{
+}
+
+RecordBatch::~RecordBatch()
+{
+  finish();
+  free();
+}
+
+void RecordBatch::alloc(int channels)
+{
+  free();
+  unsigned frames = 0;
+  if(MusEGlobal::config.recordBatchMs > 0)
+    frames = (unsigned long)MusEGlobal::config.recordBatchMs * MusEGlobal::sampleRate / 1000;
+  _capacity = std::max(frames, unsigned(MusEGlobal::segmentSize));
+  _channels = channels;
+  _buffers = new float*[_channels];
+  for(int ch = 0; ch < _channels; ++ch)
+    _buffers[ch] = new float[_capacity];
+}
+
+void RecordBatch::free()
+{
+  if(_buffers)
+  {
+    for(int ch = 0; ch < _channels; ++ch)
+      delete[] _buffers[ch];
+    delete[] _buffers;
+    _buffers = nullptr;
+  }
+  _channels = 0;
+  _capacity = 0;
+  _frames = 0;
+  _pending.store(0, std::memory_order_release);
+}
+
+//---------------------------------------------------------
+//   add
+//---------------------------------------------------------
+
+void RecordBatch::add(SndFileR& file, int channels, sf_count_t pos, float** src, unsigned n)
+{
+  if(_frames && (channels != _channels || pos != _start + sf_count_t(_frames) || _frames + n > _capacity))
+    flush(file);
+  if(!_buffers || channels != _channels)
+  {
+    alloc(channels);
+    file.setWriteSegSize(_capacity);
+  }
+  // A segment larger than the buffer goes straight out.
+  if(n > _capacity)
+  {
+    file.seek(pos, 0);
+    file.write(channels, src, n, MusEGlobal::config.liveWaveUpdate);
+    return;
+  }
+
+  if(_frames == 0)
+    _start = pos;
+  for(int ch = 0; ch < _channels; ++ch)
+    memcpy(_buffers[ch] + _frames, src[ch], n * sizeof(float));
+  _frames += n;
+  _pending.store(_frames, std::memory_order_release);
+  if(_frames == _capacity)
+    flush(file);
+}
+
+//---------------------------------------------------------
+//   flush
+//---------------------------------------------------------
+
+void RecordBatch::flush(SndFileR& file)
+{
+  if(_frames == 0)
+    return;
+  reserve(file, _start + _frames);
+  // FIXME If we are to support writing compressed file types, we probably shouldn't be seeking here. REMOVE Tim. Wave.
+  file.seek(_start, 0);
+  file.write(_channels, _buffers, _frames, MusEGlobal::config.liveWaveUpdate);
+  _frames = 0;
+  _pending.store(0, std::memory_order_release);
+}
+
+//---------------------------------------------------------
+//   reserve
+//---------------------------------------------------------
+
+void RecordBatch::reserve(SndFileR& file, sf_count_t end)
+{
+#ifdef FALLOC_FL_KEEP_SIZE
+  const QString path = file.path();
+  if(_fd < 0 || path != _fdPath)
+  {
+    finish();
+    _fd = ::open(path.toLocal8Bit().constData(), O_WRONLY);
+    if(_fd < 0)
+      return;
+    _fdPath = path;
+    _reserved = 0;
+  }
+
+  int sampleBytes = 4;
+  switch(file.format() & SF_FORMAT_SUBMASK)
+  {
+    case SF_FORMAT_PCM_S8:
+    case SF_FORMAT_PCM_U8:
+      sampleBytes = 1;
+    break;
+    case SF_FORMAT_PCM_16:
+      sampleBytes = 2;
+    break;
+    case SF_FORMAT_PCM_24:
+      sampleBytes = 3;
+    break;
+    case SF_FORMAT_DOUBLE:
+      sampleBytes = 8;
+    break;
+  }
+  // The header is not known here. Reserving a little more covers it.
+  const off_t frameBytes = off_t(sampleBytes) * file.channels();
+  const off_t needed = off_t(end) * frameBytes + 65536;
+  if(needed <= _reserved)
+    return;
+  const off_t upTo = needed + off_t(reserveBatches) * _capacity * frameBytes;
+  // Reserving is only an optimization. Writing works without it.
+  if(fallocate(_fd, FALLOC_FL_KEEP_SIZE, _reserved, upTo - _reserved) == 0)
+    _reserved = upTo;
+  else
+    // Do not try again for this file.
+    _reserved = off_t(1) << 62;
+#else
+  (void)file;
+  (void)end;
+#endif
+}
+
+//---------------------------------------------------------
+//   finish
+//---------------------------------------------------------
+
+void RecordBatch::finish()
+{
+  _frames = 0;
+  _pending.store(0, std::memory_order_release);
+  if(_fd >= 0)
+  {
+    // Truncating to the size it has frees the blocks reserved beyond it.
+    struct stat st;
+    if(fstat(_fd, &st) == 0 && ftruncate(_fd, st.st_size) != 0)
+      fprintf(stderr, "RecordBatch::finish: Cannot release reserved space of %s\n",
+        _fdPath.toLocal8Bit().constData());
+    ::close(_fd);
+    _fd = -1;
+  }
+  _fdPath.clear();
+  _reserved = 0;
+}
+
+//---------------------------------------------------------
+//   notePeakBacklog
+//---------------------------------------------------------
+
+void RecordBatch::notePeakBacklog(unsigned frames)
+{
+  unsigned peak = _peakBacklog.load(std::memory_order_relaxed);
+  while(frames > peak && !_peakBacklog.compare_exchange_weak(peak, frames, std::memory_order_relaxed))
+    ;
+}
+
+void RecordBatch::resetStats()
+{
+  _peakBacklog.store(0, std::memory_order_relaxed);
+  _overruns.store(0, std::memory_order_relaxed);
+}
+
+} // namespace MusECore
@@ -0,0 +1,102 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  record_batch.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __RECORD_BATCH_H__
+#define __RECORD_BATCH_H__
+
+#include <atomic>
+#include <sndfile.h>
+
+#include "wave.h"
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   RecordBatch
+//    Collects the recorded segments of a track into one
+//     large buffer, and writes them to the record file in
+//     one go once config.recordBatchMs of audio came
+//     together, instead of seeking and writing every
+//     segment on its own.
+//
+//    Ahead of the writes, disk space is reserved for the
+//     file without changing its size, so the file system
+//     does not have to find room for every write. What was
+//     reserved beyond the end is given back by finish().
+//
+//    Only the record writer thread adds and writes, apart
+//     from finish(), which is called once recording stopped.
+//     The backlog statistics are read by any thread.
+//---------------------------------------------------------
+
+class RecordBatch {
+      int _channels;
+      float** _buffers;
+      // Frames per channel the buffers hold.
+      unsigned _capacity;
+      // The file frame of the first collected frame, and the frames collected.
+      sf_count_t _start;
+      unsigned _frames;
+
+      // The record file opened once more, for reserving space, and how far it is reserved.
+      int _fd;
+      QString _fdPath;
+      off_t _reserved;
+
+      std::atomic<unsigned> _pending;
+      std::atomic<unsigned> _peakBacklog;
+      std::atomic<unsigned> _overruns;
+
+      void alloc(int channels);
+      void free();
+      // Reserves disk space up to beyond the given end of the written frames.
+      void reserve(SndFileR& file, sf_count_t end);
+
+   public:
+      RecordBatch();
+      ~RecordBatch();
+      RecordBatch(const RecordBatch&) = delete;
+      RecordBatch& operator=(const RecordBatch&) = delete;
+
+      // Collects n frames of the channels of src, to be written at file frame pos.
+      // Writes what was collected before if pos does not follow on, or the buffer is full.
+      void add(SndFileR& file, int channels, sf_count_t pos, float** src, unsigned n);
+      // Writes what was collected.
+      void flush(SndFileR& file);
+      // Drops anything collected, and gives back the space reserved beyond the end of the file.
+      void finish();
+
+      // Frames collected but not written yet.
+      unsigned pending() const { return _pending.load(std::memory_order_acquire); }
+      // The most frames recorded but not written at any time, and the segments lost
+      //  because the record fifo was full. Any thread.
+      unsigned peakBacklog() const { return _peakBacklog.load(std::memory_order_relaxed); }
+      unsigned overruns() const { return _overruns.load(std::memory_order_relaxed); }
+      void notePeakBacklog(unsigned frames);
+      void noteOverrun() { _overruns.fetch_add(1, std::memory_order_relaxed); }
+      void resetStats();
+      };
+
+} // namespace MusECore
+
+#endif
@@ -61,8 +61,17 @@ void Audio::sendMsg(AudioMsg* m)
 
       if (_running) {
             m->serialNo = sno++;
-            //DEBUG:
-            msg = m;
+            AudioMsgCommand cmd;
+            cmd.msg = m;
+            cmd.async = false;
+            cmd.callback = nullptr;
+            cmd.callbackData = nullptr;
+            // The number of pending asynchronous messages is limited so that there
+            //  is always room for this one.
+            if (!_msgQueue->put(cmd)) {
+                  fprintf(stderr, "Audio::sendMsg: message queue overflow\n");
+                  return;
+                  }
             // wait for next audio "process" call to finish operation
             int no = -1;
             int rv = read(fromThreadFdr, &no, sizeof(int));
@@ -75,11 +84,76 @@ void Audio::sendMsg(AudioMsg* m)
             }
       else {
             // if audio is not running (during initialization)
-            // process commands immediately
+            // process commands immediately, after any still waiting in the queue
+            processMsgQueue();
             processMsg(m);
             }
       }
 
+//---------------------------------------------------------
+//   sendMsgAsync
+//    send request from gui to sequencer
+//    without waiting until it is processed
+//---------------------------------------------------------
+
+void Audio::sendMsgAsync(AudioMsg* m, AudioMsgCallback callback, void* callbackData)
+      {
+      AudioMsgCommand cmd;
+      cmd.msg = m;
+      cmd.async = true;
+      cmd.callback = callback;
+      cmd.callbackData = callbackData;
+
+      if (!_running) {
+            // if audio is not running (during initialization)
+            // process commands immediately, after any still waiting in the queue
+            processMsgQueue();
+            processMsg(m);
+            processMsgCompletions();
+            if (callback)
+                  callback(m, callbackData);
+            delete m;
+            return;
+            }
+
+      // Leave room in the queue for one synchronous message, and make sure the
+      //  audio thread always has room to hand back the completed messages.
+      if (_asyncMsgsPending >= (int)_msgDoneQueue->capacity() - 1) {
+            processMsgCompletions();
+            if (_asyncMsgsPending >= (int)_msgDoneQueue->capacity() - 1)
+                  flushMsgs();
+            }
+
+      ++_asyncMsgsPending;
+      _msgQueue->put(cmd);
+      }
+
+//---------------------------------------------------------
+//   processMsgCompletions
+//---------------------------------------------------------
+
+void Audio::processMsgCompletions()
+      {
+      AudioMsgCommand cmd;
+      while (_msgDoneQueue->get(cmd)) {
+            --_asyncMsgsPending;
+            if (cmd.callback)
+                  cmd.callback(cmd.msg, cmd.callbackData);
+            delete cmd.msg;
+            }
+      }
+
+//---------------------------------------------------------
+//   flushMsgs
+//---------------------------------------------------------
+
+void Audio::flushMsgs()
+      {
+      // Messages are processed in order, so once this one is done all the others are too.
+      msgAudioWait();
+      processMsgCompletions();
+      }
+
 //---------------------------------------------------------
 //   sendMessage
 //    send request from gui to sequencer
@@ -684,12 +758,13 @@ void Audio::msgUpdateSoloStates()
 
 void Audio::msgSetAux(AudioTrack* track, int idx, double val)
       {
-      AudioMsg msg;
-      msg.id    = SEQM_SET_AUX;
-      msg.snode = track;
-      msg.ival  = idx;
-      msg.dval  = val;
-      sendMessage(&msg, false);
+      // No need to wait for the result. Aux knobs send many of these while moving.
+      AudioMsg* msg = new AudioMsg();
+      msg->id    = SEQM_SET_AUX;
+      msg->snode = track;
+      msg->ival  = idx;
+      msg->dval  = val;
+      sendMsgAsync(msg);
       }
 
 //---------------------------------------------------------
@@ -768,9 +843,14 @@ void Audio::msgSetSendMetronome(AudioTrack* track, bool b)
 
 void Audio::msgBounce()
       {
-      if (!MusEGlobal::checkAudioDevice()) return;
+      msgBounce(MusEGlobal::song->lPos(), MusEGlobal::song->rPos());
+      }
+
+bool Audio::msgBounce(const Pos& start, const Pos& end, bool forceFreewheel)
+      {
+      if (!MusEGlobal::checkAudioDevice()) return false;
 
-      MusEGlobal::audioDevice->seekTransport(MusEGlobal::song->lPos());
+      MusEGlobal::audioDevice->seekTransport(start);
       // Wait until seek takes effect.
       msgAudioWait();
       msgAudioWait();
@@ -784,13 +864,14 @@ void Audio::msgBounce()
       if(!_syncReady)
       {
         fprintf(stderr, "ERROR: Audio::msgBounce(): Sync not ready!\n");
-        return;
+        return false;
       }
       
+      _bounceEnd = end;
       _bounceState = BounceStart;
       
 // REMOVE Tim. latency. Added. Moved here from audio thread process code (via Song::seqSignal()).
-      if(MusEGlobal::config.freewheelMode)
+      if(MusEGlobal::config.freewheelMode || forceFreewheel)
       {
         MusEGlobal::audioDevice->setFreewheel(true);
         // Wait a few cycles for the freewheel to take effect.
@@ -806,7 +887,7 @@ void Audio::msgBounce()
           fprintf(stderr, "ERROR: Audio::msgBounce(): Freewheel mode did not start yet!\n");
         }
       }
-      
+      return true;
       }
 
 //---------------------------------------------------------
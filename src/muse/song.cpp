@@ -60,6 +60,7 @@
 //#include "strntcpy.h"
 #include "name_factory.h"
 #include "synthdialog.h"
+#include "track_freeze.h"
 
 // Forwards from header:
 #include <QAction>
@@ -113,6 +114,9 @@ Song::Song(const char* name)
       _fCpuLoad = 0.0;
       _fDspLoad = 0.0;
       _xRunsCount = 0;
+      _frozenTracksCounter = 0;
+      _overviewCounter = 0;
+      _overviewGeneration = 0;
 
       realtimeMidiEvents = new LockFreeMPSCRingBuffer<MidiRecordEvent>(256);
       mmcEvents = new LockFreeMPSCRingBuffer<MMC_Commands>(256);
@@ -123,6 +127,7 @@ Song::Song(const char* name)
       _globalPitchShift = 0;
       bounceTrack = nullptr;
       bounceOutput = nullptr;
+      freezeRender = nullptr;
       showSongInfo=true;
       clearDrumMap(); // One-time only early init
       clear(false);
@@ -1121,7 +1126,7 @@ void Song::cmdAddRecordedWave(MusECore::WaveTrack* track, MusECore::Pos s, MusEC
       //  written to the sndfile and therefore stops immediately when the transport stops and thus is
       //  safe to read here regardless of waiting.
       int tout = 100; // Ten seconds. Otherwise we gotta move on.
-      while(track->recordFifoCount() != 0)
+      while(track->recordBacklog() != 0)
       {
         usleep(100000);
         --tout;
@@ -1278,7 +1283,9 @@ void Song::setLoop(bool f)
       {
       if (loopFlag != f) {
             loopFlag = f;
-            MusEGlobal::loopAction->setChecked(loopFlag);
+            // The actions do not exist when rendering headless.
+            if (MusEGlobal::loopAction)
+                  MusEGlobal::loopAction->setChecked(loopFlag);
             emit loopChanged(loopFlag);
             }
       }
@@ -1418,7 +1425,8 @@ void Song::setPunchin(bool f)
       {
       if (punchinFlag != f) {
             punchinFlag = f;
-            MusEGlobal::punchinAction->setChecked(punchinFlag);
+            if (MusEGlobal::punchinAction)
+                  MusEGlobal::punchinAction->setChecked(punchinFlag);
             emit punchinChanged(punchinFlag);
             }
       }
@@ -1432,7 +1440,8 @@ void Song::setPunchout(bool f)
       {
       if (punchoutFlag != f) {
             punchoutFlag = f;
-            MusEGlobal::punchoutAction->setChecked(punchoutFlag);
+            if (MusEGlobal::punchoutAction)
+                  MusEGlobal::punchoutAction->setChecked(punchoutFlag);
             emit punchoutChanged(punchoutFlag);
             }
       }
@@ -1929,6 +1938,9 @@ void Song::beat()
         _timebaseMasterCounter = MusEGlobal::config.guiRefresh;
       }
 
+      // Hand the audio thread a new parallel processing graph, if the routes changed.
+      MusEGlobal::audio->updateGraph();
+
       //First: update cpu load toolbar
       _fCpuLoad = MusEGlobal::muse->getCPULoad();
       _fDspLoad = 0.0f;
@@ -1954,6 +1966,25 @@ void Song::beat()
       for(ciTrack it = _tracks.begin(); it != _tracks.end(); ++it)
         (*it)->guiHeartBeat();
 
+      // Check the frozen tracks once per second.
+      if(--_frozenTracksCounter <= 0)
+      {
+        checkFrozenTracks();
+        _frozenTracksCounter = MusEGlobal::config.guiRefresh;
+      }
+
+      // Redraw the waves a few times per second while peak files are built in the background.
+      if(--_overviewCounter <= 0)
+      {
+        const unsigned g = SndFile::overviewGeneration();
+        if(g != _overviewGeneration)
+        {
+          _overviewGeneration = g;
+          emit songChanged(SC_CLIP_MODIFIED);
+        }
+        _overviewCounter = MusEGlobal::config.guiRefresh / 4;
+      }
+
       enum {
         RTM_NONE,
         RTM_STOP,
@@ -2702,6 +2733,14 @@ void Song::clear(bool signal, bool clear_all)
         fprintf(stderr, "Song::clear\n");
       
       bounceTrack    = 0;
+      _frozenTracksCounter = 0;
+      _overviewCounter = 0;
+      if(freezeRender)
+      {
+        freezeRender->discard();
+        delete freezeRender;
+        freezeRender = nullptr;
+      }
 
       // Clear any midi control assignments.
       _midiAssignments.clear();
@@ -2843,6 +2882,12 @@ void Song::clear(bool signal, bool clear_all)
 void Song::cleanupForQuit()
 {
       bounceTrack = nullptr;
+      if(freezeRender)
+      {
+        freezeRender->discard();
+        delete freezeRender;
+        freezeRender = nullptr;
+      }
 
       if(MusEGlobal::debugMsg)
         fprintf(stderr, "MusE: Song::cleanupForQuit...\n");
@@ -3058,6 +3103,7 @@ void Song::seqSignal(int fd)
                           abortRolling();
                           // Switch all the wave converters back to online mode.
                           setAudioConvertersOfflineOperation(false);
+                          finishFreezeRender();
                         break;
 
                   case 'B': // Stop + Special stop bounce mode
@@ -3065,6 +3111,7 @@ void Song::seqSignal(int fd)
                           stopRolling();
                           // Switch all the wave converters back to online mode.
                           setAudioConvertersOfflineOperation(false);
+                          finishFreezeRender();
                         break;
 
                   case 'C': // Graph changed
@@ -3101,6 +3148,10 @@ void Song::seqSignal(int fd)
                         update(SC_DRUMMAP);
                         break;
 
+                  case 'M': // Asynchronous audio messages have been processed.
+                        MusEGlobal::audio->processMsgCompletions();
+                        break;
+
 //                   case 'E': // Midi events are available in the ipc event buffer.
 //                         if(MusEGlobal::song)
 //                           MusEGlobal::song->processIpcInEventBuffers();
@@ -4445,6 +4496,74 @@ void Song::abortRolling()
   setStopPlay(false);
 }
 
+//---------------------------------------------------------
+//   finishFreezeRender
+//---------------------------------------------------------
+
+void Song::finishFreezeRender()
+{
+  TrackFreeze* fr = freezeRender;
+  if(!fr)
+    return;
+  freezeRender = nullptr;
+
+  AudioTrack* track = fr->track();
+  // The track may have been deleted while rendering.
+  if(!_tracks.contains(track))
+  {
+    fr->discard();
+    delete fr;
+    return;
+  }
+
+  if(!fr->finishRender())
+  {
+    fprintf(stderr, "Song::finishFreezeRender: Freezing track %s did not complete\n",
+            track->name().toLocal8Bit().constData());
+    fr->discard();
+    delete fr;
+    return;
+  }
+
+  // Any old freeze now belongs to the undo system.
+  applyOperation(UndoOp(UndoOp::SetTrackFreeze, track, track->freeze(), fr));
+}
+
+//---------------------------------------------------------
+//   checkFrozenTracks
+//---------------------------------------------------------
+
+void Song::checkFrozenTracks()
+{
+  // Leave them alone while one is being rendered.
+  if(MusEGlobal::audio->bounce() || freezeRender)
+    return;
+
+  bool changed = false;
+  for(ciTrack it = _tracks.cbegin(); it != _tracks.cend(); ++it)
+  {
+    if((*it)->isMidiTrack())
+      continue;
+    AudioTrack* track = static_cast<AudioTrack*>(*it);
+    TrackFreeze* fr = track->freeze();
+    if(!fr)
+      continue;
+    const bool stale = TrackFreeze::computeStamp(track) != fr->stamp();
+    if(stale != fr->isStale())
+    {
+      fr->setStale(stale);
+      changed = true;
+    }
+  }
+
+  if(changed)
+  {
+    // The plugin latencies have changed.
+    MusEGlobal::audio->latencyChanged();
+    update(SC_TRACK_MODIFIED);
+  }
+}
+
 //---------------------------------------------------------
 //   stopRolling
 //---------------------------------------------------------
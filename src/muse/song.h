@@ -69,6 +69,7 @@ class Route;
 struct AudioMsg;
 class MidiPart;
 class Undo;
+class TrackFreeze;
 struct UndoOp;
 class UndoList;
 
@@ -136,6 +137,12 @@ class Song : public QObject {
       float _fCpuLoad;
       float _fDspLoad;
       long _xRunsCount;
+      // Heartbeats until the frozen tracks are checked again.
+      int _frozenTracksCounter;
+      // Heartbeats until the wave overviews are checked again, and the
+      //  SndFile::overviewGeneration() they were last redrawn for.
+      int _overviewCounter;
+      unsigned _overviewGeneration;
 
       // Receives events from any threads. For now, specifically for creating new
       //  midi controllers in the gui thread and adding them safely to the controller lists.
@@ -259,6 +266,8 @@ class Song : public QObject {
       bool dirty;
       WaveTrack* bounceTrack;
       AudioOutput* bounceOutput;
+      // The track freeze being rendered, if any. See MusE::freezeTrack().
+      TrackFreeze* freezeRender;
       void updatePos();
 
       void read(Xml&, bool isTemplate=false);
@@ -343,6 +352,12 @@ class Song : public QObject {
       // Fills operations if given, otherwise creates and executes its own operations list.
       void stopRolling(Undo* operations = 0);
       void abortRolling();
+      // Installs the freeze being rendered on its track if rendering completed,
+      //  otherwise discards it. Called when the transport has stopped.
+      void finishFreezeRender();
+      // Marks frozen tracks stale whose inputs have changed since they were
+      //  rendered, and unmarks them when the changes are undone.
+      void checkFrozenTracks();
 
       float cpuLoad() const { return _fCpuLoad; }
       float dspLoad() const { return _fDspLoad; }
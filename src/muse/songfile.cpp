@@ -50,6 +50,8 @@
 #include "audio.h"
 #include "mitplugin.h"
 #include "wave.h"
+#include "wave_preload.h"
+#include "plugin_preload.h"
 #include "midictrl.h"
 #include "audiodev.h"
 #include "conf.h"
@@ -593,7 +595,7 @@ void Song::read(Xml& xml, bool /*isTemplate*/)
       XmlReadStatistics stats;
 
       for (;;) {
-         if (MusEGlobal::muse->progress) {
+         if (MusEGlobal::muse && MusEGlobal::muse->progress) {
             MusEGlobal::muse->progress->setValue(MusEGlobal::muse->progress->value()+1);
          }
 
@@ -988,6 +990,84 @@ void Song::convertProjectSampleRate(int newRate)
 
 namespace MusEGui {
 
+//---------------------------------------------------------
+//   finishWavePreload
+//    Waits for the wave files of the song to be opened,
+//     and removes the ones which failed from their events.
+//---------------------------------------------------------
+
+static void finishWavePreload(MusECore::WavePreload& preload, QProgressDialog* progress)
+{
+  const QString label = progress ? progress->labelText() : QString();
+  preload.wait([progress](int done, int total) {
+    if(!progress)
+      return;
+    progress->setLabelText(QObject::tr("Opening audio files: %1 of %2").arg(done).arg(total));
+    // Only the progress dialog is painted. The other windows must not
+    //  look at the files before they are all open.
+    progress->repaint();
+    });
+  if(progress)
+    progress->setLabelText(label);
+
+  const std::deque<MusECore::WavePreload::Failure> failed = preload.failed();
+  if(failed.empty())
+    return;
+
+  std::set<const MusECore::SndFile*> failedFiles;
+  QString names;
+  for(const MusECore::WavePreload::Failure& f : failed)
+  {
+    fprintf(stderr, "open wave file(%s) for reading failed: %s\n",
+      f.file.path().toLocal8Bit().constData(), f.error.toLocal8Bit().constData());
+    failedFiles.insert(*f.file);
+    if(!names.contains(f.file.path() + "\n"))
+      names += f.file.path() + "\n";
+  }
+
+  MusECore::WaveTrackList* wtl = MusEGlobal::song->waves();
+  for(MusECore::ciWaveTrack it = wtl->begin(); it != wtl->end(); ++it)
+  {
+    MusECore::PartList* pl = (*it)->parts();
+    for(MusECore::ciPart ip = pl->begin(); ip != pl->end(); ++ip)
+    {
+      MusECore::EventList& el = ip->second->nonconst_events();
+      for(MusECore::iEvent ie = el.begin(); ie != el.end(); ++ie)
+      {
+        MusECore::Event& e = ie->second;
+        if(e.type() != MusECore::Wave || failedFiles.find(*e.sndFile()) == failedFiles.end())
+          continue;
+        MusECore::SndFileR none;
+        e.setSndFile(none);
+      }
+    }
+  }
+
+  QMessageBox::critical(nullptr, QObject::tr("MusE import error."),
+                        QObject::tr("MusE failed to open these audio files:\n%1"
+                                    "Possibly they are no sound files?\n"
+                                    "If they are, check the permissions.").arg(names),
+                        QMessageBox::Ok, QMessageBox::Ok);
+}
+
+//---------------------------------------------------------
+//   finishPluginPreload
+//    Makes the plugin instances of the song.
+//---------------------------------------------------------
+
+static void finishPluginPreload(MusECore::PluginPreload& preload, QProgressDialog* progress)
+{
+  const QString label = progress ? progress->labelText() : QString();
+  preload.instantiate([progress](int done, int total) {
+    if(!progress)
+      return;
+    progress->setLabelText(QObject::tr("Loading plugins: %1 of %2").arg(done).arg(total));
+    progress->repaint();
+    });
+  if(progress)
+    progress->setLabelText(label);
+}
+
 //---------------------------------------------------------
 //   readPart
 //---------------------------------------------------------
@@ -1219,7 +1299,17 @@ void MusE::read(MusECore::Xml& xml, bool doReadMidiPorts, bool isTemplate)
                          */
                         else if (tag == "song")
                         {
+                              {
+                              // The wave files are opened on the side, while the song is read.
+                              MusECore::WavePreload preload(MusEGlobal::config.waveLoadThreads);
+                              preload.makeCurrent();
+                              // The plugin instances are made once the song and its routes are read.
+                              MusECore::PluginPreload pluginPreload(MusEGlobal::config.pluginLoadThreads);
+                              pluginPreload.makeCurrent();
                               MusEGlobal::song->read(xml, isTemplate);
+                              finishWavePreload(preload, progress);
+                              finishPluginPreload(pluginPreload, progress);
+                              }
 
                               // Now that the song file has been fully loaded, resolve any references in the file.
                               MusEGlobal::song->resolveSongfileReferences();
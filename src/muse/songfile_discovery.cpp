@@ -22,6 +22,8 @@
 //=========================================================
 
 #include "songfile_discovery.h"
+#include "wave_preload.h"
+#include "gconfig.h"
 
 #include <QFile>
 #include <QFileInfo>
@@ -32,6 +34,10 @@ SongfileDiscoveryWaveItem::SongfileDiscoveryWaveItem(const QString& filename)
   : _filename(filename)
 {
   _valid = false;
+}
+
+void SongfileDiscoveryWaveItem::probe()
+{
   if(!_filename.isEmpty() && QFile::exists(_filename))
   {
     _sfinfo.format = 0;
@@ -81,14 +87,8 @@ void SongfileDiscovery::readWaveEvent(Xml& xml)
                                             }
                                       }
 
-                                SongfileDiscoveryWaveItem item(name);
-                                if(item._valid)
-                                {
-                                  _waveList.push_back(item);
-                                  SongSampleratesInsRes_t res =
-                                    _waveList._samplerates.insert(SongSampleratesIns_t(item._sfinfo.samplerate, 0));
-                                  ++res.first->second;
-                                }
+                                // Probed later, along with the others.
+                                _waveList.push_back(SongfileDiscoveryWaveItem(name));
                               }
                               
                               return;
@@ -203,6 +203,38 @@ void SongfileDiscovery::readSong(Xml& xml)
             }
       }
 
+//---------------------------------------------------------
+//   probeWaves
+//---------------------------------------------------------
+
+void SongfileDiscovery::probeWaves()
+      {
+      // A file used by many events is probed once.
+      std::map<QString, SongfileDiscoveryWaveItem> files;
+      for (const SongfileDiscoveryWaveItem& item : _waveList)
+            files.insert(std::make_pair(item._filename, item));
+      {
+      WavePreload probes(MusEGlobal::config.waveLoadThreads);
+      for (auto& f : files) {
+            SongfileDiscoveryWaveItem* item = &f.second;
+            probes.add([item]() { item->probe(); });
+            }
+      probes.wait();
+      }
+
+      for (SongfileDiscoveryWaveList::iterator it = _waveList.begin(); it != _waveList.end(); ) {
+            *it = files.at(it->_filename);
+            if (!it->_valid) {
+                  it = _waveList.erase(it);
+                  continue;
+                  }
+            SongSampleratesInsRes_t res =
+              _waveList._samplerates.insert(SongSampleratesIns_t(it->_sfinfo.samplerate, 0));
+            ++res.first->second;
+            ++it;
+            }
+      }
+
 //---------------------------------------------------------
 //   readSongfile
 //---------------------------------------------------------
@@ -212,6 +244,15 @@ void SongfileDiscovery::readSongfile(Xml& xml)
       // Start with resetting.
       _waveList._projectSampleRate = 0;
       _waveList._projectSampleRateValid = false;
+      _waveList.clear();
+      _waveList._samplerates.clear();
+
+      readSongfile1(xml);
+      probeWaves();
+      }
+
+void SongfileDiscovery::readSongfile1(Xml& xml)
+      {
 
       bool skipmode = true;
 
@@ -40,6 +40,8 @@ struct SongfileDiscoveryWaveItem
   SF_INFO _sfinfo;
   bool _valid;
   SongfileDiscoveryWaveItem(const QString& filename);
+  // Opens the file to see whether it is a sound file, and reads its info.
+  void probe();
 };
 
 typedef std::map<int /* samplerate */, int /* count */> SongSamplerates_t;
@@ -63,6 +65,10 @@ class SongfileDiscovery
   private:
     QString _projectPath;
 
+    // Probes the wave files found, several at once, and keeps the valid ones.
+    void probeWaves();
+    void readSongfile1(Xml& xml);
+
   public:
     SongfileDiscovery(const QString& projectPath) : _projectPath(projectPath) {}
 
@@ -56,6 +56,7 @@
 #include "xml.h"
 #include "xml_statistics.h"
 #include "plugin_scan.h"
+#include "track_freeze.h"
 
 // Undefine if and when multiple output routes are added to midi tracks.
 #define _USE_MIDI_TRACK_SINGLE_OUT_PORT_CHAN_
@@ -491,7 +492,9 @@ void* MessSynth::instantiate(const QString& instanceName)
                       museGlobalShareBA.constData(),
                       museUserBA.constData(),
                       museProjectBA.constData());
-      Mess* mess = _descr->instantiate((unsigned long long)MusEGlobal::muse->winId(),
+      // There is no parent window when rendering headless.
+      const unsigned long long parentWinId = MusEGlobal::muse ? (unsigned long long)MusEGlobal::muse->winId() : 0;
+      Mess* mess = _descr->instantiate(parentWinId,
                                        instanceName.toLatin1().constData(), &mcfg);
       
       MusEGlobal::undoSetuid();
@@ -520,6 +523,7 @@ SynthI::SynthI()
 
       _readEnable = false;
       _writeEnable = false;
+      _lastSynthLatency = 0.0f;
       }
 
 SynthI::SynthI(const SynthI& si, int flags)
@@ -534,6 +538,7 @@ SynthI::SynthI(const SynthI& si, int flags)
 
       _readEnable = false;
       _writeEnable = false;
+      _lastSynthLatency = 0.0f;
 
       Synth* s = si.synth();
       if (s) {
@@ -1547,11 +1552,19 @@ float SynthI::getWorstPluginLatencyAudio()
   if(_latencyInfo._worstPluginLatencyProcessed)
     return _latencyInfo._worstPluginLatency;
 
-  // Include the synth's own latency.
-  float worst_lat = _sif ? _sif->latency() : 0.0f;
-  // Include the effects rack latency.
-  if(_efxPipe)
-    worst_lat += _efxPipe->latency();
+  float worst_lat = 0.0f;
+  // The output of a frozen track carries the latency it was rendered with.
+  if(isFrozen())
+    worst_lat = freeze()->latency();
+  else
+  {
+    // Include the synth's own latency.
+    if(_sif)
+      worst_lat += _sif->latency();
+    // Include the effects rack latency.
+    if(_efxPipe)
+      worst_lat += _efxPipe->latency();
+  }
   
   _latencyInfo._worstPluginLatency = worst_lat;
   _latencyInfo._worstPluginLatencyProcessed = true;
@@ -4040,11 +4053,40 @@ bool SynthI::getData(unsigned pos, int ports, unsigned n, float** buffer)
       int p = midiPort();
       MidiPort* mp = (p != -1) ? &MusEGlobal::midiPorts[p] : 0;
 
-      _sif->getData(mp, pos, ports, n, buffer);
+      {
+        DspProfileScope prof(&_synthDspProbe);
+        _sif->getData(mp, pos, ports, n, buffer);
+      }
+
+      // The latency correction is only recomputed when something changes.
+      // If the synth's latency has changed, tell the audio engine to recompute it.
+      const float lat = _sif->latency();
+      if(lat != _lastSynthLatency)
+      {
+        _lastSynthLatency = lat;
+        MusEGlobal::audio->latencyChanged();
+      }
 
       return true;
       }
 
+//---------------------------------------------------------
+//   getFrozenData
+//---------------------------------------------------------
+
+void SynthI::getFrozenData(unsigned pos, int ports, unsigned n, float** buffer)
+      {
+      // The synth is deactivated. Let it consume its events the same way
+      //  as when the track is off, then play the frozen output.
+      if(_sif)
+      {
+        int p = midiPort();
+        MidiPort* mp = (p != -1) ? &MusEGlobal::midiPorts[p] : 0;
+        _sif->getData(mp, pos, ports, n, buffer);
+      }
+      AudioTrack::getFrozenData(pos, ports, n, buffer);
+      }
+
 bool MessSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsigned n, float** buffer)
 {
       const unsigned int syncFrame = MusEGlobal::audio->curSyncFrame();
@@ -4087,7 +4129,7 @@ bool MessSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsigned n,
             synti->_outUserEvents.insert(buf_ev);
         }
 
-        // Transfer the playback lock-free buffer events to the playback sorted multi-set.
+        // Transfer the playback lock-free buffer events to the playback queue.
         const unsigned int pb_buf_sz = synti->eventBuffers(MidiDevice::PlaybackBuffer)->getSize();
         for(unsigned int i = 0; i < pb_buf_sz; ++i)
         {
@@ -4103,21 +4145,20 @@ bool MessSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsigned n,
       //       Other plugin architectures combine it all into the run function, and it must be run to make any change.
       if(we)
       {
-        iMPEvent impe_pb = synti->_outPlaybackEvents.begin();
         iMPEvent impe_us = synti->_outUserEvents.begin();
         bool using_pb;
 
         while(1)
         {
-          if(impe_pb != synti->_outPlaybackEvents.end() && impe_us != synti->_outUserEvents.end())
-            using_pb = *impe_pb < *impe_us;
-          else if(impe_pb != synti->_outPlaybackEvents.end())
+          if(!synti->_outPlaybackEvents.empty() && impe_us != synti->_outUserEvents.end())
+            using_pb = synti->_outPlaybackEvents.front() < *impe_us;
+          else if(!synti->_outPlaybackEvents.empty())
             using_pb = true;
           else if(impe_us != synti->_outUserEvents.end())
             using_pb = false;
           else break;
 
-          const MidiPlayEvent& ev = using_pb ? *impe_pb : *impe_us;
+          const MidiPlayEvent& ev = using_pb ? synti->_outPlaybackEvents.front() : *impe_us;
 
           const unsigned int evTime = ev.time();
           if(evTime < syncFrame)
@@ -4163,7 +4204,7 @@ bool MessSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsigned n,
           // Done with buffer event. Remove it.
           // C++11.
           if(using_pb)
-            impe_pb = synti->_outPlaybackEvents.erase(impe_pb);
+            synti->_outPlaybackEvents.pop_front();
           else
             impe_us = synti->_outUserEvents.erase(impe_us);
         }
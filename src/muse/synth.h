@@ -35,6 +35,7 @@
 #include "stringparam.h"
 #include "plugin.h"
 #include "midi_controller.h"
+#include "mpevent_queue.h"
 
 #include <QFileInfo>
 
@@ -304,17 +305,22 @@ class SynthI : public AudioTrack, public MidiDevice,
       {
       static bool _isVisible;
       SynthIF* _sif;
+      // The synth's latency seen by the last getData(), to detect changes.
+      float _lastSynthLatency;
+      // Time spent in the synth itself each cycle.
+      DspProbe _synthDspProbe;
 
    protected:
       Synth* synthesizer;
 
-      MPEventList _outPlaybackEvents;
+      MPEventQueue _outPlaybackEvents;
       MPEventList _outUserEvents;
   
       // Holds initial controller values, parameters, sysex, custom data etc. for synths which use them.
       SynthConfiguration _initConfig;
 
       bool getData(unsigned a, int b, unsigned c, float** data);
+      void getFrozenData(unsigned pos, int channels, unsigned nframes, float** bp);
 
       // Returns the number of frames to shift forward output event scheduling times when putting events
       //  into the eventFifos.
@@ -334,6 +340,8 @@ class SynthI : public AudioTrack, public MidiDevice,
       virtual ~SynthI();
       SynthI* clone(int flags) const { return new SynthI(*this, flags); }
 
+      DspProbe* synthDspProbe() { return &_synthDspProbe; }
+
       virtual inline MidiDeviceType deviceType() const { return SYNTH_MIDI; }
       // Virtual so that inheriters (synths etc) can return whatever they want.
       virtual inline NoteOffMode noteOffMode() const { return NoteOffAll; }
@@ -341,7 +349,7 @@ class SynthI : public AudioTrack, public MidiDevice,
       SynthIF* sif() const { return _sif; }
       bool initInstance(Synth* s, const QString& instanceName);
       inline virtual float selfLatencyAudio(int channel) const
-        { return (_sif ? _sif->latency() : 0) + AudioTrack::selfLatencyAudio(channel); }
+        { return (_sif && !isFrozen() ? _sif->latency() : 0) + AudioTrack::selfLatencyAudio(channel); }
 
       virtual QString open();
       virtual void close();
@@ -230,7 +230,7 @@ bool MetronomeSynthIF::getData(MidiPort*, unsigned /*pos*/, int/*ports*/, unsign
             synti->_outUserEvents.insert(buf_ev);
         }
 
-        // Transfer the playback lock-free buffer events to the playback sorted multi-set.
+        // Transfer the playback lock-free buffer events to the playback queue.
         const unsigned int pb_buf_sz = synti->eventBuffers(MidiDevice::PlaybackBuffer)->getSize();
         for(unsigned int i = 0; i < pb_buf_sz; ++i)
         {
@@ -242,21 +242,20 @@ bool MetronomeSynthIF::getData(MidiPort*, unsigned /*pos*/, int/*ports*/, unsign
       // Don't bother if not 'running'.
       if(_curActiveState && we)
       {
-        iMPEvent impe_pb = synti->_outPlaybackEvents.begin();
         iMPEvent impe_us = synti->_outUserEvents.begin();
         bool using_pb;
 
         while(1)
         {
-          if(impe_pb != synti->_outPlaybackEvents.end() && impe_us != synti->_outUserEvents.end())
-            using_pb = *impe_pb < *impe_us;
-          else if(impe_pb != synti->_outPlaybackEvents.end())
+          if(!synti->_outPlaybackEvents.empty() && impe_us != synti->_outUserEvents.end())
+            using_pb = synti->_outPlaybackEvents.front() < *impe_us;
+          else if(!synti->_outPlaybackEvents.empty())
             using_pb = true;
           else if(impe_us != synti->_outUserEvents.end())
             using_pb = false;
           else break;
 
-          const MidiPlayEvent& ev = using_pb ? *impe_pb : *impe_us;
+          const MidiPlayEvent& ev = using_pb ? synti->_outPlaybackEvents.front() : *impe_us;
 
           const unsigned int evTime = ev.time();
           if(evTime < syncFrame)
@@ -293,7 +292,7 @@ bool MetronomeSynthIF::getData(MidiPort*, unsigned /*pos*/, int/*ports*/, unsign
           // Done with ring buffer event. Remove it from FIFO.
           // C++11.
           if(using_pb)
-            impe_pb = synti->_outPlaybackEvents.erase(impe_pb);
+            synti->_outPlaybackEvents.pop_front();
           else
             impe_us = synti->_outUserEvents.erase(impe_us);
         }
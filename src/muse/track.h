@@ -32,12 +32,16 @@
 
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 
 #include "wave.h" // for SndFileR
 #include "part.h"
 #include "mpevent.h"
 #include "key.h"
 #include "audio_fifo.h"
+#include "wave_loop_cache.h"
+#include "record_batch.h"
 #include "route.h"
 #include "ctrl.h"
 #include "globaldefs.h"
@@ -59,6 +63,8 @@ struct DrumMap;
 class WorkingDrumMapList;
 class WorkingDrumMapPatchList;
 class LatencyCompensator;
+class AnticipationBuffer;
+class TrackFreeze;
 struct XmlReadStatistics;
 struct XmlWriteStatistics;
 
@@ -650,8 +656,18 @@ class AudioTrack : public Track {
       AutomationType _automationType;
       double _gain;
 
+      // Time spent in copyData() each cycle, excluding the tracks routed into this one.
+      DspProbe _dspProbe;
+      // The rendered output of the track when it is frozen. See TrackFreeze.
+      TrackFreeze* _freeze;
+      // What reachesAudioOutput() found, and the graph generation it holds for.
+      mutable bool _reachesOutput;
+      mutable bool _reachesOutputValid;
+      mutable int _reachesOutputGeneration;
+
       void initBuffers();
       void internal_assign(const Track&, int flags);
+      bool findAudioOutput() const;
       void processTrackCtrls(unsigned pos, int trackChans, unsigned nframes, float** buffer);
 
    protected:
@@ -679,6 +695,12 @@ class AudioTrack : public Track {
       Pipeline* _efxPipe;
 
       virtual bool getData(unsigned, int, unsigned, float**);
+      // Returns true if the source and effects rack output for this cycle is
+      //  up to the anticipative renderer, in which case it has been written to
+      //  the given buffers. See AudioAnticipator.
+      virtual bool getAnticipatedData(unsigned, int, unsigned, float**) { return false; }
+      // Gets the frozen output instead of the source and effects rack output. See TrackFreeze.
+      virtual void getFrozenData(unsigned, int, unsigned, float**);
 
       SndFileR _recFile;
       // Exclusively for the recFile during bounce operations.
@@ -686,6 +708,11 @@ class AudioTrack : public Track {
       float _previousLatency;
 
       Fifo fifo;                    // fifo -> _recFile
+      // Collects the fifo's segments into large writes to _recFile.
+      RecordBatch _recBatch;
+      // Held by record() and setRecFile(), so the gui thread does not change
+      //  the record file or its batch while the record writer is writing them.
+      std::mutex _recordMutex;
       bool _processed;
       
       // Checks for old all green plugin controller colors and changes them
@@ -759,10 +786,14 @@ class AudioTrack : public Track {
       // This also performs adjustments for latency compensation before putting to the fifo.
       // Returns true on success.
       bool putFifo(int channels, unsigned long n, float** bp);
-      // Transfers the recording fifo to _recFile.
-      void record();
+      // Transfers the recording fifo to _recFile, in batches. With flush, the last
+      //  batch is written out too. Record writer thread.
+      void record(bool flush = false);
       // Returns the recording fifo current count.
       int recordFifoCount() { return fifo.getCount(); }
+      // Frames recorded but not written to _recFile yet, in the fifo or the batch.
+      unsigned recordBacklog();
+      const RecordBatch* recordBatch() const { return &_recBatch; }
 
       virtual void setMute(bool val);
       virtual void setOff(bool val);
@@ -779,11 +810,21 @@ class AudioTrack : public Track {
 
       bool prefader() const              { return _prefader; }
       double auxSend(int idx) const;
+      // Whether the send adds anything to the aux.
+      bool auxSendActive(int idx) const { return unsigned(idx) < _auxSend.size() && _auxSend[idx] > 0.0001; }
       void setAuxSend(int idx, double v);
       void addAuxSend(int n);
 
       void setPrefader(bool val);
       Pipeline* efxPipe()                { return _efxPipe;  }
+      DspProbe* dspProbe()               { return &_dspProbe; }
+      TrackFreeze* freeze() const        { return _freeze; }
+      // Installs the freeze, or removes it if null. The caller owns the old one.
+      // Called from audio thread only. See UndoOp::SetTrackFreeze.
+      void setFreeze(TrackFreeze* f);
+      // Whether the track plays its frozen output. A stale freeze, or one on a
+      //  track being recorded or monitored, is ignored.
+      bool isFrozen() const;
       void deleteAllEfxGuis();
       void clearEfxList();
       // Removes any existing plugin and inserts plugin into effects rack, and calls setupPlugin.
@@ -865,6 +906,9 @@ class AudioTrack : public Track {
       void seekPrevACEvent(int);
       void seekNextACEvent(int);
       AuxSendValueList *getAuxSendValueList() { return &_auxSend; }
+      // Whether the track's audio can reach an audio output, through its
+      //  routes and aux sends. Gui thread only.
+      bool reachesAudioOutput() const;
 
       // Drives things like plugin/synth GUIs.
       virtual void guiHeartBeat();
@@ -1021,12 +1065,51 @@ class AudioAux : public AudioTrack {
     };
 
 
+//---------------------------------------------------------
+//   PrefetchStats
+//    How well the disk prefetch keeps up with a wave track.
+//    Fill levels are in prefetch fifo blocks. Written by the
+//    prefetch threads and the audio thread, read by the gui.
+//---------------------------------------------------------
+
+struct PrefetchStats {
+      // Filled blocks when the last prefetch pass began.
+      std::atomic<int> fill;
+      // The lowest of those since the last reset. -1 if none yet.
+      std::atomic<int> minFill;
+      // Number of times the audio thread found the fifo empty.
+      std::atomic<unsigned> underruns;
+      // Blocks read, and the time spent reading them in microseconds.
+      std::atomic<unsigned long> blocksRead;
+      std::atomic<unsigned long> readUs;
+
+      // Not cleared by reset():
+      // The fifo depth in blocks to use from the next seek on. Zero means MusEGlobal::fifoLength.
+      std::atomic<int> targetDepth;
+      // Number of times the depth was raised.
+      std::atomic<unsigned> depthRaises;
+      // Prefetch thread only. The underruns already acted upon.
+      unsigned seenUnderruns;
+
+      PrefetchStats() : targetDepth(0), depthRaises(0), seenUnderruns(0) { reset(); }
+      void reset() {
+            fill.store(0, std::memory_order_relaxed);
+            minFill.store(-1, std::memory_order_relaxed);
+            underruns.store(0, std::memory_order_relaxed);
+            blocksRead.store(0, std::memory_order_relaxed);
+            readUs.store(0, std::memory_order_relaxed);
+            }
+      };
+
 //---------------------------------------------------------
 //   WaveTrack
 //---------------------------------------------------------
 
 class WaveTrack : public AudioTrack {
       Fifo _prefetchFifo;  // prefetch Fifo
+      PrefetchStats _prefetchStats;
+      // Loop region cache. For prefetch thread use only, apart from the statistics.
+      WaveLoopCache _loopCache;
       // Each wavetrack has a separate prefetch position stamp
       //  so that consumers can retard or advance the stream and
       //  the prefetch can pump as much buffers as required while
@@ -1034,6 +1117,14 @@ class WaveTrack : public AudioTrack {
       unsigned _prefetchWritePos;
       static bool _isVisible;
 
+      // Anticipative rendering, see AudioAnticipator.
+      // The session the track is claimed for, zero if none. Set by the audio thread.
+      std::atomic<unsigned> _anticipationEpoch;
+      // Whether a renderer worker is processing the track right now.
+      std::atomic<bool> _anticipationBusy;
+      // Allocated by the renderer when first needed.
+      std::atomic<AnticipationBuffer*> _anticipationBuffer;
+
       void internal_assign(const Track&, int flags);
       // Writes data from connected input routes to the track's latency compensator.
       // It uses buffer for temporary storage.
@@ -1048,6 +1139,7 @@ class WaveTrack : public AudioTrack {
 
       WaveTrack();
       WaveTrack(const WaveTrack& wt, int flags);
+      virtual ~WaveTrack();
 
       // FIXME This public assign() method doesn't really 'assign' routes -
       //        if routes are assigned in flags, it does not clear existing routes !
@@ -1066,10 +1158,24 @@ class WaveTrack : public AudioTrack {
       // Called from prefetch thread:
       // If overwrite is true, copies the data. If false, adds the data.
       virtual void fetchData(unsigned pos, unsigned frames, float** bp, bool doSeek, bool overwrite, int latency_correction = 0);
+      // Like fetchData(), but leaves the prefetch fifo alone. For prefetch threads only.
+      void readData(unsigned pos, unsigned frames, float** bp, bool doSeek, bool overwrite, int latency_correction = 0);
       
       virtual void seekData(sf_count_t pos);
       
       virtual bool getData(unsigned, int ch, unsigned, float** bp);
+      virtual bool getAnticipatedData(unsigned pos, int channels, unsigned nframes, float** bp);
+      virtual void getFrozenData(unsigned pos, int channels, unsigned nframes, float** bp);
+
+      // For anticipative renderer use only.
+      // Runs the track's source and effects rack, like getData() and copyData() would.
+      void renderAnticipated(unsigned pos, int channels, unsigned nframes, float** bp);
+      unsigned anticipationEpoch() const { return _anticipationEpoch.load(); }
+      void setAnticipationEpoch(unsigned e) { _anticipationEpoch.store(e); }
+      void setAnticipationBusy(bool v) { _anticipationBusy.store(v); }
+      AnticipationBuffer* anticipationBuffer() const { return _anticipationBuffer.load(std::memory_order_acquire); }
+      void setAnticipationBuffer(AnticipationBuffer* b) { _anticipationBuffer.store(b, std::memory_order_release); }
+      AnticipationBuffer* takeAnticipationBuffer() { return _anticipationBuffer.exchange(nullptr); }
 
       // Depending on the Monitor setting, Wave Tracks can have available correction.
       // If unmonitored, they will never dominate parallel branches.
@@ -1078,6 +1184,8 @@ class WaveTrack : public AudioTrack {
       
       void clearPrefetchFifo();
       Fifo* prefetchFifo()          { return &_prefetchFifo; }
+      PrefetchStats* prefetchStats() { return &_prefetchStats; }
+      WaveLoopCache* loopCache()     { return &_loopCache; }
       virtual void prefetchAudio(sf_count_t writePos, sf_count_t frames);
 
       // For prefetch thread use only.
@@ -0,0 +1,619 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  track_freeze.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QCryptographicHash>
+
+#include <sndfile.h>
+
+#include "track_freeze.h"
+#include "audio.h"
+#include "globals.h"
+#include "gconfig.h"
+#include "song.h"
+#include "track.h"
+#include "synth.h"
+#include "plugin.h"
+#include "midiport.h"
+#include "tempo.h"
+#include "part.h"
+#include "event.h"
+#include "ctrl.h"
+#include "xml.h"
+#include "al/dsp.h"
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   TrackFreeze
+//---------------------------------------------------------
+
+TrackFreeze::TrackFreeze(AudioTrack* track, int channels)
+  : _track(track), _channels(channels), _startFrame(0), _frames(0),
+    _endFrame(0), _renderedEnd(0), _renderFailed(false), _latency(0.0f),
+    _stale(false), _saved(false), _ioBuffer(nullptr), _ioFrames(0),
+    _prefetchWritePos(~0U), _prefetchReset(true)
+{
+}
+
+TrackFreeze::~TrackFreeze()
+{
+  if(!_file.isNull() && _file->isOpen())
+    _file->close();
+  if(_ioBuffer)
+    free(_ioBuffer);
+}
+
+//---------------------------------------------------------
+//   allocIoBuffer
+//---------------------------------------------------------
+
+bool TrackFreeze::allocIoBuffer()
+{
+  _ioFrames = MusEGlobal::segmentSize;
+  if(posix_memalign((void**)&_ioBuffer, 16, sizeof(float) * _ioFrames * _channels) != 0)
+  {
+    fprintf(stderr, "ERROR: TrackFreeze: posix_memalign failed\n");
+    _ioBuffer = nullptr;
+    return false;
+  }
+  return true;
+}
+
+//---------------------------------------------------------
+//   path
+//---------------------------------------------------------
+
+QString TrackFreeze::path() const
+{
+  return _file.isNull() ? QString() : _file->path();
+}
+
+//---------------------------------------------------------
+//   freezableTrack
+//---------------------------------------------------------
+
+AudioTrack* TrackFreeze::freezableTrack(Track* track)
+{
+  if(!track)
+    return nullptr;
+  switch(track->type())
+  {
+    case Track::WAVE:
+    case Track::AUDIO_SOFTSYNTH:
+      return static_cast<AudioTrack*>(track);
+
+    case Track::MIDI:
+    case Track::DRUM:
+    {
+      // Freezing a midi track freezes the synth it plays.
+      const int port = static_cast<MidiTrack*>(track)->outPort();
+      if(port < 0 || port >= MusECore::MIDI_PORTS)
+        return nullptr;
+      MidiDevice* md = MusEGlobal::midiPorts[port].device();
+      if(!md || !md->isSynti())
+        return nullptr;
+      return static_cast<SynthI*>(md);
+    }
+
+    default:
+      break;
+  }
+  return nullptr;
+}
+
+//---------------------------------------------------------
+//   computeStamp
+//---------------------------------------------------------
+
+QByteArray TrackFreeze::computeStamp(AudioTrack* track)
+{
+  QByteArray data;
+  QDataStream ds(&data, QIODevice::WriteOnly);
+
+  ds << qint32(track->totalProcessBuffers()) << qint32(MusEGlobal::sampleRate);
+
+  // Automation, except for the fader which comes after the rendered output.
+  const CtrlListList* cll = track->controller();
+  for(ciCtrlList icl = cll->cbegin(); icl != cll->cend(); ++icl)
+  {
+    const CtrlList* cl = icl->second;
+    const int id = cl->id();
+    if(id == AC_VOLUME || id == AC_PAN || id == AC_MUTE)
+      continue;
+    ds << qint32(id) << cl->curVal();
+    for(ciCtrl ic = cl->cbegin(); ic != cl->cend(); ++ic)
+      ds << quint32(ic->first) << ic->second.value();
+  }
+
+  // The rack. The plugin control values are in the controllers above.
+  const Pipeline* pl = track->efxPipe();
+  for(ciPluginI ip = pl->cbegin(); ip != pl->cend(); ++ip)
+  {
+    const PluginI* p = *ip;
+    if(!p)
+    {
+      ds << QString();
+      continue;
+    }
+    ds << p->uri() << p->lib() << p->pluginLabel() << p->on();
+  }
+
+  // The synth. Its control values are in the controllers above, too.
+  // Opaque state like LV2 state or VST chunks is not checked, it would cost
+  //  too much to fetch every time, and some plugins never save it the same way twice.
+  if(track->type() == Track::AUDIO_SOFTSYNTH)
+  {
+    const SynthI* si = static_cast<const SynthI*>(track);
+    if(si->sif())
+      ds << si->sif()->uri() << si->sif()->lib() << si->sif()->pluginLabel();
+  }
+
+  if(track->type() == Track::WAVE)
+  {
+    const PartList* pl = track->cparts();
+    for(ciPart ip = pl->cbegin(); ip != pl->cend(); ++ip)
+    {
+      const Part* p = ip->second;
+      ds << quint32(p->frame()) << quint32(p->lenFrame()) << p->mute();
+      for(ciEvent ie = p->events().cbegin(); ie != p->events().cend(); ++ie)
+      {
+        const Event& e = ie->second;
+        ds << quint32(e.frame()) << quint32(e.lenFrame()) << qint32(e.spos());
+        const SndFileR sf = e.sndFile();
+        if(!sf.isNull())
+        {
+          // Catch destructive edits of the file, too.
+          const QFileInfo fi(sf->path());
+          ds << fi.absoluteFilePath() << fi.lastModified().toMSecsSinceEpoch();
+        }
+      }
+    }
+  }
+  else if(track->type() == Track::AUDIO_SOFTSYNTH)
+  {
+    // The midi tracks playing the synth.
+    const int port = static_cast<SynthI*>(track)->midiPort();
+    const MidiTrackList* ml = MusEGlobal::song->midis();
+    for(ciMidiTrack it = ml->cbegin(); port >= 0 && it != ml->cend(); ++it)
+    {
+      const MidiTrack* mt = *it;
+      if(mt->outPort() != port)
+        continue;
+      ds << qint32(mt->outChannel()) << mt->off() << mt->isMute()
+         << qint32(mt->transposition) << qint32(mt->velocity) << qint32(mt->delay)
+         << qint32(mt->len) << qint32(mt->compression);
+      const PartList* pl = mt->cparts();
+      for(ciPart ip = pl->cbegin(); ip != pl->cend(); ++ip)
+      {
+        const Part* p = ip->second;
+        ds << quint32(p->tick()) << quint32(p->lenTick()) << p->mute();
+        for(ciEvent ie = p->events().cbegin(); ie != p->events().cend(); ++ie)
+        {
+          const Event& e = ie->second;
+          // In frames, so that tempo changes count.
+          ds << quint32(MusEGlobal::tempomap.tick2frame(p->tick() + e.tick()))
+             << qint32(e.type()) << qint32(e.dataA()) << qint32(e.dataB()) << qint32(e.dataC());
+          if(e.dataLen() > 0)
+            ds << QByteArray((const char*)e.data(), e.dataLen());
+        }
+      }
+    }
+  }
+
+  return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+//---------------------------------------------------------
+//   createRender
+//---------------------------------------------------------
+
+TrackFreeze* TrackFreeze::createRender(AudioTrack* track, unsigned startFrame, unsigned endFrame)
+{
+  const QString dirName = MusEGlobal::museProject + QString("/freeze");
+  if(!QDir().mkpath(dirName))
+  {
+    fprintf(stderr, "ERROR: TrackFreeze: Cannot create directory %s\n", dirName.toLocal8Bit().constData());
+    return nullptr;
+  }
+
+  const QString fbase = dirName + QString("/%1").arg(track->name().simplified().replace(" ","_"));
+  QString fileName;
+  for(int n = 1; ; ++n)
+  {
+    fileName = fbase + QString("_%1.wav").arg(n);
+    if(!QFile::exists(fileName))
+      break;
+  }
+
+  TrackFreeze* fr = new TrackFreeze(track, track->totalProcessBuffers());
+  fr->_startFrame = startFrame;
+  fr->_endFrame = endFrame;
+  fr->_renderedEnd = startFrame;
+  fr->_stamp = computeStamp(track);
+
+  // No converters. The file is always at the current sample rate.
+  fr->_file = new SndFile(fileName, false);
+  fr->_file->setFormat(SF_FORMAT_WAV | SF_FORMAT_FLOAT, fr->_channels, MusEGlobal::sampleRate);
+  if(!fr->allocIoBuffer() || fr->_file->openWrite())
+  {
+    fprintf(stderr, "ERROR: TrackFreeze: Cannot create file %s\n", fileName.toLocal8Bit().constData());
+    delete fr;
+    return nullptr;
+  }
+  return fr;
+}
+
+//---------------------------------------------------------
+//   capture
+//    Rendering runs in freewheel mode, where the audio thread
+//    is not realtime, so the data is written straight to the file.
+//---------------------------------------------------------
+
+void TrackFreeze::capture(unsigned pos, int channels, unsigned nframes, float** bp)
+{
+  if(_renderFailed || !MusEGlobal::audio->isPlaying() || !MusEGlobal::audio->bounce())
+    return;
+  if(pos < _startFrame || pos >= _endFrame)
+    return;
+  if(nframes > _endFrame - pos)
+    nframes = _endFrame - pos;
+
+  // Fill any gap, for example while the track was off.
+  if(pos != _renderedEnd)
+    _file->seek(pos - _startFrame, SEEK_SET);
+
+  const int chans = channels < _channels ? channels : _channels;
+  unsigned done = 0;
+  while(done < nframes)
+  {
+    const unsigned n = (nframes - done) < _ioFrames ? (nframes - done) : _ioFrames;
+    float* dst = _ioBuffer;
+    for(unsigned i = 0; i < n; ++i)
+    {
+      int ch = 0;
+      for( ; ch < chans; ++ch)
+        *dst++ = bp[ch][done + i];
+      for( ; ch < _channels; ++ch)
+        *dst++ = 0.0f;
+    }
+    if(_file->writeDirect(_ioBuffer, n) != n)
+    {
+      fprintf(stderr, "ERROR: TrackFreeze::capture: Write failed: %s\n", _file->strerror().toLocal8Bit().constData());
+      _renderFailed = true;
+      return;
+    }
+    done += n;
+  }
+  _renderedEnd = pos + nframes;
+}
+
+//---------------------------------------------------------
+//   finishRender
+//---------------------------------------------------------
+
+bool TrackFreeze::finishRender()
+{
+  _file->close();
+  if(_renderFailed || _renderedEnd < _endFrame)
+    return false;
+
+  _frames = _endFrame - _startFrame;
+  // The latency the rendered output carries. See AudioTrack::getWorstPluginLatencyAudio().
+  _latency = _track->efxPipe() ? _track->efxPipe()->latency() : 0.0f;
+  if(_track->type() == Track::AUDIO_SOFTSYNTH)
+  {
+    const SynthI* si = static_cast<const SynthI*>(_track);
+    if(si->sif())
+      _latency += si->sif()->latency();
+  }
+
+  if(_file->openRead(false))
+  {
+    fprintf(stderr, "ERROR: TrackFreeze: Cannot open rendered file %s\n", path().toLocal8Bit().constData());
+    return false;
+  }
+  return true;
+}
+
+//---------------------------------------------------------
+//   discard
+//---------------------------------------------------------
+
+void TrackFreeze::discard()
+{
+  if(_file.isNull())
+    return;
+  if(_saved)
+    _file->close();
+  else
+    _file->remove();
+}
+
+//---------------------------------------------------------
+//   write
+//---------------------------------------------------------
+
+void TrackFreeze::write(int level, Xml& xml) const
+{
+  // Store the file relative to the project if it is in there.
+  QString fileName = path();
+  const QString projectDir = MusEGlobal::museProject + QString("/");
+  if(fileName.startsWith(projectDir))
+    fileName.remove(0, projectDir.length());
+
+  xml.tag(level, "freeze file=\"%s\" start=\"%u\" frames=\"%u\" latency=\"%f\" stamp=\"%s\"/",
+    Xml::xmlString(fileName).toUtf8().constData(), _startFrame, _frames,
+    _latency, _stamp.toHex().constData());
+  _saved = true;
+}
+
+//---------------------------------------------------------
+//   readFromXml
+//---------------------------------------------------------
+
+TrackFreeze* TrackFreeze::readFromXml(Xml& xml, AudioTrack* track)
+{
+  QString fileName;
+  unsigned startFrame = 0;
+  unsigned frames = 0;
+  float latency = 0.0f;
+  QByteArray stamp;
+
+  for (;;) {
+        Xml::Token token = xml.parse();
+        const QString& tag = xml.s1();
+        switch (token) {
+              case Xml::Error:
+              case Xml::End:
+                    return nullptr;
+              case Xml::TagStart:
+                    xml.unknown("freeze");
+                    break;
+              case Xml::Attribut:
+                    if (tag == "file")
+                          fileName = xml.s2();
+                    else if (tag == "start")
+                          startFrame = xml.s2().toUInt();
+                    else if (tag == "frames")
+                          frames = xml.s2().toUInt();
+                    else if (tag == "latency")
+                          latency = xml.s2().toFloat();
+                    else if (tag == "stamp")
+                          stamp = QByteArray::fromHex(xml.s2().toLatin1());
+                    break;
+              case Xml::TagEnd:
+                    if (tag == "freeze")
+                          goto out_of_readFromXml_forloop;
+              default:
+                    break;
+              }
+        }
+out_of_readFromXml_forloop:
+
+  if(fileName.isEmpty())
+    return nullptr;
+  if(QFileInfo(fileName).isRelative())
+    fileName = MusEGlobal::museProject + QString("/") + fileName;
+
+  SndFile* sf = new SndFile(fileName, false);
+  if(sf->openRead(false))
+  {
+    fprintf(stderr, "TrackFreeze: Cannot open %s. Track %s is not frozen.\n",
+            fileName.toLocal8Bit().constData(), track->name().toLocal8Bit().constData());
+    delete sf;
+    return nullptr;
+  }
+  if(sf->samplerate() != MusEGlobal::sampleRate)
+  {
+    fprintf(stderr, "TrackFreeze: %s was rendered at another sample rate. Track %s is not frozen.\n",
+            fileName.toLocal8Bit().constData(), track->name().toLocal8Bit().constData());
+    delete sf;
+    return nullptr;
+  }
+
+  TrackFreeze* fr = new TrackFreeze(track, sf->channels());
+  fr->_file = sf;
+  fr->_startFrame = startFrame;
+  fr->_endFrame = startFrame + frames;
+  fr->_renderedEnd = fr->_endFrame;
+  fr->_frames = frames;
+  fr->_latency = latency;
+  fr->_stamp = stamp;
+  fr->_saved = true;
+  // Not valid until Song::checkFrozenTracks() has compared the stamp.
+  fr->_stale = true;
+  if(!fr->allocIoBuffer())
+  {
+    delete fr;
+    return nullptr;
+  }
+  return fr;
+}
+
+//---------------------------------------------------------
+//   readFile
+//---------------------------------------------------------
+
+void TrackFreeze::readFile(unsigned pos, int channels, unsigned nframes, float** bp)
+{
+  unsigned done = 0;
+
+  // Before the start of the file?
+  if(pos < _startFrame)
+  {
+    done = _startFrame - pos;
+    if(done > nframes)
+      done = nframes;
+    for(int ch = 0; ch < channels; ++ch)
+      AL::dsp->clear(bp[ch], done, MusEGlobal::config.useDenormalBias);
+  }
+
+  const unsigned fileEnd = _startFrame + _frames;
+  if(done < nframes && pos + done < fileEnd)
+    _file->seek(pos + done - _startFrame, SEEK_SET);
+
+  const int chans = channels < _channels ? channels : _channels;
+  while(done < nframes && pos + done < fileEnd)
+  {
+    unsigned n = nframes - done;
+    if(n > _ioFrames)
+      n = _ioFrames;
+    if(n > fileEnd - (pos + done))
+      n = fileEnd - (pos + done);
+    const unsigned rn = _file->readDirect(_ioBuffer, n);
+    if(rn == 0)
+      break;
+    const float* src = _ioBuffer;
+    for(unsigned i = 0; i < rn; ++i)
+    {
+      for(int ch = 0; ch < chans; ++ch)
+        bp[ch][done + i] = src[ch];
+      src += _channels;
+    }
+    for(int ch = chans; ch < channels; ++ch)
+      AL::dsp->clear(bp[ch] + done, rn, MusEGlobal::config.useDenormalBias);
+    done += rn;
+  }
+
+  // Past the end of the file.
+  if(done < nframes)
+  {
+    for(int ch = 0; ch < channels; ++ch)
+      AL::dsp->clear(bp[ch] + done, nframes - done, MusEGlobal::config.useDenormalBias);
+  }
+}
+
+//---------------------------------------------------------
+//   getData
+//---------------------------------------------------------
+
+void TrackFreeze::getData(unsigned pos, int channels, unsigned nframes, float** bp)
+{
+  // When freewheeling, read the file directly. Prefetch is not used.
+  if(MusEGlobal::audio->freewheel())
+  {
+    readFile(pos, channels, nframes, bp);
+    return;
+  }
+
+  // The prefetch thread owns the fifo while it starts over.
+  if(MusEGlobal::audio->isPlaying() && !_prefetchReset.load(std::memory_order_acquire))
+  {
+    float* pf_buf[_channels];
+    MuseCount_t fpos = 0;
+    // Discard anything left behind.
+    while(!_prefetchFifo.isEmpty())
+    {
+      if(_prefetchFifo.peek(_channels, MusEGlobal::segmentSize, pf_buf, &fpos))
+        break;
+      if(fpos >= MuseCount_t(pos))
+        break;
+      _prefetchFifo.remove();
+    }
+
+    if(!_prefetchFifo.isEmpty() && fpos == MuseCount_t(pos) && nframes <= MusEGlobal::segmentSize)
+    {
+      const int chans = channels < _channels ? channels : _channels;
+      for(int ch = 0; ch < chans; ++ch)
+        AL::dsp->cpy(bp[ch], pf_buf[ch], nframes);
+      for(int ch = chans; ch < channels; ++ch)
+        AL::dsp->clear(bp[ch], nframes, MusEGlobal::config.useDenormalBias);
+      _prefetchFifo.remove();
+      return;
+    }
+
+    // The prefetched data is not for this position, for example if the
+    //  track was not frozen for a while. Have the prefetch thread start over.
+    _prefetchReset.store(true, std::memory_order_release);
+  }
+
+  for(int ch = 0; ch < channels; ++ch)
+    AL::dsp->clear(bp[ch], nframes, MusEGlobal::config.useDenormalBias);
+}
+
+//---------------------------------------------------------
+//   seek
+//---------------------------------------------------------
+
+void TrackFreeze::seek(unsigned pos)
+{
+  _prefetchFifo.clear();
+  _prefetchWritePos = pos;
+  prefetch(false, 0, 0);
+}
+
+//---------------------------------------------------------
+//   prefetch
+//---------------------------------------------------------
+
+void TrackFreeze::prefetch(bool doLoops, unsigned lposFrame, unsigned rposFrame)
+{
+  // Start over at the transport position?
+  const bool reset = _prefetchReset.load(std::memory_order_acquire);
+  if(reset)
+  {
+    _prefetchFifo.clear();
+    _prefetchWritePos = MusEGlobal::audio->pos().frame();
+  }
+
+  const int empty_count = _prefetchFifo.getEmptyCount();
+  float* bp[_channels];
+  for(int i = 0; i < empty_count; ++i)
+  {
+    if(doLoops)
+    {
+      // Wrap around the same way as wave tracks. See AudioPrefetch::prefetch().
+      unsigned n = rposFrame - _prefetchWritePos;
+      if(n < MusEGlobal::segmentSize)
+      {
+        if(n > lposFrame)
+          n = 0;
+        _prefetchWritePos = lposFrame - n;
+      }
+    }
+
+    if(_prefetchFifo.getWriteBuffer(_channels, MusEGlobal::segmentSize, bp, _prefetchWritePos))
+    {
+      fprintf(stderr, "TrackFreeze::prefetch: No write buffer!\n");
+      break;
+    }
+    readFile(_prefetchWritePos, _channels, MusEGlobal::segmentSize, bp);
+    _prefetchFifo.add();
+    _prefetchWritePos += MusEGlobal::segmentSize;
+  }
+
+  // Hand the fifo back to the audio thread.
+  if(reset)
+    _prefetchReset.store(false, std::memory_order_release);
+}
+
+} // namespace MusECore
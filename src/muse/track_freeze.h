@@ -0,0 +1,156 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  track_freeze.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __TRACK_FREEZE_H__
+#define __TRACK_FREEZE_H__
+
+#include <atomic>
+
+#include <QString>
+#include <QByteArray>
+
+#include "wave.h" // for SndFileR
+#include "audio_fifo.h"
+
+namespace MusECore {
+
+class Track;
+class AudioTrack;
+class Xml;
+
+//---------------------------------------------------------
+//   TrackFreeze
+//
+//   The rendered output of a frozen track.
+//
+//   Freezing renders the track's source and effects rack
+//    output (post-rack, pre-fader) into a wave file, using the
+//    bounce machinery: The song is played in freewheel mode
+//    and AudioTrack::copyData() hands the data to capture().
+//    See MusE::freezeTrack() and Song::finishFreezeRender().
+//
+//   A frozen track then plays the file instead of running its
+//    source and plugins, which are deactivated. Volume, pan,
+//    mute, metering and aux sends stay live. Outside of
+//    freewheel mode the file is read ahead by the prefetch
+//    thread, like wave track data.
+//
+//   The freeze is installed on the track with the undoable
+//    UndoOp::SetTrackFreeze, which also owns the freeze that
+//    is not installed.
+//
+//   A stamp of everything the rendered output depends on
+//    (parts and events, automation except the fader, the
+//    plugins and their controls) is taken when rendering begins.
+//    Song::checkFrozenTracks() compares it with the current
+//    stamp: A frozen track whose inputs have changed is stale,
+//    and processes live until it is frozen again, or until the
+//    change is undone.
+//---------------------------------------------------------
+
+class TrackFreeze {
+      AudioTrack* _track;
+      SndFileR _file;
+      int _channels;
+      // Song frame of the first frame in the file.
+      unsigned _startFrame;
+      // Number of frames in the file.
+      unsigned _frames;
+      // While rendering: Where rendering ends, and how far it has got.
+      unsigned _endFrame;
+      unsigned _renderedEnd;
+      bool _renderFailed;
+      // The track's plugin latency when it was rendered. Reported by the frozen
+      //  track in place of the latency of its (deactivated) plugins.
+      float _latency;
+      QByteArray _stamp;
+      std::atomic<bool> _stale;
+      // Whether a saved song refers to the file. Such a file is
+      //  kept when the freeze is discarded.
+      mutable bool _saved;
+
+      // Interleaved buffer for file io.
+      float* _ioBuffer;
+      unsigned _ioFrames;
+
+      // Playback, filled by the prefetch thread.
+      Fifo _prefetchFifo;
+      unsigned _prefetchWritePos;
+      // Set when the freeze is installed, or when the audio thread finds
+      //  the prefetched data out of step. Tells the prefetch thread to
+      //  start over at the current transport position. Until it has,
+      //  the audio thread keeps off the fifo.
+      std::atomic<bool> _prefetchReset;
+
+      TrackFreeze(AudioTrack* track, int channels);
+      bool allocIoBuffer();
+      // Reads frames beginning at song frame pos. Zeros outside of the file.
+      void readFile(unsigned pos, int channels, unsigned nframes, float** bp);
+
+   public:
+      ~TrackFreeze();
+      TrackFreeze(const TrackFreeze&) = delete;
+      TrackFreeze& operator=(const TrackFreeze&) = delete;
+
+      // Returns the track a freeze of the given track applies to: Wave and synth tracks
+      //  themselves, or the synth a midi track plays. Null if it cannot be frozen.
+      static AudioTrack* freezableTrack(Track* track);
+      // Stamp of everything the track's effects rack output depends on. Gui thread only.
+      static QByteArray computeStamp(AudioTrack* track);
+
+      // Creates the file for rendering the track from startFrame to endFrame.
+      // Returns null on error. Gui thread only.
+      static TrackFreeze* createRender(AudioTrack* track, unsigned startFrame, unsigned endFrame);
+      // Audio thread only, while rendering.
+      void capture(unsigned pos, int channels, unsigned nframes, float** bp);
+      // Closes the rendered file and opens it for playback. Returns false if
+      //  rendering did not complete. Gui thread only, after the transport stopped.
+      bool finishRender();
+      // Closes the file, and removes it unless a saved song refers to it.
+      void discard();
+
+      void write(int level, Xml& xml) const;
+      // Returns null if the file cannot be opened.
+      static TrackFreeze* readFromXml(Xml& xml, AudioTrack* track);
+
+      AudioTrack* track() const       { return _track; }
+      int channels() const            { return _channels; }
+      float latency() const           { return _latency; }
+      const QByteArray& stamp() const { return _stamp; }
+      bool isStale() const            { return _stale.load(std::memory_order_relaxed); }
+      void setStale(bool v)           { _stale.store(v, std::memory_order_relaxed); }
+      QString path() const;
+
+      // Audio thread. Called when the freeze is installed on its track.
+      void installed()                { _prefetchReset.store(true, std::memory_order_release); }
+      // Audio thread. Gets the frozen data for the cycle at pos.
+      void getData(unsigned pos, int channels, unsigned nframes, float** bp);
+
+      // Prefetch thread only.
+      void seek(unsigned pos);
+      void prefetch(bool doLoops, unsigned lposFrame, unsigned rposFrame);
+      };
+
+} // namespace MusECore
+
+#endif
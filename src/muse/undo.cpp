@@ -43,6 +43,7 @@
 // Forwards from header:
 #include "track.h"
 #include "part.h"
+#include "track_freeze.h"
 
 // Enable for debugging:
 //#define _UNDO_DEBUG_
@@ -343,6 +344,7 @@ const char* UndoOp::typeName()
             "ModifyTrackName", "ModifyTrackChannel",
             "SetTrackRecord", "SetTrackMute", "SetTrackSolo", "SetTrackRecMonitor", "SetTrackOff",
             "MoveTrack",
+            "SetTrackFreeze",
             "ModifyClip", "AddMarker", "DeleteMarker", "ModifyMarker", "SetMarkerPos",
             "ModifySongLen", "SetInstrument", "DoNothing",
             "ModifyMidiDivision",
@@ -543,6 +545,29 @@ void deleteUndoOp(UndoOp& op, bool doUndos = true, bool doRedos = true)
           }
           break;
 
+    case UndoOp::SetTrackFreeze:
+          // An UNDO operation was executed, so the old freeze is not installed.
+          // A REDO operation was reverted, so the new freeze is not installed.
+          if(doUndos)
+          {
+            if(op._oldFreeze)
+            {
+              op._oldFreeze->discard();
+              delete op._oldFreeze;
+              op._oldFreeze = nullptr;
+            }
+          }
+          else if(doRedos)
+          {
+            if(op._newFreeze)
+            {
+              op._newFreeze->discard();
+              delete op._newFreeze;
+              op._newFreeze = nullptr;
+            }
+          }
+          break;
+
     default:
           break;
   }
@@ -2145,6 +2170,9 @@ void Song::revertOperationGroup2(Undo& /*operations*/)
       {
         pendingOperations.executeRTStage();
 
+        // Any operation may change what the wave tracks play in the loop.
+        WaveLoopCache::invalidateAll();
+
         // Special for tempo: Need to normalize the tempo list, and resync audio. 
         // To save time this is done here, not item by item.
         // Normalize is not needed for SC_MASTER.
@@ -2187,6 +2215,9 @@ void Song::revertOperationGroup2(Undo& /*operations*/)
 void Song::executeOperationGroup2(Undo& /*operations*/)
       {
         pendingOperations.executeRTStage();
+
+        // Any operation may change what the wave tracks play in the loop.
+        WaveLoopCache::invalidateAll();
         
         // Special for tempo if altered: Need to normalize the tempo list, and resync audio. 
         // To save time this is done here, not item by item.
@@ -2598,6 +2629,19 @@ UndoOp::UndoOp(UndoOp::UndoType type_, const Track* track_, const QString& old_n
   _newName = new QString(new_name);
 }
 
+UndoOp::UndoOp(UndoOp::UndoType type_, const Track* track_, TrackFreeze* oldFreeze, TrackFreeze* newFreeze, bool noUndo)
+{
+  assert(type_==SetTrackFreeze);
+  assert(track_);
+  assert(oldFreeze != newFreeze);
+
+  type = type_;
+  track = track_;
+  _noUndo = noUndo;
+  _oldFreeze = oldFreeze;
+  _newFreeze = newFreeze;
+}
+
 UndoOp::UndoOp(UndoType type_, int ctrlID, unsigned int frame, const CtrlVal& cv, const Track* track_, bool noUndo)
 {
   assert(type_== AddAudioCtrlValStruct);
@@ -3002,6 +3046,12 @@ void Song::revertOperationGroup1(Undo& operations)
                         pendingOperations.add(PendingOperationItem(&_tracks, i->b, i->a, PendingOperationItem::MoveTrack));
                         updateFlags |= SC_TRACK_MOVED;
                         break;
+
+                  case UndoOp::SetTrackFreeze:
+                        pendingOperations.add(PendingOperationItem(static_cast<AudioTrack*>(editable_track), i->_oldFreeze,
+                                                                   PendingOperationItem::SetTrackFreeze));
+                        updateFlags |= SC_TRACK_MODIFIED;
+                        break;
                         
                   case UndoOp::ModifyPartName:
                         pendingOperations.add(PendingOperationItem(editable_part, i->_oldName, PendingOperationItem::ModifyPartName));
@@ -4221,6 +4271,12 @@ void Song::executeOperationGroup1(Undo& operations)
                         pendingOperations.add(PendingOperationItem(&_tracks, i->a, i->b, PendingOperationItem::MoveTrack));
                         updateFlags |= SC_TRACK_MOVED;
                         break;
+
+                  case UndoOp::SetTrackFreeze:
+                        pendingOperations.add(PendingOperationItem(static_cast<AudioTrack*>(editable_track), i->_newFreeze,
+                                                                   PendingOperationItem::SetTrackFreeze));
+                        updateFlags |= SC_TRACK_MODIFIED;
+                        break;
                         
                   case UndoOp::ModifyPartName:
                         pendingOperations.add(PendingOperationItem(editable_part, i->_newName, PendingOperationItem::ModifyPartName));
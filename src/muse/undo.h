@@ -43,6 +43,7 @@ class MidiPort;
 class MidiInstrument;
 class Track;
 class Part;
+class TrackFreeze;
 
 extern std::list<QString> temporaryWavFiles; //!< Used for storing all tmp-files, for cleanup on shutdown
 //---------------------------------------------------------
@@ -66,6 +67,7 @@ struct UndoOp {
             ModifyTrackName, ModifyTrackChannel,
             SetTrackRecord, SetTrackMute, SetTrackSolo, SetTrackRecMonitor, SetTrackOff,
             MoveTrack,
+            SetTrackFreeze,
             ModifyClip,
             AddMarker, DeleteMarker, ModifyMarker,
             // This one is provided separately for optimizing repeated adjustments. It is 'combo breaker' -aware.
@@ -177,6 +179,11 @@ struct UndoOp {
                   QString* _oldName;
                   QString* _newName;
                 };
+            struct {
+                  // The freeze that is not installed belongs to the operation.
+                  TrackFreeze* _oldFreeze;
+                  TrackFreeze* _newFreeze;
+                };
             struct {
                   int trackno;
                 };
@@ -232,6 +239,7 @@ struct UndoOp {
       //UndoOp(UndoType type, MarkerList** oldMarkerList, MarkerList* newMarkerList, bool noUndo = false);
 
       UndoOp(UndoType type, const Track* track, const QString& old_name, const QString& new_name, bool noUndo = false);
+      UndoOp(UndoType type, const Track* track, TrackFreeze* oldFreeze, TrackFreeze* newFreeze, bool noUndo = false);
       // Because of C++ ambiguity complaints, these arguments are in a funny order.
       // It seems our CtrlVal(double) constructor can be interpreted as CtrlVal(unsigned int) !
       UndoOp(UndoType type, int ctrlID, unsigned int frame, const CtrlVal& cv, const Track* track, bool noUndo = false);
@@ -2763,6 +2763,8 @@ bool VstNativeSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsign
             if((samps & min_per_mask) != 0)
               samps += min_per;
           }
+          else if(ci.doInterp && cl)
+            samps = cl->rampSliceFrames(slice_frame, ci, &_controls[k].ramp, min_per, samps);
           else
             samps = min_per;
 
@@ -2773,7 +2775,7 @@ bool VstNativeSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsign
 
         float new_val;
         if(ci.doInterp && cl)
-          new_val = cl->interpolate(MusEGlobal::audio->isPlaying() ? slice_frame : pos, ci);
+          new_val = cl->rampValue(MusEGlobal::audio->isPlaying() ? slice_frame : pos, ci, &_controls[k].ramp);
         else
           new_val = ci.sVal;
         if(_controls[k].val != new_val)
@@ -2917,7 +2919,7 @@ bool VstNativeSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsign
               synti->_outUserEvents.insert(buf_ev);
           }
 
-          // Transfer the playback lock-free buffer events to the playback sorted multi-set.
+          // Transfer the playback lock-free buffer events to the playback queue.
           const unsigned int pb_buf_sz = synti->eventBuffers(MidiDevice::PlaybackBuffer)->getSize();
           for(unsigned int i = 0; i < pb_buf_sz; ++i)
           {
@@ -2930,13 +2932,7 @@ bool VstNativeSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsign
         if(_curActiveState && we)
         {
           // Count how many events we need.
-          for(ciMPEvent impe = synti->_outPlaybackEvents.begin(); impe != synti->_outPlaybackEvents.end(); ++impe)
-          {
-            const MidiPlayEvent& e = *impe;
-            if(e.time() >= (syncFrame + sample + slice_samps))
-              break;
-            ++nevents;
-          }
+          nevents += synti->_outPlaybackEvents.countBefore(syncFrame + sample + slice_samps);
           for(ciMPEvent impe = synti->_outUserEvents.begin(); impe != synti->_outUserEvents.end(); ++impe)
           {
             const MidiPlayEvent& e = *impe;
@@ -2951,22 +2947,21 @@ bool VstNativeSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsign
           vst_events->numEvents = 0;
           vst_events->reserved  = 0;
 
-          iMPEvent impe_pb = synti->_outPlaybackEvents.begin();
           iMPEvent impe_us = synti->_outUserEvents.begin();
           bool using_pb;
 
           unsigned long event_counter = 0;
           while(1)
           {
-            if(impe_pb != synti->_outPlaybackEvents.end() && impe_us != synti->_outUserEvents.end())
-              using_pb = *impe_pb < *impe_us;
-            else if(impe_pb != synti->_outPlaybackEvents.end())
+            if(!synti->_outPlaybackEvents.empty() && impe_us != synti->_outUserEvents.end())
+              using_pb = synti->_outPlaybackEvents.front() < *impe_us;
+            else if(!synti->_outPlaybackEvents.empty())
               using_pb = true;
             else if(impe_us != synti->_outUserEvents.end())
               using_pb = false;
             else break;
 
-            const MidiPlayEvent& e = using_pb ? *impe_pb : *impe_us;
+            const MidiPlayEvent& e = using_pb ? synti->_outPlaybackEvents.front() : *impe_us;
 
             #ifdef VST_NATIVE_DEBUG
             fprintf(stderr, "VstNativeSynthIF::getData eventFifos event time:%d\n", e.time());
@@ -2999,7 +2994,7 @@ bool VstNativeSynthIF::getData(MidiPort* /*mp*/, unsigned pos, int ports, unsign
             // Done with buffer's event. Remove it.
             // C++11.
             if(using_pb)
-              impe_pb = synti->_outPlaybackEvents.erase(impe_pb);
+              synti->_outPlaybackEvents.pop_front();
             else
               impe_us = synti->_outUserEvents.erase(impe_us);
           }
@@ -3541,6 +3536,10 @@ bool VstNativePluginWrapper::hasNativeGui() const
 
 void VstNativePluginWrapper::showNativeGui(PluginI *p, bool bShow)
 {
+   if(!bShow && p->instancesPending())
+      return;
+   if(p->makePendingInstances())
+      return;
    assert(p->instances > 0);
    VstNativePluginWrapper_State *state = (VstNativePluginWrapper_State *)p->handle [0];
    if(!hasNativeGui())
@@ -3579,6 +3578,8 @@ void VstNativePluginWrapper::showNativeGui(PluginI *p, bool bShow)
 
 bool VstNativePluginWrapper::nativeGuiVisible(const PluginI *p) const
 {
+   if(p->instancesPending())
+      return false;
    assert(p->instances > 0);
    VstNativePluginWrapper_State *state = (VstNativePluginWrapper_State *)p->handle [0];
    return state->guiVisible;
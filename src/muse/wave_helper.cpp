@@ -28,6 +28,7 @@
 #include <QMessageBox>
 
 #include "wave_helper.h"
+#include "wave_preload.h"
 #include "globals.h"
 #include "gconfig.h"
 #include "song.h"
@@ -256,6 +257,15 @@ SndFileR sndFileGetWave(const QString& inName, bool readOnlyFlag, bool openFlag,
       if(stretchList)
         *f->stretchList() = *stretchList;
         
+      // While a project is loaded, the file is opened along with the others,
+      //  and the loader reports the ones which failed.
+      if(openFlag && readOnlyFlag && WavePreload::current())
+      {
+        SndFileR r(f);
+        WavePreload::current()->openRead(r);
+        return r;
+      }
+
       if(openFlag)
       {
         bool error;
@@ -269,7 +279,7 @@ SndFileR sndFileGetWave(const QString& inName, bool readOnlyFlag, bool openFlag,
               QFileInfo wcainfo(cacheName);
               if (!wcainfo.exists() || wcainfo.lastModified() < wavinfo.lastModified()) {
                     QFile(cacheName).remove();
-                    f->readCache(cacheName,true);
+                    f->readCache(cacheName);
                     }
 
         }
@@ -0,0 +1,200 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  wave_loop_cache.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include <string.h>
+#include <new>
+
+#include "wave_loop_cache.h"
+#include "gconfig.h"
+
+namespace MusECore {
+
+std::atomic<unsigned> WaveLoopCache::_currentGeneration(1);
+std::atomic<long long> WaveLoopCache::_usedBytes(0);
+
+//---------------------------------------------------------
+//   WaveLoopCache
+//---------------------------------------------------------
+
+WaveLoopCache::WaveLoopCache()
+      : _channels(0), _begin(0), _end(0), _generation(0), _data(nullptr),
+        _streamStale(false), _bytes(0), _regionFrames(0), _storedFrames(0), _hits(0)
+      {
+      }
+
+WaveLoopCache::~WaveLoopCache()
+      {
+      release();
+      }
+
+//---------------------------------------------------------
+//   release
+//---------------------------------------------------------
+
+void WaveLoopCache::release()
+      {
+      if(_data)
+      {
+        delete[] _data;
+        _data = nullptr;
+        _usedBytes.fetch_sub(_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      }
+      _bytes.store(0, std::memory_order_relaxed);
+      _begin = _end = 0;
+      _channels = 0;
+      _regionFrames.store(0, std::memory_order_relaxed);
+      clearStored();
+      }
+
+//---------------------------------------------------------
+//   clearStored
+//---------------------------------------------------------
+
+void WaveLoopCache::clearStored()
+      {
+      _stored.clear();
+      _storedFrames.store(0, std::memory_order_relaxed);
+      }
+
+//---------------------------------------------------------
+//   setRegion
+//---------------------------------------------------------
+
+bool WaveLoopCache::setRegion(unsigned begin, unsigned end, int channels)
+      {
+      const long long budget = (long long)MusEGlobal::config.loopCacheMB * 1024 * 1024;
+      if(budget <= 0)
+      {
+        release();
+        return false;
+      }
+      if(end <= begin || channels <= 0)
+        return false;
+
+      const unsigned gen = _currentGeneration.load(std::memory_order_acquire);
+      if(_data && begin == _begin && end == _end && channels == _channels)
+      {
+        if(gen != _generation)
+        {
+          clearStored();
+          _generation = gen;
+        }
+        return true;
+      }
+
+      // Something else now. Start over, keeping the memory if the size is the same.
+      const size_t need = size_t(end - begin) * channels * sizeof(float);
+      if(!_data || need != _bytes.load(std::memory_order_relaxed))
+      {
+        release();
+        if(_usedBytes.fetch_add(need, std::memory_order_relaxed) + (long long)need > budget)
+        {
+          _usedBytes.fetch_sub(need, std::memory_order_relaxed);
+          return false;
+        }
+        _data = new (std::nothrow) float[size_t(end - begin) * channels];
+        if(!_data)
+        {
+          _usedBytes.fetch_sub(need, std::memory_order_relaxed);
+          return false;
+        }
+        _bytes.store(need, std::memory_order_relaxed);
+      }
+      _begin = begin;
+      _end = end;
+      _channels = channels;
+      _generation = gen;
+      _regionFrames.store(end - begin, std::memory_order_relaxed);
+      clearStored();
+      return true;
+      }
+
+//---------------------------------------------------------
+//   contains
+//---------------------------------------------------------
+
+bool WaveLoopCache::contains(unsigned pos, unsigned frames) const
+      {
+      if(!_data || pos < _begin || pos + frames > _end)
+        return false;
+      for(const auto& r : _stored)
+      {
+        if(pos < r.first)
+          return false;
+        if(pos + frames <= r.second)
+          return true;
+      }
+      return false;
+      }
+
+//---------------------------------------------------------
+//   read
+//---------------------------------------------------------
+
+void WaveLoopCache::read(unsigned pos, unsigned frames, float** dst)
+      {
+      const unsigned len = _end - _begin;
+      const float* src = _data + (pos - _begin);
+      for(int ch = 0; ch < _channels; ++ch)
+        memcpy(dst[ch], src + size_t(ch) * len, sizeof(float) * frames);
+      _hits.fetch_add(1, std::memory_order_relaxed);
+      }
+
+//---------------------------------------------------------
+//   store
+//---------------------------------------------------------
+
+void WaveLoopCache::store(unsigned pos, unsigned frames, float* const* src)
+      {
+      if(!_data)
+        return;
+      unsigned a = pos > _begin ? pos : _begin;
+      unsigned b = pos + frames < _end ? pos + frames : _end;
+      if(a >= b || contains(a, b - a))
+        return;
+
+      const unsigned len = _end - _begin;
+      for(int ch = 0; ch < _channels; ++ch)
+        memcpy(_data + size_t(ch) * len + (a - _begin), src[ch] + (a - pos), sizeof(float) * (b - a));
+
+      // Merge [a, b) with the ranges it overlaps or touches.
+      auto it = _stored.begin();
+      while(it != _stored.end() && it->second < a)
+        ++it;
+      while(it != _stored.end() && it->first <= b)
+      {
+        if(it->first < a)
+          a = it->first;
+        if(it->second > b)
+          b = it->second;
+        it = _stored.erase(it);
+      }
+      _stored.insert(it, std::make_pair(a, b));
+
+      unsigned n = 0;
+      for(const auto& r : _stored)
+        n += r.second - r.first;
+      _storedFrames.store(n, std::memory_order_relaxed);
+      }
+
+} // namespace MusECore
@@ -0,0 +1,120 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  wave_loop_cache.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __WAVE_LOOP_CACHE_H__
+#define __WAVE_LOOP_CACHE_H__
+
+#include <atomic>
+#include <stddef.h>
+#include <vector>
+#include <utility>
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   WaveLoopCache
+//    Keeps a wave track's prefetched audio for the loop
+//     region in memory while the song loops, so the later
+//     passes are copied from here instead of being read,
+//     resampled and stretched all over again.
+//
+//    The blocks read from disk during the first pass are
+//     stored as they go into the prefetch fifo. Blocks after
+//     a loop wrap start a little before the left locator,
+//     so the region starts one segment early.
+//
+//    All the caches together stay within config.loopCacheMB.
+//     A track which does not fit is simply read from disk.
+//
+//    Anything which may change what a track plays, such as
+//     executing song operations or idling the audio for wave
+//     editing, calls invalidateAll(). The caches then start
+//     over the next time they are used.
+//
+//    Only the prefetch job of the owning track uses a cache,
+//     apart from the statistics.
+//---------------------------------------------------------
+
+class WaveLoopCache {
+      int _channels;
+      // The cached region, in frames.
+      unsigned _begin;
+      unsigned _end;
+      // The invalidation generation the contents belong to.
+      unsigned _generation;
+      // _channels runs of (_end - _begin) frames.
+      float* _data;
+      // Sorted, disjoint ranges of frames stored so far.
+      std::vector<std::pair<unsigned, unsigned> > _stored;
+      // Whether the track's sound files are no longer where the next block starts.
+      bool _streamStale;
+
+      // Statistics: Memory held, frames in the region and stored so far,
+      //  and blocks copied from the cache.
+      std::atomic<size_t> _bytes;
+      std::atomic<unsigned> _regionFrames;
+      std::atomic<unsigned> _storedFrames;
+      std::atomic<unsigned long> _hits;
+
+      static std::atomic<unsigned> _currentGeneration;
+      static std::atomic<long long> _usedBytes;
+
+      void clearStored();
+
+   public:
+      WaveLoopCache();
+      ~WaveLoopCache();
+      WaveLoopCache(const WaveLoopCache&) = delete;
+      WaveLoopCache& operator=(const WaveLoopCache&) = delete;
+
+      // Makes the cache hold the region [begin, end) of the given channels, starting over
+      //  if it held something else or was invalidated. Returns false if the cache is
+      //  disabled or the region does not fit into the memory budget.
+      bool setRegion(unsigned begin, unsigned end, int channels);
+      // Frees the memory.
+      void release();
+
+      // Whether the frames [pos, pos + frames) are all stored.
+      bool contains(unsigned pos, unsigned frames) const;
+      // Copies stored frames into the channel buffers of dst. They must all be stored.
+      void read(unsigned pos, unsigned frames, float** dst);
+      // Stores the frames of the channel buffers of src, as far as they fall into the region.
+      void store(unsigned pos, unsigned frames, float* const* src);
+
+      bool streamStale() const { return _streamStale; }
+      void setStreamStale(bool v) { _streamStale = v; }
+
+      // Statistics. Any thread.
+      size_t bytes() const { return _bytes.load(std::memory_order_relaxed); }
+      unsigned regionFrames() const { return _regionFrames.load(std::memory_order_relaxed); }
+      unsigned storedFrames() const { return _storedFrames.load(std::memory_order_relaxed); }
+      unsigned long hits() const { return _hits.load(std::memory_order_relaxed); }
+
+      // Any thread.
+      static void invalidateAll() { _currentGeneration.fetch_add(1, std::memory_order_release); }
+      static long long usedBytes() { return _usedBytes.load(std::memory_order_relaxed); }
+      };
+
+} // namespace MusECore
+
+#endif
@@ -0,0 +1,87 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  wave_preload.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#include "wave_preload.h"
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   WavePreload
+//---------------------------------------------------------
+
+WavePreload::WavePreload(int threads)
+  : _jobs(threads)
+{
+}
+
+//---------------------------------------------------------
+//   add
+//---------------------------------------------------------
+
+void WavePreload::add(std::function<void()> job)
+{
+  _jobs.add(std::move(job));
+}
+
+//---------------------------------------------------------
+//   openRead
+//---------------------------------------------------------
+
+void WavePreload::openRead(const SndFileR& file)
+{
+  _entries.push_back(Entry { file, false, QString() });
+  Entry* e = &_entries.back();
+  // The job must not touch the reference count, the gui thread holds the reference.
+  SndFile* sf = *e->file;
+  _opening.insert(sf);
+  add([e, sf]() {
+    e->error = sf->openRead();
+    if(e->error)
+      e->errorText = sf->strerror();
+    });
+}
+
+//---------------------------------------------------------
+//   wait
+//---------------------------------------------------------
+
+void WavePreload::wait(const std::function<void(int done, int total)>& progress)
+{
+  _jobs.wait(progress);
+  _opening.clear();
+}
+
+//---------------------------------------------------------
+//   failed
+//---------------------------------------------------------
+
+std::deque<WavePreload::Failure> WavePreload::failed() const
+{
+  std::deque<Failure> res;
+  for(const Entry& e : _entries)
+    if(e.error)
+      res.push_back(Failure { e.file, e.errorText });
+  return res;
+}
+
+} // namespace MusECore
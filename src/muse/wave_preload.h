@@ -0,0 +1,98 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  wave_preload.h
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+#ifndef __WAVE_PRELOAD_H__
+#define __WAVE_PRELOAD_H__
+
+#include <deque>
+#include <functional>
+#include <set>
+
+#include <QString>
+
+#include "wave.h"
+#include "counted_jobs.h"
+#include "current_preload.h"
+
+namespace MusECore {
+
+//---------------------------------------------------------
+//   WavePreload
+//    Opens the wave files of a project on a few threads,
+//     while the song file is still being read. Opening a
+//     file reads its header and its .wca peak file and
+//     sets up its converters, which for big sessions
+//     is mostly waiting for the disk.
+//
+//    While a preload is current, sndFileGetWave() hands
+//     the files it would open for reading to it, and
+//     returns them before they are open. Nothing may look
+//     at those files until wait() returned, code which
+//     may see them first asks isOpening(). Afterwards,
+//     failed() lists the files which could not be opened.
+//
+//    Only the gui thread adds and waits.
+//---------------------------------------------------------
+
+class WavePreload : public CurrentPreload<WavePreload> {
+   public:
+      struct Failure {
+            SndFileR file;
+            QString error;
+            };
+
+   private:
+      struct Entry {
+            SndFileR file;
+            bool error;
+            QString errorText;
+            };
+
+      // Entries do not move when more are added, the jobs point to them.
+      std::deque<Entry> _entries;
+      // The files being opened, until wait() returned.
+      std::set<const SndFile*> _opening;
+      // Waits for the jobs not done yet when destroyed, before the entries go.
+      CountedJobs _jobs;
+
+   public:
+      WavePreload(int threads);
+      WavePreload(const WavePreload&) = delete;
+      WavePreload& operator=(const WavePreload&) = delete;
+
+      // Runs the job on one of the threads.
+      void add(std::function<void()> job);
+      // Opens the file for reading on one of the threads.
+      void openRead(const SndFileR& file);
+      // Whether the file was handed to openRead() and wait() has not returned yet.
+      bool isOpening(const SndFile* file) const { return _opening.find(file) != _opening.end(); }
+      // Waits until all jobs are done. progress, if given, is called on the
+      //  calling thread now and then, with the jobs done and the jobs added.
+      void wait(const std::function<void(int done, int total)>& progress = nullptr);
+      // The files which could not be opened, after wait().
+      std::deque<Failure> failed() const;
+      };
+
+} // namespace MusECore
+
+#endif
@@ -32,6 +32,7 @@
 #include "wave.h"
 #include "part.h"
 #include "wave_helper.h"
+#include "wave_preload.h"
 #include "audio_fifo.h"
 
 #include <iostream>
@@ -73,8 +74,13 @@ WaveEventBase::WaveEventBase(const WaveEventBase& ev, bool duplicate_not_clone)
       //       So duplicate_not_clone is not used here. 
       if(!ev.f.isNull() && !ev.f.canonicalPath().isEmpty())
       {
+        // Clones made while a project loads may copy a file which is still being opened.
+        // Its open state must not be looked at yet. It is being opened for reading,
+        //  so the copy is opened for reading along with it. Opening only reads the
+        //  converter settings and stretch list, so they can be copied meanwhile.
+        const bool opening = WavePreload::current() && WavePreload::current()->isOpening(*ev.f);
         // Don't show error box, and assign the audio converter settings and stretch list.
-        f = sndFileGetWave(ev.f.canonicalPath(), !ev.f.isWritable(), ev.f.isOpen(),
+        f = sndFileGetWave(ev.f.canonicalPath(), opening || !ev.f.isWritable(), opening || ev.f.isOpen(),
                     false, ev.f.audioConverterSettings(), ev.f.stretchList());
       }
 }
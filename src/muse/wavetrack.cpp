@@ -34,6 +34,7 @@
 #include "gconfig.h"
 #include "al/dsp.h"
 #include "audioprefetch.h"
+#include "audio_anticipator.h"
 //#include "latency_compensator.h"
 #include "config.h"
 #include "xml_statistics.h"
@@ -54,18 +55,29 @@ namespace MusECore {
 //---------------------------------------------------------
 
 // Default 1 channel for wave tracks.
-WaveTrack::WaveTrack() : AudioTrack(Track::WAVE, 1)
+WaveTrack::WaveTrack() : AudioTrack(Track::WAVE, 1), _prefetchFifo(0, MusEGlobal::fifoMaxLength)
 {
   _prefetchWritePos = ~0;
+  _anticipationEpoch.store(0);
+  _anticipationBusy.store(false);
+  _anticipationBuffer.store(nullptr);
 }
 
-WaveTrack::WaveTrack(const WaveTrack& wt, int flags) : AudioTrack(wt, flags)
+WaveTrack::WaveTrack(const WaveTrack& wt, int flags) : AudioTrack(wt, flags), _prefetchFifo(0, MusEGlobal::fifoMaxLength)
 {
   _prefetchWritePos = ~0;
+  _anticipationEpoch.store(0);
+  _anticipationBusy.store(false);
+  _anticipationBuffer.store(nullptr);
 
   internal_assign(wt, flags | Track::ASSIGN_PROPERTIES);
 }
 
+WaveTrack::~WaveTrack()
+{
+  delete takeAnticipationBuffer();
+}
+
 void WaveTrack::internal_assign(const Track& t, int flags)
 {
       if(t.type() != WAVE)
@@ -151,7 +163,18 @@ void WaveTrack::seekData(sf_count_t pos)
 
 void WaveTrack::fetchData(unsigned pos, unsigned samples, float** bp, bool doSeek, bool overwrite, int latency_correction)
       {
-      WAVETRACK_DEBUG(stderr, "WaveTrack::fetchData %s samples:%u pos:%u overwrite:%d\n",
+      readData(pos, samples, bp, doSeek, overwrite, latency_correction);
+      _prefetchFifo.add();
+      }
+
+//---------------------------------------------------------
+//   readData
+//    called from prefetch threads
+//---------------------------------------------------------
+
+void WaveTrack::readData(unsigned pos, unsigned samples, float** bp, bool doSeek, bool overwrite, int latency_correction)
+      {
+      WAVETRACK_DEBUG(stderr, "WaveTrack::readData %s samples:%u pos:%u overwrite:%d\n",
                       name().toLatin1().constData(), samples, pos, overwrite);
 
       // reset buffer to zero
@@ -245,8 +268,6 @@ void WaveTrack::fetchData(unsigned pos, unsigned samples, float** bp, bool doSee
                   for (unsigned int j = 0; j < samples; ++j)
                       bp[i][j] +=MusEGlobal::denormalBias;
             }
-
-      _prefetchFifo.add();
       }
 
 //---------------------------------------------------------
@@ -400,6 +421,7 @@ bool WaveTrack::getPrefetchData(
     if(_prefetchFifo.peek(dstChannels, nframe, pf_buf, &pos))
     {
       fprintf(stderr, "WaveTrack::getPrefetchData(%s) (prefetch peek A) fifo underrun\n", name().toLocal8Bit().constData());
+      _prefetchStats.underruns.fetch_add(1, std::memory_order_relaxed);
       return false;
     }
 
@@ -433,6 +455,7 @@ bool WaveTrack::getPrefetchData(
         if(_prefetchFifo.peek(dstChannels, nframe, pf_buf, &pos))
         {
           fprintf(stderr, "WaveTrack::getPrefetchData(%s) (prefetch peek B) fifo underrun\n", name().toLocal8Bit().constData());
+          _prefetchStats.underruns.fetch_add(1, std::memory_order_relaxed);
           return false;
         }
 
@@ -508,6 +531,7 @@ bool WaveTrack::getPrefetchData(
       if(_prefetchFifo.peek(dstChannels, nframe, pf_buf, &pos))
       {
         fprintf(stderr, "WaveTrack::getPrefetchData(%s) (prefetch peek C) fifo underrun\n", name().toLocal8Bit().constData());
+        _prefetchStats.underruns.fetch_add(1, std::memory_order_relaxed);
         return false;
       }
       
@@ -756,6 +780,73 @@ bool WaveTrack::getData(unsigned framePos, int dstChannels, unsigned nframe, flo
   return have_data || have_pf_data;
 }
 
+//---------------------------------------------------------
+//   getFrozenData
+//---------------------------------------------------------
+
+void WaveTrack::getFrozenData(unsigned pos, int channels, unsigned nframes, float** bp)
+{
+  // Keep the prefetched file data in step, so it is ready when the track
+  //  is unfrozen. Then replace it with the frozen output.
+  if(MusEGlobal::audio->isPlaying())
+    getPrefetchData(pos, channels, nframes, bp, true);
+  AudioTrack::getFrozenData(pos, channels, nframes, bp);
+}
+
+//---------------------------------------------------------
+//   getAnticipatedData
+//---------------------------------------------------------
+
+bool WaveTrack::getAnticipatedData(unsigned pos, int channels, unsigned nframes, float** bp)
+{
+  const unsigned epoch = _anticipationEpoch.load();
+  if(epoch != 0)
+  {
+    const AudioAnticipator* ant = MusEGlobal::audio->anticipator();
+    if(ant->isActive() && epoch == ant->epoch() && AudioAnticipator::canAnticipate(this))
+    {
+      // The track belongs to the renderer. Only take its blocks once the transport
+      //  is rolling. If the block is late there is nothing else to play.
+      AnticipationBuffer* b = anticipationBuffer();
+      if(!MusEGlobal::audio->isPlaying() || !b || !b->read(epoch, pos, channels, nframes, bp))
+      {
+        for(int i = 0; i < channels; ++i)
+          AL::dsp->clear(bp[i], nframes, MusEGlobal::config.useDenormalBias);
+      }
+      return true;
+    }
+    // The session has ended, or the track no longer qualifies. Take the track back.
+    _anticipationEpoch.store(0);
+  }
+
+  // The renderer checks the claim after setting the busy flag, so if it is not busy
+  //  now it will leave the track alone from here on.
+  if(!_anticipationBusy.load())
+    return false;
+
+  // The renderer is still finishing a block for the track. Don't touch it this cycle.
+  for(int i = 0; i < channels; ++i)
+    AL::dsp->clear(bp[i], nframes, MusEGlobal::config.useDenormalBias);
+  return true;
+}
+
+//---------------------------------------------------------
+//   renderAnticipated
+//    Called from anticipative renderer threads, while the
+//    track is claimed. Only playback sources are involved
+//    since claimed tracks are neither recording nor monitoring.
+//---------------------------------------------------------
+
+void WaveTrack::renderAnticipated(unsigned pos, int channels, unsigned nframes, float** bp)
+{
+  if(!getPrefetchData(pos, channels, nframes, bp, true))
+  {
+    for(int i = 0; i < channels; ++i)
+      AL::dsp->clear(bp[i], nframes, MusEGlobal::config.useDenormalBias);
+  }
+  _efxPipe->apply(pos, this->channels(), nframes, true, bp);
+}
+
 inline bool WaveTrack::canDominateOutputLatency() const
 {
   // The wave track's own wave file contributions can never dominate latency.
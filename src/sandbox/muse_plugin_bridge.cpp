@@ -0,0 +1,417 @@
+//=========================================================
+//  MusE
+//  Linux Music Editor
+//
+//  muse_plugin_bridge.cpp
+//  (C) Copyright 2026 MusE development team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; version 2 of
+//  the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//=========================================================
+
+// Runs one instance of a LADSPA or DSSI plugin for MusE, in this process
+//  instead of MusE's audio thread. Started by MusECore::PluginBridge,
+//  see plugin_bridge_shm.h for how the two talk to each other.
+//
+// Usage: muse_plugin_bridge <library> <label> <realtime priority>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <dlfcn.h>
+#include <poll.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <ladspa.h>
+
+#include "config.h"
+#ifdef DSSI_SUPPORT
+#include <dssi.h>
+#endif
+
+#include "plugin_bridge_shm.h"
+
+using namespace MusEPlugin;
+
+namespace MusEPluginBridge {
+
+//---------------------------------------------------------
+//   Host
+//---------------------------------------------------------
+
+struct Host {
+      void* shm;
+      BridgeShmHeader* header;
+      BridgeShmLayout layout;
+      const LADSPA_Descriptor* descr;
+#ifdef DSSI_SUPPORT
+      const DSSI_Descriptor* dssi;
+#endif
+      LADSPA_Handle handle;
+      bool active;
+
+      // The plugin runs on these, the rings may wrap around in the middle of a block.
+      std::vector<std::vector<float> > audioIns;
+      std::vector<std::vector<float> > audioOuts;
+      std::vector<float> controlIns;
+      std::vector<float> controlOuts;
+
+      Host(void* s) : shm(s), header((BridgeShmHeader*)s), layout(header),
+                      descr(nullptr),
+#ifdef DSSI_SUPPORT
+                      dssi(nullptr),
+#endif
+                      handle(nullptr), active(false) { }
+
+      bool instantiate(const char* filename, const char* label);
+      void connect();
+      void runCommand(const BridgeCommand* c);
+      void run(const BridgeCommand* c);
+      void selectProgram(const BridgeCommand* c);
+      void answer(BridgeRequest* r);
+      };
+
+//---------------------------------------------------------
+//   instantiate
+//---------------------------------------------------------
+
+bool Host::instantiate(const char* filename, const char* label)
+      {
+      void* lib = dlopen(filename, RTLD_NOW);
+      if (!lib) {
+            fprintf(stderr, "muse_plugin_bridge: dlopen(%s) failed: %s\n", filename, dlerror());
+            return false;
+            }
+      if (header->dssi) {
+#ifdef DSSI_SUPPORT
+            if (header->eventSize != sizeof(snd_seq_event_t)) {
+                  fprintf(stderr, "muse_plugin_bridge: MusE's DSSI events do not match this build\n");
+                  return false;
+                  }
+            DSSI_Descriptor_Function df = (DSSI_Descriptor_Function)dlsym(lib, "dssi_descriptor");
+            if (!df) {
+                  fprintf(stderr, "muse_plugin_bridge: %s is not a DSSI library\n", filename);
+                  return false;
+                  }
+            for (unsigned long i = 0; (dssi = df(i)) != nullptr; ++i)
+                  if (strcmp(dssi->LADSPA_Plugin->Label, label) == 0)
+                        break;
+            descr = dssi ? dssi->LADSPA_Plugin : nullptr;
+#else
+            fprintf(stderr, "muse_plugin_bridge: built without DSSI support\n");
+            return false;
+#endif
+            }
+      else {
+            LADSPA_Descriptor_Function ladspa = (LADSPA_Descriptor_Function)dlsym(lib, "ladspa_descriptor");
+            if (!ladspa) {
+                  fprintf(stderr, "muse_plugin_bridge: %s is not a LADSPA library\n", filename);
+                  return false;
+                  }
+            for (unsigned long i = 0; (descr = ladspa(i)) != nullptr; ++i)
+                  if (strcmp(descr->Label, label) == 0)
+                        break;
+            }
+      if (!descr) {
+            fprintf(stderr, "muse_plugin_bridge: no plugin %s in %s\n", label, filename);
+            return false;
+            }
+      if (descr->PortCount != header->portCount) {
+            fprintf(stderr, "muse_plugin_bridge: %s has %lu ports, MusE expects %u\n",
+                    label, descr->PortCount, header->portCount);
+            return false;
+            }
+
+      handle = descr->instantiate(descr, header->sampleRate);
+      if (!handle) {
+            fprintf(stderr, "muse_plugin_bridge: %s instantiate failed\n", label);
+            return false;
+            }
+      connect();
+      return true;
+      }
+
+//---------------------------------------------------------
+//   connect
+//---------------------------------------------------------
+
+void Host::connect()
+      {
+      audioIns.assign(header->audioIns, std::vector<float>(header->maxFrames));
+      audioOuts.assign(header->audioOuts, std::vector<float>(header->maxFrames));
+      controlIns.assign(header->controlIns, 0.0f);
+      controlOuts.assign(header->controlOuts, 0.0f);
+
+      unsigned long ai = 0, ao = 0, ci = 0, co = 0;
+      for (unsigned long k = 0; k < descr->PortCount; ++k) {
+            const LADSPA_PortDescriptor pd = descr->PortDescriptors[k];
+            float* buf = nullptr;
+            if (LADSPA_IS_PORT_AUDIO(pd))
+                  buf = LADSPA_IS_PORT_INPUT(pd) ? audioIns.at(ai++).data() : audioOuts.at(ao++).data();
+            else if (LADSPA_IS_PORT_CONTROL(pd))
+                  buf = LADSPA_IS_PORT_INPUT(pd) ? &controlIns.at(ci++) : &controlOuts.at(co++);
+            descr->connect_port(handle, k, buf);
+            }
+      }
+
+//---------------------------------------------------------
+//   runCommand
+//---------------------------------------------------------
+
+void Host::runCommand(const BridgeCommand* c)
+      {
+      // A program selected meanwhile set the controls, they stay until
+      //  MusE has taken them.
+      if (c->programControls == header->programControls.load(std::memory_order_relaxed)) {
+            const float* controls = BridgeShmLayout::commandControls(const_cast<BridgeCommand*>(c));
+            for (size_t i = 0; i < controlIns.size(); ++i)
+                  controlIns[i] = controls[i];
+            }
+
+      switch (c->type) {
+            case BridgeActivate:
+                  if (!active && descr->activate)
+                        descr->activate(handle);
+                  active = true;
+                  break;
+            case BridgeDeactivate:
+                  if (active && descr->deactivate)
+                        descr->deactivate(handle);
+                  active = false;
+                  break;
+            case BridgeSelectProgram:
+                  selectProgram(c);
+                  break;
+            case BridgeRun:
+                  run(c);
+                  break;
+            default:
+                  break;
+            }
+      }
+
+//---------------------------------------------------------
+//   run
+//---------------------------------------------------------
+
+void Host::run(const BridgeCommand* c)
+      {
+      const uint32_t ringFrames = header->ringFrames;
+      const uint32_t n = c->frames;
+      const uint32_t inPos = header->inputRead.load(std::memory_order_relaxed);
+      const uint32_t outPos = header->outputWrite.load(std::memory_order_relaxed);
+      for (size_t i = 0; i < audioIns.size(); ++i)
+            bridgeRingRead(layout.inputRing(shm, ringFrames, i), ringFrames, inPos,
+                           audioIns[i].data(), n);
+      header->inputRead.store(inPos + n, std::memory_order_release);
+
+#ifdef DSSI_SUPPORT
+      if (dssi && (dssi->run_synth || dssi->run_multiple_synths)) {
+            snd_seq_event_t* events = (snd_seq_event_t*)BridgeShmLayout::commandEvents(
+                                          const_cast<BridgeCommand*>(c), header->controlIns);
+            unsigned long count = c->events;
+            if (dssi->run_synth)
+                  dssi->run_synth(handle, n, count ? events : nullptr, count);
+            else {
+                  snd_seq_event_t* ev = count ? events : nullptr;
+                  dssi->run_multiple_synths(1, &handle, n, &ev, &count);
+                  }
+            }
+      else
+#endif
+            descr->run(handle, n);
+
+      for (size_t i = 0; i < audioOuts.size(); ++i)
+            bridgeRingWrite(layout.outputRing(shm, ringFrames, i), ringFrames, outPos,
+                            audioOuts[i].data(), n);
+      float* ctrlOut = layout.controlOutValues(shm);
+      for (size_t i = 0; i < controlOuts.size(); ++i)
+            ctrlOut[i] = controlOuts[i];
+      header->outputWrite.store(outPos + n, std::memory_order_release);
+      }
+
+//---------------------------------------------------------
+//   selectProgram
+//    The plugin sets its controls for the program, MusE
+//     takes them from the program controls.
+//---------------------------------------------------------
+
+void Host::selectProgram(const BridgeCommand* c)
+      {
+#ifdef DSSI_SUPPORT
+      if (dssi && dssi->select_program)
+            dssi->select_program(handle, c->bank, c->program);
+#endif
+      float* values = layout.programControlValues(shm);
+      for (size_t i = 0; i < controlIns.size(); ++i)
+            values[i] = controlIns[i];
+      header->programControls.fetch_add(1, std::memory_order_release);
+      }
+
+//---------------------------------------------------------
+//   answer
+//    Answers a request of the gui thread.
+//---------------------------------------------------------
+
+void Host::answer(BridgeRequest* r)
+      {
+      r->result = 0;
+#ifdef DSSI_SUPPORT
+      if (!dssi)
+            return;
+      switch (r->type) {
+            case BridgeConfigure:
+                  if (dssi->configure) {
+                        r->text[BridgeRequestText - 1] = 0;
+                        const char* key = r->text;
+                        const size_t keyLen = strlen(key);
+                        if (keyLen + 1 >= BridgeRequestText)
+                              break;
+                        char* message = dssi->configure(handle, key, key + keyLen + 1);
+                        if (message) {
+                              const size_t valueLen = strlen(key + keyLen + 1);
+                              char* dst = r->text + keyLen + valueLen + 2;
+                              const size_t room = BridgeRequestText - (keyLen + valueLen + 2);
+                              if (room > 0) {
+                                    strncpy(dst, message, room - 1);
+                                    dst[room - 1] = 0;
+                                    r->result = 1;
+                                    }
+                              free(message);
+                              }
+                        }
+                  break;
+            case BridgeGetProgram:
+                  if (dssi->get_program) {
+                        const DSSI_Program_Descriptor* pd = dssi->get_program(handle, r->index);
+                        if (pd) {
+                              r->bank = pd->Bank;
+                              r->program = pd->Program;
+                              strncpy(r->text, pd->Name ? pd->Name : "", BridgeRequestText - 1);
+                              r->text[BridgeRequestText - 1] = 0;
+                              r->result = 1;
+                              }
+                        }
+                  break;
+            case BridgeGetMidiController:
+                  r->result = dssi->get_midi_controller_for_port
+                                 ? dssi->get_midi_controller_for_port(handle, r->index) : DSSI_NONE;
+                  break;
+            default:
+                  break;
+            }
+#endif
+      }
+
+} // namespace MusEPluginBridge
+
+//---------------------------------------------------------
+//   main
+//---------------------------------------------------------
+
+int main(int argc, char* argv[])
+      {
+      if (argc < 4) {
+            fprintf(stderr, "usage: %s <library> <label> <realtime priority>\n"
+                            "Started by MusE, do not run it yourself.\n", argv[0]);
+            return 1;
+            }
+
+      struct stat st;
+      if (fstat(BridgeShmFd, &st) != 0 || (size_t)st.st_size < sizeof(BridgeShmHeader)) {
+            fprintf(stderr, "muse_plugin_bridge: no shared memory\n");
+            return 1;
+            }
+      void* shm = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, BridgeShmFd, 0);
+      if (shm == MAP_FAILED) {
+            fprintf(stderr, "muse_plugin_bridge: cannot map shared memory: %s\n", strerror(errno));
+            return 1;
+            }
+      BridgeShmHeader* header = (BridgeShmHeader*)shm;
+      if (header->magic != BridgeShmMagic || header->version != BridgeShmVersion
+         || BridgeShmLayout(header).total > (size_t)st.st_size) {
+            fprintf(stderr, "muse_plugin_bridge: shared memory does not match this version\n");
+            return 1;
+            }
+
+      MusEPluginBridge::Host host(shm);
+      const uint64_t one = 1;
+      if (!host.instantiate(argv[1], argv[2])) {
+            header->state.store(BridgeFailed, std::memory_order_release);
+            if (write(BridgeReplyFd, &one, sizeof(one)) < 0) { }
+            return 1;
+            }
+
+      const int priority = atoi(argv[3]);
+      if (priority > 0) {
+            sched_param sp;
+            sp.sched_priority = priority;
+            if (sched_setscheduler(0, SCHED_FIFO, &sp) != 0)
+                  fprintf(stderr, "muse_plugin_bridge: cannot set realtime priority %d: %s\n",
+                          priority, strerror(errno));
+            }
+      // The memory the plugin runs on must not be paged out either.
+      mlockall(MCL_CURRENT);
+
+      header->state.store(BridgeReady, std::memory_order_release);
+      if (write(BridgeReplyFd, &one, sizeof(one)) < 0) { }
+
+      bool quit = false;
+      while (!quit) {
+            // Wait for a command, or for MusE to go away.
+            pollfd p[2] = { { BridgeRequestFd, POLLIN, 0 }, { BridgeParentFd, POLLIN, 0 } };
+            if (poll(p, 2, -1) < 0) {
+                  if (errno == EINTR)
+                        continue;
+                  break;
+                  }
+            if (p[1].revents)
+                  break;
+            uint64_t v;
+            if (read(BridgeRequestFd, &v, sizeof(v)) < 0) {
+                  if (errno == EINTR)
+                        continue;
+                  break;
+                  }
+            uint32_t pos = header->commandRead.load(std::memory_order_relaxed);
+            while (pos != header->commandWrite.load(std::memory_order_acquire)) {
+                  const BridgeCommand* c = host.layout.command(shm, pos);
+                  if (c->type == BridgeQuit) {
+                        quit = true;
+                        break;
+                        }
+                  host.runCommand(c);
+                  header->commandRead.store(++pos, std::memory_order_release);
+                  }
+            const uint32_t request = header->requestWrite.load(std::memory_order_acquire);
+            if (!quit && request != header->requestRead.load(std::memory_order_relaxed)) {
+                  host.answer(host.layout.requestSlot(shm));
+                  header->requestRead.store(request, std::memory_order_release);
+                  }
+            if (write(BridgeReplyFd, &one, sizeof(one)) < 0) { }
+            }
+
+      if (host.active && host.descr->deactivate)
+            host.descr->deactivate(host.handle);
+      if (host.descr->cleanup)
+            host.descr->cleanup(host.handle);
+      return 0;
+      }